@@ -19,6 +19,10 @@ or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
 
  // forward decl
 struct ImagingMemoryInstance;
+namespace world
+{
+	void __vectorcall markHeightDirtyLocal(point2D_t const voxelIndex); // world.h
+} // end ns
 
 namespace Iso
 {
@@ -376,7 +380,13 @@ namespace Iso
 	}
 	STATIC_INLINE void __vectorcall setHeightStep(point2D_t const voxelIndex, uint32_t const HeightStep) // HeightStep must be within the range 0u .... 65535u
 	{
-		*Voxel::HeightMapReference(voxelIndex) = HeightStep;
+		heightstep* const __restrict pHeightStep(Voxel::HeightMapReference(voxelIndex));
+		uint32_t const last(*pHeightStep);
+
+		if (last != HeightStep) {
+			*pHeightStep = HeightStep;
+			world::markHeightDirtyLocal(voxelIndex); // derived data (ground adjacency, picking) is updated for the dirty regions once per frame
+		}
 	}
 	STATIC_INLINE_PURE float const getRealHeight(heightstep const HeightStep)
 	{
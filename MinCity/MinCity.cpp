@@ -52,6 +52,11 @@ or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
 // ^^^^ SINGLETON INCLUDES ^^^^ // b4 MinCity.h include
 #define MINCITY_IMPLEMENTATION
 #include "MinCity.h"
+#include "performance.h"
+#include "replay.h"
+#include "frameGraph.h"
+#include "codec.h"
+#include "undoJournal.h"
 
 #include "RedirectIO.h"
 
@@ -67,10 +72,6 @@ namespace // private to this file (anonymous)
 
 #ifdef DEBUG_VARIABLES_ENABLED
 
-#ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
-#include "performance.h"
-#endif
-
 // Initialization of any debug variables here
 // does not matter if a different local static variable will be referenced afterwards, can be done
 // can also be initialized to some global static
@@ -142,6 +143,18 @@ void cMinCity::LoadINI()
 
 	bool const bDPIAware = (bool)GetPrivateProfileInt(L"RENDER_SETTINGS", L"DPI_AWARE", TRUE, szINIFile);
 	Nuklear->setFrameBufferDPIAware(bDPIAware);
+
+	// compression codec per use-site (codec::eCodec)
+	codec::select(codec::eSite::GRID_CHUNK, (uint32_t)GetPrivateProfileInt(L"STORAGE_SETTINGS", L"GRID_CODEC", codec::eCodec::DENSITY_CHAMELEON, szINIFile),
+											GetPrivateProfileInt(L"STORAGE_SETTINGS", L"GRID_CODEC_LEVEL", 0, szINIFile));
+	codec::select(codec::eSite::MODEL_CACHE, (uint32_t)GetPrivateProfileInt(L"STORAGE_SETTINGS", L"MODEL_CODEC", codec::eCodec::DENSITY_CHEETAH, szINIFile),
+											 GetPrivateProfileInt(L"STORAGE_SETTINGS", L"MODEL_CODEC_LEVEL", 0, szINIFile));
+	codec::select(codec::eSite::UNDO_JOURNAL, (uint32_t)GetPrivateProfileInt(L"STORAGE_SETTINGS", L"UNDO_CODEC", codec::eCodec::VOXEL_RLE, szINIFile),
+											  GetPrivateProfileInt(L"STORAGE_SETTINGS", L"UNDO_CODEC_LEVEL", 0, szINIFile));
+
+	// undo journal memory, beyond UNDO_MEMORY_MB the oldest operations spill to disk, beyond UNDO_SPILL_MB they are discarded
+	undo::configure(size_t(GetPrivateProfileInt(L"STORAGE_SETTINGS", L"UNDO_MEMORY_MB", 8, szINIFile)) << 20,
+					size_t(GetPrivateProfileInt(L"STORAGE_SETTINGS", L"UNDO_SPILL_MB", 64, szINIFile)) << 20);
 }
 
 static void window_iconify_callback(GLFWwindow* const window, int const iconified)
@@ -220,6 +233,10 @@ NO_INLINE bool const cMinCity::Initialize(GLFWwindow*& glfwwindow)
 	// Load Settings
 	LoadINI(); // sequence first
 
+	if (replay::isHeadless()) {
+		return(InitializeHeadless());
+	}
+
 	if (!Vulkan->LoadVulkanFramework()) {// sequence second
 		fmt::print(fg(fmt::color::red), "[Vulkan] failed to load framework, unsupported required extension or feature.\n");
 		return(false);
@@ -382,6 +399,37 @@ NO_INLINE bool const cMinCity::Initialize(GLFWwindow*& glfwwindow)
 	return(true);
 }
 
+// no window is created and Vulkan is never loaded, the framebuffer size stays as set by the ini. everything that only renders is skipped, see Render()
+NO_INLINE bool const cMinCity::InitializeHeadless()
+{
+	supernoise::InitializeDefaultNoiseGeneration();
+
+	VoxelWorld->LoadTextures(); // cpu side only
+
+	Physics->Initialize();
+
+	m_bNewEventsAllowed = true;
+	VoxelWorld->Initialize();
+
+	m_bFocused = true; // never loses focus, exclusivity stays DEFAULT
+
+	City = new cCity(m_szCityName);
+
+	VoxelWorld->Update(m_tNow, zero_time_duration, true, true);
+
+	UserInterface->Initialize();
+
+	if (!Audio->Initialize()) {
+		FMT_LOG_FAIL(AUDIO_LOG, "FMOD was unable to initialize!\n");
+	}
+
+	DispatchEvent(eEvent::REFRESH_LOADLIST);
+
+	m_bRunning = true;
+
+	return(true);
+}
+
 void cMinCity::Pause(bool const bStateIsPaused)
 {
 	if (!bStateIsPaused && (eWindowType::DISABLED != Nuklear->getWindowEnabled())) // disallow changing pause state while quit, save, load, new windows are showing 
@@ -478,6 +526,8 @@ NO_INLINE std::filesystem::path const cMinCity::getUserFolder()
 	return(path);
 }
 
+constinit static int64_t _task_id_save(0); // the world keeps updating while a save is written, new & load must wait on it
+
 void cMinCity::OnNew()
 {
 	constinit static int64_t _task_id_new(0);
@@ -487,8 +537,11 @@ void cMinCity::OnNew()
 
 	DispatchEvent(eEvent::PAUSE_PROGRESS); // reset progress here!
 
+	async_long_task::wait<background>(_task_id_save, "save");
 	async_long_task::wait<background>(_task_id_new, "new"); // wait 1st on any "new" task to complete before creating a new "new" task
 
+	undo::clear(); // undo history belongs to the previous world
+
 	SAFE_DELETE(City);
 	City = new cCity(m_szCityName);
 
@@ -498,7 +551,9 @@ void cMinCity::OnNew()
 		VoxelWorld->NewWorld();
 
 		// make sure user can see feedback of loading, regardless of how fast the "new" generation execution took
-		Sleep(milliseconds(async_long_task::beats::full_second).count());
+		if (!replay::isDeterministic()) {
+			Sleep(milliseconds(async_long_task::beats::full_second).count());
+		}
 
 		FMT_LOG(GAME_LOG, "New World Generated");
 
@@ -507,6 +562,10 @@ void cMinCity::OnNew()
 
 		DispatchEvent(eEvent::REVERT_EXCLUSIVITY);
 	});
+
+	if (replay::isDeterministic()) { // tick-locked, the world is complete and its events are processed by this ProcessEvents(), never at a wall clock dependent later tick
+		async_long_task::wait<background>(_task_id_new, "new");
+	}
 }
 void cMinCity::OnLoad()
 {
@@ -517,15 +576,20 @@ void cMinCity::OnLoad()
 
 	DispatchEvent(eEvent::PAUSE_PROGRESS); // reset progress here!
 
+	async_long_task::wait<background>(_task_id_save, "save");
 	async_long_task::wait<background>(_task_id_load, "load"); // wait 1st on any loading task to complete before creating a new loading task
 
+	undo::clear(); // undo history belongs to the previous world
+
 	_task_id_load = async_long_task::enqueue<background>([&] {
 
 		DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(1));
 		VoxelWorld->LoadWorld();
 
 		// make sure user can see feedback of loading, regardless of how fast the saving execution took
-		Sleep(milliseconds(async_long_task::beats::full_second).count());
+		if (!replay::isDeterministic()) {
+			Sleep(milliseconds(async_long_task::beats::full_second).count());
+		}
 
 		FMT_LOG(GAME_LOG, "Loaded");
 
@@ -534,10 +598,14 @@ void cMinCity::OnLoad()
 
 		DispatchEvent(eEvent::REVERT_EXCLUSIVITY);
 	});
+
+	if (replay::isDeterministic()) { // tick-locked (see OnNew)
+		async_long_task::wait<background>(_task_id_load, "load");
+	}
 }
 void cMinCity::OnSave(bool const bShutdownAfter)
 {
-	constinit static int64_t _task_id_save(0);
+	tTime const tStart(high_resolution_clock::now());
 
 	async_long_task::wait_for_all(milliseconds(async_long_task::beats::frame));
 	m_eExclusivity = eExclusivity::SAVING;
@@ -545,9 +613,24 @@ void cMinCity::OnSave(bool const bShutdownAfter)
 	DispatchEvent(eEvent::PAUSE_PROGRESS); // reset progress here!
 
 	// must be done in main thread:
-	MinCity::Vulkan->enableOffscreenCopy();
+	if (!(replay::isHeadless() | replay::isDeterministic())) { // nothing is rendered headless, deterministic saves complete within the tick - the thumbnail is left black (see SaveWorld)
+		MinCity::Vulkan->enableOffscreenCopy();
+	}
+
+	async_long_task::wait<background>(_task_id_save, "save"); // wait 1st on any saving task to complete before creating a new saving task (also releases its snapshot)
+
+	// consistent state is captured here, the grid is copy-on-write from this point until the grid has been written
+	VoxelWorld->SnapshotWorld();
+
+	{
+		microseconds const stall(duration_cast<microseconds>(high_resolution_clock::now() - tStart));
+		metrics::record(metrics::eTimer::SAVE_STALL, stall);
+		FMT_LOG(PERF_LOG, "save snapshot: {:d}us main thread stall", stall.count());
+	}
 
-	async_long_task::wait<background>(_task_id_save, "save"); // wait 1st on any saving task to complete before creating a new saving task
+	if (!bShutdownAfter) {
+		m_eExclusivity = eExclusivity::DEFAULT; // the world keeps updating while the snapshot is written
+	}
 
 	_task_id_save = async_long_task::enqueue<background>([&, bShutdownAfter] {
 
@@ -555,7 +638,9 @@ void cMinCity::OnSave(bool const bShutdownAfter)
 		VoxelWorld->SaveWorld();
 
 		// make sure user can see feedback of saving, regardless of how fast the saving execution took
-		Sleep(milliseconds(async_long_task::beats::full_second).count());
+		if (!replay::isDeterministic()) {
+			Sleep(milliseconds(async_long_task::beats::full_second).count());
+		}
 		FMT_LOG(GAME_LOG, "Saved");
 
 		if (bShutdownAfter) {
@@ -565,10 +650,12 @@ void cMinCity::OnSave(bool const bShutdownAfter)
 			DispatchEvent(eEvent::PAUSE, new bool(false));
 			DispatchEvent(eEvent::PAUSE_PROGRESS); // reset progress here!
 			DispatchEvent(eEvent::REFRESH_LOADLIST);
-
-			DispatchEvent(eEvent::REVERT_EXCLUSIVITY);
 		}
 	});
+
+	if (replay::isDeterministic()) { // tick-locked (see OnNew), the snapshot is released in the same tick. no offscreen capture to wait on, which needs the next frame rendered
+		async_long_task::wait<background>(_task_id_save, "save");
+	}
 }
 
 void cMinCity::New()
@@ -701,6 +788,7 @@ NO_INLINE static bool const GradualStartUp(size_t const frameCount, bool const&
 void cMinCity::UpdateWorld()
 {
 	ZoneScopedN("UpdateWorld");
+	metrics::scoped_timer const timer(metrics::eTimer::UPDATE_WORLD);
 
 	constinit static bool bWasPaused(false);
 	constinit static tTime
@@ -736,9 +824,10 @@ void cMinCity::UpdateWorld()
 	Audio->Update(); // done 1st as this is asynchronous, other tasks can occur simultaneously
 
 	// *second*
-	bool const bInputDelta = Nuklear->UpdateInput() | ((tCriticalNow - tLastGUI) >= nanoseconds(milliseconds(Globals::INTERVAL_GUI_UPDATE))); // always update *input* everyframe, UpdateInput returns true to flag a gui update is neccesary
+	bool const bInputDelta = !replay::isHeadless() && (Nuklear->UpdateInput() | ((tCriticalNow - tLastGUI) >= nanoseconds(milliseconds(Globals::INTERVAL_GUI_UPDATE)))); // always update *input* everyframe, UpdateInput returns true to flag a gui update is neccesary (never headless, there is no window)
 
 	// *third*
+	replay::InjectInput(); // replay only, journaled input for this tick replaces live input
 	VoxelWorld->PreUpdate(bPaused); // called every frame regardless of timing
 
 	// *fourth*
@@ -747,7 +836,12 @@ void cMinCity::UpdateWorld()
 		// Accunmulate actual time per frame
 		// clamp at the 2x step size, don't care or want spurious spikes of time
 
-		tAccumulate += std::min(duration(tCriticalNow - tCriticalLast), fixed_delta_x2_duration);
+		if (replay::isDeterministic()) { // exactly one fixed step per frame, independent of wall clock time
+			tAccumulate += critical_delta();
+		}
+		else {
+			tAccumulate += std::min(duration(tCriticalNow - tCriticalLast), fixed_delta_x2_duration);
+		}
 	}
 
 	// add to fixed timestamp n fixed steps, while also removing the fixed step from the 
@@ -762,6 +856,9 @@ void cMinCity::UpdateWorld()
 		
 		bool bJustLoaded(false);
 		
+		metrics::scoped_timer const tick(metrics::eTimer::SIMULATION_TICK);
+		tTime const tTickStart(high_resolution_clock::now());
+
 		if (!bTick) { // limited to the fixed timestep of one iteration per frame
 			
 			bJustLoaded = VoxelWorld->UpdateOnce(m_tNow, m_tDelta, bPaused);
@@ -770,6 +867,8 @@ void cMinCity::UpdateWorld()
 		}
 		// *bugfix - it's absoletly critical to keep this in the while loop, otherwise frame rate independent motion will be broken.
 		VoxelWorld->Update(m_tNow, m_tDelta, bPaused, bJustLoaded); // world/game uses regular timing, with a fixed timestep (best practice)
+
+		replay::EndTick(high_resolution_clock::now() - tTickStart);
 	}
 	
 	// fractional amount for render path (uniform shader variables)
@@ -811,6 +910,7 @@ void cMinCity::StageResources(uint32_t const resource_index)
 	}
 
 	// Updating the voxel lattice by "rendering" it to the staging buffers, light probe image, etc
+	metrics::scoped_timer const timer(metrics::eTimer::STAGE_RESOURCES);
 	VoxelWorld->Render(resource_index);
 }
 
@@ -820,7 +920,15 @@ void cMinCity::Render()
 
 	static constexpr size_t const MAGIC_NUM = 67108860;
 
-	Vulkan->Render();
+	{
+		metrics::scoped_timer const timer(metrics::eTimer::VULKAN_RENDER);
+		if (!replay::isHeadless()) {
+			Vulkan->Render();
+		}
+		else { // Vulkan is not initialized, only the per frame work the simulation depends on runs (nothing is staged or rendered)
+			VoxelWorld->RenderHeadless();
+		}
+	}
 
 	if (++m_frameCount >= MAGIC_NUM) { // WRAP_AROUND SAFE (at 60 frames per second, the wrap around occurs every 12 days, 22 hours, 41 minutes, 21 seconds)
 		m_frameCount = 0; // NUMBER CALCULATED >  is the highest number a 32bit float can goto while still having a resolution of +-1.0f  (frame increments by 1, and if this uint64 is converted to float in a shader for example, it needs the precision of 1 frame)
@@ -837,9 +945,10 @@ bool const cMinCity::DispatchEvent(uint32_t const eventType, void* const data)
 }
 void cMinCity::ProcessEvents()
 {
-	if (glfwWindowShouldClose(Nuklear->getGLFWWindow())) {
+	if ((!replay::isHeadless() && glfwWindowShouldClose(Nuklear->getGLFWWindow())) || replay::isFinished()) {
 		DispatchEvent(eEvent::EXPEDITED_SHUTDOWN);
 	}
+	replay::InjectEvents(); // replay only, journaled events for this tick
 
 	std::pair<uint32_t, void*> new_event;
 
@@ -903,6 +1012,9 @@ void cMinCity::ProcessEvents()
 				Pause(true); // always
 				Nuklear->enableWindow<eWindowType::MAIN>(true);
 				break;
+			case eEvent::DUMP_METRICS:
+				DumpMetrics();
+				break;
 			case eEvent::ESCAPE:
 				MinCity::Quit(); // this cancels any modal windows or any active windows and gets back to the game
 				break;
@@ -1331,14 +1443,30 @@ __declspec(noinline) void cMinCity::CriticalInit()
 	}
 }
 
+void cMinCity::DumpMetrics()
+{
+	std::filesystem::path metricsPath(getUserFolder());
+	metricsPath += USER_DIR L"metrics";
+
+	metrics::dump(metricsPath.wstring());
+
+	FMT_LOG(PERF_LOG, "frame graph ({:s}) {:s}", (replay::isSerial() ? "serial" : "concurrent"), framegraph::last().toString());
+}
+
 __declspec(noinline) void cMinCity::Cleanup(GLFWwindow* const glfwwindow)
 {
+	DumpMetrics(); // at exit, before anything is torn down
+
 	async_long_task::cancel_all(); // cancel any outstanding or running tasks
 
 	// safe to bypass singleton pointers in CleanUp & CriticalCleanup *only* //
 
+	bool const bHeadless(replay::isHeadless()); // no window & no Vulkan resources were created
+
 	// huge memory leak bugfix
-	_.Vulkan.WaitDeviceIdle();
+	if (!bHeadless) {
+		_.Vulkan.WaitDeviceIdle();
+	}
 
 	Sleep(10); // *bugfix - sometimes a huge power spike can happen here while shutting down, resulting in the psu experiencing uneccessary stress. slowing it down with an unnoticable amount of time.
 	
@@ -1346,11 +1474,19 @@ __declspec(noinline) void cMinCity::Cleanup(GLFWwindow* const glfwwindow)
 
 	SAFE_DELETE(City);
 
+	undo::clear();
+
 	_.Audio.CleanUp();
-	_.Nuklear.CleanUp();
-	_.PostProcess.CleanUp();
+	if (!bHeadless) {
+		_.Nuklear.CleanUp();
+		_.PostProcess.CleanUp();
+	}
 	_.Physics.CleanUp();
 	_.VoxelWorld.CleanUp();
+
+	if (bHeadless)
+		return;
+
 	_.TextureBoy.CleanUp();
 
 	Sleep(10); // *bugfix - sometimes a huge power spike can happen here while shutting down, resulting in the psu experiencing uneccessary stress. slowing it down with an unnoticable amount of time.
@@ -1384,6 +1520,10 @@ int __stdcall _tWinMain(_In_ HINSTANCE hInstance,
 #ifndef NDEBUG // use quick_exit(0) at point where bug has been successfully passed, quick_exit(1) happens in the validation callback when BREAK_ON_VALIDATION_ERROR is equal to 1 in vku.hpp (for isolating sync validation errors with automation using debug_sync program)
 	cmdline::arguments(__wargv, __argc);
 #endif
+	if (!replay::Initialize(__argc, __wargv)) {
+		cMinCity::CriticalCleanup();
+		return(1);
+	}
 		
 	cMinCity::Initialize(g_glfwwindow);  // no need to check the state here, unles.s handling errors
 										// Running status is updated in this function if succesful
@@ -1393,16 +1533,22 @@ int __stdcall _tWinMain(_In_ HINSTANCE hInstance,
 
 		ZoneScopedN("Root");
 
-		cMinCity::UpdateWorld();
-		cMinCity::Render();
+		{
+			metrics::scoped_timer const frame(metrics::eTimer::FRAME);
+			cMinCity::UpdateWorld();
+			cMinCity::Render();
+		}
+		metrics::tick();
 		FrameMark;
 	}
 
+	int const exit_code(replay::CleanUp()); // writes the replay journal, non-zero if a replay diverged
+
 	cMinCity::Cleanup(g_glfwwindow);
 	cMinCity::CriticalCleanup();
 
 
 	WaitIOClose();
 
-	return(0);
+	return(exit_code);
 }
@@ -27,6 +27,7 @@ BETTER_ENUM(eEvent, uint32_t const,
 	RESET,
 	SHOW_IMPORT_WINDOW,
 	SHOW_MAIN_WINDOW,
+	DUMP_METRICS,
 
 	ESCAPE,
 	EXIT			   = (UINT32_MAX - 1),
@@ -111,6 +112,7 @@ public:
 	static void Save(bool const bShutdownAfter = false);
 	static int32_t const Quit(bool const bQueryStateOnly = false); // prompts user to quit, returns user selection (eWindowQuit)
 	static void Reset();
+	static void DumpMetrics(); // writes the runtime metrics history & summary to the user folder
 	
 	// Callbacks / Events //
 	static void OnFocusLost();
@@ -124,6 +126,7 @@ private:
 	__declspec(noinline) static int32_t const SetupEnvironment(); // for main thread only
 
 	static void LoadINI();
+	NO_INLINE static bool const InitializeHeadless(); // Initialize() without the window & Vulkan (-headless)
 	static bool const Shutdown(int32_t const action, bool const expedite = false); // returns true if MinCity will be shutdown
 	static void ProcessEvents();
 	static void OnNew();
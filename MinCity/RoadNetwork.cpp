@@ -0,0 +1,632 @@
+#include "pch.h"
+#include "RoadNetwork.h"
+#include "world.h"
+#include "replay.h"
+#include <Utility/class_helper.h>
+
+namespace // private to this file
+{
+	static constexpr uint32_t const
+		INVALID_NODE = UINT32_MAX,
+		ROUTE_CACHE_SIZE = 4096,					// routes
+		MAX_EDGE_LENGTH = Iso::WORLD_GRID_WIDTH;	// voxels, guard for tracing a road that never reaches another node
+
+	// indexed by eDirection N, S, E, W (same voxel directions as cCarGameObject::state)
+	static constexpr int32_t const DIRECTION_X[4] = { 0, 0, 1, -1 },
+								   DIRECTION_Y[4] = { 1, -1, 0, 0 };
+	static constexpr uint32_t const OPPOSITE[4] = { eDirection::S, eDirection::N, eDirection::W, eDirection::E };
+
+	STATIC_INLINE_PURE uint32_t const pack(point2D_t const voxelIndex)
+	{
+		return((uint32_t(uint16_t(voxelIndex.x)) << 16u) | uint32_t(uint16_t(voxelIndex.y)));
+	}
+	STATIC_INLINE_PURE uint64_t const pack(point2D_t const voxelStart, point2D_t const voxelGoal)
+	{
+		return((uint64_t(pack(voxelStart)) << 32ull) | uint64_t(pack(voxelGoal)));
+	}
+	STATIC_INLINE_PURE uint32_t const manhattan(point2D_t const a, point2D_t const b)
+	{
+		point2D_t const distance(p2D_abs(p2D_sub(a, b)));
+		return(uint32_t(distance.x + distance.y));
+	}
+
+	typedef struct sRoadNode
+	{
+		point2D_t		origin;
+		uint32_t		neighbour[4],	// indexed by eDirection N, S, E, W
+						length[4];		// voxels to neighbour
+		bool			live;
+	} sRoadNode;
+
+	typedef struct sSearchScratch
+	{
+		vector<uint32_t>					cost, parent, stamp;
+		vector<std::pair<uint32_t, uint32_t>>	open;	// (estimated total cost, node) min-heap
+		uint32_t							current = 0;
+	} sSearchScratch;
+
+	static thread_local sSearchScratch search_scratch; // A* is run by any thread that queries a route not in the cache
+
+	class cRoadGraph : private no_copy
+	{
+	public:
+		size_t const	 size() const { return(_nodes.size()); }
+		uint32_t const	 liveCount() const { return(_live); }
+		uint32_t const	 version() const { return(_version); }
+		sRoadNode const& node(uint32_t const index) const { return(_nodes[index]); }
+
+		uint32_t const __vectorcall lookup(point2D_t const voxelNode) const
+		{
+			auto const found(_lookup.find(pack(voxelNode)));
+			return(_lookup.cend() != found ? found->second : INVALID_NODE);
+		}
+
+		uint32_t const __vectorcall add(point2D_t const voxelNode)
+		{
+			uint32_t index(lookup(voxelNode));
+			if (INVALID_NODE != index)
+				return(index);
+
+			if (!_free.empty()) {
+				index = _free.back(); _free.pop_back();
+			}
+			else {
+				index = (uint32_t)_nodes.size();
+				_nodes.emplace_back();
+			}
+
+			sRoadNode& __restrict node(_nodes[index]);
+			node.origin = voxelNode;
+			for (uint32_t d = 0; d < 4; ++d) {
+				node.neighbour[d] = INVALID_NODE;
+				node.length[d] = 0;
+			}
+			node.live = true;
+
+			_lookup[pack(voxelNode)] = index;
+			++_live;
+			return(index);
+		}
+
+		void remove(uint32_t const index)
+		{
+			for (uint32_t d = 0; d < 4; ++d) {
+				unlink(index, d);
+			}
+			_lookup.erase(pack(_nodes[index].origin));
+			_nodes[index].live = false;
+			_free.emplace_back(index);
+			--_live;
+		}
+
+		void link(uint32_t const a, uint32_t const direction, uint32_t const b, uint32_t const length) // road is two way, both sides are linked
+		{
+			unlink(a, direction);
+			unlink(b, OPPOSITE[direction]);
+
+			_nodes[a].neighbour[direction] = b;				_nodes[a].length[direction] = length;
+			_nodes[b].neighbour[OPPOSITE[direction]] = a;	_nodes[b].length[OPPOSITE[direction]] = length;
+		}
+
+		void unlink(uint32_t const a, uint32_t const direction)
+		{
+			uint32_t const b(_nodes[a].neighbour[direction]);
+			if (INVALID_NODE != b) {
+				if (a == _nodes[b].neighbour[OPPOSITE[direction]]) {
+					_nodes[b].neighbour[OPPOSITE[direction]] = INVALID_NODE;
+				}
+				_nodes[a].neighbour[direction] = INVALID_NODE;
+			}
+		}
+
+		void touch() { ++_version; } // any change to the graph invalidates all cached routes
+
+		void clear()
+		{
+			_nodes.clear(); _free.clear(); _lookup.clear();
+			_live = 0;
+			touch();
+		}
+
+		bool const search(uint32_t const start, uint32_t const goal, vector<point2D_t>& __restrict waypoints) const;
+
+	private:
+		vector<sRoadNode>						_nodes;
+		vector<uint32_t>						_free;
+		std::unordered_map<uint32_t, uint32_t>	_lookup;	// packed origin -> node
+		uint32_t								_live = 0,
+												_version = 0;
+	};
+
+	// A*, edges are axis aligned so the manhattan distance is an exact lower bound of the remaining road length
+	bool const cRoadGraph::search(uint32_t const start, uint32_t const goal, vector<point2D_t>& __restrict waypoints) const
+	{
+		sSearchScratch& __restrict scratch(search_scratch);
+
+		if (scratch.stamp.size() < _nodes.size()) {
+			scratch.cost.resize(_nodes.size());
+			scratch.parent.resize(_nodes.size());
+			scratch.stamp.resize(_nodes.size(), 0);
+		}
+		if (0 == ++scratch.current) { // wrapped, stamps must be reset
+			std::fill(scratch.stamp.begin(), scratch.stamp.end(), 0);
+			scratch.current = 1;
+		}
+		uint32_t const current(scratch.current);
+		point2D_t const voxelGoal(_nodes[goal].origin);
+
+		auto& __restrict open(scratch.open);
+		open.clear();
+
+		scratch.stamp[start] = current;
+		scratch.cost[start] = 0;
+		scratch.parent[start] = INVALID_NODE;
+		open.emplace_back(manhattan(_nodes[start].origin, voxelGoal), start);
+
+		while (!open.empty()) {
+
+			std::pop_heap(open.begin(), open.end(), std::greater<>());
+			auto const [estimate, index] = open.back();
+			open.pop_back();
+
+			if (goal == index) {
+
+				waypoints.clear();
+				for (uint32_t i = goal; INVALID_NODE != i; i = scratch.parent[i]) {
+					waypoints.emplace_back(_nodes[i].origin);
+				}
+				std::reverse(waypoints.begin(), waypoints.end());
+				return(true);
+			}
+
+			sRoadNode const& __restrict node(_nodes[index]);
+			uint32_t const cost(scratch.cost[index]);
+
+			if (estimate > cost + manhattan(node.origin, voxelGoal)) {
+				continue; // stale, a cheaper path to this node was already expanded
+			}
+
+			for (uint32_t d = 0; d < 4; ++d) {
+
+				uint32_t const neighbour(node.neighbour[d]);
+				if (INVALID_NODE == neighbour)
+					continue;
+
+				uint32_t const neighbour_cost(cost + node.length[d]);
+				if (current != scratch.stamp[neighbour] || neighbour_cost < scratch.cost[neighbour]) {
+
+					scratch.stamp[neighbour] = current;
+					scratch.cost[neighbour] = neighbour_cost;
+					scratch.parent[neighbour] = index;
+
+					open.emplace_back(neighbour_cost + manhattan(_nodes[neighbour].origin, voxelGoal), neighbour);
+					std::push_heap(open.begin(), open.end(), std::greater<>());
+				}
+			}
+		}
+
+		return(false);
+	}
+
+	// fixed size LRU of routes keyed by (start, goal). Unreachable goals are cached as empty routes so they are not searched again.
+	class cRouteCache : private no_copy
+	{
+		typedef struct sEntry
+		{
+			uint64_t			key;
+			uint32_t			version,
+								prev, next;
+			vector<point2D_t>	waypoints;
+		} sEntry;
+
+	public:
+		size_t const hits() const { return(_hits); }
+		size_t const misses() const { return(_misses); }
+
+		bool const get(uint64_t const key, uint32_t const version, vector<point2D_t>& __restrict waypoints)
+		{
+			tbb::spin_mutex::scoped_lock lock(_lock);
+
+			auto const found(_lookup.find(key));
+			if (_lookup.cend() != found) {
+
+				sEntry const& __restrict entry(_entries[found->second]);
+				if (version == entry.version) {
+
+					detach(found->second);
+					attach(found->second);
+
+					waypoints = entry.waypoints;
+					++_hits;
+					return(true);
+				}
+			}
+
+			++_misses;
+			return(false);
+		}
+
+		void put(uint64_t const key, uint32_t const version, vector<point2D_t> const& __restrict waypoints)
+		{
+			tbb::spin_mutex::scoped_lock lock(_lock);
+
+			uint32_t index;
+
+			auto const found(_lookup.find(key));
+			if (_lookup.cend() != found) {
+				index = found->second;
+				detach(index);
+			}
+			else if (_entries.size() < ROUTE_CACHE_SIZE) {
+				index = (uint32_t)_entries.size();
+				_entries.emplace_back();
+				_lookup[key] = index;
+			}
+			else { // evict least recently used
+				index = _tail;
+				detach(index);
+				_lookup.erase(_entries[index].key);
+				_lookup[key] = index;
+			}
+
+			sEntry& __restrict entry(_entries[index]);
+			entry.key = key;
+			entry.version = version;
+			entry.waypoints = waypoints;
+
+			attach(index);
+		}
+
+		void clear()
+		{
+			tbb::spin_mutex::scoped_lock lock(_lock);
+
+			_entries.clear(); _lookup.clear();
+			_head = _tail = INVALID_NODE;
+			_hits = _misses = 0;
+		}
+
+	private:
+		void detach(uint32_t const index)
+		{
+			sEntry& __restrict entry(_entries[index]);
+
+			if (INVALID_NODE != entry.prev) _entries[entry.prev].next = entry.next; else _head = entry.next;
+			if (INVALID_NODE != entry.next) _entries[entry.next].prev = entry.prev; else _tail = entry.prev;
+		}
+		void attach(uint32_t const index) // most recently used is the head
+		{
+			sEntry& __restrict entry(_entries[index]);
+
+			entry.prev = INVALID_NODE;
+			entry.next = _head;
+			if (INVALID_NODE != _head) _entries[_head].prev = index; else _tail = index;
+			_head = index;
+		}
+
+	private:
+		tbb::spin_mutex							_lock;
+		vector<sEntry>							_entries;
+		std::unordered_map<uint64_t, uint32_t>	_lookup;	// key -> entry
+		uint32_t								_head = INVALID_NODE,
+												_tail = INVALID_NODE;
+		size_t									_hits = 0,
+												_misses = 0;
+	};
+
+	static bool const query(cRoadGraph const& __restrict graph, cRouteCache& __restrict cache, point2D_t const voxelStartNode, point2D_t const voxelGoalNode, vector<point2D_t>& __restrict waypoints)
+	{
+		uint64_t const key(pack(voxelStartNode, voxelGoalNode));
+		uint32_t const version(graph.version());
+
+		if (!cache.get(key, version, waypoints)) {
+
+			uint32_t const start(graph.lookup(voxelStartNode)), goal(graph.lookup(voxelGoalNode));
+
+			waypoints.clear();
+			if (INVALID_NODE != start && INVALID_NODE != goal) {
+				graph.search(start, goal, waypoints);
+			}
+			cache.put(key, version, waypoints);
+		}
+
+		return(!waypoints.empty());
+	}
+
+	static bool const __vectorcall isNodeCenter(Iso::Voxel const& __restrict oVoxel)
+	{
+		return(Iso::isRoad(oVoxel) && !Iso::isPending(oVoxel) && Iso::isRoadNode(oVoxel) && Iso::isRoadNodeCenter(oVoxel));
+	}
+
+	// walks the road center line from a node in a direction until it reaches the center of the next node
+	static void trace(cRoadGraph& __restrict graph, uint32_t const index, uint32_t const direction)
+	{
+		graph.unlink(index, direction);
+
+		point2D_t const voxelStep(DIRECTION_X[direction], DIRECTION_Y[direction]);
+		point2D_t voxelIndex(graph.node(index).origin);
+
+		for (uint32_t length = 1; length < MAX_EDGE_LENGTH; ++length) {
+
+			voxelIndex = p2D_add(voxelIndex, voxelStep);
+
+			Iso::Voxel const* const pVoxel(world::getVoxelAt(voxelIndex));
+			if (!pVoxel)
+				return;
+
+			Iso::Voxel const oVoxel(*pVoxel);
+			if (!Iso::isRoad(oVoxel) || Iso::isPending(oVoxel))
+				return; // road end
+
+			if (isNodeCenter(oVoxel)) {
+
+				uint32_t const neighbour(graph.lookup(voxelIndex));
+				if (INVALID_NODE != neighbour) {
+					graph.link(index, direction, neighbour, length);
+				}
+				return;
+			}
+		}
+	}
+
+	STATIC_INLINE_PURE bool const __vectorcall overlaps(rect2D_t const area, point2D_t const a, point2D_t const b) // inclusive segment a-b, exclusive area
+	{
+		point2D_t const minimum(p2D_min(a, b)), maximum(p2D_max(a, b));
+
+		return(minimum.x < area.right && maximum.x >= area.left && minimum.y < area.bottom && maximum.y >= area.top);
+	}
+
+	static void __vectorcall rebuild(cRoadGraph& __restrict graph, rect2D_t area)
+	{
+		area = r2D_clamp(r2D_grow(area, point2D_t(1)), point2D_t(Iso::MIN_VOXEL_COORD_U, Iso::MIN_VOXEL_COORD_V), point2D_t(Iso::MAX_VOXEL_COORD_U, Iso::MAX_VOXEL_COORD_V));
+
+		// remove nodes in area
+		for (uint32_t i = 0; i < (uint32_t)graph.size(); ++i) {
+			if (graph.node(i).live && r2D_contains(area, graph.node(i).origin)) {
+				graph.remove(i);
+			}
+		}
+
+		// find node centers in area, rows in parallel
+		tbb::enumerable_thread_specific<vector<point2D_t>> found_nodes;
+
+		tbb::parallel_for(int32_t(area.top), int32_t(area.bottom), [&](int32_t const y) {
+
+			auto& __restrict local_nodes(found_nodes.local());
+
+			point2D_t voxelIndex(area.left, y);
+			for (; voxelIndex.x < area.right; ++voxelIndex.x) {
+
+				Iso::Voxel const* const pVoxel(world::getVoxelAt(voxelIndex));
+				if (pVoxel && isNodeCenter(*pVoxel)) {
+					local_nodes.emplace_back(voxelIndex);
+				}
+			}
+		});
+
+		for (auto const& local_nodes : found_nodes) {
+			for (auto const voxelNode : local_nodes) {
+				graph.add(voxelNode);
+			}
+		}
+
+		// re-trace every edge that starts in, ends in or passes thru the area. Dead ends are re-traced too, a new road can connect them from outside the area
+		for (uint32_t i = 0; i < (uint32_t)graph.size(); ++i) {
+
+			sRoadNode const& __restrict node(graph.node(i));
+			if (!node.live)
+				continue;
+
+			bool const bInside(r2D_contains(area, node.origin));
+
+			for (uint32_t d = 0; d < 4; ++d) {
+
+				uint32_t const neighbour(node.neighbour[d]);
+
+				if (bInside || INVALID_NODE == neighbour || overlaps(area, node.origin, graph.node(neighbour).origin)) {
+					trace(graph, i, d);
+				}
+			}
+		}
+
+		graph.touch();
+	}
+
+	static cRoadGraph			theGraph;
+	static cRouteCache			theCache;
+
+	static vector<rect2D_t>		thePending;
+	static tbb::spin_mutex		lock_pending;
+	constinit static bool		bBuilt(false);
+
+	template<typename draw_function>
+	static bool const random_node(point2D_t& __restrict voxelNode, draw_function&& draw)
+	{
+		if (0 == theGraph.liveCount())
+			return(false);
+
+		for (uint32_t attempt = 0; attempt < 8; ++attempt) { // removed nodes leave holes, only retry a few times
+
+			uint64_t const range(theGraph.size());
+			sRoadNode const& __restrict node(theGraph.node(uint32_t((uint64_t(draw(attempt)) * range) >> 32ull))); // same mapping as replay::RandomNumber32(stream, 0, size - 1)
+			if (node.live) {
+				voxelNode = node.origin;
+				return(true);
+			}
+		}
+
+		return(false);
+	}
+
+} // end ns
+
+namespace world
+{
+	namespace roads
+	{
+		void __vectorcall invalidate(rect2D_t const voxelArea)
+		{
+			tbb::spin_mutex::scoped_lock lock(lock_pending);
+
+			thePending.emplace_back(voxelArea);
+		}
+
+		void update()
+		{
+			vector<rect2D_t> pending;
+			{
+				tbb::spin_mutex::scoped_lock lock(lock_pending);
+				pending.swap(thePending);
+			}
+
+			if (!bBuilt) {
+
+				tTime const tStart(high_resolution_clock::now());
+				rebuild(theGraph, rect2D_t(point2D_t(Iso::MIN_VOXEL_COORD_U, Iso::MIN_VOXEL_COORD_V), point2D_t(Iso::MAX_VOXEL_COORD_U, Iso::MAX_VOXEL_COORD_V)));
+				bBuilt = true;
+
+				FMT_LOG(GAME_LOG, "road network built, {:d} nodes  {:f} seconds", theGraph.liveCount(), fp_seconds(high_resolution_clock::now() - tStart).count());
+				return; // whole world is already up to date
+			}
+
+			for (auto const& area : pending) {
+				rebuild(theGraph, area);
+			}
+		}
+
+		bool const __vectorcall findClosestNode(point2D_t const voxelIndex, point2D_t& __restrict voxelNode, int32_t const search_distance)
+		{
+			// closest by road, walk out in each direction along the road
+			uint32_t closest(UINT32_MAX);
+
+			for (uint32_t d = 0; d < 4; ++d) {
+
+				point2D_t const voxelStep(DIRECTION_X[d], DIRECTION_Y[d]);
+				point2D_t voxelSearch(voxelIndex);
+
+				for (int32_t distance = 0; distance < search_distance && (uint32_t)distance < closest; ++distance) {
+
+					Iso::Voxel const* const pVoxel(world::getVoxelAt(voxelSearch));
+					if (!pVoxel || !Iso::isRoad(*pVoxel))
+						break;
+
+					if (isNodeCenter(*pVoxel) && INVALID_NODE != theGraph.lookup(voxelSearch)) {
+						closest = (uint32_t)distance;
+						voxelNode = voxelSearch;
+						break;
+					}
+					voxelSearch = p2D_add(voxelSearch, voxelStep);
+				}
+			}
+
+			return(UINT32_MAX != closest);
+		}
+
+		bool const getRandomNode(point2D_t& __restrict voxelNode)
+		{
+			return(random_node(voxelNode, [](uint32_t const) { return(replay::RandomNumber32(replay::eStream::CARS)); }));
+		}
+
+		bool const getRandomNode(point2D_t& __restrict voxelNode, uint32_t const key)
+		{
+			return(random_node(voxelNode, [key](uint32_t const attempt) { return(replay::RandomKeyed(replay::eStream::CARS, key + attempt)); }));
+		}
+
+		bool const __vectorcall findRoute(point2D_t const voxelStartNode, point2D_t const voxelGoalNode, vector<point2D_t>& __restrict waypoints)
+		{
+			return(query(theGraph, theCache, voxelStartNode, voxelGoalNode, waypoints));
+		}
+
+		uint32_t const __vectorcall nextDirection(point2D_t const voxelNode, point2D_t const voxelGoalNode)
+		{
+			static thread_local vector<point2D_t> waypoints;
+
+			if (query(theGraph, theCache, voxelNode, voxelGoalNode, waypoints) && waypoints.size() > 1) {
+
+				point2D_t const voxelDirection(p2D_sgn(p2D_sub(waypoints[1], waypoints[0])));
+
+				for (uint32_t d = 0; d < 4; ++d) {
+					if (DIRECTION_X[d] == voxelDirection.x && DIRECTION_Y[d] == voxelDirection.y) {
+						return(d);
+					}
+				}
+			}
+
+			return(INVALID_DIRECTION);
+		}
+
+		void CleanUp()
+		{
+			theCache.clear();
+			theGraph.clear();
+			thePending.clear(); thePending.shrink_to_fit();
+			bBuilt = false;
+		}
+
+#ifdef DEBUG_BENCHMARK_ROUTE_QUERY
+		// headless, a synthetic city block lattice with random missing roads. Does not touch the grid or the shared graph & cache.
+		void benchmark()
+		{
+			static constexpr int32_t const  LATTICE_SIZE = 128,				// nodes per side
+											BLOCK_SIZE = 32;				// voxels between nodes
+			static constexpr uint32_t const QUERY_COUNT = 100000,
+											UNIQUE_ROUTES = ROUTE_CACHE_SIZE >> 1; // working set that fits in the cache
+			static constexpr float const	MISSING_ROAD_CHANCE = 0.15f;
+
+			cRoadGraph graph;
+			cRouteCache cache;
+			vector<point2D_t> waypoints;
+
+			for (int32_t y = 0; y < LATTICE_SIZE; ++y) {
+				for (int32_t x = 0; x < LATTICE_SIZE; ++x) {
+
+					uint32_t const index(graph.add(point2D_t(x * BLOCK_SIZE, y * BLOCK_SIZE)));
+
+					if (x > 0 && PsuedoRandomFloat() >= MISSING_ROAD_CHANCE) {
+						graph.link(index, eDirection::W, graph.lookup(point2D_t((x - 1) * BLOCK_SIZE, y * BLOCK_SIZE)), BLOCK_SIZE);
+					}
+					if (y > 0 && PsuedoRandomFloat() >= MISSING_ROAD_CHANCE) {
+						graph.link(index, eDirection::S, graph.lookup(point2D_t(x * BLOCK_SIZE, (y - 1) * BLOCK_SIZE)), BLOCK_SIZE);
+					}
+				}
+			}
+			graph.touch();
+
+			auto const random_node = []() {
+				return(point2D_t(PsuedoRandomNumber32(0, LATTICE_SIZE - 1) * BLOCK_SIZE, PsuedoRandomNumber32(0, LATTICE_SIZE - 1) * BLOCK_SIZE));
+			};
+
+			vector<std::pair<point2D_t, point2D_t>> routes;
+			routes.reserve(UNIQUE_ROUTES);
+			for (uint32_t i = 0; i < UNIQUE_ROUTES; ++i) {
+				routes.emplace_back(random_node(), random_node());
+			}
+
+			FMT_LOG(PERF_LOG, "route query benchmark: {:d}x{:d} nodes, {:d} queries, {:d} unique routes", LATTICE_SIZE, LATTICE_SIZE, QUERY_COUNT, UNIQUE_ROUTES);
+
+			size_t found(0);
+			fp_seconds tUncached{}, tCached{};
+
+			{ // A* only
+				tTime const tStart(high_resolution_clock::now());
+				for (uint32_t i = 0; i < QUERY_COUNT; ++i) {
+					auto const& route(routes[i % UNIQUE_ROUTES]);
+					found += graph.search(graph.lookup(route.first), graph.lookup(route.second), waypoints);
+				}
+				tUncached = high_resolution_clock::now() - tStart;
+			}
+			{ // shared cache
+				tTime const tStart(high_resolution_clock::now());
+				for (uint32_t i = 0; i < QUERY_COUNT; ++i) {
+					auto const& route(routes[i % UNIQUE_ROUTES]);
+					query(graph, cache, route.first, route.second, waypoints);
+				}
+				tCached = high_resolution_clock::now() - tStart;
+			}
+
+			FMT_LOG(PERF_LOG, "uncached {:.0f} queries/s  cached {:.0f} queries/s  ({:d} hits, {:d} misses, {:d}% reachable)",
+				double(QUERY_COUNT) / tUncached.count(), double(QUERY_COUNT) / tCached.count(), cache.hits(), cache.misses(), (found * 100) / QUERY_COUNT);
+		}
+#endif
+	} // end ns roads
+} // end ns world
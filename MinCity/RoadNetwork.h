@@ -0,0 +1,41 @@
+#pragma once
+#include "globals.h"
+#include <Math/point2D_t.h>
+#include "eDirection.h"
+
+// compact road graph. A node for every road node center (xing or corner), an edge for every straight run of road between two nodes.
+// the graph is built from the grid and only the area touched by a road edit is rebuilt. Routes are found with A* on the graph and
+// shared by all cars & ai movers thru a fixed size LRU cache, so a route between two nodes is only searched once per graph version.
+namespace world
+{
+	namespace roads
+	{
+		static constexpr uint32_t const
+			INVALID_DIRECTION = UINT32_MAX;
+
+		// queues an area of the grid that has changed roads, applied on the next update()
+		void __vectorcall invalidate(rect2D_t const voxelArea);
+
+		// applies all queued invalidations, the first update builds the whole graph. Must not be called concurrently with route queries.
+		void update();
+
+		// returns true and the closest road node center to voxelIndex within the search distance
+		bool const __vectorcall findClosestNode(point2D_t const voxelIndex, point2D_t& __restrict voxelNode, int32_t const search_distance = Iso::ROAD_SEGMENT_WIDTH * 8);
+
+		// returns true and a random road node center, false if there are no roads
+		bool const getRandomNode(point2D_t& __restrict voxelNode);
+		bool const getRandomNode(point2D_t& __restrict voxelNode, uint32_t const key); // keyed draws (replay::RandomKeyed), independent of the order of callers - safe from parallel updates
+
+		// waypoints are the road node centers from start to goal inclusive. Thread safe.
+		bool const __vectorcall findRoute(point2D_t const voxelStartNode, point2D_t const voxelGoalNode, vector<point2D_t>& __restrict waypoints);
+
+		// the eDirection to leave voxelNode in to get closer to voxelGoalNode, INVALID_DIRECTION if unreachable or already there. Thread safe.
+		uint32_t const __vectorcall nextDirection(point2D_t const voxelNode, point2D_t const voxelGoalNode);
+
+		void CleanUp();
+
+#ifdef DEBUG_BENCHMARK_ROUTE_QUERY
+		void benchmark();
+#endif
+	} // end ns roads
+} // end ns world
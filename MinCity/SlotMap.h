@@ -0,0 +1,438 @@
+/* Copyright (C) 20xx Jason Tully - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License
+ * http://www.supersinfulsilicon.com/
+ *
+This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/
+or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+#pragma once
+#include "globals.h"
+#include "types.h"
+#include <tbb/tbb.h>
+#include <Utility/class_helper.h>
+#include <atomic>
+#include <algorithm>
+
+// generational slot map from a (non-zero) 32 bit hash to a value of type T
+//
+// values live in fixed pages of slots that are never moved or freed until destruction, so a reference to a value is stable for the life of the entry
+// (game objects alias the value in place). Live slots are also indexed by a packed dense array so iteration is contiguous and only touches live entries.
+// The hash -> slot index is an open addressed table of single 64bit words { hash, slot }, so lookups are lock-free and never see a torn entry.
+//
+// concurrency - same contract as the tbb::concurrent_unordered_map this replaces:
+//		find / get / operator[] / emplace / size / iteration are all safe concurrently with each other (writers serialize on a spin mutex, readers never lock)
+//		erase / clear are *not* concurrency safe, no other operations can be happening on the map
+template<typename T>
+class tSlotMap : no_copy
+{
+public:
+	static constexpr uint32_t const PAGE_SHIFT = 12,
+									PAGE_SIZE = (1u << PAGE_SHIFT),	// slots per page
+									MAX_PAGES = 1024,				// 4M entries maximum
+									MIN_INDEX_SHIFT = 10;			// smallest hash index table is 1024 words
+
+	typedef struct sHandle {	// a handle is only valid while the generation of its slot is unchanged
+
+		uint32_t slot, generation;
+
+	} handle;
+
+	typedef struct sSlot {
+
+		T			value;
+		uint32_t	key,			// hash, zero when the slot is free
+					generation,		// incremented every time the slot is released
+					dense;			// position of this slot in the dense array
+
+	} slot;
+
+private:
+	typedef struct sPage {
+
+		slot		slots[PAGE_SIZE];
+		uint32_t	dense[PAGE_SIZE];	// dense array of live slot indices, dense position i lives in page (i >> PAGE_SHIFT)
+
+	} page;
+
+	typedef struct sIndexTable {
+
+		uint32_t			shift;		// 64 - log2(capacity)
+		uint32_t			mask;
+		std::atomic_uint64_t entries[1];	// [capacity] { low = hash, high = slot }, 0 = empty
+
+	} index_table;
+
+	static constexpr uint64_t const TOMBSTONE = 0xffffffff00000000ull; // hash of zero never matches a key
+
+public:
+	class const_iterator
+	{
+	public:
+		slot const& operator*() const { return(_map->at_dense(_i)); }
+		slot const* const operator->() const { return(&_map->at_dense(_i)); }
+		const_iterator& operator++() { ++_i; return(*this); }
+		bool const operator!=(const_iterator const& rhs) const { return(_i != rhs._i); }
+		bool const operator==(const_iterator const& rhs) const { return(_i == rhs._i); }
+
+		const_iterator(tSlotMap const* const map_, uint32_t const i_)
+			: _map(map_), _i(i_)
+		{}
+	private:
+		tSlotMap const* _map;
+		uint32_t		_i;
+	};
+	class iterator
+	{
+	public:
+		slot& operator*() const { return(_map->at_dense(_i)); }
+		slot* const operator->() const { return(&_map->at_dense(_i)); }
+		iterator& operator++() { ++_i; return(*this); }
+		bool const operator!=(iterator const& rhs) const { return(_i != rhs._i); }
+		bool const operator==(iterator const& rhs) const { return(_i == rhs._i); }
+
+		iterator(tSlotMap* const map_, uint32_t const i_)
+			: _map(map_), _i(i_)
+		{}
+	private:
+		tSlotMap*	_map;
+		uint32_t	_i;
+	};
+
+	// iteration is over live entries only, in dense order. Entries inserted concurrently after begin() may or may not be visited.
+	const_iterator const cbegin() const { return(const_iterator(this, 0)); }
+	const_iterator const cend() const { return(const_iterator(this, _size.load(std::memory_order_acquire))); }
+	const_iterator const begin() const { return(cbegin()); }
+	const_iterator const end() const { return(cend()); }
+	iterator const begin() { return(iterator(this, 0)); }
+	iterator const end() { return(iterator(this, _size.load(std::memory_order_acquire))); }
+
+	size_t const size() const { return(_size.load(std::memory_order_acquire)); }
+	bool const empty() const { return(0 == size()); }
+
+	// lock-free, returns nullptr if not found
+	__inline T* const __restrict find(uint32_t const key) const
+	{
+		uint32_t const found(find_slot(key));
+		if (UINT32_MAX != found) {
+			return(&at(found).value);
+		}
+		return(nullptr);
+	}
+	// lock-free, a handle remains valid until the entry is erased. handle.slot is UINT32_MAX if not found
+	__inline handle const find_handle(uint32_t const key) const
+	{
+		uint32_t const found(find_slot(key));
+		if (UINT32_MAX != found) {
+			return(handle{ found, at(found).generation });
+		}
+		return(handle{ UINT32_MAX, 0 });
+	}
+	// lock-free, skips the hash index entirely. returns nullptr if the entry the handle refers to has since been erased
+	__inline T* const __restrict get(handle const h) const
+	{
+		if (h.slot < _high.load(std::memory_order_acquire)) {
+			slot& s(at(h.slot));
+			if (h.generation == s.generation && 0 != s.key) {
+				return(&s.value);
+			}
+		}
+		return(nullptr);
+	}
+
+	// returns the existing value for key, or inserts a default constructed value. The returned reference is stable until the entry is erased.
+	T& operator[](uint32_t const key)
+	{
+		{ // lock-free when existing
+			uint32_t const existing(find_slot(key));
+			if (UINT32_MAX != existing)
+				return(at(existing).value);
+		}
+		slot* const __restrict entry(insert(key, T{}));
+		[[unlikely]] if (nullptr == entry) { // full, caller still requires a reference
+			_overflow = T{};
+			return(_overflow);
+		}
+		return(entry->value);
+	}
+	// returns false if the key already exists (value unchanged) or the map is full
+	bool const emplace(uint32_t const key, T const& value)
+	{
+		uint32_t const existing(find_slot(key));
+		if (UINT32_MAX != existing)
+			return(false);
+
+		return(nullptr != insert(key, value));
+	}
+
+	// **** not concurrency safe **** returns true if the key existed. The slot's value is reset to T{} so anything still aliasing it sees an empty value.
+	bool const erase(uint32_t const key);
+	// **** not concurrency safe **** pages are kept for reuse
+	void clear();
+
+	void reserve(size_t const count);
+
+private:
+	__inline slot& at(uint32_t const s) const { return(_pages[s >> PAGE_SHIFT].load(std::memory_order_acquire)->slots[s & (PAGE_SIZE - 1)]); }
+	__inline uint32_t& dense_at(uint32_t const i) const { return(_pages[i >> PAGE_SHIFT].load(std::memory_order_acquire)->dense[i & (PAGE_SIZE - 1)]); }
+	__inline slot& at_dense(uint32_t const i) const { return(at(dense_at(i))); }
+
+	STATIC_INLINE_PURE uint32_t const bucket(uint32_t const key, uint32_t const shift) {
+		return(uint32_t((uint64_t(key) * 0x9e3779b97f4a7c15ull) >> shift)); // fibonacci hashing, hashes are not guaranteed to be well distributed (loaded/imported)
+	}
+
+	__inline uint32_t const find_slot(uint32_t const key) const
+	{
+		if (0 == key)
+			return(UINT32_MAX);
+
+		index_table const* const __restrict table(_index.load(std::memory_order_acquire));
+
+		uint32_t i(bucket(key, table->shift));
+		for (;;) {
+			uint64_t const entry(table->entries[i].load(std::memory_order_acquire));
+			if (0 == entry)
+				return(UINT32_MAX);
+			if (uint32_t(entry) == key)
+				return(uint32_t(entry >> 32));
+			i = (i + 1) & table->mask;
+		}
+	}
+
+	slot* const insert(uint32_t const key, T const& value);
+	uint32_t const acquire_slot();
+	void rehash(uint32_t const min_capacity);
+	index_table* const new_index(uint32_t const log2_capacity);
+
+private:
+	std::atomic<page*>					_pages[MAX_PAGES];
+	std::atomic<index_table*>			_index;
+	vector<index_table*>				_retired;	// old index tables are only freed by clear() / destruction, concurrent readers may still be probing them
+	vector<uint32_t>					_free;		// released slots, lifo to keep the live slots packed low
+	std::atomic_uint32_t				_size,		// live entries == dense array length
+										_high;		// slots ever handed out (high water)
+	uint32_t							_used;		// index table words that are not empty (live + tombstones)
+	tbb::spin_mutex						_lock;		// writers only
+	T									_overflow;	// only referenced when the map is full
+
+public:
+	tSlotMap();
+	~tSlotMap();
+};
+
+template<typename T>
+tSlotMap<T>::tSlotMap()
+	: _pages{}, _index(nullptr), _size(0), _high(0), _used(0), _overflow{}
+{
+	_index.store(new_index(MIN_INDEX_SHIFT), std::memory_order_release);
+}
+
+template<typename T>
+tSlotMap<T>::~tSlotMap()
+{
+	for (auto* const table : _retired) {
+		scalable_aligned_free(table);
+	}
+	scalable_aligned_free(_index.load(std::memory_order_relaxed));
+
+	for (uint32_t i = 0; i < MAX_PAGES; ++i) {
+		page* const p(_pages[i].load(std::memory_order_relaxed));
+		if (p) {
+			scalable_aligned_free(p);
+		}
+	}
+}
+
+template<typename T>
+typename tSlotMap<T>::index_table* const tSlotMap<T>::new_index(uint32_t const log2_capacity)
+{
+	uint32_t const capacity(1u << log2_capacity);
+	size_t const bytes(sizeof(index_table) + sizeof(std::atomic_uint64_t) * (capacity - 1));
+
+	index_table* const table((index_table*)scalable_aligned_malloc(bytes, CACHE_LINE_BYTES));
+	memset(table, 0, bytes);
+	table->shift = 64 - log2_capacity;
+	table->mask = capacity - 1;
+
+	return(table);
+}
+
+template<typename T>
+void tSlotMap<T>::rehash(uint32_t const min_capacity) // writer lock must be held
+{
+	// size for the live entries only at <= 25% load, tombstones are dropped
+	uint32_t const live(_size.load(std::memory_order_relaxed));
+	uint32_t log2_capacity(MIN_INDEX_SHIFT);
+	while ((1u << log2_capacity) < (std::max(live, min_capacity) << 2u)) {
+		++log2_capacity;
+	}
+
+	index_table* const __restrict table(new_index(log2_capacity));
+
+	for (uint32_t i = 0; i < live; ++i) {
+
+		uint32_t const s(dense_at(i));
+		uint32_t j(bucket(at(s).key, table->shift));
+		while (0 != table->entries[j].load(std::memory_order_relaxed)) {
+			j = (j + 1) & table->mask;
+		}
+		table->entries[j].store(uint64_t(at(s).key) | (uint64_t(s) << 32), std::memory_order_relaxed);
+	}
+	_used = live;
+
+	_retired.emplace_back(_index.load(std::memory_order_relaxed));
+	_index.store(table, std::memory_order_release); // publish
+}
+
+template<typename T>
+uint32_t const tSlotMap<T>::acquire_slot() // writer lock must be held
+{
+	if (!_free.empty()) {
+		uint32_t const s(_free.back());
+		_free.pop_back();
+		return(s);
+	}
+
+	uint32_t const s(_high.load(std::memory_order_relaxed));
+	uint32_t const page_index(s >> PAGE_SHIFT);
+
+	[[unlikely]] if (page_index >= MAX_PAGES) {
+		FMT_LOG_FAIL(GAME_LOG, "slot map is full ({:d} entries)", MAX_PAGES * PAGE_SIZE);
+		return(UINT32_MAX);
+	}
+	if (nullptr == _pages[page_index].load(std::memory_order_relaxed)) {
+
+		page* const p((page*)scalable_aligned_malloc(sizeof(page), CACHE_LINE_BYTES));
+		memset(p, 0, sizeof(page));
+		_pages[page_index].store(p, std::memory_order_release);
+	}
+
+	_high.store(s + 1, std::memory_order_release);
+	return(s);
+}
+
+template<typename T>
+typename tSlotMap<T>::slot* const tSlotMap<T>::insert(uint32_t const key, T const& value)
+{
+	tbb::spin_mutex::scoped_lock lock(_lock);
+
+	{ // existing ? (could have been inserted by another writer before the lock was acquired)
+		uint32_t const existing(find_slot(key));
+		if (UINT32_MAX != existing)
+			return(&at(existing));
+	}
+
+	index_table* __restrict table(_index.load(std::memory_order_relaxed));
+	if (((_used + 1) << 1u) > (table->mask + 1)) { // keep load (including tombstones) <= 50%
+		rehash(_size.load(std::memory_order_relaxed) + 1);
+		table = _index.load(std::memory_order_relaxed);
+	}
+
+	uint32_t const s(acquire_slot());
+	[[unlikely]] if (UINT32_MAX == s) {
+		return(nullptr);
+	}
+
+	slot& entry(at(s));
+	entry.value = value;
+	entry.key = key;
+
+	uint32_t const dense(_size.load(std::memory_order_relaxed));
+	entry.dense = dense;
+	dense_at(dense) = s;
+
+	// find first empty or tombstone word for key
+	uint32_t i(bucket(key, table->shift));
+	uint64_t word;
+	while (0 != (word = table->entries[i].load(std::memory_order_relaxed)) && TOMBSTONE != word) {
+		i = (i + 1) & table->mask;
+	}
+	if (0 == word) {
+		++_used; // tombstone reuse does not change load
+	}
+
+	_size.store(dense + 1, std::memory_order_release); // iteration
+	table->entries[i].store(uint64_t(key) | (uint64_t(s) << 32), std::memory_order_release); // lookup
+
+	return(&entry);
+}
+
+template<typename T>
+bool const tSlotMap<T>::erase(uint32_t const key)
+{
+	if (0 == key)
+		return(false);
+
+	tbb::spin_mutex::scoped_lock lock(_lock);
+
+	index_table* const __restrict table(_index.load(std::memory_order_relaxed));
+
+	uint32_t i(bucket(key, table->shift));
+	for (;;) {
+		uint64_t const entry(table->entries[i].load(std::memory_order_relaxed));
+		if (0 == entry)
+			return(false);
+		if (uint32_t(entry) == key)
+			break;
+		i = (i + 1) & table->mask;
+	}
+
+	uint32_t const s(uint32_t(table->entries[i].load(std::memory_order_relaxed) >> 32));
+	table->entries[i].store(TOMBSTONE, std::memory_order_release);
+
+	slot& entry(at(s));
+
+	// swap last dense entry into the hole
+	uint32_t const last(_size.load(std::memory_order_relaxed) - 1);
+	uint32_t const moved(dense_at(last));
+	dense_at(entry.dense) = moved;
+	at(moved).dense = entry.dense;
+	_size.store(last, std::memory_order_release);
+
+	// release slot
+	entry.value = T{};
+	entry.key = 0;
+	++entry.generation;
+	_free.emplace_back(s);
+
+	return(true);
+}
+
+template<typename T>
+void tSlotMap<T>::clear()
+{
+	tbb::spin_mutex::scoped_lock lock(_lock);
+
+	uint32_t const live(_size.load(std::memory_order_relaxed));
+	for (uint32_t i = 0; i < live; ++i) {
+
+		slot& entry(at(dense_at(i)));
+		entry.value = T{};
+		entry.key = 0;
+		++entry.generation; // invalidate any outstanding handles, pages and generations persist
+	}
+	_size.store(0, std::memory_order_release);
+	_high.store(0, std::memory_order_release);
+	_free.clear();
+
+	for (auto* const table : _retired) {
+		scalable_aligned_free(table);
+	}
+	_retired.clear();
+
+	index_table* const table(_index.load(std::memory_order_relaxed));
+	memset(table->entries, 0, sizeof(std::atomic_uint64_t) * (table->mask + 1));
+	_used = 0;
+}
+
+template<typename T>
+void tSlotMap<T>::reserve(size_t const count)
+{
+	tbb::spin_mutex::scoped_lock lock(_lock);
+
+	index_table const* const table(_index.load(std::memory_order_relaxed));
+	if ((uint32_t(count) << 1u) > (table->mask + 1)) {
+		rehash(uint32_t(count));
+	}
+}
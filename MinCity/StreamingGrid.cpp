@@ -16,8 +16,10 @@ or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
 #include "IsoVoxel.h"
 #include <Math/superfastmath.h>
 #include <Utility/async_long_task.h>
+#include "performance.h"
 #include <winioctl.h>
-#include <density.h>	// https://github.com/centaurean/density - Density, fastest compression/decompression library out there with simple interface. must reproduce license file. attribution.
+#include <io.h>
+#include "codec.h"
 #include <mimalloc.h>   // https://microsoft.github.io/mimalloc/modules.html - mimalloc - fastest allocator available. maintained by Microsoft. MIT License.
 
 #pragma intrinsic(memcpy)
@@ -45,29 +47,46 @@ namespace // private to this file (anonymous)
 		struct alignas(64) {
 			std::atomic_flag       _state;            // *bugfix - mutex no longer required. Concurrent access is only during RenderGrid, and all streaming grid access at that time is read-only. All other time during a frame there is no concurrent access to the grid.
 			std::atomic<tTime>     _last_access;      //         - close() also has all unique write locations. the grid maintains an embarrisingly parallel coherence  (with the usage of thread_local decompression and compression buffers) 
-		}; // 24 bytes
+			std::atomic_flag       _transition;       // only held while a chunk is changing state (CLOSED <-> OPEN), the prefetcher can open a chunk at the same time as RenderGrid. fast-path (already OPEN) never touches it.
+			std::atomic_flag       _prefetched;       // set by the prefetcher, cleared by the first access that follows (prefetch hit)
+			std::atomic_flag       _dirty;            // set by any write, cleared when the chunk is saved or loaded
+			std::atomic_uint32_t   _epoch;            // snapshot epoch this chunk was last preserved for
+			std::atomic_uint8_t    _frame_dirty;      // DIRTY_ bits written this frame, non-zero once the tile is in the dirty tile list
+			std::atomic_uint64_t   _hash;             // crc of the decompressed voxels, 0 = not computed yet. any write clears it (see HashChunks)
+		}; // 48 bytes
 		
 		// space //
 		struct alignas(64) {
 			uint8_t*               _data; // data is compressed if CLOSED, or, data is decompressed if OPEN
-			uint16_t               _compressed_size;
-		}; // 16 bytes
+			uint8_t*               _snapshot; // chunk as it was at the snapshot, same layout as _data (nullptr if the chunk was empty)
+			uint16_t               _compressed_size,
+				                   _snapshot_size;
+			uint8_t                _codec,          // codec::eCodec of _data when CLOSED
+				                   _snapshot_codec;
+			bool                   _snapshot_open, // true if _snapshot is decompressed
+				                   _mapped;        // _data is a record in the .grid file mapping (CLOSED, not owned), copied on first open
+		}; // 24 bytes
 
 	private:
-		__declspec(safebuffers) void open();
+		__declspec(safebuffers) bool const open(); // returns true if chunk was decompressed
+		__declspec(safebuffers) void preserve();
 
 	public:
 		__declspec(safebuffers) Iso::Voxel const open(uint32_t const index);
 		__declspec(safebuffers) void update(uint32_t const index, Iso::Voxel const&& oVoxel);
+		__declspec(safebuffers) void prefetch(tTime const tNow);
 		__declspec(safebuffers) void close();
 
+		__forceinline void lock() { while (_transition.test_and_set(std::memory_order_acquire)) { _mm_pause(); } }
+		__forceinline void unlock() { _transition.clear(std::memory_order_release); }
+
 	} Chunk; // 128 bytes
 	static_assert(sizeof(Chunk) <= 128); // Ensure Chunk is correct size @ compile time
 
 	constinit static inline thread_local struct no_vtable alignas(64) decompressed {
 
 		static constexpr uint32_t const
-			DECOMPRESS_SAFE_BUFFER_SIZE = 2304;  // 2304 is a safe decompression size for density for 2048 bytes below in chunk
+			DECOMPRESS_SAFE_BUFFER_SIZE = 2304;  // 2304 is a safe decompression size for density for 2048 bytes below in chunk (largest of all codecs, checked in Initialize)
 
 		struct {
 			uint8_t    buffer[DECOMPRESS_SAFE_BUFFER_SIZE];          // 2304 is a safe decompression size for density for 2048 bytes above in chunk
@@ -78,7 +97,7 @@ namespace // private to this file (anonymous)
 	constinit static inline thread_local struct no_vtable alignas(64) compressed {
 
 		static constexpr uint32_t const
-			COMPRESS_SAFE_BUFFER_SIZE = 2784;    // 2784 ""    ""  compression    ""         ""        ""    ""    ""      ""
+			COMPRESS_SAFE_BUFFER_SIZE = 2784;    // 2784 ""    ""  compression    ""         ""        ""    ""    ""      ""  (largest of all codecs, checked in Initialize)
 
 		struct {
 			uint8_t    buffer[COMPRESS_SAFE_BUFFER_SIZE];          // 2784 is a safe compression size for density for 2048 bytes above in chunk
@@ -90,58 +109,223 @@ namespace // private to this file (anonymous)
 	{
 		static constexpr uint32_t const CHUNK_VOXELS = StreamingGrid::CHUNK_VOXELS; // Must always be power of 2
 		static constexpr uint32_t const CHUNK_BITS = 6; // must be CHUNK_VOXELS = (1 << CHUNK_BITS) (manually set to match)
+		static constexpr uint32_t const CHUNK_TILE = StreamingGrid::CHUNK_TILE;
+		static constexpr uint32_t const CHUNK_TILE_BITS = 3; // must be CHUNK_TILE = (1 << CHUNK_TILE_BITS) (manually set to match)
 		static constexpr uint32_t const CHUNK_SIZE = CHUNK_VOXELS * sizeof(Iso::Voxel);
 		static constexpr uint32_t const CHUNK_COUNT = (Iso::WORLD_GRID_WIDTH * Iso::WORLD_GRID_HEIGHT) / CHUNK_VOXELS;
 		
-		static constexpr uint32_t const HEADER_SIZE = 8; // same value as density_header_size(), constant does not change in density always equals 8 bytes.
+		// chunk table is morton (z-order) ordered over square blocks of tiles, the world grid is 2:1 so there are 2 blocks side by side.
+		// neighbouring chunks in both x and y are then close in memory, a camera pan touches a compact range of chunks instead of CHUNK_TILE rows scattered across the entire table.
+		static constexpr uint32_t const TILE_BLOCK_BITS = Iso::WORLD_GRID_SIZE_BITS - 1 - CHUNK_TILE_BITS; // square block of tiles is (1 << TILE_BLOCK_BITS) x (1 << TILE_BLOCK_BITS)
+		static constexpr uint32_t const TILE_BLOCK_MASK = (1u << TILE_BLOCK_BITS) - 1u;
+
+		static_assert(CHUNK_TILE * CHUNK_TILE == CHUNK_VOXELS && (1u << CHUNK_TILE_BITS) == CHUNK_TILE && (1u << CHUNK_BITS) == CHUNK_VOXELS);
+		static_assert((Iso::WORLD_GRID_WIDTH >> 1u) == Iso::WORLD_GRID_HEIGHT); // tile blocks assume a 2:1 world grid
 
 		Chunk* __restrict            _chunks = nullptr;
-		density_context*             _context = nullptr; // re-usuable context for decompression/compression 
+
+		// counters //
+		struct alignas(64) {
+			std::atomic_uint64_t     _prefetched,
+				                     _prefetch_hits,
+				                     _misses,
+				                     _stall_ns;
+			std::atomic_int64_t      _resident;          // chunks currently OPEN (decompressed)
+		};
+
+		// copy-on-write snapshot //
+		struct alignas(64) {
+			std::atomic_uint32_t     _epoch;             // current snapshot epoch, 0 = none taken yet
+			std::atomic_bool         _snapshot;          // snapshot active, writes preserve chunks first
+			std::atomic_uint64_t     _cloned,
+				                     _snapshot_bytes;
+		};
+
+		// dirty regions //
+		struct alignas(64) {
+			std::atomic_bool         _tracking;          // off while a world is generated / loaded
+		};
 
 		__declspec(safebuffers) __forceinline operator Chunk* const __restrict() const {
 			return(_chunks);
 		}
 
-		STATIC_INLINE_PURE uint32_t const voxelToChunkIndex(uint32_t const offset) {
-			// v1D = offset = 1D index from 2D voxel index
-			// chunk1D = floor(v1D / chunkSize)
-			return(offset >> CHUNK_BITS);
+		STATIC_INLINE_PURE uint32_t const voxelToChunkIndex(point2D_t const voxelIndex) {
+			// tile = floor(voxelIndex / CHUNK_TILE)
+			uint32_t const tile_x(uint32_t(voxelIndex.x) >> CHUNK_TILE_BITS),
+				           tile_y(uint32_t(voxelIndex.y) >> CHUNK_TILE_BITS);
+
+			// interleave bits of x & y within the square block, blocks are stored one after another
+			return(((tile_x >> TILE_BLOCK_BITS) << (TILE_BLOCK_BITS << 1u)) | _pdep_u32(tile_x & TILE_BLOCK_MASK, 0x55555555u) | _pdep_u32(tile_y, 0xAAAAAAAAu));
+		}
+
+		STATIC_INLINE_PURE uint32_t const voxelToChunkOffset(point2D_t const voxelIndex) {
+			// row-major inside the tile
+			return(((uint32_t(voxelIndex.y) & (CHUNK_TILE - 1u)) << CHUNK_TILE_BITS) | (uint32_t(voxelIndex.x) & (CHUNK_TILE - 1u)));
 		}
 
-		__declspec(safebuffers) __forceinline Chunk* const __restrict const voxelToChunk(uint32_t const offset) const {
-			// v1D = offset = 1D index from 2D voxel index
-			// chunk1D = floor(v1D / chunkSize)
-			return(&_chunks[offset >> CHUNK_BITS]);
+		__declspec(safebuffers) __forceinline Chunk* const __restrict const voxelToChunk(point2D_t const voxelIndex) const {
+			return(&_chunks[voxelToChunkIndex(voxelIndex)]);
 		}
 
 	} world_grid{};
 
+	// chunk tiles written this frame, each tile once. double buffered - writers push to the active buffer, swap_dirty() makes the other
+	// buffer active and waits for writers still pushing to the previous one, which is then exclusive to the caller (read & clear).
+	static inline struct sDirtyTiles
+	{
+		tbb::concurrent_vector<point2D_t>	tiles[2];
+		std::atomic_uint32_t				writers[2];
+		std::atomic_uint32_t				active;
+		tbb::spin_mutex						consumer;	// held by the caller of swap_dirty() until it has cleared the buffer
+
+	} dirty_tiles{};
+
+	__declspec(safebuffers) __forceinline void __vectorcall push_dirty(point2D_t const tile)
+	{
+		for (;;) {
+			uint32_t const buffer(::dirty_tiles.active.load(std::memory_order_seq_cst));
+
+			::dirty_tiles.writers[buffer].fetch_add(1, std::memory_order_seq_cst);
+
+			[[likely]] if (buffer == ::dirty_tiles.active.load(std::memory_order_seq_cst)) { // not swapped in the meantime
+				::dirty_tiles.tiles[buffer].push_back(tile);
+				::dirty_tiles.writers[buffer].fetch_sub(1, std::memory_order_release);
+				return;
+			}
+
+			::dirty_tiles.writers[buffer].fetch_sub(1, std::memory_order_release); // retry on the buffer that is now active
+		}
+	}
+
+	static tbb::concurrent_vector<point2D_t>& __restrict swap_dirty()
+	{
+		uint32_t const buffer(::dirty_tiles.active.fetch_xor(1, std::memory_order_seq_cst));
+
+		while (0 != ::dirty_tiles.writers[buffer].load(std::memory_order_acquire)) {
+			_mm_pause();
+		}
+
+		return(::dirty_tiles.tiles[buffer]);
+	}
+
+	__declspec(safebuffers) __forceinline void __vectorcall mark_dirty(Chunk* const __restrict chunk, point2D_t const voxelIndex, uint32_t const flags)
+	{
+		[[likely]] if (::world_grid._tracking.load(std::memory_order_relaxed)) {
+
+			if (flags != (flags & chunk->_frame_dirty.load(std::memory_order_relaxed))) { // fast-path, tile already recorded with these flags
+
+				if (0 == chunk->_frame_dirty.fetch_or(uint8_t(flags), std::memory_order_relaxed)) { // first write to the tile this frame
+					push_dirty(point2D_t(voxelIndex.x >> WorldGrid::CHUNK_TILE_BITS, voxelIndex.y >> WorldGrid::CHUNK_TILE_BITS));
+				}
+			}
+		}
+	}
+
+	// .grid file format (chunk records) //
+	// [sGridFileHeader] [sChunkRecord * CHUNK_COUNT] * 2 [compressed chunk records in any order....]
+	// a record is the chunk exactly as it is stored in memory when CLOSED, so no recompression is required for chunks that are not OPEN.
+	// there are two tables, header.table is the current one. an incremental save writes its records only to space the current table does not reference
+	// (free slots or the end of file), then the other table, then flips header.table - a crash at any point leaves the last save intact.
+	static constexpr char const     GRID_FILE_TAG[4] = { 'G', 'R', 'I', 'D' };
+	static constexpr uint32_t const GRID_FILE_VERSION = 3,      // 3 - two tables (journaled table swap), 2 - codec id per record, version 1 & 2 files are still readable (density, single table)
+		                            GRID_RECORD_ALIGNMENT = 64, // record slots are multiples of this, free slots are reused by size
+		                            GRID_TABLE_PAGE = 256;      // chunk records per table page, only the pages that changed are written by an incremental save
+	static constexpr uint64_t const GRID_COMPACT_BYTES = 16ull * 1024ull * 1024ull; // an incremental save becomes a full save (compaction) once the free slots exceed this and the live records
+
+	typedef struct sGridFileHeader {
+		char      tag[4];
+		uint32_t  version;
+		uint32_t  chunk_count;
+		uint32_t  chunk_voxels;
+		uint32_t  table;            // version 3, current table (0 or 1)
+		uint32_t  reserved;
+	} sGridFileHeader;
+	static constexpr size_t const GRID_FILE_V2_HEADER_SIZE = 16; // version 1 & 2 header, no table field
+
+	typedef struct sChunkRecord {
+		uint64_t  offset;           // file offset of compressed record, 0 = empty chunk
+		uint16_t  compressed_size;
+		uint16_t  capacity;         // reserved bytes @ offset
+		uint8_t   codec;            // codec::eCodec
+		uint8_t   reserved[3];
+	} sChunkRecord;
+	static_assert(sizeof(sChunkRecord) == 16);
+
+	static constexpr size_t const   GRID_TABLE_SIZE = sizeof(sChunkRecord) * WorldGrid::CHUNK_COUNT;
+	static constexpr uint32_t const GRID_TABLE_PAGES = WorldGrid::CHUNK_COUNT / GRID_TABLE_PAGE;
+	static constexpr uint64_t const GRID_RECORDS_OFFSET = ((sizeof(sGridFileHeader) + GRID_TABLE_SIZE * 2ull + GRID_RECORD_ALIGNMENT - 1ull) / GRID_RECORD_ALIGNMENT) * GRID_RECORD_ALIGNMENT;
+	static_assert(0 == (WorldGrid::CHUNK_COUNT % GRID_TABLE_PAGE));
+
+	STATIC_INLINE_PURE uint64_t const grid_table_offset(uint32_t const table) {
+		return(sizeof(sGridFileHeader) + GRID_TABLE_SIZE * table);
+	}
+
+	constinit static inline struct no_vtable sPrefetcher
+	{
+		std::atomic<task_id_t> _task_id;  // Prefetch() runs in the frame graph, PrefetchWait() also on the background load
+		rect2D_t        _lastVisibleArea;
+		point2D_t       _velocity;       // voxels / frame
+		bool            _bValid;
+
+	} prefetcher{};
+
+	static inline std::wstring baseline_file; // .grid file the current chunk state was last saved to or loaded from
+	static inline vector<uint8_t> baseline_stale_pages; // table pages where the other table of baseline_file differs from the current one, empty = unknown (all)
+
+	// CLOSED chunks point into the mapping of the .grid file they were loaded from until they are first opened
+	static inline struct sGridMapping
+	{
+		mio::mmap_source  source;
+		std::wstring      file;
+
+	} grid_mapping{};
+
 	// private //
-	__declspec(safebuffers) void Chunk::open()
+	__declspec(safebuffers) bool const Chunk::open()
 	{
 		static constexpr size_t const ALIGNMENT = alignof(Iso::Voxel);
 
-		if (!_state.test_and_set(std::memory_order_relaxed)) { // CLOSED = false/clear
+		bool bDecompressed(false);
 
-			/**/ // OPEN = set // /**/
-			// write access
+		if (!_state.test(std::memory_order_acquire)) { // CLOSED = false/clear
 
-			[[unlikely]] if (nullptr == _data) { // treat as OPEN & skip decompression
-				_data = (uint8_t* const __restrict)mi_zalloc_aligned(WorldGrid::CHUNK_SIZE, ALIGNMENT);
-			}
-			else {
-				density_processing_result const result = density_decompress_with_context(_data + ::WorldGrid::HEADER_SIZE, // _data is compressed, skip over header
-					                                                                     _compressed_size,
-					                                                                     thread_local_decompress_chunks.safe.buffer, thread_local_decompress_chunks.DECOMPRESS_SAFE_BUFFER_SIZE,
-					                                                                     ::world_grid._context);
-				if (!result.state) {
+			lock(); // only contended if the prefetcher and an accessor open the same chunk simultaneously, or a save is reading the chunk
+
+			if (!_state.test(std::memory_order_relaxed)) { // still CLOSED
 
-					_data = (uint8_t* const __restrict)mi_realloc_aligned(_data, WorldGrid::CHUNK_SIZE, ALIGNMENT); // _data becomes decompressed
+				// write access
 
-					// copy out to chunk local cache //
-					memcpy(_data, thread_local_decompress_chunks.safe.buffer, WorldGrid::CHUNK_SIZE);
+				[[unlikely]] if (nullptr == _data) { // treat as OPEN & skip decompression
+					_data = (uint8_t* const __restrict)mi_zalloc_aligned(WorldGrid::CHUNK_SIZE, ALIGNMENT);
 				}
+				else {
+					size_t const decompressed_size = codec::decompress(_codec, _data, _compressed_size, // _data is compressed
+						                                               thread_local_decompress_chunks.safe.buffer, thread_local_decompress_chunks.DECOMPRESS_SAFE_BUFFER_SIZE);
+					if (WorldGrid::CHUNK_SIZE == decompressed_size) {
+
+						if (_mapped) { // record stays in the file mapping
+							_data = (uint8_t* const __restrict)mi_malloc_aligned(WorldGrid::CHUNK_SIZE, ALIGNMENT);
+							_mapped = false;
+						}
+						else {
+							_data = (uint8_t* const __restrict)mi_realloc_aligned(_data, WorldGrid::CHUNK_SIZE, ALIGNMENT); // _data becomes decompressed
+						}
+
+						// copy out to chunk local cache //
+						memcpy(_data, thread_local_decompress_chunks.safe.buffer, WorldGrid::CHUNK_SIZE);
+					}
+					bDecompressed = true;
+				}
+
+				/**/ // OPEN = set // /**/
+				_state.test_and_set(std::memory_order_release);
+
+				::world_grid._resident.fetch_add(1, std::memory_order_relaxed);
+				metrics::count(metrics::eCounter::CHUNKS_OPENED);
 			}
+
+			unlock();
 		}
 		else if (nullptr == _data) { // treat as OPEN & skip decompression
 
@@ -149,13 +333,42 @@ namespace // private to this file (anonymous)
 			_data = (uint8_t* const __restrict)mi_zalloc_aligned(WorldGrid::CHUNK_SIZE, ALIGNMENT);
 		}
 
+		return(bDecompressed);
+	}
+
+	__declspec(safebuffers) static void chunk_open_demand(Chunk* const __restrict chunk)
+	{
+		// fast-path
+		if (chunk->_state.test(std::memory_order_acquire)) { // already OPEN
+
+			[[unlikely]] if (chunk->_prefetched.test(std::memory_order_relaxed)) {
+				chunk->_prefetched.clear(std::memory_order_relaxed);
+				::world_grid._prefetch_hits.fetch_add(1, std::memory_order_relaxed);
+				metrics::count(metrics::eCounter::CHUNK_PREFETCH_HITS);
+			}
+		}
 	}
 
 	// public //
 	__declspec(safebuffers) Iso::Voxel const Chunk::open(uint32_t const index)  // used by getVoxel() of StreamingGrid
 	{
 		// fast-path
-		open(); // open chunk
+		chunk_open_demand(this);
+
+		[[unlikely]] if (!_state.test(std::memory_order_acquire)) { // slow-path, demand decompression stalls the accessing thread
+
+			tTime const tStart(high_resolution_clock::now());
+			if (open()) { // open chunk
+				nanoseconds const stall(high_resolution_clock::now() - tStart);
+				::world_grid._misses.fetch_add(1, std::memory_order_relaxed);
+				::world_grid._stall_ns.fetch_add(stall.count(), std::memory_order_relaxed);
+				metrics::count(metrics::eCounter::CHUNK_MISSES);
+				metrics::record(metrics::eTimer::CHUNK_STALL, duration_cast<microseconds>(stall));
+			}
+		}
+		else {
+			open(); // open chunk (OPEN w/o data)
+		}
 
 		_last_access.store(critical_now(), std::memory_order_relaxed); // atomic  [after read access]
 
@@ -163,15 +376,74 @@ namespace // private to this file (anonymous)
 		return(decompressed[index]);
 	}
 
+	// copy-on-write, first write to this chunk since the snapshot. the chunk is preserved as is (compressed or not), SaveChunks does any compression.
+	__declspec(safebuffers) void Chunk::preserve()
+	{
+		uint32_t const epoch(::world_grid._epoch.load(std::memory_order_acquire));
+
+		if (epoch == _epoch.load(std::memory_order_acquire)) // fast-path, already preserved
+			return;
+
+		lock();
+
+		// snapshot may have been released in the meantime, ReleaseSnapshot() also locks every chunk
+		if (::world_grid._snapshot.load(std::memory_order_seq_cst) && epoch != _epoch.load(std::memory_order_relaxed)) {
+
+			_snapshot = nullptr;
+			_snapshot_size = 0;
+			_snapshot_open = false;
+
+			if (nullptr != _data) {
+
+				_snapshot_open = _state.test(std::memory_order_relaxed); // OPEN
+				_snapshot_size = (_snapshot_open ? (uint16_t)WorldGrid::CHUNK_SIZE : _compressed_size);
+				_snapshot_codec = _codec;
+				_snapshot = (uint8_t* const __restrict)mi_malloc(_snapshot_size);
+				memcpy(_snapshot, _data, _snapshot_size);
+			}
+
+			_epoch.store(epoch, std::memory_order_release);
+
+			::world_grid._cloned.fetch_add(1, std::memory_order_relaxed);
+			metrics::gauge(metrics::eGauge::SNAPSHOT_BYTES, (int64_t)(::world_grid._snapshot_bytes.fetch_add(_snapshot_size, std::memory_order_relaxed) + _snapshot_size));
+			metrics::count(metrics::eCounter::CHUNKS_CLONED);
+		}
+
+		unlock();
+	}
+
 	__declspec(safebuffers) void Chunk::update(uint32_t const index, Iso::Voxel const&& oVoxel) // used by setVoxel() of StreamingGrid
 	{
+		[[unlikely]] if (::world_grid._snapshot.load(std::memory_order_relaxed)) {
+			preserve(); // before the chunk changes in any way
+		}
+
 		// fast-path
+		chunk_open_demand(this);
 		open(); // open chunk
 
 		_last_access.store(critical_now(), std::memory_order_relaxed); // atomic  [before write access]
 
+		_dirty.test_and_set(std::memory_order_relaxed);
+
 		Iso::Voxel* const decompressed(reinterpret_cast<Iso::Voxel* const>(_data));
 		decompressed[index] = std::move(oVoxel);
+
+		_hash.store(0, std::memory_order_relaxed);
+	}
+
+	__declspec(safebuffers) void Chunk::prefetch(tTime const tNow) // used by Prefetch() of StreamingGrid
+	{
+		if (!_state.test(std::memory_order_acquire)) { // CLOSED
+
+			if (open()) {
+				_prefetched.test_and_set(std::memory_order_relaxed);
+				::world_grid._prefetched.fetch_add(1, std::memory_order_relaxed);
+				metrics::count(metrics::eCounter::CHUNKS_PREFETCHED);
+			}
+		}
+
+		_last_access.store(tNow, std::memory_order_relaxed); // keep alive until view arrives
 	}
 
 	// mutex always enabled
@@ -179,19 +451,24 @@ namespace // private to this file (anonymous)
 	{
 		if (_state.test(std::memory_order_relaxed)) { // OPEN = true/set
 
+			lock(); // a save may be reading the chunk
+
 			/**/ // CLOSED = clear // /**/
 			_state.clear(std::memory_order_relaxed); /**/
+			_prefetched.clear(std::memory_order_relaxed);
+
+			::world_grid._resident.fetch_sub(1, std::memory_order_relaxed);
+			metrics::count(metrics::eCounter::CHUNKS_CLOSED);
 
 			// read-only access //
 
-			density_processing_result const result = density_compress_with_context(_data, // _data is decompressed
-																					WorldGrid::CHUNK_SIZE,
-																					thread_local_compress_chunks.safe.buffer, thread_local_compress_chunks.COMPRESS_SAFE_BUFFER_SIZE,
-																					::world_grid._context);
+			codec::selection const method(codec::selected(codec::eSite::GRID_CHUNK));
 
-			if (!result.state) {
+			size_t const new_compressed_size = codec::compress(method, _data, // _data is decompressed
+															   WorldGrid::CHUNK_SIZE,
+															   thread_local_compress_chunks.safe.buffer, thread_local_compress_chunks.COMPRESS_SAFE_BUFFER_SIZE, sizeof(Iso::Voxel));
 
-				size_t const new_compressed_size(result.bytesWritten);
+			if (0 != new_compressed_size) {
 
 				// write access //
 
@@ -200,7 +477,12 @@ namespace // private to this file (anonymous)
 				memcpy(_data, thread_local_compress_chunks.safe.buffer, new_compressed_size);
 
 				_compressed_size = (uint16_t)new_compressed_size; // small chunk size < UINT16_MAX
+				_codec = (uint8_t)method.codec;
+
+				metrics::count(metrics::eCounter::CHUNK_BYTES_RECLAIMED, WorldGrid::CHUNK_SIZE - new_compressed_size);
 			}
+
+			unlock();
 		}
 	}
 } // end ns
@@ -235,14 +517,17 @@ bool const StreamingGrid::Initialize()
 
 		FMT_LOG(VOX_LOG, "world chunk allocation: {:n} bytes", (sizeof(Chunk) * WorldGrid::CHUNK_COUNT));
 
-		// Setup context
-		::world_grid._context = density_alloc_context(DENSITY_ALGORITHM_CHAMELEON, false, mi_malloc); //*bugfix - CHEETAH and LION are bugged "input buffer too small" error. Only CHAMELEON works properly it seems...
-
-		// Determine safe buffer sizes ~4400 bytes	 
-		size_t const decompress_safe_size = density_decompress_safe_size(WorldGrid::CHUNK_SIZE);
-		size_t const compressed_safe_size = density_compress_safe_size(WorldGrid::CHUNK_SIZE);
+		// Determine safe buffer sizes, chunks loaded from a .grid file can be in any codec
+		size_t decompress_safe_size(0), compressed_safe_size(0);
+		for (uint32_t method = 0; method < codec::eCodec::_size_constant; ++method) {
+			if (codec::available(method)) {
+				decompress_safe_size = std::max(decompress_safe_size, codec::decompress_bound(method, WorldGrid::CHUNK_SIZE));
+				compressed_safe_size = std::max(compressed_safe_size, codec::compress_bound(method, WorldGrid::CHUNK_SIZE));
+			}
+		}
 
-		FMT_LOG(VOX_LOG, "chunk size: {:n} bytes / chunk decompress safe size: {:n} bytes / chunk compress safe size: {:n} bytes", WorldGrid::CHUNK_SIZE, decompress_safe_size, compressed_safe_size);
+		FMT_LOG(VOX_LOG, "chunk size: {:n} bytes / chunk decompress safe size: {:n} bytes / chunk compress safe size: {:n} bytes / codec {:s}", WorldGrid::CHUNK_SIZE, decompress_safe_size, compressed_safe_size,
+			codec::name(codec::selected(codec::eSite::GRID_CHUNK).codec));
 		
 		if (decompress_safe_size > thread_local_decompress_chunks.DECOMPRESS_SAFE_BUFFER_SIZE) {
 
@@ -261,21 +546,119 @@ bool const StreamingGrid::Initialize()
 
 __declspec(safebuffers) Iso::Voxel const __vectorcall StreamingGrid::getVoxel(point2D_t const voxelIndex) const
 {
-	uint32_t const offset(voxelIndex.y * Iso::WORLD_GRID_WIDTH + voxelIndex.x);
-
-	Chunk* const __restrict chunk = ::world_grid.voxelToChunk(offset);
+	Chunk* const __restrict chunk = ::world_grid.voxelToChunk(voxelIndex);
 
 	// open chunk
-	return(chunk->open(offset & (StreamingGrid::CHUNK_VOXELS - 1)));
+	return(chunk->open(WorldGrid::voxelToChunkOffset(voxelIndex)));
 }
 
 __declspec(safebuffers) void __vectorcall StreamingGrid::setVoxel(point2D_t const voxelIndex, Iso::Voxel const&& oVoxel)
 {
-	uint32_t const offset(voxelIndex.y * Iso::WORLD_GRID_WIDTH + voxelIndex.x);
+	Chunk* const __restrict chunk = ::world_grid.voxelToChunk(voxelIndex);
+
+	chunk->update(WorldGrid::voxelToChunkOffset(voxelIndex), std::forward<Iso::Voxel const&&>(oVoxel));
 
-	Chunk* const __restrict chunk = ::world_grid.voxelToChunk(offset);
+	mark_dirty(chunk, voxelIndex, DIRTY_VOXELS);
+}
 
-	chunk->update(offset & (StreamingGrid::CHUNK_VOXELS - 1), std::forward<Iso::Voxel const&&>(oVoxel));
+__declspec(safebuffers) void __vectorcall StreamingGrid::MarkDirty(point2D_t const voxelIndex, uint32_t const flags)
+{
+	mark_dirty(::world_grid.voxelToChunk(voxelIndex), voxelIndex, flags);
+}
+
+// rows of consecutive tiles become spans, spans with the same extent on consecutive rows become rects. only tiles with the same flags are merged.
+// a single voxel edit is one tile, a road stroke a few thin rects, a large area edit one rect.
+void StreamingGrid::TakeDirtyRegions(vector<dirtyRegion>& __restrict regions)
+{
+	regions.clear();
+
+	tbb::spin_mutex::scoped_lock lock(::dirty_tiles.consumer);
+
+	// tiles first written after the swap are in the other buffer and are reported by the next call. their flags are only reset below
+	// for the tiles of this buffer, so a tile is never skipped by the fast-path of mark_dirty without being in one of the buffers.
+	tbb::concurrent_vector<point2D_t>& __restrict dirty(swap_dirty());
+
+	if (dirty.empty())
+		return;
+
+	typedef struct sDirtySpan {
+		int32_t   x0, x1, y0, y1;  // tiles, inclusive
+		uint32_t  flags;
+	} dirtySpan;
+
+	vector<dirtySpan> tiles;
+	tiles.reserve(dirty.size());
+
+	for (point2D_t const tile : dirty) {
+
+		Chunk* const __restrict chunk = ::world_grid.voxelToChunk(point2D_t(tile.x << WorldGrid::CHUNK_TILE_BITS, tile.y << WorldGrid::CHUNK_TILE_BITS));
+
+		tiles.emplace_back(dirtySpan{ tile.x, tile.x, tile.y, tile.y, uint32_t(chunk->_frame_dirty.exchange(0, std::memory_order_relaxed)) }); // reset for the next frame
+	}
+	dirty.clear(); // no writers, see swap_dirty()
+
+	// rows
+	std::sort(tiles.begin(), tiles.end(), [](dirtySpan const& a, dirtySpan const& b) {
+		return(std::tie(a.flags, a.y0, a.x0) < std::tie(b.flags, b.y0, b.x0));
+	});
+
+	vector<dirtySpan> spans;
+	for (dirtySpan const& tile : tiles) {
+
+		if (!spans.empty()) {
+			dirtySpan& __restrict last(spans.back());
+			if (last.flags == tile.flags && last.y0 == tile.y0 && (last.x1 + 1) == tile.x0) {
+				last.x1 = tile.x0;
+				continue;
+			}
+		}
+		spans.emplace_back(tile);
+	}
+
+	// columns
+	std::sort(spans.begin(), spans.end(), [](dirtySpan const& a, dirtySpan const& b) {
+		return(std::tie(a.flags, a.x0, a.x1, a.y0) < std::tie(b.flags, b.x0, b.x1, b.y0));
+	});
+
+	tiles.clear();
+	for (dirtySpan const& span : spans) {
+
+		if (!tiles.empty()) {
+			dirtySpan& __restrict last(tiles.back());
+			if (last.flags == span.flags && last.x0 == span.x0 && last.x1 == span.x1 && (last.y1 + 1) == span.y0) {
+				last.y1 = span.y0;
+				continue;
+			}
+		}
+		tiles.emplace_back(span);
+	}
+
+	regions.reserve(tiles.size());
+	for (dirtySpan const& rect : tiles) {
+
+		regions.emplace_back(dirtyRegion{ rect2D_t(point2D_t(rect.x0 << WorldGrid::CHUNK_TILE_BITS, rect.y0 << WorldGrid::CHUNK_TILE_BITS),
+												   point2D_t(((rect.x1 + 1) << WorldGrid::CHUNK_TILE_BITS) - 1, ((rect.y1 + 1) << WorldGrid::CHUNK_TILE_BITS) - 1)),
+										  rect.flags });
+	}
+}
+
+void StreamingGrid::EnableDirtyTracking(bool const bEnable)
+{
+	::world_grid._tracking.store(bEnable, std::memory_order_relaxed);
+
+	if (!bEnable) { // discard anything recorded, in both buffers
+		tbb::spin_mutex::scoped_lock lock(::dirty_tiles.consumer);
+
+		for (uint32_t i = 0; i < 2; ++i) {
+
+			tbb::concurrent_vector<point2D_t>& __restrict dirty(swap_dirty());
+
+			for (point2D_t const tile : dirty) {
+				::world_grid.voxelToChunk(point2D_t(tile.x << WorldGrid::CHUNK_TILE_BITS, tile.y << WorldGrid::CHUNK_TILE_BITS))->_frame_dirty.store(0, std::memory_order_relaxed);
+			}
+			dirty.clear();
+		}
+	}
 }
 
 #ifdef DEBUG_OUTPUT_STREAMING_STATS
@@ -290,8 +673,638 @@ namespace {
 } // end ns
 #endif
 
+// velocity driven lookahead - the visible area is extrapolated PREFETCH_LOOKAHEAD_FRAMES ahead, only the leading strip that is not currently visible is prefetched.
+// called once per frame after RenderGrid, the prefetch runs in the background and is synchronized before the next GarbageCollect.
+void StreamingGrid::Prefetch(rect2D_t const visibleArea)
+{
+	PrefetchWait();
+
+	if (!::prefetcher._bValid) {
+		::prefetcher._lastVisibleArea = visibleArea;
+		::prefetcher._bValid = true;
+		return;
+	}
+
+	point2D_t const delta(p2D_sub(visibleArea.left_top(), ::prefetcher._lastVisibleArea.left_top()));
+	::prefetcher._lastVisibleArea = visibleArea;
+
+	// smoothed velocity (voxels/frame), teleports (large jumps) reset the prediction
+	if (std::abs(delta.x) > (int32_t)Iso::SCREEN_VOXELS_X || std::abs(delta.y) > (int32_t)Iso::SCREEN_VOXELS_Z) {
+		::prefetcher._velocity = point2D_t{};
+		return;
+	}
+	::prefetcher._velocity = p2D_shiftr(p2D_add(::prefetcher._velocity, delta), 1);
+
+	if (0 == ::prefetcher._velocity.x && 0 == ::prefetcher._velocity.y) {
+		return; // camera is not moving, nothing to predict
+	}
+
+	// predicted visible area (union of current and lookahead, grown by border)
+	point2D_t const lookahead(p2D_muls(::prefetcher._velocity, (int32_t)PREFETCH_LOOKAHEAD_FRAMES));
+	rect2D_t const predicted(r2D_add(visibleArea, lookahead));
+	rect2D_t const area(r2D_grow(rect2D_t(p2D_min(visibleArea.left_top(), predicted.left_top()), p2D_max(visibleArea.right_bottom(), predicted.right_bottom())), point2D_t(PREFETCH_BORDER, PREFETCH_BORDER)));
+
+	::prefetcher._task_id.store(async_long_task::enqueue<background>([area] {
+
+		tTime const tNow(critical_now());
+
+		// step in whole chunk tiles
+		int32_t const
+			y_begin(area.top & ~int32_t(WorldGrid::CHUNK_TILE - 1)),
+			x_begin(area.left & ~int32_t(WorldGrid::CHUNK_TILE - 1));
+
+		tbb::parallel_for(tbb::blocked_range2d<int32_t, int32_t>(0, (area.bottom - y_begin + WorldGrid::CHUNK_TILE - 1) >> WorldGrid::CHUNK_TILE_BITS, 1,
+			                                                     0, (area.right - x_begin + WorldGrid::CHUNK_TILE - 1) >> WorldGrid::CHUNK_TILE_BITS, 1),
+			[&](tbb::blocked_range2d<int32_t, int32_t> const& r) {
+
+				for (int32_t tile_y = r.rows().begin(); tile_y < r.rows().end(); ++tile_y) {
+					for (int32_t tile_x = r.cols().begin(); tile_x < r.cols().end(); ++tile_x) {
+
+						point2D_t const voxelIndex(x_begin + (tile_x << WorldGrid::CHUNK_TILE_BITS), y_begin + (tile_y << WorldGrid::CHUNK_TILE_BITS));
+						point2D_t const voxelIndexWrapped(p2D_wrap_pow2(voxelIndex, point2D_t(Iso::WORLD_GRID_WIDTH, Iso::WORLD_GRID_HEIGHT)));
+
+						::world_grid.voxelToChunk(voxelIndexWrapped)->prefetch(tNow);
+					}
+				}
+			});
+	}), std::memory_order_release);
+}
+
+void StreamingGrid::PrefetchWait()
+{
+	task_id_t const task_id(::prefetcher._task_id.exchange(0, std::memory_order_acq_rel));
+
+	if (task_id) {
+		async_long_task::wait<background>(task_id, "prefetch");
+	}
+}
+
+StreamingGrid::sStreamingStats const StreamingGrid::getStats(bool const bReset)
+{
+	sStreamingStats const stats{
+		::world_grid._prefetched.load(std::memory_order_relaxed),
+		::world_grid._prefetch_hits.load(std::memory_order_relaxed),
+		::world_grid._misses.load(std::memory_order_relaxed),
+		nanoseconds(::world_grid._stall_ns.load(std::memory_order_relaxed))
+	};
+
+	if (bReset) {
+		::world_grid._prefetched.store(0, std::memory_order_relaxed);
+		::world_grid._prefetch_hits.store(0, std::memory_order_relaxed);
+		::world_grid._misses.store(0, std::memory_order_relaxed);
+		::world_grid._stall_ns.store(0, std::memory_order_relaxed);
+	}
+
+	return(stats);
+}
+
+uint32_t const StreamingGrid::Snapshot()
+{
+	PrefetchWait(); // quiesced here, SaveChunks() runs in the background and does not synchronize with the prefetcher
+
+	uint32_t const epoch(::world_grid._epoch.fetch_add(1, std::memory_order_acq_rel) + 1);
+
+	::world_grid._cloned.store(0, std::memory_order_relaxed);
+	::world_grid._snapshot_bytes.store(0, std::memory_order_relaxed);
+	::world_grid._snapshot.store(true, std::memory_order_seq_cst);
+
+	return(epoch);
+}
+
+void StreamingGrid::ReleaseSnapshot()
+{
+	if (!::world_grid._snapshot.exchange(false, std::memory_order_seq_cst))
+		return;
+
+	// every chunk is locked, so a writer that has not seen the release yet can not preserve a chunk after it was visited here
+	tbb::parallel_for(tbb::blocked_range<uint32_t>(0, WorldGrid::CHUNK_COUNT), [&](tbb::blocked_range<uint32_t> const& r) {
+
+		for (uint32_t i = r.begin(); i < r.end(); ++i) {
+
+			Chunk& chunk(world_grid._chunks[i]);
+
+			chunk.lock();
+			if (chunk._snapshot) {
+				mi_free(chunk._snapshot); chunk._snapshot = nullptr;
+			}
+			chunk.unlock();
+		}
+	});
+
+	sSnapshotStats const stats(getSnapshotStats());
+	FMT_LOG(VOX_LOG, "snapshot released: {:n} chunks copied on write, {:n} bytes", stats.cloned, stats.bytes);
+
+	metrics::gauge(metrics::eGauge::SNAPSHOT_BYTES, 0);
+}
+
+StreamingGrid::sSnapshotStats const StreamingGrid::getSnapshotStats() const
+{
+	return(sSnapshotStats{ ::world_grid._cloned.load(std::memory_order_relaxed), ::world_grid._snapshot_bytes.load(std::memory_order_relaxed) });
+}
+
+namespace {
+
+	STATIC_INLINE_PURE uint32_t const crc_chunk(uint8_t const* const __restrict voxels) // crc32c of a decompressed chunk
+	{
+		uint64_t crc(0);
+		for (uint32_t i = 0; i < WorldGrid::CHUNK_SIZE; i += sizeof(uint64_t)) {
+			uint64_t bits;
+			memcpy(&bits, voxels + i, sizeof(bits));
+			crc = _mm_crc32_u64(crc, bits);
+		}
+		return((uint32_t)crc);
+	}
+
+} // end ns
+
+// order independent hash of every voxel of the grid. each chunk caches the crc of its voxels until it is written again, so only chunks changed since the last call
+// are decompressed (into the thread local buffer, the chunk is not opened). empty chunks and chunks of only empty voxels do not contribute, the result is the same
+// whether or not a chunk was ever opened. must be called when there are no concurrent writers (main thread, between ticks).
+uint64_t const StreamingGrid::HashChunks() const
+{
+	alignas(64) static constexpr uint8_t const zeroes[WorldGrid::CHUNK_SIZE]{};
+	uint32_t const empty_crc(crc_chunk(zeroes));
+
+	return(tbb::parallel_reduce(tbb::blocked_range<uint32_t>(0, WorldGrid::CHUNK_COUNT), uint64_t(0), [&](tbb::blocked_range<uint32_t> const& r, uint64_t h) {
+
+		for (uint32_t i = r.begin(); i < r.end(); ++i) {
+
+			Chunk& chunk(world_grid._chunks[i]);
+
+			uint64_t cached(chunk._hash.load(std::memory_order_relaxed));
+			if (0 == cached) {
+
+				uint32_t crc(empty_crc);
+
+				chunk.lock(); // garbage collection may be closing the chunk
+				if (nullptr != chunk._data) {
+					if (chunk._state.test(std::memory_order_relaxed)) { // OPEN
+						crc = crc_chunk(chunk._data);
+					}
+					else if (WorldGrid::CHUNK_SIZE == codec::decompress(chunk._codec, chunk._data, chunk._compressed_size, thread_local_decompress_chunks.safe.buffer, thread_local_decompress_chunks.DECOMPRESS_SAFE_BUFFER_SIZE)) {
+						crc = crc_chunk(thread_local_decompress_chunks.safe.buffer);
+					}
+				}
+				chunk.unlock();
+
+				cached = (empty_crc == crc) ? 1ull : ((uint64_t(i) << 32) | crc) * 0x9e3779b97f4a7c15ull | 1ull; // never 0, 1 = empty
+				chunk._hash.store(cached, std::memory_order_relaxed);
+			}
+			if (1ull != cached) {
+				h += cached;
+			}
+		}
+		return(h);
+
+	}, std::plus<uint64_t>()));
+}
+
+namespace {
+
+	// free record slots of a .grid file, the space between the records the current table references. slots are found by size class (multiples of GRID_RECORD_ALIGNMENT),
+	// a larger slot is split. space freed by a save is only reused by the save after it, when the table that referenced it is no longer current.
+	typedef struct sFreeSlots
+	{
+		static constexpr uint32_t const CLASSES = (thread_local_compress_chunks.COMPRESS_SAFE_BUFFER_SIZE + GRID_RECORD_ALIGNMENT - 1) / GRID_RECORD_ALIGNMENT + 1;
+
+		vector<uint64_t>  offsets[CLASSES]; // by size class, class n is n * GRID_RECORD_ALIGNMENT bytes
+		uint64_t          bytes = 0;
+
+		void add(uint64_t offset, uint64_t size) {
+
+			bytes += size;
+			for (; size >= (CLASSES - 1) * GRID_RECORD_ALIGNMENT; size -= (CLASSES - 1) * GRID_RECORD_ALIGNMENT, offset += (CLASSES - 1) * GRID_RECORD_ALIGNMENT) {
+				offsets[CLASSES - 1].emplace_back(offset);
+			}
+			if (size) {
+				offsets[size / GRID_RECORD_ALIGNMENT].emplace_back(offset);
+			}
+		}
+
+		uint64_t const allocate(uint32_t const capacity) { // returns 0 if there is no free slot large enough
+
+			uint32_t const size_class(capacity / GRID_RECORD_ALIGNMENT);
+
+			for (uint32_t from = size_class; from < CLASSES; ++from) {
+
+				if (!offsets[from].empty()) {
+
+					uint64_t const offset(offsets[from].back());
+					offsets[from].pop_back();
+					bytes -= uint64_t(from) * GRID_RECORD_ALIGNMENT;
+
+					if (from != size_class) { // remainder of the split
+						add(offset + capacity, uint64_t(from - size_class) * GRID_RECORD_ALIGNMENT);
+					}
+					return(offset);
+				}
+			}
+			return(0);
+		}
+
+	} sFreeSlots;
+
+	// every slot referenced by the table is live, anything between them (after the tables) is free. returns the end of the last record.
+	static uint64_t const find_free_slots(vector<sChunkRecord> const& __restrict table, sFreeSlots& __restrict free_slots, uint64_t& __restrict live_bytes)
+	{
+		vector<std::pair<uint64_t, uint64_t>> slots; // offset, capacity
+		slots.reserve(WorldGrid::CHUNK_COUNT);
+
+		for (sChunkRecord const& entry : table) {
+			if (0 != entry.offset && 0 != entry.compressed_size) {
+				slots.emplace_back(entry.offset, entry.capacity);
+			}
+		}
+		tbb::parallel_sort(slots.begin(), slots.end());
+
+		uint64_t end(GRID_RECORDS_OFFSET);
+		live_bytes = 0;
+
+		for (auto const& [offset, capacity] : slots) {
+
+			if (offset > end) {
+				free_slots.add(end, offset - end);
+			}
+			end = std::max(end, offset + capacity);
+			live_bytes += capacity;
+		}
+
+		return(end);
+	}
+
+	// copies the records CLOSED chunks still point to in the file mapping to the heap and releases the mapping, so the .grid file can be replaced
+	static void release_grid_mapping()
+	{
+		if (!::grid_mapping.source.is_mapped())
+			return;
+
+		tbb::parallel_for(tbb::blocked_range<uint32_t>(0, WorldGrid::CHUNK_COUNT), [&](tbb::blocked_range<uint32_t> const& r) {
+
+			for (uint32_t i = r.begin(); i < r.end(); ++i) {
+
+				Chunk& chunk(world_grid._chunks[i]);
+
+				chunk.lock();
+				if (chunk._mapped) {
+					uint8_t* const __restrict record((uint8_t* const __restrict)mi_malloc(chunk._compressed_size));
+					memcpy(record, chunk._data, chunk._compressed_size);
+					chunk._data = record;
+					chunk._mapped = false;
+				}
+				chunk.unlock();
+			}
+		});
+
+		::grid_mapping.source.unmap();
+		::grid_mapping.file.clear();
+	}
+
+} // end ns
+
+// chunks are compressed in batches (parallel) then written sequentially
+// while a snapshot is active, chunks written since the snapshot are saved from their preserved state
+bool const StreamingGrid::SaveChunks(std::wstring const& path)
+{
+	static constexpr uint32_t const BATCH_CHUNKS = 4096;
+
+	// incremental - the file is updated in place, no record or table the current table references is overwritten, flipping header.table commits the save.
+	// full - a new file is written and renamed over the original once complete. also compacts the file once the free slots outgrow the live records.
+	// either way a crash mid-save leaves the last save intact.
+	std::wstring const temp_path(path + L".tmp");
+
+	FILE* stream(nullptr);
+	vector<sChunkRecord> table(WorldGrid::CHUNK_COUNT);
+	sGridFileHeader header{};
+	sFreeSlots free_slots{};
+	uint64_t end_of_file(GRID_RECORDS_OFFSET);
+	bool bFull(true), bCompact(false);
+
+	if (path == ::baseline_file && 0 == _wfopen_s(&stream, path.c_str(), L"r+bR") && nullptr != stream) { // existing table
+
+		if (1 == _fread_nolock(&header, sizeof(header), 1, stream) && 0 == memcmp(header.tag, GRID_FILE_TAG, sizeof(GRID_FILE_TAG)) &&
+			GRID_FILE_VERSION == header.version && WorldGrid::CHUNK_COUNT == header.chunk_count && WorldGrid::CHUNK_VOXELS == header.chunk_voxels && header.table <= 1) {
+
+			_fseeki64_nolock(stream, grid_table_offset(header.table), SEEK_SET);
+			bFull = (1 != _fread_nolock(table.data(), GRID_TABLE_SIZE, 1, stream));
+		}
+
+		if (!bFull) {
+			uint64_t live_bytes(0);
+			end_of_file = find_free_slots(table, free_slots, live_bytes);
+
+			bFull = bCompact = (free_slots.bytes > GRID_COMPACT_BYTES && free_slots.bytes > live_bytes);
+		}
+
+		if (bFull) { // not usable as a baseline or compacting, a new file is written
+			_fclose_nolock(stream); stream = nullptr;
+			free_slots = sFreeSlots{};
+			end_of_file = GRID_RECORDS_OFFSET;
+		}
+	}
+	if (nullptr == stream) {
+		if (0 != _wfopen_s(&stream, temp_path.c_str(), L"wbS") || nullptr == stream) {
+			FMT_LOG_FAIL(VOX_LOG, "unable to open grid file for writing");
+			return(false);
+		}
+	}
+
+	if (bFull) {
+		memset(table.data(), 0, GRID_TABLE_SIZE);
+		header = sGridFileHeader{};
+	}
+
+	vector<uint8_t> changed_pages(GRID_TABLE_PAGES); // table pages changed by this save
+
+	struct alignas(64) batch_record {
+		uint8_t  data[thread_local_compress_chunks.COMPRESS_SAFE_BUFFER_SIZE];
+		uint32_t size;
+		uint8_t  codec;
+		bool     write;
+	};
+	batch_record* const __restrict batch((batch_record* const __restrict)mi_malloc_aligned(sizeof(batch_record) * BATCH_CHUNKS, CACHE_LINE_BYTES));
+
+	bool const bSnapshot(::world_grid._snapshot.load(std::memory_order_acquire));
+	uint32_t const epoch(::world_grid._epoch.load(std::memory_order_acquire));
+	codec::selection const method(codec::selected(codec::eSite::GRID_CHUNK));
+
+	size_t written(0);
+
+	for (uint32_t start = 0; start < WorldGrid::CHUNK_COUNT; start += BATCH_CHUNKS) {
+
+		uint32_t const count(std::min(BATCH_CHUNKS, WorldGrid::CHUNK_COUNT - start));
+
+		tbb::parallel_for(uint32_t(0), count, [&](uint32_t const i) {
+
+			Chunk& chunk(world_grid._chunks[start + i]);
+			batch_record& record(batch[i]);
+
+			record.write = bFull || chunk._dirty.test(std::memory_order_relaxed);
+			record.size = 0;
+
+			if (!record.write)
+				return;
+
+			if (bSnapshot) {
+				chunk.lock(); // the first write since the snapshot has to wait until the chunk has been read
+			}
+
+			uint8_t const* data(chunk._data);
+			bool bOpen(chunk._state.test(std::memory_order_relaxed));
+			uint32_t size(chunk._compressed_size);
+			uint8_t data_codec(chunk._codec);
+
+			if (bSnapshot && epoch == chunk._epoch.load(std::memory_order_acquire)) { // written since the snapshot, use the preserved chunk
+				data = chunk._snapshot;
+				bOpen = chunk._snapshot_open;
+				size = chunk._snapshot_size;
+				data_codec = chunk._snapshot_codec;
+			}
+
+			if (nullptr != data) {
+
+				if (bOpen) { // OPEN, compress without closing
+
+					record.size = (uint32_t)codec::compress(method, data, WorldGrid::CHUNK_SIZE, record.data, sizeof(record.data), sizeof(Iso::Voxel));
+					record.codec = (uint8_t)method.codec;
+				}
+				else { // CLOSED, already compressed
+					record.size = size;
+					record.codec = data_codec;
+					memcpy(record.data, data, record.size);
+				}
+			}
+
+			if (bSnapshot) {
+				chunk.unlock();
+			}
+		});
+
+		for (uint32_t i = 0; i < count; ++i) {
+
+			batch_record const& record(batch[i]);
+			if (!record.write)
+				continue;
+
+			Chunk& chunk(world_grid._chunks[start + i]);
+
+			if (bSnapshot) { // chunks written since the snapshot stay dirty for the next save
+				chunk.lock();
+				if (epoch != chunk._epoch.load(std::memory_order_relaxed)) {
+					chunk._dirty.clear(std::memory_order_relaxed);
+				}
+				chunk.unlock();
+			}
+			else {
+				chunk._dirty.clear(std::memory_order_relaxed);
+			}
+
+			sChunkRecord& entry(table[start + i]);
+			changed_pages[(start + i) / GRID_TABLE_PAGE] = 1;
+
+			if (0 == record.size) { // empty, the slot is free for the next save
+				entry = sChunkRecord{};
+				continue;
+			}
+
+			// never in place, the current table still references the old slot until the save is committed
+			entry.capacity = (uint16_t)SFM::roundToMultipleOf<true>((int32_t)record.size, (int32_t)GRID_RECORD_ALIGNMENT);
+			entry.offset = free_slots.allocate(entry.capacity);
+			if (0 == entry.offset) { // append
+				entry.offset = end_of_file;
+				end_of_file += entry.capacity;
+			}
+			entry.compressed_size = (uint16_t)record.size;
+			entry.codec = record.codec;
+
+			_fseeki64_nolock(stream, entry.offset, SEEK_SET);
+			_fwrite_nolock(record.data, record.size, 1, stream);
+			++written;
+		}
+	}
+
+	mi_free_aligned(batch, CACHE_LINE_BYTES);
+
+	bool bWritten(false);
+
+	if (bFull) { // header & both tables last
+
+		memcpy(header.tag, GRID_FILE_TAG, sizeof(GRID_FILE_TAG));
+		header.version = GRID_FILE_VERSION;
+		header.chunk_count = WorldGrid::CHUNK_COUNT;
+		header.chunk_voxels = WorldGrid::CHUNK_VOXELS;
+		header.table = 0;
+
+		_fseeki64_nolock(stream, 0, SEEK_SET);
+		_fwrite_nolock(&header, sizeof(header), 1, stream);
+		_fwrite_nolock(table.data(), GRID_TABLE_SIZE, 1, stream);
+		_fwrite_nolock(table.data(), GRID_TABLE_SIZE, 1, stream);
+
+		bWritten = (0 == _fflush_nolock(stream) && 0 == ferror(stream) && 0 == _commit(_fileno(stream))); // on disk before it replaces the original
+		_fclose_nolock(stream);
+
+		if (bWritten) {
+			if (path == ::grid_mapping.file) { // a mapped file can not be replaced
+				release_grid_mapping();
+			}
+			bWritten = MoveFileExW(temp_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+		}
+		if (!bWritten) {
+			DeleteFileW(temp_path.c_str());
+		}
+		else {
+			::baseline_stale_pages.assign(GRID_TABLE_PAGES, 0); // both tables are the same
+		}
+	}
+	else { // the other table, then the header that makes it current
+
+		uint32_t const next_table(header.table ^ 1u);
+		bool const bStaleKnown(!::baseline_stale_pages.empty());
+
+		for (uint32_t page = 0; page < GRID_TABLE_PAGES; ) {
+
+			uint32_t end(page);
+			while (end < GRID_TABLE_PAGES && (changed_pages[end] || !bStaleKnown || ::baseline_stale_pages[end])) {
+				++end;
+			}
+
+			if (end != page) { // run of pages that differ
+				_fseeki64_nolock(stream, grid_table_offset(next_table) + sizeof(sChunkRecord) * GRID_TABLE_PAGE * page, SEEK_SET);
+				_fwrite_nolock(&table[GRID_TABLE_PAGE * page], sizeof(sChunkRecord) * GRID_TABLE_PAGE * (end - page), 1, stream);
+				page = end;
+			}
+			else {
+				++page;
+			}
+		}
+
+		bWritten = (0 == _fflush_nolock(stream) && 0 == ferror(stream) && 0 == _commit(_fileno(stream))); // records & table on disk before the table is made current
+
+		if (bWritten) {
+			header.table = next_table;
+
+			_fseeki64_nolock(stream, 0, SEEK_SET);
+			_fwrite_nolock(&header, sizeof(header), 1, stream);
+
+			bWritten = (0 == _fflush_nolock(stream) && 0 == ferror(stream) && 0 == _commit(_fileno(stream)));
+		}
+		_fclose_nolock(stream);
+
+		::baseline_stale_pages = std::move(changed_pages); // the previous table now differs in exactly the pages this save changed
+	}
+
+	if (!bWritten) {
+		::baseline_file.clear(); // chunks written above are no longer dirty, the next save must be a full save
+		::baseline_stale_pages.clear();
+		FMT_LOG_FAIL(VOX_LOG, "unable to write grid file, the previous save is unchanged");
+		return(false);
+	}
+
+	::baseline_file = path;
+
+	FMT_LOG(VOX_LOG, "grid saved: {:n} of {:n} chunks written ({:s}), {:n} bytes in free slots", written, WorldGrid::CHUNK_COUNT,
+		bCompact ? "compacted" : (bFull ? "full" : "incremental"), free_slots.bytes);
+
+	return(true);
+}
+
+bool const StreamingGrid::LoadChunks(std::wstring const& path)
+{
+	PrefetchWait();
+
+	std::error_code error{};
+	mio::mmap_source mmap = mio::make_mmap_source(path, FILE_FLAG_RANDOM_ACCESS | FILE_ATTRIBUTE_NORMAL, error);
+	if (error || !mmap.is_open() || !mmap.is_mapped() || mmap.size() < (GRID_FILE_V2_HEADER_SIZE + GRID_TABLE_SIZE)) {
+		FMT_LOG_FAIL(VOX_LOG, "unable to open grid file");
+		return(false);
+	}
+
+	uint8_t const* const __restrict data((uint8_t const* const __restrict)mmap.data());
+	size_t const file_size(mmap.size());
+
+	sGridFileHeader const header(*reinterpret_cast<sGridFileHeader const* const>(data));
+	if (0 != memcmp(header.tag, GRID_FILE_TAG, sizeof(GRID_FILE_TAG)) || header.version < 1 || header.version > GRID_FILE_VERSION ||
+		WorldGrid::CHUNK_COUNT != header.chunk_count || WorldGrid::CHUNK_VOXELS != header.chunk_voxels) {
+		FMT_LOG_FAIL(VOX_LOG, "grid file version mismatch");
+		return(false);
+	}
+
+	// version 1 & 2 have a single table after a shorter header
+	uint64_t const table_offset(header.version >= 3 ? grid_table_offset(header.table) : GRID_FILE_V2_HEADER_SIZE);
+	if ((header.version >= 3 && header.table > 1) || file_size < table_offset + GRID_TABLE_SIZE) {
+		FMT_LOG_FAIL(VOX_LOG, "grid file is truncated or corrupt");
+		return(false);
+	}
+
+	sChunkRecord const* const __restrict table(reinterpret_cast<sChunkRecord const* const __restrict>(data + table_offset));
+	bool const bCodecs(header.version >= 2); // version 1 records are all density (reserved field is zero)
+
+	std::atomic_bool bValid(true);
+
+	// nothing is copied, CLOSED chunks point at their record in the mapping and decompress lazily on first access
+	tbb::parallel_for(tbb::blocked_range<uint32_t>(0, WorldGrid::CHUNK_COUNT), [&](tbb::blocked_range<uint32_t> const& r) {
+
+		for (uint32_t i = r.begin(); i < r.end(); ++i) {
+
+			Chunk& chunk(world_grid._chunks[i]);
+			sChunkRecord const record(table[i]);
+
+			if (chunk._state.test(std::memory_order_relaxed)) {
+				::world_grid._resident.fetch_sub(1, std::memory_order_relaxed);
+			}
+			chunk._state.clear(std::memory_order_relaxed); // CLOSED
+			chunk._prefetched.clear(std::memory_order_relaxed);
+			chunk._dirty.clear(std::memory_order_relaxed);
+			chunk._hash.store(0, std::memory_order_relaxed);
+
+			if (chunk._data && !chunk._mapped) {
+				mi_free(chunk._data);
+			}
+			chunk._data = nullptr;
+			chunk._mapped = false;
+			chunk._compressed_size = 0;
+
+			if (0 == record.compressed_size)
+				continue;
+
+			uint8_t const record_codec(bCodecs ? record.codec : (uint8_t)codec::eCodec::DENSITY_CHAMELEON);
+
+			[[unlikely]] if (record.offset + record.compressed_size > file_size || !codec::available(record_codec)) {
+				bValid = false;
+				continue;
+			}
+
+			chunk._data = (uint8_t* const __restrict)(data + record.offset); // read-only, open() decompresses to a new allocation
+			chunk._mapped = true;
+			chunk._compressed_size = record.compressed_size;
+			chunk._codec = record_codec;
+		}
+	});
+
+	// no chunk points into the previous mapping anymore
+	::grid_mapping.source = std::move(mmap);
+	::grid_mapping.file = path;
+	::baseline_stale_pages.clear();
+
+	if (!bValid) {
+		FMT_LOG_FAIL(VOX_LOG, "grid file is truncated or corrupt");
+		::baseline_file.clear();
+		return(false);
+	}
+
+	::baseline_file = path;
+	return(true);
+}
+
+void StreamingGrid::ResetBaseline()
+{
+	::baseline_file.clear();
+	::baseline_stale_pages.clear();
+}
+
 void StreamingGrid::Flush() // closes all chunks to "flush" any chunks that are open/
 {
+	PrefetchWait();
+
 	tbb::parallel_for(uint32_t(0), uint32_t(WorldGrid::CHUNK_COUNT), [&](uint32_t const i) {
 
 		world_grid._chunks[i].close(); // close the chunk
@@ -315,6 +1328,10 @@ __declspec(safebuffers) void StreamingGrid::GarbageCollect(tTime const tNow, nan
 
 	if ((accumulator += tDelta) >= interval || bForce) {
 
+		metrics::scoped_timer const timer(metrics::eTimer::GARBAGE_COLLECT);
+
+		PrefetchWait(); // chunks being opened by the prefetcher must not be closed at the same time
+
 		static constinit uint32_t mode{};
 
 		// load balancing //
@@ -359,6 +1376,7 @@ __declspec(safebuffers) void StreamingGrid::GarbageCollect(tTime const tNow, nan
 			mi_collect(bForce);                        // If Forced, there could be a significant delay - used only during load-time to reduce memory pressure / usage. Do not use force during run-time.
 		}
 	}
+	metrics::gauge(metrics::eGauge::CHUNKS_RESIDENT, ::world_grid._resident.load(std::memory_order_relaxed));
 	
 #ifdef DEBUG_OUTPUT_STREAMING_STATS // Has a large impact on performance, update infrequently!  ** causes a visual "hitch" every second. ***
 	{
@@ -469,8 +1487,10 @@ void StreamingGrid::OutputDebugStats(fp_seconds const& tDelta)
 	if (elapsed >= interval) {
 
 #ifndef NDEBUG
-		FMT_NUKLEAR_DEBUG(false, "open {:n} - {:n} bytes)  /  closed {:n} - {:n} bytes",
-			(chunksOpen / count), (bytesOpen / count), (chunksClosed / count), (bytesClosed / count)
+		sStreamingStats const stats(getStats(true));
+		FMT_NUKLEAR_DEBUG(false, "open {:n} - {:n} bytes)  /  closed {:n} - {:n} bytes  /  prefetched {:n} hits {:n} misses {:n} stall {:n} us",
+			(chunksOpen / count), (bytesOpen / count), (chunksClosed / count), (bytesClosed / count),
+			stats.prefetched, stats.prefetch_hits, stats.misses, duration_cast<microseconds>(stats.stall_duration).count()
 		);
 #endif
 		MinCity::Nuklear->debug_update_streaming(chunksClosed / count, chunksClosed / count, chunksOpen / count);
@@ -486,6 +1506,184 @@ void StreamingGrid::OutputDebugStats(fp_seconds const& tDelta)
 }
 #endif
 
+#ifdef DEBUG_BENCHMARK_CHUNK_CODECS
+// chunk codec benchmark - the chunks of the current city grid (every chunk that is not empty, evenly spread up to BENCHMARK_CHUNKS) are decompressed to
+// plain voxels once, then compressed & decompressed by every available codec on a single thread. decompressed chunks are verified against the original.
+void StreamingGrid::BenchmarkCodecs() const
+{
+	static constexpr uint32_t const BENCHMARK_CHUNKS = 16384;
+	static constexpr codec::selection const BENCHMARK_METHODS[]{
+		{ codec::eCodec::DENSITY_CHAMELEON, 0 }, { codec::eCodec::DENSITY_CHEETAH, 0 }, { codec::eCodec::DENSITY_LION, 0 },
+		{ codec::eCodec::VOXEL_RLE, 0 },
+		{ codec::eCodec::LZ4, 0 }, { codec::eCodec::LZ4, 9 },
+		{ codec::eCodec::ZSTD, 1 }, { codec::eCodec::ZSTD, 3 }, { codec::eCodec::ZSTD, 9 }, { codec::eCodec::ZSTD, 19 }
+	};
+	static constexpr size_t const COMPRESSED_STRIDE = thread_local_compress_chunks.COMPRESS_SAFE_BUFFER_SIZE;
+
+	const_cast<StreamingGrid* const>(this)->PrefetchWait();
+
+	vector<uint32_t> occupied;
+	for (uint32_t i = 0; i < WorldGrid::CHUNK_COUNT; ++i) {
+		if (nullptr != world_grid._chunks[i]._data) {
+			occupied.push_back(i);
+		}
+	}
+
+	size_t const step(std::max(size_t(1), occupied.size() / BENCHMARK_CHUNKS));
+	size_t const count(std::min(occupied.size(), size_t(BENCHMARK_CHUNKS)));
+
+	if (0 == count) {
+		FMT_LOG_WARN(VOX_LOG, "codec benchmark: grid is empty");
+		return;
+	}
+
+	uint8_t* const __restrict raw((uint8_t* const __restrict)mi_malloc_aligned(count * WorldGrid::CHUNK_SIZE, CACHE_LINE_BYTES));
+	uint8_t* const __restrict compressed((uint8_t* const __restrict)mi_malloc_aligned(count * COMPRESSED_STRIDE, CACHE_LINE_BYTES));
+	vector<uint32_t> sizes(count);
+
+	size_t source_bytes(0); // as currently stored
+	size_t valid(0);
+
+	for (size_t i = 0; i < count; ++i) {
+
+		Chunk& chunk(world_grid._chunks[occupied[i * step]]);
+		uint8_t* const __restrict target(raw + valid * WorldGrid::CHUNK_SIZE);
+
+		chunk.lock();
+		if (chunk._state.test(std::memory_order_relaxed)) { // OPEN
+			memcpy(target, chunk._data, WorldGrid::CHUNK_SIZE);
+			source_bytes += WorldGrid::CHUNK_SIZE;
+			++valid;
+		}
+		else if (WorldGrid::CHUNK_SIZE == codec::decompress(chunk._codec, chunk._data, chunk._compressed_size, thread_local_decompress_chunks.safe.buffer, thread_local_decompress_chunks.DECOMPRESS_SAFE_BUFFER_SIZE)) {
+			memcpy(target, thread_local_decompress_chunks.safe.buffer, WorldGrid::CHUNK_SIZE);
+			source_bytes += chunk._compressed_size;
+			++valid;
+		}
+		chunk.unlock();
+	}
+
+	size_t const raw_bytes(valid * WorldGrid::CHUNK_SIZE);
+
+	FMT_LOG(VOX_LOG, "codec benchmark: {:n} of {:n} chunks, {:n} bytes ({:n} bytes as stored, {:s})", valid, occupied.size(), raw_bytes, source_bytes, codec::name(codec::selected(codec::eSite::GRID_CHUNK).codec));
+
+	for (auto const& method : BENCHMARK_METHODS) {
+
+		if (!codec::available(method.codec))
+			continue;
+
+		size_t compressed_bytes(0), failures(0);
+
+		tTime const tCompressStart(high_resolution_clock::now());
+		for (size_t i = 0; i < valid; ++i) {
+			sizes[i] = (uint32_t)codec::compress(method, raw + i * WorldGrid::CHUNK_SIZE, WorldGrid::CHUNK_SIZE, compressed + i * COMPRESSED_STRIDE, COMPRESSED_STRIDE, sizeof(Iso::Voxel));
+			compressed_bytes += sizes[i];
+		}
+		fp_seconds const tCompress(high_resolution_clock::now() - tCompressStart);
+
+		tTime const tDecompressStart(high_resolution_clock::now());
+		for (size_t i = 0; i < valid; ++i) {
+			size_t const decompressed(codec::decompress(method.codec, compressed + i * COMPRESSED_STRIDE, sizes[i], thread_local_decompress_chunks.safe.buffer, thread_local_decompress_chunks.DECOMPRESS_SAFE_BUFFER_SIZE));
+			failures += (WorldGrid::CHUNK_SIZE != decompressed);
+		}
+		fp_seconds const tDecompress(high_resolution_clock::now() - tDecompressStart);
+
+		// verification is not timed
+		for (size_t i = 0; i < valid; ++i) {
+			if (WorldGrid::CHUNK_SIZE == codec::decompress(method.codec, compressed + i * COMPRESSED_STRIDE, sizes[i], thread_local_decompress_chunks.safe.buffer, thread_local_decompress_chunks.DECOMPRESS_SAFE_BUFFER_SIZE)) {
+				failures += (0 != memcmp(thread_local_decompress_chunks.safe.buffer, raw + i * WorldGrid::CHUNK_SIZE, WorldGrid::CHUNK_SIZE));
+			}
+		}
+
+		static constexpr double const MB = 1024.0 * 1024.0;
+
+		FMT_LOG(VOX_LOG, "  {:<18s} level {:>2d}   ratio {:6.2f}   compress {:8.1f} MB/s   decompress {:8.1f} MB/s   {:s}",
+			codec::name(method.codec), method.level, double(raw_bytes) / double(std::max(size_t(1), compressed_bytes)),
+			(double(raw_bytes) / MB) / tCompress.count(), (double(raw_bytes) / MB) / tDecompress.count(),
+			(0 == failures ? "ok" : fmt::format("{:d} failed", failures)));
+	}
+
+	mi_free_aligned(compressed, CACHE_LINE_BYTES);
+	mi_free_aligned(raw, CACHE_LINE_BYTES);
+}
+#endif
+
+#ifdef DEBUG_BENCHMARK_STREAMING_PAN
+// streaming pan benchmark - a synthetic camera pans across the current city grid (one leg along x, then one along y, at a constant speed) and every frame
+// reads each voxel of the visible area, as RenderGrid does. the pan runs once without and once with the prefetcher, each time from a fully closed grid.
+// stall is the time the reading threads spent decompressing chunks on demand, which is what the prefetcher moves off the render path.
+void StreamingGrid::BenchmarkPan()
+{
+	static constexpr int32_t const FRAMES_PER_LEG = 180,
+		                           SPEED = 6; // voxels / frame
+
+	typedef struct sPanResult {
+		fp_seconds       render;
+		sStreamingStats  stats;
+	} sPanResult;
+
+	auto const pan = [this](bool const bPrefetch) {
+
+		Flush(); // every chunk CLOSED, also waits for any pending prefetch
+		::prefetcher._bValid = false;
+		::prefetcher._velocity = point2D_t{};
+		getStats(true);
+
+		sPanResult result{};
+		point2D_t position{};
+
+		for (int32_t frame = 0; frame < (FRAMES_PER_LEG << 1); ++frame) {
+
+			position = p2D_add(position, (frame < FRAMES_PER_LEG) ? point2D_t(SPEED, 0) : point2D_t(0, SPEED));
+			rect2D_t const visibleArea(position, p2D_add(position, point2D_t(Iso::SCREEN_VOXELS_X, Iso::SCREEN_VOXELS_Z)));
+
+			PrefetchWait(); // in game the prefetch has the rest of the frame to complete
+
+			tTime const tStart(high_resolution_clock::now());
+			tbb::parallel_for(tbb::blocked_range<int32_t>(visibleArea.top, visibleArea.bottom), [&](tbb::blocked_range<int32_t> const& r) {
+
+				for (int32_t y = r.begin(); y < r.end(); ++y) {
+					for (int32_t x = visibleArea.left; x < visibleArea.right; ++x) {
+						getVoxel(p2D_wrap_pow2(point2D_t(x, y), point2D_t(Iso::WORLD_GRID_WIDTH, Iso::WORLD_GRID_HEIGHT)));
+					}
+				}
+			});
+			result.render += high_resolution_clock::now() - tStart;
+
+			if (bPrefetch) {
+				Prefetch(visibleArea);
+			}
+		}
+		PrefetchWait();
+
+		result.stats = getStats(true);
+		return(result);
+	};
+
+	sPanResult const results[2]{ pan(false), pan(true) };
+
+	::prefetcher._bValid = false; // the next Prefetch() of the game starts a new prediction
+
+	FMT_LOG(VOX_LOG, "pan benchmark: {:d} frames, {:d} voxels/frame, {:d}x{:d} visible voxels", FRAMES_PER_LEG << 1, SPEED, Iso::SCREEN_VOXELS_X, Iso::SCREEN_VOXELS_Z);
+
+	for (uint32_t i = 0; i < 2; ++i) {
+
+		sPanResult const& result(results[i]);
+
+		FMT_LOG(VOX_LOG, "  {:<12s} read {:8.2f} ms   stall {:8.2f} ms   misses {:n}   prefetched {:n}   hits {:n}",
+			(0 == i ? "no prefetch" : "prefetch"), result.render.count() * 1000.0, duration_cast<fp_seconds>(result.stats.stall_duration).count() * 1000.0,
+			result.stats.misses, result.stats.prefetched, result.stats.prefetch_hits);
+	}
+
+	double const stall_without(duration_cast<fp_seconds>(results[0].stats.stall_duration).count()),
+		         stall_with(duration_cast<fp_seconds>(results[1].stats.stall_duration).count());
+
+	if (stall_without > 0.0) {
+		FMT_LOG(VOX_LOG, "  on demand decompression reduced by {:.1f}%", (1.0 - stall_with / stall_without) * 100.0);
+	}
+}
+#endif
+
 static void mi_output_function(const char* msg, void* arg)
 {
 	fmt::print(fg(fmt::color::orange_red), "{:s}", msg);
@@ -493,9 +1691,10 @@ static void mi_output_function(const char* msg, void* arg)
 
 void StreamingGrid::CleanUp()
 {
-	// free context
-	if (::world_grid._context) {
-		density_free_context(::world_grid._context, mi_free); ::world_grid._context = nullptr;
+	PrefetchWait();
+	ReleaseSnapshot();
+	if (::world_grid._chunks) {
+		EnableDirtyTracking(false);
 	}
 
 	// free all chunks
@@ -519,6 +1718,7 @@ void StreamingGrid::CleanUp()
 
 		mi_free_aligned(::world_grid._chunks, CACHE_LINE_BYTES); ::world_grid._chunks = nullptr;
 	}
+	::grid_mapping.source.unmap();
 
 #ifdef DEBUG_OUTPUT_STREAMING_STATS
 	mi_stats_merge();
@@ -24,15 +24,68 @@ class StreamingGrid : no_copy
 {
 public:
 	static constexpr uint32_t const         CHUNK_VOXELS = 64;   // must always be power of 2   16 is 1KB, 64 is 4KB ... uncompressed size (CHUNK_VOXELS * sizeof(Iso::Voxel))  [set 1st] 
+	static constexpr uint32_t const         CHUNK_TILE = 8;      // chunks are square tiles of CHUNK_TILE x CHUNK_TILE voxels, must always be CHUNK_TILE * CHUNK_TILE = CHUNK_VOXELS
 		                                   
+	static constexpr uint32_t const         PREFETCH_LOOKAHEAD_FRAMES = 8; // how far ahead (in frames of current camera velocity) the prefetcher decompresses chunks
+	static constexpr int32_t const          PREFETCH_BORDER = (int32_t)CHUNK_TILE; // always prefetch a one chunk border around the predicted visible area
+
 	static constexpr milliseconds const     GARBAGE_COLLECTION_INTERVAL = milliseconds(100), // garbage collection beat
 		                                    CHUNK_TTL = GARBAGE_COLLECTION_INTERVAL * 5; // time to live, chunk life when no recent access' are made
+	typedef struct sStreamingStats {
+
+		uint64_t  prefetched,        // chunks decompressed by the background prefetcher
+			      prefetch_hits,     // chunks opened by the prefetcher that were later accessed
+			      misses;            // chunks decompressed on demand (stall in the accessing thread)
+		nanoseconds stall_duration;  // total time spent in on demand decompression
+
+	} sStreamingStats;
+
+	static constexpr uint32_t const         DIRTY_VOXELS = (1u << 0u),   // any setVoxel()
+		                                    DIRTY_HEIGHTS = (1u << 1u);  // heightmap writes (Iso::setHeightStep)
+
+	typedef struct sDirtyRegion {
+
+		rect2D_t  area;     // Grid Space (0,0) to (X, Y), chunk tile aligned
+		uint32_t  flags;    // DIRTY_ bits, the same for every tile of the region
+
+	} dirtyRegion;
+
 public:
 	__declspec(safebuffers) Iso::Voxel const __vectorcall getVoxel(point2D_t const voxelIndexWrapped) const;
 	__declspec(safebuffers) void __vectorcall             setVoxel(point2D_t const voxelIndexWrapped, Iso::Voxel const&& oVoxel);
 
+	// dirty regions - the first write to a chunk tile in a frame records the tile, TakeDirtyRegions() (once per frame, writers may run concurrently)
+	// coalesces the recorded tiles into rects and starts the next frame. tracking is off while a world is generated or loaded (everything is dirty then).
+	__declspec(safebuffers) void __vectorcall             MarkDirty(point2D_t const voxelIndexWrapped, uint32_t const flags); // setVoxel() marks DIRTY_VOXELS itself
+	void                                                  TakeDirtyRegions(vector<dirtyRegion>& __restrict regions);
+	void                                                  EnableDirtyTracking(bool const bEnable);
+
 	bool const Initialize();
 	
+	void Prefetch(rect2D_t const visibleArea); // predicts the next visible area from the movement of visibleArea and asynchronously decompresses chunks ahead of the view
+	void PrefetchWait();                        // synchronizes with any pending prefetch
+
+	sStreamingStats const getStats(bool const bReset = false); // hit/miss/stall counters since last reset
+
+	typedef struct sSnapshotStats {
+
+		uint64_t  cloned,            // chunks copied on write since the snapshot
+			      bytes;             // memory held by the preserved chunks
+
+	} sSnapshotStats;
+
+	// copy-on-write snapshot. Snapshot() is O(1), it only starts a new epoch - must be called when there are no concurrent writers (main thread, between frames).
+	// afterwards the first write to a chunk preserves the chunk as it was at the snapshot, SaveChunks() saves the preserved state while the grid keeps changing.
+	uint32_t const Snapshot();                  // also waits for any pending prefetch, SaveChunks() does not
+	void ReleaseSnapshot();                     // frees all preserved chunks, returns to normal (no copy-on-write) operation
+	sSnapshotStats const getSnapshotStats() const;
+
+	uint64_t const HashChunks() const;          // order independent hash of the voxels of every chunk, cached per chunk until the chunk is written (replay state hash)
+
+	bool const SaveChunks(std::wstring const& path); // writes every chunk as an independently compressed record, only chunks dirtied since the last save/load are rewritten (into free slots) if path is the same file. crash safe either way
+	void ResetBaseline();                       // the chunks no longer match the file they were loaded from or last saved to (new world, legacy load), the next save is a full save
+	bool const LoadChunks(std::wstring const& path); // parallel, the file stays mapped - chunks remain compressed in the mapping until first access
+
 	void Flush();
 	__declspec(safebuffers) void GarbageCollect(tTime const tNow, nanoseconds const tDelta, bool const bForce = false); // see notes in cpp for proper usage
 
@@ -41,6 +94,12 @@ public:
 #ifdef DEBUG_OUTPUT_STREAMING_STATS
 	void OutputDebugStats(fp_seconds const& tDelta);
 #endif
+#ifdef DEBUG_BENCHMARK_CHUNK_CODECS
+	void BenchmarkCodecs() const;
+#endif
+#ifdef DEBUG_BENCHMARK_STREAMING_PAN
+	void BenchmarkPan();
+#endif
 
 public:
 	StreamingGrid();
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "globals.h"
 #include "cAIMover.h"
+#include "replay.h"
 #include <Random/superrandom.hpp>
 
 cAIMover::cAIMover() // default 1 / voxel per second & 1 / voxel radians per second **do not change these default values**
@@ -14,8 +15,8 @@ sRoute const __vectorcall cAIMover::getNewRouteDestination(FXMVECTOR const xmLoc
 	point2D_t randomTarget;
 
 	// generate 2D point that fits inside desired area
-	randomTarget.x = PsuedoRandomNumber32(rectArea.left, rectArea.right);
-	randomTarget.y = PsuedoRandomNumber32(rectArea.top, rectArea.bottom);
+	randomTarget.x = replay::RandomNumber32(replay::eStream::WORLD, rectArea.left, rectArea.right);
+	randomTarget.y = replay::RandomNumber32(replay::eStream::WORLD, rectArea.top, rectArea.bottom);
 
 	XMVECTOR const xmNewLocation(p2D_to_v2(randomTarget));
 	// v = d/t
@@ -16,9 +16,11 @@ namespace supernoise
 
 	}
 
-	void cBlueNoise::Load(std::wstring_view const blueNoiseFile)
+	void cBlueNoise::Load(std::wstring_view const blueNoiseFile, bool const bTexture)
 	{
-		MinCity::TextureBoy->LoadKTXTexture(_blueNoiseTextures, blueNoiseFile); // this loads the bluenoise in to the gpu texture. it should be linear (non-srgb) colorspace.
+		if (bTexture) {
+			MinCity::TextureBoy->LoadKTXTexture(_blueNoiseTextures, blueNoiseFile); // this loads the bluenoise in to the gpu texture. it should be linear (non-srgb) colorspace.
+		}
 
 		ImagingMemoryInstance const* imgBlueNoise = ImagingLoadKTX(blueNoiseFile); // this temporarily loads the blue noise into a LA Imaging Instance (linear)
 
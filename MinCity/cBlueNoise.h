@@ -49,7 +49,7 @@ namespace supernoise
 		vku::TextureImage2DArray* const& __restrict		getTexture2DArray() const { return(_blueNoiseTextures); }	// 2D Layered Texture (w/ bluenoise over time) [RG]
 
 		// initialize //
-		void Load(std::wstring_view const blueNoiseFile);
+		void Load(std::wstring_view const blueNoiseFile, bool const bTexture = true); // bTexture = false only loads the cpu side 1D noise
 
 		void Release();
 	private:
@@ -8,6 +8,9 @@
 #include "MinCity.h"
 #include "cTrafficSignGameObject.h"
 #include "eTrafficLightState.h"
+#include "RoadNetwork.h"
+#include "replay.h"
+#include "deferredUpdate.h"
 
 using namespace world;
 
@@ -34,6 +37,10 @@ BETTER_ENUM(eSecondaryColors, uint32_t const,
 
 static constexpr int32_t const CENTER_NODE_OFFSET(Iso::SEGMENT_SIDE_WIDTH + 1);
 
+// indexed by eDirection N, S, E, W
+static constexpr uint32_t const TURN_LEFT[4] = { eDirection::W, eDirection::E, eDirection::N, eDirection::S },
+								TURN_RIGHT[4] = { eDirection::E, eDirection::W, eDirection::S, eDirection::N };
+
 static void OnRelease(void const* const __restrict _this) // private to this file
 {
 	if (_this) {
@@ -45,21 +52,22 @@ cCarGameObject::cCarGameObject(Volumetric::voxelModelInstance_Dynamic* const __r
 	: tUpdateableGameObject(instance_)
 {
 	instance_->setOwnerGameObject<cCarGameObject>(this, &OnRelease);
-	instance_->setVoxelEventFunction(&cCarGameObject::OnVoxel);
+	instance_->setVoxelBatchEventFunction(&cCarGameObject::OnVoxelBatch);
 	_this.tIdleStart = zero_time_point;
 
 	// save car length
 	rect2D_t const localArea(instance_->getModel()._LocalArea);
 	_this.half_length = float(SFM::max(localArea.width(), localArea.height())) * 0.5f;
+	_this.half_width = float(SFM::min(localArea.width(), localArea.height())) * 0.5f;
 
 	// car color selection
-	_this.primary_color = ePrimaryColors::_from_index_unchecked(PsuedoRandomNumber32(0, ePrimaryColors::_size() - 1));
+	_this.primary_color = ePrimaryColors::_from_index_unchecked(replay::RandomNumber32(replay::eStream::CARS, 0, ePrimaryColors::_size() - 1));
 
-	if (PsuedoRandom5050()) {
+	if (replay::Random5050(replay::eStream::CARS)) {
 		_this.secondary_color = _this.primary_color >> 1; // darkened
 	}
 	else {
-		_this.secondary_color = eSecondaryColors::_from_index_unchecked(PsuedoRandomNumber32(0, eSecondaryColors::_size() - 1));
+		_this.secondary_color = eSecondaryColors::_from_index_unchecked(replay::RandomNumber32(replay::eStream::CARS, 0, eSecondaryColors::_size() - 1));
 	}
 }
 
@@ -72,12 +80,12 @@ cCarGameObject::cCarGameObject(cCarGameObject&& src) noexcept
 	// important
 	if (Instance && *Instance) {
 		(*Instance)->setOwnerGameObject<cCarGameObject>(this, &OnRelease);
-		(*Instance)->setVoxelEventFunction(&cCarGameObject::OnVoxel);
+		(*Instance)->setVoxelBatchEventFunction(&cCarGameObject::OnVoxelBatch);
 	}
 	// important
 	if (src.Instance && *src.Instance) {
 		(*src.Instance)->setOwnerGameObject<cCarGameObject>(nullptr, nullptr);
-		(*src.Instance)->setVoxelEventFunction(nullptr);
+		(*src.Instance)->setVoxelBatchEventFunction(nullptr);
 	}
 
 	_this = std::move(src._this);
@@ -92,12 +100,12 @@ cCarGameObject& cCarGameObject::operator=(cCarGameObject&& src) noexcept
 	// important
 	if (Instance && *Instance) {
 		(*Instance)->setOwnerGameObject<cCarGameObject>(this, &OnRelease);
-		(*Instance)->setVoxelEventFunction(&cCarGameObject::OnVoxel);
+		(*Instance)->setVoxelBatchEventFunction(&cCarGameObject::OnVoxelBatch);
 	}
 	// important
 	if (src.Instance && *src.Instance) {
 		(*src.Instance)->setOwnerGameObject<cCarGameObject>(nullptr, nullptr);
-		(*src.Instance)->setVoxelEventFunction(nullptr);
+		(*src.Instance)->setVoxelBatchEventFunction(nullptr);
 	}
 
 	_this = std::move(src._this);
@@ -107,38 +115,47 @@ cCarGameObject& cCarGameObject::operator=(cCarGameObject&& src) noexcept
 }
 
 // If currently visible event:
-VOXEL_EVENT_FUNCTION_RETURN __vectorcall cCarGameObject::OnVoxel(VOXEL_EVENT_FUNCTION_PARAMETERS)
+void __vectorcall cCarGameObject::OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_PARAMETERS)
 {
-	return(reinterpret_cast<cCarGameObject const* const>(_this)->OnVoxel(xmIndex, voxel, vxl_index));
+	reinterpret_cast<cCarGameObject const* const>(_this)->OnVoxelBatch(batch);
 }
 // ***** watchout - thread safety is a concern here this method is executed in parallel ******
-VOXEL_EVENT_FUNCTION_RETURN __vectorcall cCarGameObject::OnVoxel(VOXEL_EVENT_FUNCTION_RESOLVED_PARAMETERS) const
+void __vectorcall cCarGameObject::OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_RESOLVED_PARAMETERS) const
 {
-	Volumetric::voxelModelInstance_Dynamic const* const __restrict instance(getModelInstance());
+	// state is read once per block rather than once per voxel
+	bool const headlight(!(_this.left_signal_on || _this.right_signal_on)),
+			   left_signal(_this.left_signal_on),
+			   right_signal(_this.right_signal_on);
+	uint32_t const taillight(_this.brakes_on ? 0x0000ff : 0x00007f), // bgra (bright red) when braking
+				   primary(_this.primary_color),
+				   secondary(_this.secondary_color);
 
-	switch(voxel.Color)
-	{
-	case MASK_COLOR_HEADLIGHT:
-		voxel.Emissive = !(_this.left_signal_on || _this.right_signal_on);
-		break;
-	case MASK_COLOR_TAILLIGHT:
-		voxel.Color = _this.brakes_on ? 0x0000ff : 0x00007f; // bgra (bright red) when braking
-		break;
-	case MASK_COLOR_LEFTSIGNAL:
-		voxel.Emissive = _this.left_signal_on;
-		break;
-	case MASK_COLOR_RIGHTSIGNAL:
-		voxel.Emissive = _this.right_signal_on;
-		break;
-	case MASK_COLOR_PRIMARY:
-		voxel.Color = _this.primary_color;
-		break;
-	case MASK_COLOR_SECONDARY:
-		voxel.Color = _this.secondary_color;
-		break;
+	for (uint32_t i = 0; i < batch.count; ++i) {
+
+		Volumetric::voxB::voxelDescPacked& __restrict voxel(batch.voxel[i]);
+
+		switch (voxel.Color)
+		{
+		case MASK_COLOR_HEADLIGHT:
+			voxel.Emissive = headlight;
+			break;
+		case MASK_COLOR_TAILLIGHT:
+			voxel.Color = taillight;
+			break;
+		case MASK_COLOR_LEFTSIGNAL:
+			voxel.Emissive = left_signal;
+			break;
+		case MASK_COLOR_RIGHTSIGNAL:
+			voxel.Emissive = right_signal;
+			break;
+		case MASK_COLOR_PRIMARY:
+			voxel.Color = primary;
+			break;
+		case MASK_COLOR_SECONDARY:
+			voxel.Color = secondary;
+			break;
+		}
 	}
-	
-	return(voxel);
 }
 
 namespace world
@@ -269,22 +286,41 @@ bool const __vectorcall cCarGameObject::xing(state const& __restrict currentStat
 			switch (pGameObject->getState())
 			{
 			case eTrafficLightState::GREEN_TURNING_ENABLED:
-				bTurningLeft = PsuedoRandom5050();
+				bTurningLeft = (randomKeyed() >> 31u);
 			case eTrafficLightState::GREEN_TURNING_DISABLED:
-				bTurningRight = PsuedoRandom5050();
+				bTurningRight = (randomKeyed() >> 31u);
 				break;
 			case eTrafficLightState::YELLOW_CLEAR:
 			case eTrafficLightState::RED_STOP:
 			default:
 				return(false); // stop - no longer moving
 			}
+
+			// follow the shared route to the destination instead of turning at random
+			if (_this.has_destination) {
+
+				if (voxelRoadCenterNode.x == _this.destination.x && voxelRoadCenterNode.y == _this.destination.y) { // arrived, pick the next destination
+					_this.has_destination = world::roads::getRandomNode(_this.destination, randomKeyed());
+				}
+				else {
+					uint32_t const routeDirection(world::roads::nextDirection(voxelRoadCenterNode, _this.destination));
+
+					if (world::roads::INVALID_DIRECTION != routeDirection) {
+						bTurningLeft = (eTrafficLightState::GREEN_TURNING_ENABLED == pGameObject->getState()) && (TURN_LEFT[currentState.direction] == routeDirection);
+						bTurningRight = (TURN_RIGHT[currentState.direction] == routeDirection);
+					}
+					else { // unreachable from here, pick another destination
+						_this.has_destination = world::roads::getRandomNode(_this.destination, randomKeyed());
+					}
+				}
+			}
 			
 			// 3way intersection? lane that always turns left? or the lane that can't turn right or the lane that can't turn left?
 			switch (roadNodeType)
 			{
 			case Iso::ROAD_NODE_TYPE::XING_RTL:
 				if (eDirection::S == currentState.direction) { // must turn in this lane
-					if (PsuedoRandom5050()) {
+					if (randomKeyed() >> 31u) {
 						bTurningLeft = true;
 					}
 					else {
@@ -301,7 +337,7 @@ bool const __vectorcall cCarGameObject::xing(state const& __restrict currentStat
 				break;
 			case Iso::ROAD_NODE_TYPE::XING_TLB:
 				if (eDirection::E == currentState.direction) { // must turn in this lane
-					if (PsuedoRandom5050()) {
+					if (randomKeyed() >> 31u) {
 						bTurningLeft = true;
 					}
 					else {
@@ -318,7 +354,7 @@ bool const __vectorcall cCarGameObject::xing(state const& __restrict currentStat
 				break;
 			case Iso::ROAD_NODE_TYPE::XING_LBR:
 				if (eDirection::N == currentState.direction) { // must turn in this lane
-					if (PsuedoRandom5050()) {
+					if (randomKeyed() >> 31u) {
 						bTurningLeft = true;
 					}
 					else {
@@ -335,7 +371,7 @@ bool const __vectorcall cCarGameObject::xing(state const& __restrict currentStat
 				break;
 			case Iso::ROAD_NODE_TYPE::XING_BRT:
 				if (eDirection::W == currentState.direction) { // must turn in this lane
-					if (PsuedoRandom5050()) {
+					if (randomKeyed() >> 31u) {
 						bTurningLeft = true;
 					}
 					else {
@@ -411,7 +447,9 @@ bool const __vectorcall cCarGameObject::xing(state const& __restrict currentStat
 				int32_t const car_half_length(SFM::round_to_i32(_this.half_length));
 				point2D_t const targetOffset(p2D_add(targetState.voxelIndex, p2D_muls(targetState.voxelDirection, car_half_length)));
 				// target offset is the origin of the car offset by half its length in the target direction
-				if (!checkSpace(targetOffset, targetState.voxelDirection, car_half_length, evaluate_car_space)) {
+				// silently fail if the space is off the grid or occupied by a *stopped* car already
+				if (!checkSpace(targetOffset, targetState.voxelDirection, car_half_length, [](Iso::Voxel const&) { return(true); })
+					|| world::movers::overlaps(spaceArea(targetOffset, targetState.voxelDirection, car_half_length), (*Instance)->getHash(), true)) {
 					return(false);
 				}
 			}
@@ -524,16 +562,8 @@ bool const cCarGameObject::forward(state const& __restrict currentState, state&
 		}
 		
 		// cars?
-		{
-			Iso::Voxel const* const pVoxelAhead = world::getVoxelAt(voxelAhead);
-			if (pVoxelAhead) {
-
-				Iso::Voxel const oVoxelAhead(*pVoxelAhead);
-
-				if (world::hasCar(oVoxelAhead, (*Instance)->getHash())) {
-					return(false);  // blocked by car
-				}
-			}
+		if (world::movers::overlaps(rect2D_t(voxelAhead, voxelAhead), (*Instance)->getHash())) {
+			return(false);  // blocked by car
 		}
 
 		bool bFound(false);
@@ -742,18 +772,16 @@ void __vectorcall cCarGameObject::gravity(FXMVECTOR const xmLocation, FXMVECTOR
 bool const __vectorcall cCarGameObject::ccd(FXMVECTOR const xmLocation, FXMVECTOR const xmYaw) const
 {
 	// actual front + 1 (not offset to road center) // ***subtract here works for ccd don't know how - but it works***
-	XMVECTOR const xmAhead(XMVectorSubtract(xmLocation, XMVectorScale(xmYaw, _this.half_length + 1.0f)));
+	XMVECTOR const xmFront(XMVectorSubtract(xmLocation, XMVectorScale(xmYaw, _this.half_length))),
+				   xmAhead(XMVectorSubtract(xmLocation, XMVectorScale(xmYaw, _this.half_length + 1.0f)));
 
-	// only doing check directly infront of car
-	point2D_t const voxelIndexAhead(v2_to_p2D_rounded(xmAhead)); // rounding to catch a collision that is a little more ahead than if this were not rounded as usual.
-	
-    // return current state of voxel car<>car collision
-	return(!world::hasCar(voxelIndexAhead, (*Instance)->getHash()));
+	// only doing check directly infront of car, the voxel wide strip swept from the front to one voxel ahead against the oriented boxes of the other cars
+	return(!world::movers::sweep(xmFront, xmAhead, 0.5f, (*Instance)->getHash()));
 } // returns true on no collision, false on collision
 
 #ifndef NDEBUG
 #ifdef DEBUG_TRAFFIC
-static uint32_t g_cars_errored_out(0);
+static std::atomic_uint32_t g_cars_errored_out(0); // cars update in parallel
 #endif
 #endif
 
@@ -809,6 +837,8 @@ void __vectorcall cCarGameObject::OnUpdate(tTime const& __restrict tNow, fp_seco
 
 			// common //
 			_this.accumulator = accumulator;
+			XMStoreFloat2A(&_this.location, xmNow);
+			XMStoreFloat2A(&_this.axis, xmNowR);
 
 			if (end_of_state) {
 				// make current = target
@@ -937,16 +967,31 @@ void cCarGameObject::setInitialState(state&& initialState)
 
 	_this.moving = false;
 	_this.accumulator = 0.0f;
+	XMStoreFloat2A(&_this.location, p2D_to_v2(_this.currentState.voxelIndex));
+	XMStoreFloat2A(&_this.axis, _this.currentState.vYaw.v2());
+
+	_this.has_destination = world::roads::getRandomNode(_this.destination);
 
 	_speed = MIN_SPEED;
 }
 
+void cCarGameObject::submitMover() const
+{
+	if ((*Instance)->destroyPending())
+		return;
+
+	world::movers::submit(world::movers::mover{ _this.location, _this.axis, _this.half_length, _this.half_width, (*Instance)->getHash(), _this.brakes_on });
+}
+
 // STATIC METHODS : //
 
 void cCarGameObject::UpdateAll(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta)
 {
 #ifndef GIF_MODE
 	
+	world::roads::update(); // apply any road edits to the road network before cars query routes
+	world::movers::rebuild(); // poses submitted last frame (cars & police cars), every car query below is against the hash
+
 	constinit static tTime tLastAttempt(zero_time_point);
 
 	if (tNow - tLastAttempt > milliseconds(CAR_CREATE_INTERVAL)) {
@@ -957,7 +1002,7 @@ void cCarGameObject::UpdateAll(tTime const& __restrict tNow, fp_seconds const& _
 
 		if (size() < maximum_cars) {
 
-			if (PsuedoRandom5050()) {
+			if (replay::Random5050(replay::eStream::CARS)) {
 				CreateCar();
 			}
 		}
@@ -965,16 +1010,15 @@ void cCarGameObject::UpdateAll(tTime const& __restrict tNow, fp_seconds const& _
 		tLastAttempt = tNow;
 	}
 
-	auto it = begin();
-	while (end() != it) {
-	
-		it->OnUpdate(tNow, tDelta);
-		++it;
-	}
+	// parallel, random draws are keyed & instance changes are deferred (world::deferred)
+	world::deferred::update<cCarGameObject>([&](cCarGameObject& car) {
+		car.OnUpdate(tNow, tDelta);
+		car.submitMover();
+	});
 
 #ifndef NDEBUG
 #ifdef DEBUG_TRAFFIC
-	FMT_NUKLEAR_DEBUG(false, "cars active: {:n}  cars errored out: {:n}", size(), g_cars_errored_out);
+	FMT_NUKLEAR_DEBUG(false, "cars active: {:n}  cars errored out: {:n}", size(), g_cars_errored_out.load());
 #endif
 #endif	
 #endif
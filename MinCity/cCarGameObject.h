@@ -3,6 +3,8 @@
 #include "cUpdateableGameObject.h"
 #include <Utility/type_colony.h>
 #include "eDirection.h"
+#include "replay.h"
+#include "moverHash.h"
 #include <Math/biarc_t.h>
 
 // forward decl
@@ -14,6 +16,7 @@ namespace Volumetric
 		class voxelModel;
 
 		struct voxelDescPacked;
+		struct voxelEventBatch;
 	}
 }
 
@@ -92,12 +95,14 @@ namespace world
 
 		void __vectorcall OnUpdate(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta);
 
-		static VOXEL_EVENT_FUNCTION_RETURN __vectorcall OnVoxel(VOXEL_EVENT_FUNCTION_PARAMETERS);
-		VOXEL_EVENT_FUNCTION_RETURN __vectorcall OnVoxel(VOXEL_EVENT_FUNCTION_RESOLVED_PARAMETERS) const;
+		static void __vectorcall OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_PARAMETERS);
+		void __vectorcall OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_RESOLVED_PARAMETERS) const;
 
 		static void UpdateAll(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta);
 	protected:
 		void setInitialState(state&& initialState);
+		void submitMover() const; // pose for the next frame's mover hash (after OnUpdate)
+		uint32_t const randomKeyed() { return(replay::RandomKeyed(replay::eStream::CARS, (*Instance)->getHash() + (_this.draws++ * 0x9e3779b9u))); } // independent of the update order of the cars (parallel update)
 		template<typename T = cCarGameObject>
 		STATIC_INLINE void CreateCar(int32_t carModelIndex = -1);
 	private:
@@ -110,8 +115,8 @@ namespace world
 
 		// special 
 		STATIC_INLINE_PURE bool const evaluate_spawn_space(Iso::Voxel const& __restrict oVoxel);
-		STATIC_INLINE_PURE bool const evaluate_car_space(Iso::Voxel const& __restrict oVoxel);
 
+		STATIC_INLINE_PURE rect2D_t const __vectorcall spaceArea(point2D_t const voxelIndex, point2D_t const voxelDirection, int32_t const car_half_length);
 		template<typename condition_function>
 		STATIC_INLINE_PURE bool const __vectorcall checkSpace(point2D_t const voxelIndex, point2D_t const voxelDirection, int32_t const car_half_length, condition_function const func);
 
@@ -134,9 +139,18 @@ namespace world
 			state			currentState,
 							targetState;
 
+			point2D_t		destination;		// road node center the car is routing to
+			bool			has_destination;
+
 			float			half_length,
+							half_width,
 							accumulator;
 
+			uint32_t		draws;				// keyed random draws made
+
+			XMFLOAT2A		location,			// last pose that passed ccd, submitted to the mover hash
+							axis;
+
 		} _this = {};
 
 		biarc_t				_arcs[2];
@@ -167,31 +181,28 @@ namespace world
 		if (Iso::isRoadNode(oVoxel)) {
 			return(false);
 		}
-		// silently fail if voxel is occupied by a car already
-		if (world::hasCar(oVoxel))
-			return(false);
-
+		// occupancy by other cars is tested separately against the mover hash (spaceArea)
 		return(true);
 	}
-	bool const cCarGameObject::evaluate_car_space(Iso::Voxel const& __restrict oVoxel)
-	{
-		// silently fail if voxel is occupied by a *stopped* car already
-		return(!world::hasStoppedCar(oVoxel));
-	}
 
-	template<typename condition_function>
-	STATIC_INLINE_PURE bool const __vectorcall cCarGameObject::checkSpace(point2D_t const voxelIndex, point2D_t const voxelDirection, int32_t const car_half_length, condition_function const func)
+	rect2D_t const __vectorcall cCarGameObject::spaceArea(point2D_t const voxelIndex, point2D_t const voxelDirection, int32_t const car_half_length)
 	{
 		// voxels to check (forms a straight line)
 		point2D_t const voxelAhead(p2D_add(voxelIndex, p2D_muls(voxelDirection, car_half_length))),
 			voxelBehind(p2D_sub(voxelIndex, p2D_muls(voxelDirection, car_half_length)));
 
+		// ordered so the area is well formed (inclusive)
+		return(rect2D_t(p2D_min(voxelAhead, voxelBehind), p2D_max(voxelAhead, voxelBehind)));
+	}
+
+	template<typename condition_function>
+	STATIC_INLINE_PURE bool const __vectorcall cCarGameObject::checkSpace(point2D_t const voxelIndex, point2D_t const voxelDirection, int32_t const car_half_length, condition_function const func)
+	{
 		// depending on direction, y or x will only iterate once because they are equal (straight line with a width of 1)
 		// the opposite of the y or x index will iterate for the car length +- 1
-
-		// traverse voxels in order correctly for the loop
-		point2D_t const voxelBegin(p2D_min(voxelAhead, voxelBehind)),
-			voxelEnd(p2D_max(voxelAhead, voxelBehind));
+		rect2D_t const area(spaceArea(voxelIndex, voxelDirection, car_half_length));
+		point2D_t const voxelBegin(area.left_top()),
+			voxelEnd(area.right_bottom());
 
 		point2D_t voxelSpace;
 		for (voxelSpace.y = voxelBegin.y; voxelSpace.y <= voxelEnd.y; ++voxelSpace.y) {
@@ -238,7 +249,7 @@ namespace world
 					return; // silently fail if the voxel is marked temporary / pending / constructing
 				}
 				// silently fail if voxel is occupied by a car already
-				if (world::hasCar(oVoxel))
+				if (world::movers::overlaps(rect2D_t(randomRoadEdgeVoxelIndex, randomRoadEdgeVoxelIndex)))
 					return;
 
 				uint32_t carDirection(0);
@@ -247,12 +258,12 @@ namespace world
 				{
 				case Iso::ROAD_DIRECTION::N:
 				case Iso::ROAD_DIRECTION::S:
-					carDirection = PsuedoRandom5050() ? eDirection::N : eDirection::S;
+					carDirection = replay::Random5050(replay::eStream::CARS) ? eDirection::N : eDirection::S;
 					break;
 
 				case Iso::ROAD_DIRECTION::E:
 				case Iso::ROAD_DIRECTION::W:
-					carDirection = PsuedoRandom5050() ? eDirection::E : eDirection::W;
+					carDirection = replay::Random5050(replay::eStream::CARS) ? eDirection::E : eDirection::W;
 					break;
 				}
 
@@ -263,7 +274,7 @@ namespace world
 
 				// randomly pick car model that will be used for instance, if one is not already specified
 				if (carModelIndex < 0) {
-					carModelIndex = PsuedoRandomNumber(1, Volumetric::getVoxelModelCount<Volumetric::eVoxelModels_Dynamic::CARS>() - 1); // **** +1 avoids the Police car being placed as a regular car - it's always the first "index" in cars files.
+					carModelIndex = replay::RandomNumber32(replay::eStream::CARS, 1, Volumetric::getVoxelModelCount<Volumetric::eVoxelModels_Dynamic::CARS>() - 1); // **** +1 avoids the Police car being placed as a regular car - it's always the first "index" in cars files.
 				}
 				auto const* const carModel(Volumetric::getVoxelModel<Volumetric::eVoxelModels_Dynamic::CARS>(carModelIndex));
 				// determine the length of the car
@@ -271,7 +282,8 @@ namespace world
 				float const half_length(float(SFM::max(localArea.width(), localArea.height())) * 0.5f);
 				int32_t const car_half_length(SFM::round_to_i32(half_length) + 1); // rounding so length of car is never short, +1 so its one voxel ahead or behind (below)
 
-				if (checkSpace(initialState.voxelIndex, initialState.voxelDirection, car_half_length, evaluate_spawn_space)) {
+				if (checkSpace(initialState.voxelIndex, initialState.voxelDirection, car_half_length, evaluate_spawn_space)
+					&& !world::movers::overlaps(spaceArea(initialState.voxelIndex, initialState.voxelDirection, car_half_length))) {
 
 					// finally attempt creating instance of model previousky selected at random
 					using flags = Volumetric::eVoxelModelInstanceFlags;
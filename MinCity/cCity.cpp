@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "globals.h"
 #include "cCity.h"
+#include "replay.h"
 #include <Random/superrandom.hpp>
 
 static constexpr fp_seconds const		EPSILON = fp_seconds(fixed_delta_duration);
@@ -16,7 +17,7 @@ cCity::cCity(std::string_view const name)
 
 void cCity::modifyPopulationBy(int32_t delta)
 {
-	fp_seconds const tLife( PsuedoRandomFloat() * MAX_POP_DELTA_LIFE + EPSILON); // always not zero
+	fp_seconds const tLife( replay::RandomFloat(replay::eStream::CITY) * MAX_POP_DELTA_LIFE + EPSILON); // always not zero
 
 	if (delta < 0) {
 		// if the change will put the committed population below zero at some point in time
@@ -36,7 +37,7 @@ void cCity::modifyPopulationBy(int32_t delta)
 }
 void cCity::modifyCashBy(int32_t const delta)
 {
-	fp_seconds const tLife( PsuedoRandomFloat() * MAX_POP_DELTA_LIFE + EPSILON); // always not zero
+	fp_seconds const tLife( replay::RandomFloat(replay::eStream::CITY) * MAX_POP_DELTA_LIFE + EPSILON); // always not zero
 
 	_cash_changes.emplace_back(deltaGrowth(tLife, now(), delta));
 }
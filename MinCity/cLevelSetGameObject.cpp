@@ -19,7 +19,7 @@ namespace world
 		: tProceduralGameObject(instance_, model_)
 	{
 		instance_->setOwnerGameObject<cLevelSetGameObject>(this, &OnRelease);
-		instance_->setVoxelEventFunction(&cLevelSetGameObject::OnVoxel);
+		instance_->setVoxelBatchEventFunction(&cLevelSetGameObject::OnVoxelBatch);
 
 		if (nullptr == _bits) {
 
@@ -35,12 +35,12 @@ namespace world
 		// important
 		if (Validate()) {
 			Instance->setOwnerGameObject<cLevelSetGameObject>(this, &OnRelease);
-			Instance->setVoxelEventFunction(&cLevelSetGameObject::OnVoxel);
+			Instance->setVoxelBatchEventFunction(&cLevelSetGameObject::OnVoxelBatch);
 		}
 		// important
 		if (src.Validate()) {
 			src.Instance->setOwnerGameObject<cLevelSetGameObject>(nullptr, nullptr);
-			src.Instance->setVoxelEventFunction(nullptr);
+			src.Instance->setVoxelBatchEventFunction(nullptr);
 		}
 
 		_bits = std::move(src._bits);
@@ -53,12 +53,12 @@ namespace world
 		// important
 		if (Validate()) {
 			Instance->setOwnerGameObject<cLevelSetGameObject>(this, &OnRelease);
-			Instance->setVoxelEventFunction(&cLevelSetGameObject::OnVoxel);
+			Instance->setVoxelBatchEventFunction(&cLevelSetGameObject::OnVoxelBatch);
 		}
 		// important
 		if (src.Validate()) {
 			src.Instance->setOwnerGameObject<cLevelSetGameObject>(nullptr, nullptr);
-			src.Instance->setVoxelEventFunction(nullptr);
+			src.Instance->setVoxelBatchEventFunction(nullptr);
 		}
 
 		_bits = std::move(src._bits);
@@ -69,47 +69,35 @@ namespace world
 	read_only inline float const _xmInvBounds(1.0f / (float)Volumetric::LEVELSET_MAX_DIMENSIONS_XYZ);
 
 	// If currently visible event:
-	VOXEL_EVENT_FUNCTION_RETURN __vectorcall cLevelSetGameObject::OnVoxel(VOXEL_EVENT_FUNCTION_PARAMETERS)
+	void __vectorcall cLevelSetGameObject::OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_PARAMETERS)
 	{
-		return(reinterpret_cast<cLevelSetGameObject const* const>(_this)->OnVoxel(xmIndex, voxel, vxl_index));
+		reinterpret_cast<cLevelSetGameObject const* const>(_this)->OnVoxelBatch(batch);
 	}
 	// ***** watchout - thread safety is a concern here this method is executed in parallel ******
-	VOXEL_EVENT_FUNCTION_RETURN __vectorcall cLevelSetGameObject::OnVoxel(VOXEL_EVENT_FUNCTION_RESOLVED_PARAMETERS) const
+	void __vectorcall cLevelSetGameObject::OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_RESOLVED_PARAMETERS) const
 	{
-		tTime const tNow(now());
+		for (uint32_t i = 0; i < batch.count; ++i) {
 
-		uvec4_v const localIndex(voxel.x, voxel.y, voxel.z);
-		
-		voxel.setAdjacency(encode_adjacency(localIndex)); // apply adjacency
+			Volumetric::voxB::voxelDescPacked& __restrict voxel(batch.voxel[i]);
 
-		XMVECTOR xmUVW(XMVectorMultiply(localIndex.v4f(), XMVectorReplicate(_xmInvBounds)));
+			uvec4_v const localIndex(voxel.x, voxel.y, voxel.z);
 
-		xmUVW = SFM::__fms(xmUVW, XMVectorReplicate(2.0f), XMVectorReplicate(1.0f));
-		
-		uvec4_t rgba;
-		SFM::saturate_to_u8(XMVectorScale(XMVector3Length(xmUVW), 255.0f), rgba);
-		
-		//bool const odd(((voxel.x & 1) & (voxel.y & 1) & (voxel.z & 1)));
-		//voxel.Color = SFM::pack_rgba(rgba);
-		//voxel.setMetallic(true);
-		//voxel.setRoughness(0.5f);
-		uint32_t const adjacency(voxel.getAdjacency());
-		uint32_t adjacent_count(0);
-		for (uint32_t i = 0; i < 5; ++i) {
-			if (adjacency & (1 << i)) {
-				++adjacent_count;
-			}
-		}
+			uint32_t const adjacency(encode_adjacency(localIndex));
+			voxel.setAdjacency(adjacency); // apply adjacency
 
-		voxel.Hidden = (adjacent_count > 3);
-		voxel.Emissive = !voxel.Hidden && (adjacent_count < 1);
-		voxel.Metallic = true;
-		//voxel.Transparent = true;
-		//voxel.Hidden = !odd;
-		
-		//voxel.Emissive = (voxel.Color & 0xff) > 0xef;
-		
-		return(voxel);
+			//bool const odd(((voxel.x & 1) & (voxel.y & 1) & (voxel.z & 1)));
+			//voxel.setMetallic(true);
+			//voxel.setRoughness(0.5f);
+			uint32_t const adjacent_count(__popcnt(adjacency & 0x1f)); // below, above, back, front, right
+
+			voxel.Hidden = (adjacent_count > 3);
+			voxel.Emissive = !voxel.Hidden && (adjacent_count < 1);
+			voxel.Metallic = true;
+			//voxel.Transparent = true;
+			//voxel.Hidden = !odd;
+
+			//voxel.Emissive = (voxel.Color & 0xff) > 0xef;
+		}
 	}
 
 	/*
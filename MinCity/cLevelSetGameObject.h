@@ -13,6 +13,7 @@ namespace Volumetric
 		class voxelModel;
 
 		struct voxelDescPacked;
+		struct voxelEventBatch;
 	}
 
 	using voxelModel_Dynamic = voxB::voxelModel<true>;
@@ -29,8 +30,8 @@ namespace world
 		constexpr virtual types::game_object_t const to_type() const override {
 			return(types::game_object_t::NonSaveable);
 		}
-		static VOXEL_EVENT_FUNCTION_RETURN __vectorcall OnVoxel(VOXEL_EVENT_FUNCTION_PARAMETERS);
-		VOXEL_EVENT_FUNCTION_RETURN __vectorcall OnVoxel(VOXEL_EVENT_FUNCTION_RESOLVED_PARAMETERS) const;
+		static void __vectorcall OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_PARAMETERS);
+		void __vectorcall OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_RESOLVED_PARAMETERS) const;
 		
 		void OnUpdate(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta);
 
@@ -4,6 +4,7 @@
 #include <Math/point2D_t.h>
 #include "Declarations.h"
 #include "MinCity.h"
+#include "replay.h"
 #include "cTextureBoy.h"
 #include "cVulkan.h"
 #include "Declarations.h"
@@ -1608,7 +1609,9 @@ void cNuklear::do_cyberpunk_mainmenu_window(std::string& __restrict szHint, bool
 								bResetHint = false;
 								bSmallHint = false;
 
-								MinCity::DispatchEvent(eEvent::NEW);
+								if (replay::Event(replay::eInput::EVENT_NEW)) {
+									MinCity::DispatchEvent(eEvent::NEW);
+								}
 								enableWindow<eWindowType::MAIN>(false);
 								nk_window_close(_ctx, subwindowName._to_string());  // hides main window but does not close it in this case 
 								break;
@@ -1898,8 +1901,10 @@ void cNuklear::do_cyberpunk_loadsave_slot(bool const mode, int32_t& __restrict s
 						bResetHint = false;
 						bSmallHint = false;
 
-						MinCity::setCityName(nameCities[selected]);
-						MinCity::DispatchEvent(eEvent::LOAD);
+						if (replay::Event(replay::eInput::EVENT_LOAD, nameCities[selected])) {
+							MinCity::setCityName(nameCities[selected]);
+							MinCity::DispatchEvent(eEvent::LOAD);
+						}
 
 						enableWindow<eWindowType::LOAD>(false);
 						nk_window_close(_ctx, windowName._to_string());
@@ -17,9 +17,98 @@ bool const cPhysics::Initialize()
 	_force_field_direction[STAGING] = force_volume::create();
 	_force_field_direction[COHERENT] = force_volume::create();
 	
+#ifdef DEBUG_BENCHMARK_FORCE_FIELD
+	Benchmark_ForceField();
+#endif
+
 	return(true);
 }
 
+#ifdef DEBUG_BENCHMARK_FORCE_FIELD
+// stress scenario, emitters are spheres of force (like an explosion) at random locations. Reports the cost of staging, clearing and querying the force field.
+void cPhysics::Benchmark_ForceField()
+{
+	static constexpr uint32_t const EMITTER_COUNTS[] = { 0, 10, 1000 },
+									QUERY_COUNT = 1000000;
+	static constexpr int32_t const  EMITTER_RADIUS = 4;
+
+	using dense_volume = bit_volume<force_volume::width(), force_volume::height(), force_volume::depth()>;
+
+	{ // reference, the dense volume clear that was done every frame
+		dense_volume* const dense(dense_volume::create());
+		tTime const tStart(high_resolution_clock::now());
+		dense->clear();
+		FMT_LOG(PERF_LOG, "force field benchmark: dense clear {:d} us", duration_cast<microseconds>(high_resolution_clock::now() - tStart).count());
+		dense_volume::destroy(dense);
+	}
+
+	for (uint32_t const emitter_count : EMITTER_COUNTS) {
+
+		vector<uvec4_t> emitters;
+		for (uint32_t i = 0; i < emitter_count; ++i) {
+			emitters.emplace_back(uvec4_t{ (uint32_t)PsuedoRandomNumber32(EMITTER_RADIUS, force_volume::width() - EMITTER_RADIUS - 1),
+										   (uint32_t)PsuedoRandomNumber32(EMITTER_RADIUS, force_volume::height() - EMITTER_RADIUS - 1),
+										   (uint32_t)PsuedoRandomNumber32(EMITTER_RADIUS, force_volume::depth() - EMITTER_RADIUS - 1), 0 });
+		}
+
+		auto const stage = [&] {
+			tbb::parallel_for(uint32_t(0), emitter_count, [&](uint32_t const i) {
+				uvec4_t const& center(emitters[i]);
+				for (int32_t z = -EMITTER_RADIUS; z <= EMITTER_RADIUS; ++z) {
+					for (int32_t y = -EMITTER_RADIUS; y <= EMITTER_RADIUS; ++y) {
+						for (int32_t x = -EMITTER_RADIUS; x <= EMITTER_RADIUS; ++x) {
+							if (x * x + y * y + z * z <= EMITTER_RADIUS * EMITTER_RADIUS) {
+								_force_field_direction[STAGING]->set_bit(center.x + x, center.y + y, center.z + z);
+							}
+						}
+					}
+				}
+			});
+		};
+
+		fp_seconds tStage{}, tClear{}, tQuery{};
+		size_t forces(0);
+
+		{ // frame 1 becomes coherent
+			tTime const tStart(high_resolution_clock::now());
+			stage();
+			tStage = high_resolution_clock::now() - tStart;
+			std::swap<force_volume* __restrict>(_force_field_direction[COHERENT], _force_field_direction[STAGING]);
+		}
+		uint32_t const active_tiles(_force_field_direction[COHERENT]->active_tiles());
+
+		{ // half of the queries are near emitters, the rest anywhere in the volume
+			tTime const tStart(high_resolution_clock::now());
+			for (uint32_t i = 0; i < QUERY_COUNT; ++i) {
+
+				XMVECTOR xmIndex;
+				if (emitter_count && (i & 1)) {
+					uvec4_t const& center(emitters[i % emitter_count]);
+					xmIndex = XMVectorSet(float(center.x + (i & 7)) - 4.0f, float(center.y), float(center.z + ((i >> 3) & 7)) - 4.0f, 0.0f);
+				}
+				else {
+					xmIndex = XMVectorSet(PsuedoRandomFloat() * float(force_volume::width() - 1), PsuedoRandomFloat() * float(force_volume::height() - 1), PsuedoRandomFloat() * float(force_volume::depth() - 1), 0.0f);
+				}
+				forces += (0.0f != XMVectorGetX(XMVector3LengthSq(get_force(xmIndex))));
+			}
+			tQuery = high_resolution_clock::now() - tStart;
+		}
+
+		{ // frame 2 staged then cleared
+			stage();
+			tTime const tStart(high_resolution_clock::now());
+			_force_field_direction[STAGING]->clear();
+			tClear = high_resolution_clock::now() - tStart;
+		}
+
+		FMT_LOG(PERF_LOG, "{:d} emitters  {:d} tiles  stage {:d} us  clear {:d} us  query {:.1f} ns  ({:d} forces)", emitter_count, active_tiles,
+			duration_cast<microseconds>(tStage).count(), duration_cast<microseconds>(tClear).count(), (tQuery.count() * 1e9) / double(QUERY_COUNT), forces);
+
+		_force_field_direction[COHERENT]->clear();
+	}
+}
+#endif
+
 void cPhysics::AsyncClear()
 {
 	// CURRENT MAIN THREAD //
@@ -69,6 +158,13 @@ XMVECTOR const __vectorcall	cPhysics::get_force(uvec4_v const xmIndex) const
 {
 	XMVECTOR xmForce(XMVectorZero());
 	
+	force_volume const* const __restrict coherent(_force_field_direction[COHERENT]);
+	force_volume const* const __restrict past(_force_field_direction[PAST]);
+
+	[[likely]] if (0 == coherent->active_tiles()) { // no forces this frame
+		return(xmForce);
+	}
+
 	ivec4_t iIndex;
 	ivec4_v(xmIndex).xyzw(iIndex);
 	//BETTER_ENUM(adjacency, uint32_t const,  // matching the same values to voxelModel.h values
@@ -78,48 +174,56 @@ XMVECTOR const __vectorcall	cPhysics::get_force(uvec4_v const xmIndex) const
 	//	back = voxB::BIT_ADJ_BACK,
 	//	above = voxB::BIT_ADJ_ABOVE
 
+	// batched neighbour reads - the neighbours are in the same tile unless the index is on a tile border, so the tiles are only looked up once
+	using tile = force_volume::tile;
+	static constexpr int32_t const TILE_MASK(force_volume::TILE_MASK);
+
+	tile const* const __restrict center_coherent(coherent->get_tile(iIndex.x, iIndex.y, iIndex.z));
+	tile const* const __restrict center_past(past->get_tile(iIndex.x, iIndex.y, iIndex.z));
+
+	auto const read_neighbour = [&](int32_t const x, int32_t const y, int32_t const z, bool const same_tile, uint32_t const adjacency, float& __restrict magnitude) -> uint32_t {
+
+		tile const* const __restrict tile_coherent(same_tile ? center_coherent : coherent->get_tile(x, y, z));
+
+		uint32_t const direction = uint32_t(force_volume::read_bit(tile_coherent, x, y, z)) << adjacency;
+		if (direction) {
+			tile const* const __restrict tile_past(same_tile ? center_past : past->get_tile(x, y, z));
+			magnitude = 1.0f + float(force_volume::read_bit(tile_past, x, y, z));
+		}
+		return(direction);
+	};
+
 	uint32_t adjacent(0);
+	float magnitude(0.0f);
 
 	// force right
 	if (iIndex.x - 1 >= 0) {
-		size_t const index(force_volume::get_index(iIndex.x - 1, iIndex.y, iIndex.z));
-		
-		uint32_t const direction = _force_field_direction[COHERENT]->read_bit(index) << Volumetric::adjacency::left;
+		uint32_t const direction = read_neighbour(iIndex.x - 1, iIndex.y, iIndex.z, 0 != (iIndex.x & TILE_MASK), Volumetric::adjacency::left, magnitude);
 		if (direction) {
-			float const magnitude = 1.0f + float(_force_field_direction[PAST]->read_bit(index));
 			xmForce = XMVectorAdd(xmForce, XMVectorSet(magnitude, 0.0f, 0.0f, 0.0f)); // adjacent to force on the left, outgoing force is left to right.
 			adjacent |= direction;
 		}
 	}
 	// force left
 	if (iIndex.x + 1 < force_volume::width()) {
-		size_t const index(force_volume::get_index(iIndex.x + 1, iIndex.y, iIndex.z));
-		
-		uint32_t const direction = _force_field_direction[COHERENT]->read_bit(index) << Volumetric::adjacency::right;
+		uint32_t const direction = read_neighbour(iIndex.x + 1, iIndex.y, iIndex.z, TILE_MASK != (iIndex.x & TILE_MASK), Volumetric::adjacency::right, magnitude);
 		if (direction) {
-			float const magnitude = 1.0f + float(_force_field_direction[PAST]->read_bit(index));
 			xmForce = XMVectorAdd(xmForce, XMVectorSet(-magnitude, 0.0f, 0.0f, 0.0f)); // adjacent to force on the right, outgoing force is right to left.
 			adjacent |= direction;
 		}
 	}
 	// force forward
 	if (iIndex.z - 1 >= 0) {
-		size_t const index(force_volume::get_index(iIndex.x, iIndex.y, iIndex.z - 1));
-		
-		uint32_t const direction = _force_field_direction[COHERENT]->read_bit(index) << Volumetric::adjacency::front;
+		uint32_t const direction = read_neighbour(iIndex.x, iIndex.y, iIndex.z - 1, 0 != (iIndex.z & TILE_MASK), Volumetric::adjacency::front, magnitude);
 		if (direction) {
-			float const magnitude = 1.0f + float(_force_field_direction[PAST]->read_bit(index));
 			xmForce = XMVectorAdd(xmForce, XMVectorSet(0.0f, 0.0f, magnitude, 0.0f)); // adjacent to force in front, outgoing force is front to back.
 			adjacent |= direction;
 		}
 	}
 	// force backward
 	if (iIndex.z + 1 < force_volume::depth()) {
-		size_t const index(force_volume::get_index(iIndex.x, iIndex.y, iIndex.z + 1));
-		
-		uint32_t const direction = _force_field_direction[COHERENT]->read_bit(index) << Volumetric::adjacency::back;
+		uint32_t const direction = read_neighbour(iIndex.x, iIndex.y, iIndex.z + 1, TILE_MASK != (iIndex.z & TILE_MASK), Volumetric::adjacency::back, magnitude);
 		if (direction) {
-			float const magnitude = 1.0f + float(_force_field_direction[PAST]->read_bit(index));
 			xmForce = XMVectorAdd(xmForce, XMVectorSet(0.0f, 0.0f, -magnitude, 0.0f)); // adjacent to force in back, outgoing force is back to front.
 			adjacent |= direction;
 		}
@@ -132,11 +236,8 @@ XMVECTOR const __vectorcall	cPhysics::get_force(uvec4_v const xmIndex) const
 
 	// force downwards
 	if (iIndex.y + 1 < force_volume::height()) {
-		size_t const index(force_volume::get_index(iIndex.x, iIndex.y + 1, iIndex.z));
-		
-		uint32_t const direction = _force_field_direction[COHERENT]->read_bit(index) << Volumetric::adjacency::above;
+		uint32_t const direction = read_neighbour(iIndex.x, iIndex.y + 1, iIndex.z, TILE_MASK != (iIndex.y & TILE_MASK), Volumetric::adjacency::above, magnitude);
 		if (direction) {
-			float const magnitude = 1.0f + float(_force_field_direction[PAST]->read_bit(index));
 			xmForce = XMVectorAdd(xmForce, XMVectorSet(0.0f, -magnitude, 0.0f, 0.0f)); // adjacent to force above, outgoing force is above to below.
 			adjacent |= direction;
 		}
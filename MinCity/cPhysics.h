@@ -3,6 +3,149 @@
 #include "voxelAlloc.h"
 #include <Utility/bit_volume.h>
 
+// sparse bit volume, allocated in tiles of 8x8x8 bits (one cache line) only where bits are set.
+// clearing only touches the tiles that were allocated, so memory & clear cost scale with the number of active force emitters rather than the volume size.
+template<uint32_t const Width, uint32_t const Height, uint32_t const Depth>
+class no_vtable sparse_bit_volume : no_copy
+{
+public:
+	static constexpr uint32_t const
+		TILE_BITS = 3,
+		TILE_SIZE = (1u << TILE_BITS),
+		TILE_MASK = TILE_SIZE - 1u,
+		TILES_X = Width >> TILE_BITS, TILES_Y = Height >> TILE_BITS, TILES_Z = Depth >> TILE_BITS,
+		TILE_COUNT = TILES_X * TILES_Y * TILES_Z,
+		CHUNK_BITS = 12,					// tiles are pooled in chunks of 4096 tiles (256 KB), chunks are only allocated when needed and kept for reuse
+		CHUNK_SIZE = (1u << CHUNK_BITS),
+		CHUNK_COUNT = (TILE_COUNT + CHUNK_SIZE - 1u) >> CHUNK_BITS;
+
+	static_assert(0 == (Width & TILE_MASK) && 0 == (Height & TILE_MASK) && 0 == (Depth & TILE_MASK), "sparse_bit_volume dimensions must be a multiple of the tile size");
+
+	typedef struct alignas(CACHE_LINE_BYTES) tile
+	{
+		uint64_t bits[TILE_SIZE];	// one z slice of 8x8 (x,y) bits per word
+	} tile;
+
+	static constexpr int32_t const width() { return(Width); }
+	static constexpr int32_t const height() { return(Height); }
+	static constexpr int32_t const depth() { return(Depth); }
+
+	static constexpr uint32_t const get_tile_index(uint32_t const x, uint32_t const y, uint32_t const z) {
+		return(((z >> TILE_BITS) * TILES_Y + (y >> TILE_BITS)) * TILES_X + (x >> TILE_BITS));
+	}
+	static constexpr uint32_t const get_bit_index(uint32_t const x, uint32_t const y, uint32_t const z) { // within tile
+		return(((z & TILE_MASK) << (TILE_BITS << 1u)) | ((y & TILE_MASK) << TILE_BITS) | (x & TILE_MASK));
+	}
+
+	uint32_t const active_tiles() const { return(SFM::min(_count, CHUNK_COUNT * CHUNK_SIZE)); }
+
+	// nullptr if no bits are set in the tile containing x,y,z
+	tile const* const __restrict get_tile(uint32_t const x, uint32_t const y, uint32_t const z) const {
+		uint32_t const slot(_directory[get_tile_index(x, y, z)]);
+		return(slot ? &_chunks[(slot - 1u) >> CHUNK_BITS]->tiles[(slot - 1u) & (CHUNK_SIZE - 1u)] : nullptr);
+	}
+
+	static bool const read_bit(tile const* const __restrict pTile, uint32_t const x, uint32_t const y, uint32_t const z) {
+		uint32_t const bit(get_bit_index(x, y, z));
+		return(pTile && (pTile->bits[bit >> 6u] & (1ull << (bit & 63u))));
+	}
+	bool const read_bit(uint32_t const x, uint32_t const y, uint32_t const z) const {
+		return(read_bit(get_tile(x, y, z), x, y, z));
+	}
+
+	// thread safe
+	void set_bit(uint32_t const x, uint32_t const y, uint32_t const z) {
+
+		uint32_t const tile_index(get_tile_index(x, y, z));
+
+		uint32_t slot(std::atomic_ref<uint32_t>(_directory[tile_index]).load(std::memory_order_acquire));
+		[[unlikely]] if (0 == slot) {
+			slot = allocate(tile_index);
+			[[unlikely]] if (0 == slot)
+				return; // pool exhausted, force dropped
+		}
+
+		uint32_t const bit(get_bit_index(x, y, z));
+		std::atomic_ref<uint64_t>(_chunks[(slot - 1u) >> CHUNK_BITS]->tiles[(slot - 1u) & (CHUNK_SIZE - 1u)].bits[bit >> 6u]).fetch_or(1ull << (bit & 63u), std::memory_order_relaxed);
+	}
+
+	// only the allocated tiles are cleared & released back to the pool
+	void clear() {
+
+		uint32_t const count(active_tiles());
+
+		for (uint32_t chunk_index = 0; (chunk_index << CHUNK_BITS) < count; ++chunk_index) {
+
+			chunk* const __restrict pChunk(_chunks[chunk_index]);
+			uint32_t const used(SFM::min(count - (chunk_index << CHUNK_BITS), CHUNK_SIZE));
+
+			for (uint32_t i = 0; i < used; ++i) {
+				_directory[pChunk->keys[i]] = 0;
+			}
+			memset(pChunk->tiles, 0, used * sizeof(tile));
+		}
+
+		_count = 0;
+	}
+
+	static sparse_bit_volume* const __restrict create() {
+		sparse_bit_volume* const __restrict volume((sparse_bit_volume * __restrict)scalable_aligned_malloc(sizeof(sparse_bit_volume), CACHE_LINE_BYTES));
+		memset(volume, 0, sizeof(sparse_bit_volume));
+		return(volume);
+	}
+	static void destroy(sparse_bit_volume* const __restrict volume) {
+		if (volume) {
+			for (uint32_t i = 0; i < CHUNK_COUNT; ++i) {
+				if (volume->_chunks[i]) {
+					scalable_aligned_free(volume->_chunks[i]); volume->_chunks[i] = nullptr;
+				}
+			}
+			scalable_aligned_free(volume);
+		}
+	}
+
+private:
+	typedef struct chunk
+	{
+		tile		tiles[CHUNK_SIZE];
+		uint32_t	keys[CHUNK_SIZE];	// tile index of each allocated tile, used by clear()
+	} chunk;
+
+	__declspec(noinline) uint32_t const allocate(uint32_t const tile_index) {
+
+		uint32_t const index(std::atomic_ref<uint32_t>(_count).fetch_add(1u, std::memory_order_relaxed));
+		if (index >= CHUNK_COUNT * CHUNK_SIZE)
+			return(0);
+
+		chunk*& __restrict pChunkRef(_chunks[index >> CHUNK_BITS]);
+		chunk* pChunk(std::atomic_ref<chunk*>(pChunkRef).load(std::memory_order_acquire));
+		if (nullptr == pChunk) {
+
+			chunk* const pNewChunk((chunk*)scalable_aligned_malloc(sizeof(chunk), CACHE_LINE_BYTES));
+			memset(pNewChunk, 0, sizeof(chunk));
+
+			if (std::atomic_ref<chunk*>(pChunkRef).compare_exchange_strong(pChunk, pNewChunk, std::memory_order_acq_rel)) {
+				pChunk = pNewChunk;
+			}
+			else { // another thread allocated the chunk first
+				scalable_aligned_free(pNewChunk);
+			}
+		}
+		pChunk->keys[index & (CHUNK_SIZE - 1u)] = tile_index;
+
+		uint32_t slot(0);
+		if (std::atomic_ref<uint32_t>(_directory[tile_index]).compare_exchange_strong(slot, index + 1u, std::memory_order_acq_rel)) {
+			return(index + 1u);
+		}
+		return(slot); // another thread allocated the same tile first, the tile at index stays empty and is released on the next clear()
+	}
+
+private:
+	uint32_t	_count;						// allocated tiles
+	chunk*		_chunks[CHUNK_COUNT];
+	uint32_t	_directory[TILE_COUNT];		// tile index -> allocated slot + 1, 0 = empty
+};
+
 class no_vtable cPhysics : no_copy
 {
 	static constexpr float const GRAVITY_NONE = -0.000001f;
@@ -27,7 +170,7 @@ private:
 	static constexpr uint32_t COHERENT = 1,
 							  STAGING = 0;
 	
-	using force_volume = bit_volume<Volumetric::Allocation::VOXEL_MINIGRID_VISIBLE_X, Volumetric::Allocation::VOXEL_MINIGRID_VISIBLE_Y, Volumetric::Allocation::VOXEL_MINIGRID_VISIBLE_Z>;	// 16 MB
+	using force_volume = sparse_bit_volume<Volumetric::Allocation::VOXEL_MINIGRID_VISIBLE_X, Volumetric::Allocation::VOXEL_MINIGRID_VISIBLE_Y, Volumetric::Allocation::VOXEL_MINIGRID_VISIBLE_Z>;	// 1 MB directory + 256 KB / 4096 active tiles
 public:
 	XMVECTOR const __vectorcall		get_force(FXMVECTOR xmIndex) const { return(get_force(SFM::floor_to_u32(xmIndex))); }
 
@@ -40,16 +183,17 @@ private:
 		uvec4_t local;
 		xmIndex.xyzw(local);
 
-		size_t const index(force_volume::get_index(local.x, local.y, local.z));
-
-		_force_field_direction[STAGING]->set_bit(index);
+		_force_field_direction[STAGING]->set_bit(local.x, local.y, local.z);
 	}
 public:
 	bool const Initialize();
 	void AsyncClear();
 	void Update(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta);
+#ifdef DEBUG_BENCHMARK_FORCE_FIELD
+	void Benchmark_ForceField();
+#endif
 private:
-	force_volume* __restrict _force_field_direction[2]; // 16.7MB each
+	force_volume* __restrict _force_field_direction[2];
 
 	int64_t					 _AsyncClearTaskID;
 public:
@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "eDirection.h"
 #include "cPoliceCarGameObject.h"
+#include "replay.h"
+#include "deferredUpdate.h"
 
 using namespace world;
 
@@ -25,7 +27,7 @@ cPoliceCarGameObject::cPoliceCarGameObject(Volumetric::voxelModelInstance_Dynami
 	: cCarGameObject(instance_)
 {
 	instance_->setOwnerGameObject<cPoliceCarGameObject>(this, &OnRelease);
-	instance_->setVoxelEventFunction(&cPoliceCarGameObject::OnVoxel);
+	instance_->setVoxelBatchEventFunction(&cPoliceCarGameObject::OnVoxelBatch);
 
 }
 
@@ -38,12 +40,12 @@ cPoliceCarGameObject::cPoliceCarGameObject(cPoliceCarGameObject&& src) noexcept
 	// important
 	if (Instance && *Instance) {
 		(*Instance)->setOwnerGameObject<cPoliceCarGameObject>(this, &OnRelease);
-		(*Instance)->setVoxelEventFunction(&cPoliceCarGameObject::OnVoxel);
+		(*Instance)->setVoxelBatchEventFunction(&cPoliceCarGameObject::OnVoxelBatch);
 	}
 	// important
 	if (src.Instance && *src.Instance) {
 		(*src.Instance)->setOwnerGameObject<cPoliceCarGameObject>(nullptr, nullptr);
-		(*src.Instance)->setVoxelEventFunction(nullptr);
+		(*src.Instance)->setVoxelBatchEventFunction(nullptr);
 	}
 
 	_this = std::move(src._this);
@@ -57,12 +59,12 @@ cPoliceCarGameObject& cPoliceCarGameObject::operator=(cPoliceCarGameObject&& src
 	// important
 	if (Instance && *Instance) {
 		(*Instance)->setOwnerGameObject<cPoliceCarGameObject>(this, &OnRelease);
-		(*Instance)->setVoxelEventFunction(&cPoliceCarGameObject::OnVoxel);
+		(*Instance)->setVoxelBatchEventFunction(&cPoliceCarGameObject::OnVoxelBatch);
 	}
 	// important
 	if (src.Instance && *src.Instance) {
 		(*src.Instance)->setOwnerGameObject<cPoliceCarGameObject>(nullptr, nullptr);
-		(*src.Instance)->setVoxelEventFunction(nullptr);
+		(*src.Instance)->setVoxelBatchEventFunction(nullptr);
 	}
 
 	_this = std::move(src._this);
@@ -71,32 +73,41 @@ cPoliceCarGameObject& cPoliceCarGameObject::operator=(cPoliceCarGameObject&& src
 }
 
 // If currently visible event:
-VOXEL_EVENT_FUNCTION_RETURN __vectorcall cPoliceCarGameObject::OnVoxel(VOXEL_EVENT_FUNCTION_PARAMETERS)
+void __vectorcall cPoliceCarGameObject::OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_PARAMETERS)
 {
-	return(reinterpret_cast<cPoliceCarGameObject const* const>(_this)->OnVoxel(xmIndex, voxel, vxl_index));
+	reinterpret_cast<cPoliceCarGameObject const* const>(_this)->OnVoxelBatch(batch);
 }
 // ***** watchout - thread safety is a concern here this method is executed in parallel ******
-VOXEL_EVENT_FUNCTION_RETURN __vectorcall cPoliceCarGameObject::OnVoxel(VOXEL_EVENT_FUNCTION_RESOLVED_PARAMETERS) const
+void __vectorcall cPoliceCarGameObject::OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_RESOLVED_PARAMETERS) const
 {
-	cCarGameObject::OnVoxel(xmIndex, voxel, vxl_index);
-
 	if (_this.bLightsOn) {
 
-		if (MASK_COLOR_BLUE == voxel.Color) {
-			voxel.Color = _this.colorBlueLight;
-		}
-		else if (MASK_COLOR_RED == voxel.Color) {
-			voxel.Color = _this.colorRedLight;
+		uint32_t const blue(_this.colorBlueLight),
+					   red(_this.colorRedLight);
+
+		for (uint32_t i = 0; i < batch.count; ++i) {
+
+			Volumetric::voxB::voxelDescPacked& __restrict voxel(batch.voxel[i]);
+
+			if (MASK_COLOR_BLUE == voxel.Color) {
+				voxel.Color = blue;
+			}
+			else if (MASK_COLOR_RED == voxel.Color) {
+				voxel.Color = red;
+			}
 		}
 	}
 	else {
-		if (MASK_COLOR_BLUE == voxel.Color || MASK_COLOR_RED == voxel.Color) {
-			voxel.Color = 0x00000000; // lights off
-			voxel.Emissive = false;
+		for (uint32_t i = 0; i < batch.count; ++i) {
+
+			Volumetric::voxB::voxelDescPacked& __restrict voxel(batch.voxel[i]);
+
+			if (MASK_COLOR_BLUE == voxel.Color || MASK_COLOR_RED == voxel.Color) {
+				voxel.Color = 0x00000000; // lights off
+				voxel.Emissive = false;
+			}
 		}
 	}
-
-	return(voxel);
 }
 
 void __vectorcall cPoliceCarGameObject::OnUpdate(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta)
@@ -107,7 +118,7 @@ void __vectorcall cPoliceCarGameObject::OnUpdate(tTime const& __restrict tNow, f
 
 		_this.checked_last = tNow;
 
-		bool const next_pursuit = PsuedoRandomNumber(0, 100) < PURSUIT_CHANCE;
+		bool const next_pursuit = int32_t((uint64_t(randomKeyed()) * 101ull) >> 32ull) < PURSUIT_CHANCE; // [0, 100], same mapping as replay::RandomNumber32
 
 		if (!isStopped() && next_pursuit) { // only start new pursuit if car is moving
 			_speed = PURSUIT_SPEED;
@@ -189,12 +200,10 @@ void cPoliceCarGameObject::UpdateAll(tTime const& __restrict tNow, fp_seconds co
 		}
 	}
 
-	auto it = begin();
-	while (end() != it) {
-
-		it->OnUpdate(tNow, tDelta);
-		++it;
-	}
+	world::deferred::update<cPoliceCarGameObject>([&](cPoliceCarGameObject& car) {
+		car.OnUpdate(tNow, tDelta);
+		car.submitMover();
+	});
 #endif
 }
 
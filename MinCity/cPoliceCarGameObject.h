@@ -40,8 +40,8 @@ namespace world
 
 		void __vectorcall OnUpdate(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta);
 
-		static VOXEL_EVENT_FUNCTION_RETURN __vectorcall OnVoxel(VOXEL_EVENT_FUNCTION_PARAMETERS);
-		VOXEL_EVENT_FUNCTION_RETURN __vectorcall OnVoxel(VOXEL_EVENT_FUNCTION_RESOLVED_PARAMETERS) const;
+		static void __vectorcall OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_PARAMETERS);
+		void __vectorcall OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_RESOLVED_PARAMETERS) const;
 
 		static void UpdateAll(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta);
 	protected:
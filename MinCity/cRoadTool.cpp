@@ -8,6 +8,7 @@
 #include "cTrafficSignGameObject.h"
 #include "cTrafficControlGameObject.h"
 #include "prices.h"
+#include "RoadNetwork.h"
 
 #include "cNuklear.h"
 #include "gui.h"
@@ -28,7 +29,14 @@ cRoadTool::cRoadTool()
 	_seed_traffic_sign(PsuedoRandomNumber64()),
 	_seed_signage(PsuedoRandomNumber64())
 {
+#ifdef DEBUG_BENCHMARK_ROUTE_QUERY
+	world::roads::benchmark();
+#endif
+}
 
+cRoadTool::~cRoadTool()
+{
+	world::roads::CleanUp();
 }
 
 STATIC_INLINE_PURE point2D_t const getHoveredVoxelIndexSnapped() // bloody-hell
@@ -165,10 +173,14 @@ void __vectorcall cRoadTool::ReleaseAction(FXMVECTOR const xmMousePos)
 
 void cRoadTool::commitRoadHistory() // commits current "road" to grid
 {
+	point2D_t voxelMin(INT32_MAX), voxelMax(INT32_MIN);
+
 	// using history (only voxel indices) to acquire the voxel from the grid, unset the pending bit, then update the voxel in the grid
 	for (vector<sUndoVoxel>::const_iterator commitVoxel = getHistory().cbegin(); commitVoxel != getHistory().cend(); ++commitVoxel)
 	{
 		point2D_t const voxelIndex(commitVoxel->voxelIndex);
+		voxelMin = p2D_min(voxelMin, voxelIndex);
+		voxelMax = p2D_max(voxelMax, voxelIndex);
 		Iso::Voxel const* const pVoxel = world::getVoxelAt(voxelIndex);
 		if (pVoxel) {
 
@@ -185,6 +197,11 @@ void cRoadTool::commitRoadHistory() // commits current "road" to grid
 		MinCity::VoxelWorld->destroyVoxelModelInstance(destroyInstance->hash); // doesn't need to be immediate
 	}
 	
+	// only the committed area of the road network needs rebuilding
+	if (!getHistory().empty()) {
+		world::roads::invalidate(rect2D_t(voxelMin, p2D_adds(voxelMax, 1)));
+	}
+
 	// clear all history, all changes to grid committed
 	_undoExistingSignage.clear();
 	_undoSignage.clear();
@@ -53,7 +53,7 @@ private:
 						_seed_signage;
 public:
 	cRoadTool();
-	virtual ~cRoadTool() = default;
+	virtual ~cRoadTool();
 };
 
 
@@ -17,7 +17,7 @@ namespace world
 		: tNonUpdateableGameObject(instance_), _videoscreen(nullptr)
 	{
 		instance_->setOwnerGameObject<cSignageGameObject>(this, &OnRelease);
-		instance_->setVoxelEventFunction(&cSignageGameObject::OnVoxel);
+		instance_->setVoxelBatchEventFunction(&cSignageGameObject::OnVoxelBatch);
 
 		Volumetric::voxB::voxelScreen const* const voxelscreen(instance_->getModel()._Features.videoscreen);
 		if (nullptr != voxelscreen) {									// this copy is small, the local copy provides better locality of reference
@@ -34,12 +34,12 @@ namespace world
 		// important
 		if (Instance && *Instance) {
 			(*Instance)->setOwnerGameObject<cSignageGameObject>(this, &OnRelease);
-			(*Instance)->setVoxelEventFunction(&cSignageGameObject::OnVoxel);
+			(*Instance)->setVoxelBatchEventFunction(&cSignageGameObject::OnVoxelBatch);
 		}
 		// important
 		if (src.Instance && *src.Instance) {
 			(*src.Instance)->setOwnerGameObject<cSignageGameObject>(nullptr, nullptr);
-			(*src.Instance)->setVoxelEventFunction(nullptr);
+			(*src.Instance)->setVoxelBatchEventFunction(nullptr);
 		}
 
 		_videoscreen = std::move(src._videoscreen); src._videoscreen = nullptr;
@@ -53,12 +53,12 @@ namespace world
 		// important
 		if (Instance && *Instance) {
 			(*Instance)->setOwnerGameObject<cSignageGameObject>(this, &OnRelease);
-			(*Instance)->setVoxelEventFunction(&cSignageGameObject::OnVoxel);
+			(*Instance)->setVoxelBatchEventFunction(&cSignageGameObject::OnVoxelBatch);
 		}
 		// important
 		if (src.Instance && *src.Instance) {
 			(*src.Instance)->setOwnerGameObject<cSignageGameObject>(nullptr, nullptr);
-			(*src.Instance)->setVoxelEventFunction(nullptr);
+			(*src.Instance)->setVoxelBatchEventFunction(nullptr);
 		}
 
 		_videoscreen = std::move(src._videoscreen); src._videoscreen = nullptr;
@@ -67,33 +67,37 @@ namespace world
 	}
 
 	// If currently visible event:
-	VOXEL_EVENT_FUNCTION_RETURN __vectorcall cSignageGameObject::OnVoxel(VOXEL_EVENT_FUNCTION_PARAMETERS)
+	void __vectorcall cSignageGameObject::OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_PARAMETERS)
 	{
-		return(reinterpret_cast<cSignageGameObject const* const>(_this)->OnVoxel(xmIndex, voxel, vxl_index));
+		reinterpret_cast<cSignageGameObject const* const>(_this)->OnVoxelBatch(batch);
 	}
 	// ***** watchout - thread safety is a concern here this method is executed in parallel ******
-	VOXEL_EVENT_FUNCTION_RETURN __vectorcall cSignageGameObject::OnVoxel(VOXEL_EVENT_FUNCTION_RESOLVED_PARAMETERS) const
+	void __vectorcall cSignageGameObject::OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_RESOLVED_PARAMETERS) const
 	{
-		Volumetric::voxelModelInstance_Dynamic const* const __restrict instance(getModelInstance());
+		if (nullptr == _videoscreen) // signage without a videoscreen has nothing to change, the whole block is skipped
+			return;
 
-		tTime const tNow(now());
+		bool alive(false);
 
-		// alive !
-		if (voxel.Video && nullptr != _videoscreen) {
+		for (uint32_t i = 0; i < batch.count; ++i) {
 
-			_videoscreen->setAllowedObtainNewSequences(true);
+			Volumetric::voxB::voxelDescPacked& __restrict voxel(batch.voxel[i]);
 
-			voxel.Color = _videoscreen->getPixelColor(voxel.getPosition()) & 0x00FFFFFF; // no alpha
+			// alive !
+			if (voxel.Video) {
 
-			// if video color is pure black turn off emission
-			voxel.Emissive = !(0 == voxel.Color);
+				voxel.Color = _videoscreen->getPixelColor(voxel.getPosition()) & 0x00FFFFFF; // no alpha
 
-			//voxel.Alpha = Volumetric::eVoxelTransparency::ALPHA_75;
-			//voxelState.Transparent = true;
+				// if video color is pure black turn off emission
+				voxel.Emissive = !(0 == voxel.Color);
 
+				alive = true;
+			}
 		}
 
-		return(voxel);
+		if (alive) {
+			_videoscreen->setAllowedObtainNewSequences(true);
+		}
 	}
 
 
@@ -13,6 +13,7 @@ namespace Volumetric
 		class voxelModel;
 
 		struct voxelDescPacked;
+		struct voxelEventBatch;
 	}
 }
 
@@ -28,8 +29,8 @@ namespace world
 		}
 		// ALL derivatives of this class must call base function first in overriden methods, and check its return value
 		// typedef Volumetric::voxB::voxelState const(* const voxel_event_function)(void* const _this, Volumetric::voxB::voxelState const& __restrict rOriginalVoxelState);
-		static VOXEL_EVENT_FUNCTION_RETURN __vectorcall OnVoxel(VOXEL_EVENT_FUNCTION_PARAMETERS);
-		VOXEL_EVENT_FUNCTION_RETURN __vectorcall OnVoxel(VOXEL_EVENT_FUNCTION_RESOLVED_PARAMETERS) const;
+		static void __vectorcall OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_PARAMETERS);
+		void __vectorcall OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_RESOLVED_PARAMETERS) const;
 
 	public:
 		cSignageGameObject(cSignageGameObject&& src) noexcept;
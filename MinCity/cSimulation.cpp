@@ -2,6 +2,7 @@
 #include "globals.h"
 #include "cSimulation.h"
 #include <Random/superrandom.hpp>
+#include "replay.h"
 #include <Math/vec4_t.h>
 #include "eVoxelModels.h"
 #include "world.h"
@@ -41,7 +42,7 @@ cSimulation::cSimulation()
 		_plot_sizes.emplace_back(i);
 	}
 
-	random_shuffle(_plot_sizes.begin(), _plot_sizes.end());
+	std::shuffle(_plot_sizes.begin(), _plot_sizes.end(), replay::stream_engine{ replay::eStream::ZONING });
 
  	_current_packing.plot_size = _plot_sizes[_plot_size_index];
 
@@ -54,7 +55,7 @@ cSimulation::cSimulation()
 			_patches.emplace_back(uv, p2D_adds(uv, packing::PATCH_SIZE));
 		}
 	}
-	random_shuffle(_patches.begin(), _patches.end());
+	std::shuffle(_patches.begin(), _patches.end(), replay::stream_engine{ replay::eStream::SIMULATION });
 
 	// new properties for patches
 	_patch_properties.reserve(packing::PATCH_COUNT);
@@ -87,7 +88,7 @@ static Volumetric::voxB::voxelModel<Volumetric::voxB::STATIC> const* const __vec
 	}
 
 	if (!models.empty()) {
-		return(models[PsuedoRandomNumber32(0, ((int32_t)models.size()) - 1)]);
+		return(models[replay::RandomNumber32(replay::eStream::ZONING, 0, ((int32_t)models.size()) - 1)]);
 	}
 
 	return(nullptr);
@@ -185,7 +186,7 @@ bool const __vectorcall cSimulation::generate_zoning(rect2D_t const simArea, Iso
 	// demand influenced random numbers
 	uvec4_v const uvMinimum(SFM::floor_to_u32(XMVectorScale(XMLoadFloat3A(&_properties.demand), MAXIMUM_RANGE_SCALE))); 
 
-	uvec4_v const uvRandom(PsuedoRandomNumber32(), PsuedoRandomNumber32(), PsuedoRandomNumber32());
+	uvec4_v const uvRandom(replay::RandomNumber32(replay::eStream::ZONING), replay::RandomNumber32(replay::eStream::ZONING), replay::RandomNumber32(replay::eStream::ZONING));
 
 	uint32_t const masked(uvec4_v::result<3>(uvRandom < uvMinimum));
 
@@ -240,7 +241,7 @@ bool const __vectorcall cSimulation::generate_zoning(rect2D_t const simArea, Iso
 		if (pending_min != pending_max) {
 
 			// randomly select
-			active = (PsuedoRandom5050() ? pending_min : pending_max);
+			active = (replay::Random5050(replay::eStream::ZONING) ? pending_min : pending_max);
 		}
 		else {
 			active = pending_min;
@@ -253,7 +254,7 @@ bool const __vectorcall cSimulation::generate_zoning(rect2D_t const simArea, Iso
 		// the entire map. larger plot sizes are rarer than small plot sizes.
 		if (_plot_sizes.size() == ++_plot_size_index) {
 			_plot_size_index = 0;
-			random_shuffle(_plot_sizes.begin(), _plot_sizes.end());
+			std::shuffle(_plot_sizes.begin(), _plot_sizes.end(), replay::stream_engine{ replay::eStream::ZONING });
 		}
 		_current_packing.plot_size = _plot_sizes[_plot_size_index]; // update currently used plot size
 
@@ -379,12 +380,13 @@ STATIC_INLINE_PURE result const __vectorcall require_building_adjacent_to_road(I
 
 STATIC_INLINE_PURE result const __vectorcall test_adjacent_building_adjacent_to_road(rect2D_t const perimeter)
 {
+	uint32_t const perimeter_key(uint32_t(perimeter.left) ^ (uint32_t(perimeter.top) << 16));
 	point2D_t voxelIndex[2];
 
 	{ // top -- bottom
 
-		// setup
-		uint32_t const start = (uint32_t const)PsuedoRandom5050();
+		// setup - called from parallel candidates, keyed so the result does not depend on scheduling
+		uint32_t const start = replay::RandomKeyed(replay::eStream::ZONING, perimeter_key) >> 31;
 
 		// first row
 		voxelIndex[start] = perimeter.left_top();
@@ -414,7 +416,7 @@ STATIC_INLINE_PURE result const __vectorcall test_adjacent_building_adjacent_to_
 	{ // left -- right
 
 		// setup
-		uint32_t const start = (uint32_t const)PsuedoRandom5050();
+		uint32_t const start = (replay::RandomKeyed(replay::eStream::ZONING, perimeter_key) >> 30) & 1;
 
 		// first column
 		voxelIndex[start] = perimeter.left_top();
@@ -579,35 +581,29 @@ static zone const __vectorcall process(rect2D_t const simArea, uint32_t const zo
 	);
 
 	tbb::flattened2d<Areas> const flat_view(tbb::flatten2d(areas));
-	uint32_t const count((uint32_t const)flat_view.size());
+
+	// order of the thread local areas depends on scheduling, sorted so the selection only depends on the zoning random stream
+	vector<zone> sorted(flat_view.begin(), flat_view.end());
+	std::sort(sorted.begin(), sorted.end(), [](zone const& a, zone const& b) {
+		return(std::tie(a.area.top, a.area.left, a.area.bottom, a.area.right) < std::tie(b.area.top, b.area.left, b.area.bottom, b.area.right));
+	});
+	uint32_t const count((uint32_t const)sorted.size());
 
 	zone selected{};
 
 	if (count) {
 		
-		if (PsuedoRandom5050()) {
+		if (replay::Random5050(replay::eStream::ZONING)) {
 			   
-			uint32_t const random_index(PsuedoRandomNumber32(0, count - 1));
-
-			uint32_t index(0);
-
-			for (tbb::flattened2d<Areas>::const_iterator
-				i = flat_view.begin(); i != flat_view.end(); ++i) {
-
-				if (random_index == index) {
-					selected = *i;
-					break;
-				}
-				++index;
-			}
+			selected = sorted[replay::RandomNumber32(replay::eStream::ZONING, 0, count - 1)];
 		}
 		else {
 
 			//float min_square_ratio(9999999.0f), max_area(0.0f);
 			uint32_t max_area(0);
 
-			for (tbb::flattened2d<Areas>::const_iterator
-				i = flat_view.begin(); i != flat_view.end(); ++i) {
+			for (vector<zone>::const_iterator
+				i = sorted.cbegin(); i != sorted.cend(); ++i) {
 
 				point2D_t const width_height(i->area.width_height());
 
@@ -789,7 +785,7 @@ void cSimulation::run(tTime const& __restrict tNow, fp_seconds const& __restrict
 {
 	// age demand
 	{
-		alignas(16) float const seed(PsuedoRandomFloat());
+		alignas(16) float const seed(replay::RandomFloat(replay::eStream::SIMULATION));
 
 		size_t population(0), possible_population(0);
 
@@ -867,7 +863,7 @@ void cSimulation::run(tTime const& __restrict tNow, fp_seconds const& __restrict
 			if (_patches.size() == ++_patch_index) {
 
 				_patch_index = 0;
-				random_shuffle(_patches.begin(), _patches.end());
+				std::shuffle(_patches.begin(), _patches.end(), replay::stream_engine{ replay::eStream::SIMULATION });
 			}
 			simArea = _patches[_patch_index];
 		}
@@ -3,6 +3,8 @@
 #include "cUser.h"
 #include "cToolProvider.h"
 #include "MinCity.h"
+#include "replay.h"
+#include "undoJournal.h"
 
 
 cUserInterface::cUserInterface()
@@ -46,6 +48,9 @@ uint32_t const cUserInterface::getActivatedSubToolType() const
 }
 void cUserInterface::setActivatedTool(uint32_t const uiToolType, std::optional<uint32_t const> uiSubTool)
 {
+	if (!replay::Input(replay::eInput::TOOL, (int32_t)uiToolType, uiSubTool.has_value() ? (int32_t)*uiSubTool : -1))
+		return; // replaying, live input ignored
+
 	_tools->setActivatedTool(uiToolType, uiSubTool);
 }
 
@@ -91,6 +96,22 @@ void cUserInterface::KeyAction(int32_t const key, bool const down, bool const ct
 			_user->KeyAction(key, down, ctrl);
 		}
 		break;
+	case GLFW_KEY_Z: // ctrl+z undo
+	case GLFW_KEY_Y: // ctrl+y redo
+		if (ctrl) {
+			if (!down) { // on released
+				ActivatedTool->deactivate(); // any highlighting or operation in progress is removed first
+				if (GLFW_KEY_Z == key) {
+					undo::undo();
+				}
+				else {
+					undo::redo();
+				}
+				ActivatedTool->activate();
+			}
+			break;
+		}
+		[[fallthrough]];
 	default: // if not one of the reserved keys that control the user
 		ActivatedTool->KeyAction(key, down, ctrl);
 		break;
@@ -30,10 +30,14 @@ or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
 #include "cPhysics.h"
 #include <Utility/async_long_task.h>
 #include "Interpolator.h"
+#include "performance.h"
+#include "replay.h"
+#include "frameGraph.h"
 
 #define V2_ROTATION_IMPLEMENTATION
 #include "voxelAlloc.h"
 #include "voxelModel.h"
+#include "voxBinary.h"
 #include "eVoxelModels.h"
 #include "cUserInterface.h"
 #include "cCity.h"
@@ -43,6 +47,9 @@ or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
 
 #include "cExplosionGameObject.h"
 #include "cCharacterGameObject.h"
+#include "picking.h"
+#include "moverHash.h"
+#include "deferredUpdate.h"
 
 #include <queue>
 #include <tracy.h>
@@ -287,6 +294,97 @@ static auto const __vectorcall groundAdjacency(point2D_t const voxelIndex) // Ad
 	return(structured_binding{ (uint16_t)SFM::max(1u, curVoxelHeightStep), (uint8_t)(minimum_heightstep >> 8), (uint8_t)Adjacency }); // *bugfix-adjust heights for rendering requirements
 }
 
+namespace // private to this file (anonymous)
+{
+	// ground adjacency of the visible area, cached per chunk tile (8x8 voxels) in the ground hash format. a tile is computed once when it first
+	// becomes visible and again only when a dirty region (height edit + one voxel border) invalidates it, instead of every voxel every frame.
+	// direct mapped, the window of tiles is larger than the visible area so visible tiles never collide within a frame.
+	static constexpr uint32_t const GROUND_CACHE_TILE_BITS = 3,												 // same as StreamingGrid::CHUNK_TILE
+									GROUND_CACHE_TILE = (1u << GROUND_CACHE_TILE_BITS),
+									GROUND_CACHE_WINDOW = 64,												 // tiles, power of 2
+									GROUND_CACHE_EMPTY = 0,
+									GROUND_CACHE_FILLING = UINT32_MAX;
+
+	static_assert(GROUND_CACHE_TILE == StreamingGrid::CHUNK_TILE && (GROUND_CACHE_WINDOW * GROUND_CACHE_TILE) >= (Iso::SCREEN_VOXELS << 1u));
+
+	typedef struct alignas(CACHE_LINE_BYTES) sGroundCacheTile
+	{
+		std::atomic_uint32_t	key;														// tile + 1, or EMPTY / FILLING
+		uint32_t				hash[GROUND_CACHE_TILE * GROUND_CACHE_TILE];				// adjacency | heightstep << 8 | minimum heightstep << 24
+
+	} groundCacheTile;
+
+	constinit static groundCacheTile ground_cache[GROUND_CACHE_WINDOW * GROUND_CACHE_WINDOW]{};
+
+	STATIC_INLINE_PURE uint32_t const groundCacheKey(uint32_t const tile_x, uint32_t const tile_y) { return(((tile_y << 16u) | tile_x) + 1u); }
+	STATIC_INLINE groundCacheTile& groundCacheSlot(uint32_t const tile_x, uint32_t const tile_y) {
+		return(ground_cache[(tile_y & (GROUND_CACHE_WINDOW - 1u)) * GROUND_CACHE_WINDOW + (tile_x & (GROUND_CACHE_WINDOW - 1u))]);
+	}
+
+	STATIC_INLINE uint32_t const __vectorcall groundHashAdjacency(point2D_t const voxelIndex)
+	{
+		auto const [heightstep, minheightstep, adjacency] = groundAdjacency(voxelIndex);
+
+		return(uint32_t(adjacency) | (uint32_t(heightstep) << 8u) | (uint32_t(minheightstep) << 24u));
+	}
+
+	// in: local voxel index only. concurrent (RenderGrid), the first thread to reach an empty tile fills it.
+	__declspec(safebuffers) STATIC_INLINE uint32_t const __vectorcall groundAdjacencyCached(point2D_t const voxelIndex)
+	{
+		uint32_t const tile_x(uint32_t(voxelIndex.x) >> GROUND_CACHE_TILE_BITS), tile_y(uint32_t(voxelIndex.y) >> GROUND_CACHE_TILE_BITS);
+		uint32_t const key(groundCacheKey(tile_x, tile_y));
+		uint32_t const offset(((uint32_t(voxelIndex.y) & (GROUND_CACHE_TILE - 1u)) << GROUND_CACHE_TILE_BITS) | (uint32_t(voxelIndex.x) & (GROUND_CACHE_TILE - 1u)));
+
+		groundCacheTile& __restrict slot(groundCacheSlot(tile_x, tile_y));
+
+		uint32_t current(slot.key.load(std::memory_order_acquire));
+		[[likely]] if (key == current) {
+			return(slot.hash[offset]);
+		}
+
+		if (GROUND_CACHE_FILLING != current && slot.key.compare_exchange_strong(current, GROUND_CACHE_FILLING, std::memory_order_acquire)) {
+
+			point2D_t const origin(tile_x << GROUND_CACHE_TILE_BITS, tile_y << GROUND_CACHE_TILE_BITS);
+			for (uint32_t y = 0; y < GROUND_CACHE_TILE; ++y) {
+				for (uint32_t x = 0; x < GROUND_CACHE_TILE; ++x) {
+					slot.hash[(y << GROUND_CACHE_TILE_BITS) | x] = groundHashAdjacency(p2D_add(origin, point2D_t(x, y)));
+				}
+			}
+			slot.key.store(key, std::memory_order_release);
+
+			return(slot.hash[offset]);
+		}
+
+		return(groundHashAdjacency(voxelIndex)); // another thread is filling the tile
+	}
+
+	// no concurrent access (before RenderGrid). area is local and may extend one voxel outside of the world, tiles wrap.
+	static void __vectorcall groundCacheInvalidate(rect2D_t const voxelArea)
+	{
+		int32_t const x0(voxelArea.left >> GROUND_CACHE_TILE_BITS), y0(voxelArea.top >> GROUND_CACHE_TILE_BITS),
+					  x1(voxelArea.right >> GROUND_CACHE_TILE_BITS), y1(voxelArea.bottom >> GROUND_CACHE_TILE_BITS);
+
+		for (int32_t y = y0; y <= y1; ++y) {
+			for (int32_t x = x0; x <= x1; ++x) {
+
+				uint32_t const tile_x(uint32_t(x) & ((Iso::WORLD_GRID_WIDTH >> GROUND_CACHE_TILE_BITS) - 1u)),
+							   tile_y(uint32_t(y) & ((Iso::WORLD_GRID_HEIGHT >> GROUND_CACHE_TILE_BITS) - 1u));
+
+				groundCacheTile& __restrict slot(groundCacheSlot(tile_x, tile_y));
+				if (groundCacheKey(tile_x, tile_y) == slot.key.load(std::memory_order_relaxed)) {
+					slot.key.store(GROUND_CACHE_EMPTY, std::memory_order_relaxed);
+				}
+			}
+		}
+	}
+	static void groundCacheReset()
+	{
+		for (auto& slot : ground_cache) {
+			slot.key.store(GROUND_CACHE_EMPTY, std::memory_order_relaxed);
+		}
+	}
+} // end ns
+
 /*
 // https://www.shadertoy.com/view/ftSfRw
 struct Crater {
@@ -618,6 +716,9 @@ void __vectorcall cVoxelWorld::updateCameraFollow(FXMVECTOR xmPosition, XMVECTOR
 
 void cVoxelWorld::OnKey(int32_t const key, bool const down, bool const ctrl)
 {
+	if (!replay::Input(replay::eInput::KEY, key, int32_t(down) | (int32_t(ctrl) << 1)))
+		return; // replaying, live input ignored
+
 	if (eInputEnabledBits::KEYS != (_inputEnabledBits & eInputEnabledBits::KEYS))
 		return; // input disabled!
 
@@ -746,6 +847,9 @@ void cVoxelWorld::OnKey(int32_t const key, bool const down, bool const ctrl)
 
 bool const __vectorcall cVoxelWorld::OnMouseMotion(FXMVECTOR xmMotionIn, bool const bIgnore)
 {
+	if (!replay::Input(replay::eInput::MOUSE_MOTION, int32_t(bIgnore), 0, XMVectorGetX(xmMotionIn), XMVectorGetY(xmMotionIn)))
+		return(false); // replaying, live input ignored
+
 	if (eInputEnabledBits::MOUSE_MOTION != (_inputEnabledBits & eInputEnabledBits::MOUSE_MOTION))
 		return(false); // input disabled!
 
@@ -802,6 +906,9 @@ bool const __vectorcall cVoxelWorld::OnMouseMotion(FXMVECTOR xmMotionIn, bool co
 }
 void cVoxelWorld::OnMouseLeft(int32_t const state)
 {
+	if (!replay::Input(replay::eInput::MOUSE_LEFT, state))
+		return; // replaying, live input ignored
+
 	if (eInputEnabledBits::MOUSE_BUTTON_LEFT != (_inputEnabledBits & eInputEnabledBits::MOUSE_BUTTON_LEFT))
 		return; // input disabled!
 
@@ -822,6 +929,9 @@ void cVoxelWorld::OnMouseLeft(int32_t const state)
 }
 void cVoxelWorld::OnMouseRight(int32_t const state)
 {
+	if (!replay::Input(replay::eInput::MOUSE_RIGHT, state))
+		return; // replaying, live input ignored
+
 	if (eInputEnabledBits::MOUSE_BUTTON_RIGHT != (_inputEnabledBits & eInputEnabledBits::MOUSE_BUTTON_RIGHT))
 		return; // input disabled!
 
@@ -838,6 +948,9 @@ void cVoxelWorld::OnMouseRight(int32_t const state)
 }
 void cVoxelWorld::OnMouseLeftClick()
 {
+	if (!replay::Input(replay::eInput::MOUSE_LEFT_CLICK))
+		return; // replaying, live input ignored
+
 	if (eInputEnabledBits::MOUSE_BUTTON_LEFT != (_inputEnabledBits & eInputEnabledBits::MOUSE_BUTTON_LEFT))
 		return; // input disabled!
 
@@ -845,6 +958,9 @@ void cVoxelWorld::OnMouseLeftClick()
 }
 void cVoxelWorld::OnMouseRightClick()
 {
+	if (!replay::Input(replay::eInput::MOUSE_RIGHT_CLICK))
+		return; // replaying, live input ignored
+
 	if (eInputEnabledBits::MOUSE_BUTTON_RIGHT != (_inputEnabledBits & eInputEnabledBits::MOUSE_BUTTON_RIGHT))
 		return; // input disabled!
 
@@ -853,6 +969,9 @@ void cVoxelWorld::OnMouseRightClick()
 }
 void cVoxelWorld::OnMouseScroll(float const delta)
 {
+	if (!replay::Input(replay::eInput::MOUSE_SCROLL, 0, 0, delta))
+		return; // replaying, live input ignored
+
 	if (eInputEnabledBits::MOUSE_SCROLL_WHEEL != (_inputEnabledBits & eInputEnabledBits::MOUSE_SCROLL_WHEEL))
 		return; // input disabled!
 
@@ -860,6 +979,9 @@ void cVoxelWorld::OnMouseScroll(float const delta)
 }
 void cVoxelWorld::OnMouseInactive()
 {
+	if (!replay::Input(replay::eInput::MOUSE_INACTIVE))
+		return; // replaying, live input ignored
+
 	if (eMouseButtonState::RELEASED == _mouseState) {
 		_mouseState = eMouseButtonState::INACTIVE;
 		_bDraggingMouse = false;
@@ -1280,6 +1402,11 @@ namespace world
 		return(maximum_height);
 	}
 
+	void __vectorcall markHeightDirtyLocal(point2D_t const voxelIndex)
+	{
+		((StreamingGrid* const __restrict)::grid)->MarkDirty(voxelIndex, StreamingGrid::DIRTY_HEIGHTS);
+	}
+
 	void setVoxelHeightAt(point2D_t const voxelIndex, uint32_t const heightstep)
 	{
 		Iso::setHeightStep(getLocalVoxelIndexAt(voxelIndex), heightstep);
@@ -1754,8 +1881,8 @@ namespace world
 	// Random //
 	point2D_t const __vectorcall getRandomVoxelIndexInArea(rect2D_t const area)
 	{
-		return(point2D_t(PsuedoRandomNumber32(area.left, area.right),
-						 PsuedoRandomNumber32(area.top, area.bottom)));
+		return(point2D_t(replay::RandomNumber32(replay::eStream::WORLD, area.left, area.right),
+						 replay::RandomNumber32(replay::eStream::WORLD, area.top, area.bottom)));
 	}
 	point2D_t const __vectorcall getRandomVisibleVoxelIndexInArea(rect2D_t const area)
 	{
@@ -1785,7 +1912,7 @@ namespace world
 		vector<uint32_t> enabledDirections({  eDirection::NW, eDirection::N,  eDirection::NE,
 											  eDirection::E,  eDirection::SE, eDirection::S,
 											  eDirection::SW, eDirection::W });
-		random_shuffle(enabledDirections.begin(), enabledDirections.end()); // adds more randomization at a very low cost
+		std::shuffle(enabledDirections.begin(), enabledDirections.end(), replay::stream_engine{ replay::eStream::WORLD }); // adds more randomization at a very low cost
 
 		bool bInvalidDirection(false);
 
@@ -1797,7 +1924,7 @@ namespace world
 			vector<uint32_t>::iterator iterCurrent;
 
 			do {
-				uint32_t const pending_direction = (uint32_t const)PsuedoRandomNumber32(0, (int32_t)(enabledDirections.size()) - 1);
+				uint32_t const pending_direction = (uint32_t const)replay::RandomNumber32(replay::eStream::WORLD, 0, (int32_t)(enabledDirections.size()) - 1);
 
 				for (vector<uint32_t>::iterator iter = enabledDirections.begin(); iter != enabledDirections.end(); ++iter) {
 					if (pending_direction == *iter) {
@@ -2004,13 +2131,10 @@ namespace // private to this file (anonymous)
 				bool const emissive((Iso::isEmissive(oVoxel) & (bool)color)); // if color is true black it's not emissive
 
 				// Build hash //
-				uint32_t groundHash(0);
-				auto const [heightstep, minheightstep, adjacency] = groundAdjacency(voxelIndex);
-
-				groundHash |= adjacency;			                                //			        	          0011 1111
+				uint32_t groundHash(groundAdjacencyCached(voxelIndex));			    // adjacency		        	          0011 1111
+																					// heightstep     1111 1111 1111 1111 xxxx xxxx
+																					// min  1111 1111 xxxx xxxx xxxx xxxx xxxx xxxx
 				groundHash |= (emissive << 6);                                      //		                          R1xx xxxx
-				groundHash |= (((uint32_t)heightstep) << 8);                        //            1111 1111 1111 1111 xxxx xxxx
-				groundHash |= (((uint32_t)minheightstep) << 24);	                //  1111 1111 xxxx xxxx xxxx xxxx xxxx xxxx
 				
 				// *bugfix - ground uv tiling needs to be centered on voxel + 0.5f, otherwise tiling between voxels do not matchup on adjacent edges.
 				XMVECTOR xmUVs(XMVectorMultiply(XMVectorAdd(p2D_to_v2(voxelIndex), XMVectorReplicate(0.5f)), XMVectorSet(Iso::INVERSE_WORLD_GRID_FWIDTH, Iso::INVERSE_WORLD_GRID_FHEIGHT, 0.0f, 0.0f)));
@@ -2175,91 +2299,145 @@ namespace // private to this file (anonymous)
 						x_begin(r.cols().begin()),
 						x_end(r.cols().end());
 
+#if !defined(NDEBUG) && defined(DEBUG_WORLD_ORIGIN)
+					XMVECTOR const xmWorldOrigin(getDebugVariable(XMVECTOR, DebugLabel::WORLD_ORIGIN));
+					float const fHeightOffset(XMVectorGetY(xmWorldOrigin));
+#else // normal:
+					float const fHeightOffset(heightOffset);
+#endif
+					static constexpr float const voxel_radius(Volumetric::volumetricVisibility::getVoxelRadius());
+
+					Volumetric::volumetricVisibility const& __restrict visibility(Volumetric::VolumetricLink->Visibility);
+
+					// hierarchical - the whole block is tested first, bounded by the minimum and maximum terrain height. the ground voxels of a block completely
+					// outside or completely inside the frustum do not need to be tested individually, only the ground voxels of an intersecting block are tested (8 at a time).
+					int32_t block_visibility(-1); // intersecting
+					{
+						static constexpr float const min_height(Iso::VOX_SIZE), max_height(Iso::TERRAIN_MAX_HEIGHT * Iso::VOX_SIZE);
+						static constexpr float const extent_pad(voxel_radius * 1.05f); // radius error compensation of sphere test, ensures every voxel sphere is inside the block bounds
+
+						point2D_t const renderBegin(p2D_sub(point2D_t(x_begin, y_begin), voxelStart)), 
+							            renderEnd(p2D_sub(point2D_t(x_end - 1, y_end - 1), voxelStart));
+
+						XMVECTOR const xmBlockMin(XMVectorSet((float)renderBegin.x, -max_height - fHeightOffset, (float)renderBegin.y, 0.0f)),
+							           xmBlockMax(XMVectorSet((float)renderEnd.x, -min_height - fHeightOffset, (float)renderEnd.y, 0.0f));
+
+						XMVECTOR const xmBlockCenter(XMVectorScale(XMVectorAdd(xmBlockMin, xmBlockMax), 0.5f)),
+							           xmBlockExtents(XMVectorAdd(XMVectorScale(XMVectorSubtract(xmBlockMax, xmBlockMin), 0.5f), XMVectorReplicate(extent_pad)));
+
+						block_visibility = visibility.AABBIntersectFrustum(xmBlockCenter, xmBlockExtents);
+					}
+
 					point2D_t voxelIndex; // *** range is [0...WORLD_GRID_SIZE] for voxelIndex here *** //
 
 #pragma loop( ivdep )
 					for (voxelIndex.y = y_begin; voxelIndex.y < y_end; ++voxelIndex.y) 
 					{
-#pragma loop( ivdep )
-						for (voxelIndex.x = x_begin; voxelIndex.x < x_end; ++voxelIndex.x)
+						for (int32_t x_batch = x_begin; x_batch < x_end; x_batch += Volumetric::sSphereBatch::WIDTH)
 						{
-							// *bugfix: Rendering is FRONT to BACK only (roughly)
-							point2D_t const voxelIndexWrapped(p2D_wrap_pow2(voxelIndex, point2D_t(Iso::WORLD_GRID_WIDTH, Iso::WORLD_GRID_HEIGHT))); // [0...16384] world grid coord
-							
-							// Make index relative to starting index voxel
-							point2D_t const renderIndex(p2D_sub(voxelIndex, voxelStart)); // [-128...128] visible grid relative coord
+							int32_t const x_batch_end(SFM::min(x_batch + (int32_t)Volumetric::sSphereBatch::WIDTH, x_end));
 
-							// *bugfix - this trickles down thru the voxel output position, to uv's, to light emitter position in the lightmap. All is the same. don't fuck with the fractional offset, it's not required here
-							XMVECTOR const xmVoxelOrigin(XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Z, XM_SWIZZLE_Y, XM_SWIZZLE_W>(p2D_to_v2(renderIndex))); // [0.0...256.0]
-							
-							// test ground voxel visible at ground height
-#if !defined(NDEBUG) && defined(DEBUG_WORLD_ORIGIN)
-							XMVECTOR const xmWorldOrigin(getDebugVariable(XMVECTOR, DebugLabel::WORLD_ORIGIN));
-							float const fWorldPlaneHeightOffset(XMVectorGetY(xmWorldOrigin));
-							bool bRenderVisible(isVoxelVisible(XMVectorSetY(xmVoxelOrigin, -(Iso::getRealHeight(voxelIndexWrapped)) - fWorldPlaneHeightOffset), Volumetric::volumetricVisibility::getVoxelRadius()));
-#else // normal:
-							bool bRenderVisible(isVoxelVisible(XMVectorSetY(xmVoxelOrigin, -Iso::getRealHeight(voxelIndexWrapped) - heightOffset), Volumetric::volumetricVisibility::getVoxelRadius()));
-#endif
-							/* @todo (optional)
-							if (Iso::isOwner(oVoxel, Iso::GROUND_HASH) && isExtended(oVoxel))
-							{
-								switch (getExtendedType(oVoxel))
-								{
-								case Iso::EXTENDED_TYPE_ROAD:
-									// todo
-									break;
-								case Iso::EXTENDED_TYPE_WATER:
-									// todo
-									break;
-									// default should not exist //
+							// visibility of ground voxels for this batch (bit per voxel)
+							uint32_t visible_mask(block_visibility ? 0xffu : 0u);
+
+							if (block_visibility < 0) { // intersecting
+								Volumetric::sSphereBatch batch;
+
+								for (int32_t x = x_batch; x < x_batch_end; ++x) {
+									uint32_t const lane(x - x_batch);
+
+									point2D_t const voxelIndexWrapped(p2D_wrap_pow2(point2D_t(x, voxelIndex.y), point2D_t(Iso::WORLD_GRID_WIDTH, Iso::WORLD_GRID_HEIGHT)));
+									point2D_t const renderIndex(p2D_sub(point2D_t(x, voxelIndex.y), voxelStart));
+
+									batch.x[lane] = (float)renderIndex.x;
+									batch.y[lane] = -Iso::getRealHeight(voxelIndexWrapped) - fHeightOffset;
+									batch.z[lane] = (float)renderIndex.y;
+									batch.radius[lane] = voxel_radius;
+								}
+								for (uint32_t lane = x_batch_end - x_batch; lane < Volumetric::sSphereBatch::WIDTH; ++lane) { // unused lanes, result is ignored
+									batch.x[lane] = batch.y[lane] = batch.z[lane] = batch.radius[lane] = 0.0f;
 								}
-							} // extended
-							*/
-							Iso::Voxel const oVoxel(streamingGrid->getVoxel(voxelIndexWrapped));
 
-							if (Iso::isOwner(oVoxel, Iso::STATIC_HASH))	// only roots actually do rendering work.
+								visible_mask = visibility.SphereTestFrustum(batch);
+							}
+
+#pragma loop( ivdep )
+							for (voxelIndex.x = x_batch; voxelIndex.x < x_batch_end; ++voxelIndex.x)
 							{
+								// *bugfix: Rendering is FRONT to BACK only (roughly)
+								point2D_t const voxelIndexWrapped(p2D_wrap_pow2(voxelIndex, point2D_t(Iso::WORLD_GRID_WIDTH, Iso::WORLD_GRID_HEIGHT))); // [0...16384] world grid coord
+								
+								// Make index relative to starting index voxel
+								point2D_t const renderIndex(p2D_sub(voxelIndex, voxelStart)); // [-128...128] visible grid relative coord
+
+								// *bugfix - this trickles down thru the voxel output position, to uv's, to light emitter position in the lightmap. All is the same. don't fuck with the fractional offset, it's not required here
+								XMVECTOR const xmVoxelOrigin(XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Z, XM_SWIZZLE_Y, XM_SWIZZLE_W>(p2D_to_v2(renderIndex))); // [0.0...256.0]
+								
+								// ground voxel visible at ground height (batched above)
+								bool bRenderVisible((visible_mask >> (voxelIndex.x - x_batch)) & 1u);
+
+								/* @todo (optional)
+								if (Iso::isOwner(oVoxel, Iso::GROUND_HASH) && isExtended(oVoxel))
+								{
+									switch (getExtendedType(oVoxel))
+									{
+									case Iso::EXTENDED_TYPE_ROAD:
+										// todo
+										break;
+									case Iso::EXTENDED_TYPE_WATER:
+										// todo
+										break;
+										// default should not exist //
+									}
+								} // extended
+								*/
+								Iso::Voxel const oVoxel(streamingGrid->getVoxel(voxelIndexWrapped));
+
+								if (Iso::isOwner(oVoxel, Iso::STATIC_HASH))	// only roots actually do rendering work.
+								{
 #ifndef DEBUG_NO_RENDER_STATIC_MODELS
- 								bRenderVisible |= RenderModel<false>(Iso::STATIC_HASH, xmVoxelOrigin, voxelIndexWrapped, bRenderVisible, oVoxel, statics, dynamics, trans, part);
+	 								bRenderVisible |= RenderModel<false>(Iso::STATIC_HASH, xmVoxelOrigin, voxelIndexWrapped, bRenderVisible, oVoxel, statics, dynamics, trans, part);
 #endif
-							} // root
-							// a voxel in the grid can have a static model and dynamic model simultaneously
-							if (Iso::isOwnerAny(oVoxel, Iso::DYNAMIC_HASH)) { // only if there are dynamic hashes which this voxel owns
-								for (uint32_t i = Iso::DYNAMIC_HASH; i < Iso::HASH_COUNT; ++i) {
-									if (Iso::isOwner(oVoxel, i)) {
-
-										bRenderVisible |= RenderModel<true>(i, xmVoxelOrigin, voxelIndexWrapped, bRenderVisible, oVoxel, statics, dynamics, trans, part);
+								} // root
+								// a voxel in the grid can have a static model and dynamic model simultaneously
+								if (Iso::isOwnerAny(oVoxel, Iso::DYNAMIC_HASH)) { // only if there are dynamic hashes which this voxel owns
+									for (uint32_t i = Iso::DYNAMIC_HASH; i < Iso::HASH_COUNT; ++i) {
+										if (Iso::isOwner(oVoxel, i)) {
+
+											bRenderVisible |= RenderModel<true>(i, xmVoxelOrigin, voxelIndexWrapped, bRenderVisible, oVoxel, statics, dynamics, trans, part);
+										}
 									}
 								}
-							}
 
-							if (bRenderVisible && r2D_contains(visibleArea, voxelIndexWrapped)) {
+								if (bRenderVisible && r2D_contains(visibleArea, voxelIndexWrapped)) {
 #if !defined(NDEBUG) && defined(DEBUG_WORLD_ORIGIN)
-								Iso::Voxel oOutVoxel(oVoxel);
-								Iso::setColor(oOutVoxel, 0x00007f00);
-								Iso::setEmissive(oOutVoxel);
-								RenderGround(xmVoxelOrigin, voxelIndexWrapped, renderIndex, oOutVoxel, grounds, localGround);
+									Iso::Voxel oOutVoxel(oVoxel);
+									Iso::setColor(oOutVoxel, 0x00007f00);
+									Iso::setEmissive(oOutVoxel);
+									RenderGround(xmVoxelOrigin, voxelIndexWrapped, renderIndex, oOutVoxel, grounds, localGround);
 #else // normal
 
-								Iso::Voxel oOutVoxel(oVoxel);
+									Iso::Voxel oOutVoxel(oVoxel);
 
-								//point2D_t const hashIndex( Hash(voxelIndexWrapped.v) );
-								//Iso::setColor(oOutVoxel, 0x00ffffff);
-								if ((voxelIndexWrapped.x & 1) ^ (voxelIndexWrapped.y & 1)) {
-									//Iso::setEmissive(oOutVoxel);
-								}
-								RenderGround(xmVoxelOrigin, voxelIndexWrapped, renderIndex, oOutVoxel, grounds, localGround);
+									//point2D_t const hashIndex( Hash(voxelIndexWrapped.v) );
+									//Iso::setColor(oOutVoxel, 0x00ffffff);
+									if ((voxelIndexWrapped.x & 1) ^ (voxelIndexWrapped.y & 1)) {
+										//Iso::setEmissive(oOutVoxel);
+									}
+									RenderGround(xmVoxelOrigin, voxelIndexWrapped, renderIndex, oOutVoxel, grounds, localGround);
 #endif
-							}
+								}
 #if !defined(NDEBUG) && defined(DEBUG_WORLD_ORIGIN)
-							else {
-								Iso::Voxel oOutVoxel(oVoxel);
-								Iso::setColor(oOutVoxel, 0x0000007f);
-								Iso::setEmissive(oOutVoxel);
-								RenderGround(xmVoxelOrigin, voxelIndexWrapped, renderIndex, oOutVoxel, grounds, localGround);
-							}
+								else {
+									Iso::Voxel oOutVoxel(oVoxel);
+									Iso::setColor(oOutVoxel, 0x0000007f);
+									Iso::setEmissive(oOutVoxel);
+									RenderGround(xmVoxelOrigin, voxelIndexWrapped, renderIndex, oOutVoxel, grounds, localGround);
+								}
 #endif
-						} // for
+							} // for
+
+						} // for batch
 
 					} // for                                                                                                                             
 
@@ -2353,7 +2531,7 @@ namespace world
 		, DebugStorageBuffer(nullptr)
 #endif
 	{
-		Volumetric::VolumetricLink = new Volumetric::voxLink{ *this, _OpacityMap, _Visibility, oCamera.voxelFractionalGridOffset };
+		Volumetric::VolumetricLink = new Volumetric::voxLink{ *this, _OpacityMap, _Visibility, oCamera.voxelFractionalGridOffset, oCamera.ZoomFactor };
 		
 		_occlusion.tToOcclude = Volumetric::Konstants::OCCLUSION_DELAY;
 	}
@@ -2468,6 +2646,12 @@ namespace world
 
 	void cVoxelWorld::LoadTextures()
 	{
+		if (replay::isHeadless()) { // no gpu textures, only the images used on the cpu
+			supernoise::blue.Load(TEXTURE_DIR L"bluenoise.ktx", false);
+			_blackbodyImage = ImagingLoadRawBGRA(TEXTURE_DIR "blackbody.data", BLACKBODY_IMAGE_WIDTH, 1);
+			return;
+		}
+
 		MinCity::TextureBoy->Initialize();
 
 		// Load bluenoise *** must be done here first so that noise is available
@@ -2561,9 +2745,11 @@ namespace world
 #ifndef NDEBUG
 		OutputVoxelStats();
 #endif
-		_OpacityMap.create(MinCity::Vulkan->getDevice(), MinCity::Vulkan->computePool(), MinCity::Vulkan->computeQueue(), MinCity::Vulkan->transientPool(), MinCity::Vulkan->graphicsQueue(), MinCity::getFramebufferSize(), MinCity::hardware_concurrency());
-		MinCity::PostProcess->create(MinCity::Vulkan->getDevice(), MinCity::Vulkan->transientPool(), MinCity::Vulkan->graphicsQueue(), MinCity::getFramebufferSize(), MinCity::Vulkan->isHDR());
-		createAllBuffers(MinCity::Vulkan->getDevice(), MinCity::Vulkan->transientPool(), MinCity::Vulkan->graphicsQueue());
+		if (!replay::isHeadless()) { // gpu resources
+			_OpacityMap.create(MinCity::Vulkan->getDevice(), MinCity::Vulkan->computePool(), MinCity::Vulkan->computeQueue(), MinCity::Vulkan->transientPool(), MinCity::Vulkan->graphicsQueue(), MinCity::getFramebufferSize(), MinCity::hardware_concurrency());
+			MinCity::PostProcess->create(MinCity::Vulkan->getDevice(), MinCity::Vulkan->transientPool(), MinCity::Vulkan->graphicsQueue(), MinCity::getFramebufferSize(), MinCity::Vulkan->isHDR());
+			createAllBuffers(MinCity::Vulkan->getDevice(), MinCity::Vulkan->transientPool(), MinCity::Vulkan->graphicsQueue());
+		}
 		
 		Volumetric::LoadAllVoxelModels();
 
@@ -2574,9 +2760,50 @@ namespace world
 		else {
 			MinCity::DispatchEvent(eEvent::SHOW_MAIN_WINDOW);
 		}
+#ifdef DEBUG_BENCHMARK_VOXEL_EMISSION
+		benchmarks::add("voxel emission", [this] { Benchmark_VoxelEmission(); return(true); });
+#endif
+#ifdef DEBUG_BENCHMARK_FRUSTUM_CULLING
+		benchmarks::add("frustum culling", [this] { Benchmark_FrustumCulling(); return(true); });
+#endif
+#ifdef DEBUG_BENCHMARK_MODEL_RENDER
+		benchmarks::add("model render", [this] { Benchmark_ModelRender(); return(true); });
+#endif
+#ifdef DEBUG_BENCHMARK_MODEL_LOD
+		benchmarks::add("model lod", [this] { Benchmark_ModelLOD(); return(true); });
+#endif
+#ifdef DEBUG_BENCHMARK_VOXEL_EVENTS
+		benchmarks::add("voxel events", [this] { return(Benchmark_VoxelEvents()); }); // once the scene is busy enough
+#endif
+#ifdef DEBUG_BENCHMARK_INSTANCE_LOOKUP
+		benchmarks::add("instance lookup", [this] { Benchmark_InstanceLookup(); return(true); });
+#endif
+#ifdef DEBUG_BENCHMARK_VOXEL_ADJACENCY
+		benchmarks::add("voxel adjacency", [] { Volumetric::voxB::BenchmarkAdjacency(); return(true); });
+#endif
+#ifdef DEBUG_BENCHMARK_CHUNK_CODECS
+		benchmarks::add("chunk codecs", [this] { _streamingGrid.BenchmarkCodecs(); return(true); });
+#endif
+#ifdef DEBUG_BENCHMARK_STREAMING_PAN
+		benchmarks::add("streaming pan", [this] { _streamingGrid.BenchmarkPan(); return(true); });
+#endif
+#ifdef DEBUG_BENCHMARK_DIRTY_REGIONS
+		benchmarks::add("dirty regions", [this] { Benchmark_DirtyRegions(); return(true); });
+#endif
+#ifdef DEBUG_BENCHMARK_RAY_PICKING
+		benchmarks::add("ray picking", [this] { picking::benchmark(XMVectorNegate(v3_rotate_yaw(Iso::xmEyePt_Iso, oCamera.Yaw)), oCamera.voxelIndex_Center); return(true); });
+#endif
+#ifdef DEBUG_BENCHMARK_TRAFFIC
+		benchmarks::add("traffic", [] { world::movers::benchmark(); return(true); });
+#endif
+#ifdef DEBUG_BENCHMARK_GAME_OBJECT_UPDATE
+		benchmarks::add("game object update", [] { world::deferred::benchmark(); return(true); });
+#endif
 #ifdef DEBUG_STORAGE_BUFFER
-		DebugStorageBuffer = new vku::StorageBuffer(sizeof(UniformDecl::DebugStorageBuffer), false, vk::BufferUsageFlagBits::eTransferDst);
-		DebugStorageBuffer->upload(MinCity::Vulkan->getDevice(), MinCity::Vulkan->transientPool(), MinCity::Vulkan->graphicsQueue(), init_debug_buffer);
+		if (!replay::isHeadless()) {
+			DebugStorageBuffer = new vku::StorageBuffer(sizeof(UniformDecl::DebugStorageBuffer), false, vk::BufferUsageFlagBits::eTransferDst);
+			DebugStorageBuffer->upload(MinCity::Vulkan->getDevice(), MinCity::Vulkan->transientPool(), MinCity::Vulkan->graphicsQueue(), init_debug_buffer);
+		}
 #endif
 	}
 
@@ -2600,17 +2827,17 @@ namespace world
 
 				uint32_t const hash(data_models_static[i].hash);
 
-				mapRootIndex::const_iterator const iter(_hshVoxelModelRootIndex.find(hash));
+				point2D_t const* const rootIndex(_hshVoxelModelRootIndex.find(hash));
 
-				if (_hshVoxelModelRootIndex.cend() != iter) {
+				if (nullptr != rootIndex) {
 
 					using voxelModelStatic = Volumetric::voxB::voxelModel<Volumetric::voxB::STATIC>;
 					// get model
 					voxelModelStatic const* const __restrict voxelModel = Volumetric::getVoxelModel<false>(data_models_static[i].identity._modelGroup, data_models_static[i].identity._index);
 					if (voxelModel) {
-						Volumetric::voxelModelInstance_Static* pInstance = Volumetric::voxelModelInstance_Static::create(*voxelModel, hash, iter->second);
+						Volumetric::voxelModelInstance_Static* pInstance = Volumetric::voxelModelInstance_Static::create(*voxelModel, hash, *rootIndex);
 						if (pInstance) {
-							// keep in unordered map container
+							// keep in slot map container
 							_hshVoxelModelInstances_Static[hash] = pInstance;
 							// create associated game object
 							create_game_object(hash, data_models_static[i].gameobject_type);
@@ -2630,17 +2857,17 @@ namespace world
 
 				uint32_t const hash(data_models_dynamic[i].hash);
 
-				mapRootIndex::const_iterator const iter(_hshVoxelModelRootIndex.find(hash));
+				point2D_t const* const rootIndex(_hshVoxelModelRootIndex.find(hash));
 
-				if (_hshVoxelModelRootIndex.cend() != iter) {
+				if (nullptr != rootIndex) {
 
 					using voxelModelDynamic = Volumetric::voxB::voxelModel<Volumetric::voxB::DYNAMIC>;
 					// get model
 					voxelModelDynamic const* const __restrict voxelModel = Volumetric::getVoxelModel<true>(data_models_dynamic[i].identity._modelGroup, data_models_dynamic[i].identity._index);
 					if (voxelModel) {
-						Volumetric::voxelModelInstance_Dynamic* pInstance = Volumetric::voxelModelInstance_Dynamic::create(*voxelModel, hash, iter->second);
+						Volumetric::voxelModelInstance_Dynamic* pInstance = Volumetric::voxelModelInstance_Dynamic::create(*voxelModel, hash, *rootIndex);
 						if (pInstance) {
-							// keep in unordered map container
+							// keep in slot map container
 							_hshVoxelModelInstances_Dynamic[hash] = pInstance;
 							// create associated game object
 							create_game_object(hash, data_models_dynamic[i].gameobject_type);
@@ -2814,6 +3041,9 @@ namespace world
 
 		// clear *all* game object colonies
 		world::access::release_game_objects();
+		world::movers::clear();
+
+		_streamingGrid.EnableDirtyTracking(false); // until onloaded
 		
 		// reset world / camera *bugfix important
 		resetCamera();
@@ -2824,12 +3054,34 @@ namespace world
 		_streamingGrid.GarbageCollect(critical_now(), critical_delta(), bForce);
 	}
 
+	// derived data is only recomputed where the grid or heights changed since the last frame: ground adjacency of the tiles plus a one voxel border
+	// (the neighbours' adjacency depends on the changed heights) and the picking pyramid over the changed heights, if anything has picked since the load.
+	void cVoxelWorld::UpdateDirtyRegions()
+	{
+		_streamingGrid.TakeDirtyRegions(_dirtyRegions);
+
+		for (auto const& region : _dirtyRegions) {
+
+			if (StreamingGrid::DIRTY_HEIGHTS & region.flags) {
+				groundCacheInvalidate(r2D_grow(region.area, point2D_t(1)));
+				picking::updateArea(region.area);
+			}
+		}
+	}
+
+	void cVoxelWorld::Prefetch(point2D_t const voxelStart)
+	{
+		point2D_t const voxelReset(p2D_add(voxelStart, Iso::GRID_OFFSET)); // same visible area as RenderGrid
+		_streamingGrid.Prefetch(rect2D_t(voxelReset, p2D_add(voxelReset, point2D_t(Iso::SCREEN_VOXELS_X, Iso::SCREEN_VOXELS_Z))));
+	}
+
 	void cVoxelWorld::NewWorld()
 	{
 		Clear();
 		MinCity::DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(10));
 		 
 		GenerateGround(); // generate new ground
+		_streamingGrid.ResetBaseline(); // a save must not be incremental against the .grid file of the previous city
 		
 		// must be last
 		_onLoadedRequired = true; // trigger onloaded() inside Update of VoxelWorld
@@ -2843,6 +3095,10 @@ namespace world
 
 	void cVoxelWorld::OnLoaded(tTime const& __restrict tNow)
 	{
+		picking::invalidate(); // heightmap is final (new or loaded), the pyramid is rebuilt by the next pick
+		groundCacheReset();
+		_streamingGrid.EnableDirtyTracking(true);
+
 		oCamera.reset();
 		MinCity::UserInterface->OnLoaded();
 
@@ -3080,55 +3336,42 @@ namespace world
 		_onLoadedRequired = false; // reset (must be last)
 	}
 
-	// *** no simultaneous !writes! to grid or grid data can occur while calling this function ***
-	// simultaneous reads (read-only) is OK.
-	// RenderGrid is protected only for read-only access
-	// GridSnapshot is protected for read-only access                                                             // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-	auto cVoxelWorld::GridSnapshot() const -> std::pair<Iso::Voxel const* const __restrict, uint32_t const> const // !broken! - when required again need @TODO compatibility w/ StreamingGrid. Grid is large enough now that it does not all fit in memory at once, StreamingGrid fixes that.
-	{                                                                                                             // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-		/*static constexpr uint32_t const voxel_count(Iso::WORLD_GRID_SIZE * Iso::WORLD_GRID_SIZE);
-		static constexpr size_t const gridSz(sizeof(Iso::Voxel) * size_t(voxel_count));
+	// *** no simultaneous !writes! to grid or grid data can occur while calling these functions ***
+	// grid is saved / loaded as independently compressed StreamingGrid chunk records in a .grid file alongside the .city file
+	bool const cVoxelWorld::GridSave(std::wstring const& path)
+	{
+		return(_streamingGrid.SaveChunks(path));
+	}
 
-		Iso::Voxel* __restrict gridSnapshot = (Iso::Voxel * __restrict)scalable_malloc(gridSz);
+	bool const cVoxelWorld::GridLoad(std::wstring const& path)
+	{
+		return(_streamingGrid.LoadChunks(path));
+	}
 
-		{
-			tbb::queuing_rw_mutex::scoped_lock lock(_streamingGrid.access_lock(), false); // read-only access
-			////////////////////////////memcpy(gridSnapshot, the::grid, gridSz);
-		}
+	// legacy .city files (monolithic row-major grid blob)
+	void cVoxelWorld::GridLoadLegacy(Iso::Voxel const* const __restrict legacy_grid)
+	{
+		static constexpr int32_t const BAND_ROWS = 512; // bounds the amount of chunks that are open (decompressed) at once
 
-		return(std::make_pair( gridSnapshot, voxel_count ));*/
-		return {};
-	}
+		_streamingGrid.ResetBaseline(); // not loaded from a .grid file
 
-	// *** no simultaneous !writes! to grid or grid data can occur while calling this function ***
-	// simultaneous reads (read-only) is NOT OK - unless protected
-	// RenderGrid is protected only for read-only access
-	// GridSnapshotLoad is protected for write access                               // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-	void cVoxelWorld::GridSnapshotLoad(Iso::Voxel const* const __restrict new_grid) // !broken! - when required again need @TODO compatibility w/ StreamingGrid. Grid is large enough now that it does not all fit in memory at once, StreamingGrid fixes that.
-	{                                                                               // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-		/*static constexpr uint32_t const voxel_count(Iso::WORLD_GRID_SIZE * Iso::WORLD_GRID_SIZE);
-		static constexpr size_t const gridSz(sizeof(Iso::Voxel) * size_t(voxel_count));
+		for (int32_t band = 0; band < (int32_t)Iso::WORLD_GRID_HEIGHT; band += BAND_ROWS) {
 
-		// internally memory for the grid uses VirtualAlloc2 / VirtualFree for it's data
-		Iso::Voxel* const __restrict theGrid = (Iso::Voxel* const __restrict)scalable_aligned_malloc(gridSz, CACHE_LINE_BYTES);
+			tbb::parallel_for(tbb::blocked_range<int32_t>(band, band + BAND_ROWS, StreamingGrid::CHUNK_TILE), [&](tbb::blocked_range<int32_t> const& r) {
 
-		memcpy(theGrid, new_grid, gridSz);
+				for (int32_t y = r.begin(); y < r.end(); ++y) {
 
-		// the sizes are the same for the new grid, and existing grid so we could just memcpy 
-		// however to ensure atomicity we would rather do a interlocked pointer swap, making this routine threadsafe
-		Iso::Voxel* __restrict oldGrid(nullptr);
-		{
-			// the data inside of the pointer (memory allocated, voxels of the grid) needs to be protected by a mutex
-			// to be thread safe. This lock has very little contention put on it from this side, however if the lock is already 
-			// obtained by RenderGrid the wait this function will have is high (time for RenderGrid to complete)
+					Iso::Voxel const* const __restrict row(legacy_grid + size_t(y) * size_t(Iso::WORLD_GRID_WIDTH));
+
+					for (int32_t x = 0; x < (int32_t)Iso::WORLD_GRID_WIDTH; ++x) {
+
+						_streamingGrid.setVoxel(point2D_t(x, y), std::forward<Iso::Voxel const&&>(Iso::Voxel(row[x])));
+					}
+				}
+			});
 
-			tbb::queuing_rw_mutex::scoped_lock lock(_streamingGrid.access_lock(), true); // write access
-			///////////////////////////////oldGrid = (Iso::Voxel*)_InterlockedExchangePointer((PVOID * __restrict)&the::grid._protected, theGrid);
+			_streamingGrid.Flush(); // compress everything that was just decompressed
 		}
-		// free the old grid's large allocation
-		if (oldGrid) {
-			scalable_aligned_free(oldGrid);
-		}*/
 	}
 
 } // end ns world
@@ -3458,172 +3701,954 @@ namespace world
 			getVolumetricOpacity().clear(resource_index); // better distribution of cpu at a later point in time of the frame.
 		}
 
-		// mapping direct buffers //
-		VertexDecl::VoxelNormal const* const MappedVoxels_Terrain_Start(voxels.visibleTerrain.buffer.direct);
-		std::atomic<VertexDecl::VoxelNormal*> MappedVoxels_Terrain(voxels.visibleTerrain.buffer.direct);
+		// per frame inputs of the stages, the graph is built once and reuses them every frame
+		static struct sStagingFrame
+		{
+			uint32_t								resource_index;
 
-		VertexDecl::VoxelNormal const* const MappedVoxels_Static_Start(voxels.visibleStatic.buffer.direct);
-		std::atomic<VertexDecl::VoxelNormal*> MappedVoxels_Static(voxels.visibleStatic.buffer.direct);
+			// mapping direct buffers //
+			VertexDecl::VoxelNormal const*			MappedVoxels_Terrain_Start;
+			std::atomic<VertexDecl::VoxelNormal*>	MappedVoxels_Terrain;
 
-		VertexDecl::VoxelDynamic const* const MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::_size()]{
-			voxels.visibleDynamic.opaque.buffer.direct,
-			voxels.visibleDynamic.trans.buffer.direct,
-		};
-		std::atomic<VertexDecl::VoxelDynamic*> MappedVoxels_Dynamic[Volumetric::eVoxelType::_size()]{
-			voxels.visibleDynamic.opaque.buffer.direct,
-			voxels.visibleDynamic.trans.buffer.direct
-		};
+			VertexDecl::VoxelNormal const*			MappedVoxels_Static_Start;
+			std::atomic<VertexDecl::VoxelNormal*>	MappedVoxels_Static;
 
-		// lru streaming grid deadzone
-		MinCity::VoxelWorld->GarbageCollect(); // optimal position to exploit wait at begining of RenderTask_Normal, this is the ideal "dead-zone"
+			VertexDecl::VoxelDynamic const*			MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::_size()];
+			std::atomic<VertexDecl::VoxelDynamic*>	MappedVoxels_Dynamic[Volumetric::eVoxelType::_size()];
 
-		// ensure the async clears are done
-		async_long_task::wait<background_critical>(_AsyncClearTaskID, "async clears");
-		___streaming_store_fence(); // ensure "streaming" clears are coherent
+			tbb::affinity_partitioner				part; // *bugfix - lifetime of partioner should be the lifetime of the graph
+#ifdef DEBUG_VOXEL_BANDWIDTH
+			std::atomic_size_t						voxel_count; /// all voxels
+#endif
+		} frame{};
 
-		_OpacityMap.map(); // (maps, should be done once clear for lights has completed, and before any lights are added)
+		frame.resource_index = resource_index;
 
-		// GRID RENDER //
-		tbb::affinity_partitioner part{}; // *bugfix - lifetime of partioner should be in this scope
+		frame.MappedVoxels_Terrain_Start = voxels.visibleTerrain.buffer.direct;
+		frame.MappedVoxels_Terrain = voxels.visibleTerrain.buffer.direct;
 
-		voxelRender::RenderGrid(
-			oCamera.voxelIndex_TopLeft, XMVectorGetY(SFM::getPositionVector(_Visibility.getWorldMatrix())),
-			std::forward<Volumetric::voxelBufferReference_Terrain&& __restrict>(Volumetric::voxelBufferReference_Terrain(MappedVoxels_Terrain, MappedVoxels_Terrain_Start, voxels.visibleTerrain.bits)),
-			std::forward<Volumetric::voxelBufferReference_Static&& __restrict>(Volumetric::voxelBufferReference_Static(MappedVoxels_Static, MappedVoxels_Static_Start, voxels.visibleStatic.bits)),
-			std::forward<Volumetric::voxelBufferReference_Dynamic&& __restrict>(Volumetric::voxelBufferReference_Dynamic(MappedVoxels_Dynamic[Volumetric::eVoxelType::opaque], MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::opaque], voxels.visibleDynamic.opaque.bits)),
-			std::forward<Volumetric::voxelBufferReference_Dynamic&& __restrict>(Volumetric::voxelBufferReference_Dynamic(MappedVoxels_Dynamic[Volumetric::eVoxelType::trans], MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::trans], voxels.visibleDynamic.trans.bits)),
-			part
-		);
+		frame.MappedVoxels_Static_Start = voxels.visibleStatic.buffer.direct;
+		frame.MappedVoxels_Static = voxels.visibleStatic.buffer.direct;
 
-		// game related asynchronous methods
-		// physics can be "cleared" as early as here. corresponding wait is in Update() of VoxelWorld.
-		MinCity::Physics->AsyncClear();
+		frame.MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::opaque] = voxels.visibleDynamic.opaque.buffer.direct;
+		frame.MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::trans] = voxels.visibleDynamic.trans.buffer.direct;
+		frame.MappedVoxels_Dynamic[Volumetric::eVoxelType::opaque] = voxels.visibleDynamic.opaque.buffer.direct;
+		frame.MappedVoxels_Dynamic[Volumetric::eVoxelType::trans] = voxels.visibleDynamic.trans.buffer.direct;
+#ifdef DEBUG_VOXEL_BANDWIDTH
+		frame.voxel_count = 0;
+#endif
 
-		_OpacityMap.commit(); // (commits the new bounds, unmaps)
+		using framegraph::eResource;
+		using framegraph::bit;
+		using framegraph::DIRECT_ALL;
+
+		// stages are added in the order they used to run in, edges are derived from the declared resources. see frameGraph.h
+		static framegraph::cFrameGraph graph; // main thread only
+
+		if (graph.empty()) {
+
+			// lru streaming grid deadzone
+			graph.add("gc", 0, bit(eResource::STREAMING_GRID), [this] {
+				MinCity::VoxelWorld->GarbageCollect(); // exploits the wait for the async clears below, this is the ideal "dead-zone"
+			});
+
+			graph.add("async clears", 0, DIRECT_ALL | bit(eResource::OPACITY), [this] {
+				// ensure the async clears are done
+				async_long_task::wait<background_critical>(_AsyncClearTaskID, "async clears");
+				___streaming_store_fence(); // ensure "streaming" clears are coherent
+
+				_OpacityMap.map(); // (maps, should be done once clear for lights has completed, and before any lights are added)
+			});
+
+			graph.add("dirty regions", bit(eResource::STREAMING_GRID), bit(eResource::DIRTY_REGIONS), [this] {
+				MinCity::VoxelWorld->UpdateDirtyRegions(); // edits of the last frame, before anything derived from them is rendered
+			});
+
+			// GRID RENDER //
+			graph.add("render grid", bit(eResource::STREAMING_GRID) | bit(eResource::DIRTY_REGIONS) | bit(eResource::PHYSICS), DIRECT_ALL | bit(eResource::OPACITY), [this] {
+				voxelRender::RenderGrid(
+					oCamera.voxelIndex_TopLeft, XMVectorGetY(SFM::getPositionVector(_Visibility.getWorldMatrix())),
+					std::forward<Volumetric::voxelBufferReference_Terrain&& __restrict>(Volumetric::voxelBufferReference_Terrain(frame.MappedVoxels_Terrain, frame.MappedVoxels_Terrain_Start, voxels.visibleTerrain.bits)),
+					std::forward<Volumetric::voxelBufferReference_Static&& __restrict>(Volumetric::voxelBufferReference_Static(frame.MappedVoxels_Static, frame.MappedVoxels_Static_Start, voxels.visibleStatic.bits)),
+					std::forward<Volumetric::voxelBufferReference_Dynamic&& __restrict>(Volumetric::voxelBufferReference_Dynamic(frame.MappedVoxels_Dynamic[Volumetric::eVoxelType::opaque], frame.MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::opaque], voxels.visibleDynamic.opaque.bits)),
+					std::forward<Volumetric::voxelBufferReference_Dynamic&& __restrict>(Volumetric::voxelBufferReference_Dynamic(frame.MappedVoxels_Dynamic[Volumetric::eVoxelType::trans], frame.MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::trans], voxels.visibleDynamic.trans.bits)),
+					frame.part
+				);
+			});
+
+			// lru streaming grid prefetch (background), chunks the camera is moving towards are decompressed before RenderGrid of a following frame needs them
+			graph.add("prefetch", 0, bit(eResource::STREAMING_GRID), [this] {
+				MinCity::VoxelWorld->Prefetch(oCamera.voxelIndex_TopLeft);
+			});
+
+			// game related asynchronous methods
+			// physics can be "cleared" as early as here. corresponding wait is in Update() of VoxelWorld.
+			graph.add("physics clear", 0, bit(eResource::PHYSICS), [this] {
+				MinCity::Physics->AsyncClear();
+			});
+
+			graph.add("opacity commit", 0, bit(eResource::OPACITY), [this] {
+				_OpacityMap.commit(); // (commits the new bounds, unmaps)
+			});
+
+			// mapping staging buffers //
+			// [dynamic] [static] [terrain] staging buffers compaction are independent of each other
+
+			graph.add("compact dynamic", bit(eResource::DIRECT_DYNAMIC), bit(eResource::STAGING_DYNAMIC), [this] { // dynamic voxels (dynamic partition size and offset updates) //
+				vku::VertexBufferPartition* const __restrict& __restrict dynamic_partition_info_updater(MinCity::Vulkan->getDynamicPartitionInfo(frame.resource_index));
+				size_t running_offset_size(0);
+
+				{ // dynamic (opaques)
+					VertexDecl::VoxelDynamic* const MappedVoxels_Dynamic_End = frame.MappedVoxels_Dynamic[Volumetric::eVoxelType::opaque];
+					size_t activeSize = MappedVoxels_Dynamic_End - frame.MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::opaque];
+					voxels.visibleDynamic.opaque.buffer.active_size = activeSize * sizeof(VertexDecl::VoxelDynamic); // direct buffer size
+
+					VertexDecl::VoxelDynamic* const __restrict Mapped_Staging_Voxels_Dynamic_Start = (VertexDecl::VoxelDynamic* const __restrict)voxels.visibleDynamic.opaque.buffer.staging[frame.resource_index].map();
+					//___memcpy_threaded<32>(Mapped_Staging_Voxels_Dynamic_Start, frame.MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::opaque], bytes);
+					activeSize = StreamCompaction<VertexDecl::VoxelDynamic, Volumetric::dynamic_direct_buffer_size>(Mapped_Staging_Voxels_Dynamic_Start, frame.MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::opaque],
+						                                                                                            activeSize, voxels.visibleDynamic.opaque.bits);
+					voxels.visibleDynamic.opaque.buffer.staging[frame.resource_index].unmap();
+					voxels.visibleDynamic.opaque.buffer.staging[frame.resource_index].setActiveSizeBytes(activeSize * sizeof(VertexDecl::VoxelDynamic)); // staging buffer size
+					metrics::gauge(metrics::eGauge::VOXELS_DYNAMIC_OPAQUE, (int64_t)activeSize);
+
+					// set the parent / main partition info
+					dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::PARENT_MAIN].active_vertex_count = (uint32_t const)activeSize;
+					dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::PARENT_MAIN].vertex_start_offset = (uint32_t const)running_offset_size;
+					running_offset_size += activeSize;
 
-		/// all voxels
 #ifdef DEBUG_VOXEL_BANDWIDTH
-		size_t voxel_count(0);
+					frame.voxel_count += activeSize;
 #endif
-		// mapping staging buffers //
+				}
+				{
+					// Update Dynamic VertexBuffer Offsets for "Custom Voxel Shader Children"
+					// ########### only use [Volumetric::eVoxelType::opaque] even if the child is a transparent pipeline
+					// ########### the [Volumetric::eVoxelType::trans] is reserved for voxels belong to model instances on the grid and is soley for PARENT_TRANS usage
 
-		tbb::parallel_invoke( // [dynamic] [static] [terrain] staging buffers compaction are independent of each other
+					/* do not delete, required reference for custom voxel fragment shader implementation details
+					if (_activeRain) {
 
-		[&]{ // dynamic voxels (dynamic partition size and offset updates) //
-			vku::VertexBufferPartition* const __restrict& __restrict dynamic_partition_info_updater(MinCity::Vulkan->getDynamicPartitionInfo(resource_index));
-			size_t running_offset_size(0);
+						RenderRain(_activeRain, frame.MappedVoxels_Dynamic[Volumetric::eVoxelType::opaque]);
+					}
+					{ // RAIN
+						VertexDecl::VoxelDynamic* const __restrict MappedVoxels_Dynamic_Current = frame.MappedVoxels_Dynamic[Volumetric::eVoxelType::opaque];
+						size_t const current_dynamic_size = MappedVoxels_Dynamic_Current - running_offset_start;
+						// set the parent / main partition info
+						dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::VOXEL_SHADER_RAIN].active_vertex_count = (uint32_t const)current_dynamic_size;
+						dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::VOXEL_SHADER_RAIN].vertex_start_offset = (uint32_t const)running_offset_size;
+						running_offset_size += current_dynamic_size;
+						running_offset_start = MappedVoxels_Dynamic_Current;
+
+		#ifdef DEBUG_RAIN_COUNT
+						if (dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::VOXEL_SHADER_RAIN].active_vertex_count) {
+							FMT_NUKLEAR_DEBUG(false, "      {:d} rain voxels being rendered", dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::VOXEL_SHADER_RAIN].active_vertex_count);
+						}
+						else {
+							FMT_NUKLEAR_DEBUG_OFF();
+						}
+		#endif
 
-			{ // dynamic (opaques)
-				VertexDecl::VoxelDynamic* const MappedVoxels_Dynamic_End = MappedVoxels_Dynamic[Volumetric::eVoxelType::opaque];
-				size_t activeSize = MappedVoxels_Dynamic_End - MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::opaque];
-				voxels.visibleDynamic.opaque.buffer.active_size = activeSize * sizeof(VertexDecl::VoxelDynamic); // direct buffer size
+					}
+					*/
+					// todo add other children here for added partitions of dynamic voxel parent
+				}
+				{ // dynamic (transparents) ***MUST BE LAST DYNAMIC***
+					VertexDecl::VoxelDynamic* const MappedVoxels_Dynamic_End = frame.MappedVoxels_Dynamic[Volumetric::eVoxelType::trans];
+					size_t activeSize = MappedVoxels_Dynamic_End - frame.MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::trans];
+					voxels.visibleDynamic.trans.buffer.active_size = activeSize * sizeof(VertexDecl::VoxelDynamic); // direct buffer size
+
+					VertexDecl::VoxelDynamic* const __restrict Mapped_Staging_Voxels_Dynamic_Start = (VertexDecl::VoxelDynamic* const __restrict)voxels.visibleDynamic.trans.buffer.staging[frame.resource_index].map();
+					//___memcpy_threaded<32>(Mapped_Staging_Voxels_Dynamic_Start, frame.MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::trans], bytes);
+					activeSize = StreamCompaction<VertexDecl::VoxelDynamic, Volumetric::dynamic_direct_buffer_size>(Mapped_Staging_Voxels_Dynamic_Start, frame.MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::trans],
+						                                                                                            activeSize, voxels.visibleDynamic.trans.bits);
+				
+					voxels.visibleDynamic.trans.buffer.staging[frame.resource_index].unmap();
+					voxels.visibleDynamic.trans.buffer.staging[frame.resource_index].setActiveSizeBytes(activeSize * sizeof(VertexDecl::VoxelDynamic)); // staging buffer size
+					metrics::gauge(metrics::eGauge::VOXELS_DYNAMIC_TRANS, (int64_t)activeSize);
 
-				VertexDecl::VoxelDynamic* const __restrict Mapped_Staging_Voxels_Dynamic_Start = (VertexDecl::VoxelDynamic* const __restrict)voxels.visibleDynamic.opaque.buffer.staging[resource_index].map();
-				//___memcpy_threaded<32>(Mapped_Staging_Voxels_Dynamic_Start, MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::opaque], bytes);
-				activeSize = StreamCompaction<VertexDecl::VoxelDynamic, Volumetric::dynamic_direct_buffer_size>(Mapped_Staging_Voxels_Dynamic_Start, MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::opaque],
-					                                                                                            activeSize, voxels.visibleDynamic.opaque.bits);
-				voxels.visibleDynamic.opaque.buffer.staging[resource_index].unmap();
-				voxels.visibleDynamic.opaque.buffer.staging[resource_index].setActiveSizeBytes(activeSize * sizeof(VertexDecl::VoxelDynamic)); // staging buffer size
+					// set the parent / main partition info
+					dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::PARENT_TRANS].active_vertex_count = (uint32_t const)activeSize;
+					dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::PARENT_TRANS].vertex_start_offset = (uint32_t const)running_offset_size;  // special handling injecting transparents into opaque / main frame.part
+#ifdef DEBUG_VOXEL_BANDWIDTH
+					frame.voxel_count += activeSize;
+#endif
+				}
+			});
+
+			graph.add("compact static", bit(eResource::DIRECT_STATIC), bit(eResource::STAGING_STATIC), [this] {
+				VertexDecl::VoxelNormal const* const MappedVoxels_Static_End = frame.MappedVoxels_Static;
+				size_t activeSize = MappedVoxels_Static_End - frame.MappedVoxels_Static_Start;
+				voxels.visibleStatic.buffer.active_size = activeSize * sizeof(VertexDecl::VoxelNormal); // direct buffer size
+
+				VertexDecl::VoxelNormal* const __restrict Mapped_Staging_Voxels_Static_Start = (VertexDecl::VoxelNormal* const __restrict)voxels.visibleStatic.buffer.staging[frame.resource_index].map();
+				//___memcpy_threaded<32>(Mapped_Staging_Voxels_Static_Start, frame.MappedVoxels_Static_Start, activeSize * sizeof(VertexDecl::VoxelNormal));
+				activeSize = StreamCompaction<VertexDecl::VoxelNormal, Volumetric::static_direct_buffer_size>(Mapped_Staging_Voxels_Static_Start, frame.MappedVoxels_Static_Start,
+					                                                                                          activeSize, voxels.visibleStatic.bits);
+				voxels.visibleStatic.buffer.staging[frame.resource_index].unmap();
+				voxels.visibleStatic.buffer.staging[frame.resource_index].setActiveSizeBytes(activeSize * sizeof(VertexDecl::VoxelNormal)); // staging buffer size
+				metrics::gauge(metrics::eGauge::VOXELS_STATIC, (int64_t)activeSize);
+			
+#ifdef DEBUG_VOXEL_BANDWIDTH
+				frame.voxel_count += activeSize;
+#endif 
+			});
+
+			graph.add("compact terrain", bit(eResource::DIRECT_TERRAIN), bit(eResource::STAGING_TERRAIN), [this] {
+				voxels.visibleTerrain.buffer.active_size = Volumetric::terrain_direct_buffer_size * sizeof(VertexDecl::VoxelNormal); // direct buffer size
+
+				VertexDecl::VoxelNormal* const __restrict Mapped_Staging_Voxels_Terrain_Start = (VertexDecl::VoxelNormal* const __restrict)voxels.visibleTerrain.buffer.staging[frame.resource_index].map();
+				///___memcpy_threaded<32>(Mapped_Staging_Voxels_Terrain_Start, frame.MappedVoxels_Terrain_Start, bytes);
+				size_t const activeSize = StreamCompaction<VertexDecl::VoxelNormal, Volumetric::terrain_direct_buffer_size>(Mapped_Staging_Voxels_Terrain_Start, frame.MappedVoxels_Terrain_Start,
+					                                                                                                        Volumetric::terrain_direct_buffer_size, voxels.visibleTerrain.bits);
+				voxels.visibleTerrain.buffer.staging[frame.resource_index].unmap();
+				voxels.visibleTerrain.buffer.staging[frame.resource_index].setActiveSizeBytes(activeSize * sizeof(VertexDecl::VoxelNormal)); // staging buffer size
+				metrics::gauge(metrics::eGauge::VOXELS_TERRAIN, (int64_t)activeSize);
+			
+#ifdef DEBUG_VOXEL_BANDWIDTH
+				frame.voxel_count += activeSize;
+#endif
+			});
+		}
 
-				// set the parent / main partition info
-				dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::PARENT_MAIN].active_vertex_count = (uint32_t const)activeSize;
-				dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::PARENT_MAIN].vertex_start_offset = (uint32_t const)running_offset_size;
-				running_offset_size += activeSize;
+		graph.run(replay::isSerial());
 
 #ifdef DEBUG_VOXEL_BANDWIDTH
-				voxel_count += activeSize;
+		frameBandwidth(high_resolution_clock::now(), frame.voxel_count);
+#endif
+	}
+#ifdef DEBUG_BENCHMARK_RENDER
+	// cpu render benchmarks render into the direct buffers like a normal frame. Begin takes the buffers over from the async clears and maps the opacity map
+	// for the lights the voxels emit - that is the light staging buffer, so these benchmarks need the gpu resources of the running game.
+	// End unmaps the opacity map and leaves the buffers as AsyncClears would.
+	void cVoxelWorld::BenchmarkRenderBegin()
+	{
+		async_long_task::wait<background_critical>(_AsyncClearTaskID, "async clears");
+
+		_OpacityMap.map();
+	}
+
+	void cVoxelWorld::BenchmarkRenderEnd()
+	{
+		_OpacityMap.commit();
+
+		voxels.visibleTerrain.buffer.active_size = Volumetric::terrain_direct_buffer_size * sizeof(VertexDecl::VoxelNormal);
+		voxels.visibleStatic.buffer.active_size = Volumetric::static_direct_buffer_size * sizeof(VertexDecl::VoxelNormal);
+		voxels.visibleDynamic.opaque.buffer.active_size = Volumetric::dynamic_direct_buffer_size * sizeof(VertexDecl::VoxelDynamic);
+		voxels.visibleDynamic.trans.buffer.active_size = Volumetric::dynamic_direct_buffer_size * sizeof(VertexDecl::VoxelDynamic);
+		AsyncClears(0); // resource index is unused by clears
+	}
 #endif
+#ifdef DEBUG_BENCHMARK_VOXEL_EMISSION
+	template<size_t const direct_buffer_size>
+	static size_t const bitOccupancy(bit_row_atomic<direct_buffer_size> const* const __restrict bits)
+	{
+		static constexpr size_t const block_count(bit_row_atomic<direct_buffer_size>::stride());
+
+		auto const* const __restrict stream_bits(bits->data());
+		size_t count(0);
+
+		for (size_t block = 0; block < block_count; ++block) {
+			count += __popcnt64(stream_bits[block]);
+		}
+		return(count);
+	}
+
+	// cpu voxel emission benchmark - RenderGrid + StreamCompaction, compaction is into plain host memory instead of the voxel staging buffers.
+	// fixed camera positions are relative to the current camera, each is rendered BENCHMARK_ITERATIONS times.
+	void cVoxelWorld::Benchmark_VoxelEmission()
+	{
+		static constexpr uint32_t const BENCHMARK_ITERATIONS = 64;
+		static constexpr point2D_t const BENCHMARK_POSITIONS[] = { point2D_t(0, 0), point2D_t(Iso::SCREEN_VOXELS_X, 0), point2D_t(0, Iso::SCREEN_VOXELS_Z),
+			                                                       point2D_t(-(int32_t)Iso::SCREEN_VOXELS_X * 4, -(int32_t)Iso::SCREEN_VOXELS_Z * 4), point2D_t(Iso::SCREEN_VOXELS_X * 16, Iso::SCREEN_VOXELS_Z * 8) };
+
+		BenchmarkRenderBegin();
+
+		// host memory targets for stream compaction (replaces the mapped staging buffers)
+		tbb::cache_aligned_allocator< VertexDecl::VoxelDynamic > allocator_dynamic;
+		tbb::cache_aligned_allocator< VertexDecl::VoxelNormal > allocator_normal;
+
+		VertexDecl::VoxelDynamic* const __restrict host_opaque(allocator_dynamic.allocate(Volumetric::dynamic_direct_buffer_size));
+		VertexDecl::VoxelDynamic* const __restrict host_trans(allocator_dynamic.allocate(Volumetric::dynamic_direct_buffer_size));
+		VertexDecl::VoxelNormal* const __restrict host_static(allocator_normal.allocate(Volumetric::static_direct_buffer_size));
+		VertexDecl::VoxelNormal* const __restrict host_terrain(allocator_normal.allocate(Volumetric::terrain_direct_buffer_size));
+
+		FMT_LOG(PERF_LOG, "voxel emission benchmark: {:d} positions x {:d} iterations", std::size(BENCHMARK_POSITIONS), BENCHMARK_ITERATIONS);
+
+		for (uint32_t position = 0; position < std::size(BENCHMARK_POSITIONS); ++position) {
+
+			point2D_t const voxelStart(p2D_add(oCamera.voxelIndex_TopLeft, BENCHMARK_POSITIONS[position]));
+
+			nanoseconds tClear{}, tRender{}, tCompaction{};
+			size_t voxel_count(0), occupancy_terrain(0), occupancy_static(0), occupancy_dynamic(0);
+
+			for (uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration) {
+
+				tTime const tStart(high_resolution_clock::now());
+
+				// clears (same as AsyncClears, synchronous)
+				___memset_threaded_stream<64>(voxels.visibleTerrain.buffer.direct, 0, Volumetric::terrain_direct_buffer_size * sizeof(VertexDecl::VoxelNormal));
+				___memset_threaded_stream<64>(voxels.visibleStatic.buffer.direct, 0, Volumetric::static_direct_buffer_size * sizeof(VertexDecl::VoxelNormal));
+				___memset_threaded_stream<64>(voxels.visibleDynamic.opaque.buffer.direct, 0, Volumetric::dynamic_direct_buffer_size * sizeof(VertexDecl::VoxelDynamic));
+				___memset_threaded_stream<64>(voxels.visibleDynamic.trans.buffer.direct, 0, Volumetric::dynamic_direct_buffer_size * sizeof(VertexDecl::VoxelDynamic));
+				voxels.visibleTerrain.bits->clear();
+				voxels.visibleStatic.bits->clear();
+				voxels.visibleDynamic.opaque.bits->clear();
+				voxels.visibleDynamic.trans.bits->clear();
+				___streaming_store_fence();
+
+				tTime const tCleared(high_resolution_clock::now());
+
+				std::atomic<VertexDecl::VoxelNormal*> MappedVoxels_Terrain(voxels.visibleTerrain.buffer.direct);
+				std::atomic<VertexDecl::VoxelNormal*> MappedVoxels_Static(voxels.visibleStatic.buffer.direct);
+				std::atomic<VertexDecl::VoxelDynamic*> MappedVoxels_Opaque(voxels.visibleDynamic.opaque.buffer.direct);
+				std::atomic<VertexDecl::VoxelDynamic*> MappedVoxels_Trans(voxels.visibleDynamic.trans.buffer.direct);
+
+				{
+					tbb::affinity_partitioner part{};
+
+					voxelRender::RenderGrid(
+						voxelStart, XMVectorGetY(SFM::getPositionVector(_Visibility.getWorldMatrix())),
+						std::forward<Volumetric::voxelBufferReference_Terrain&& __restrict>(Volumetric::voxelBufferReference_Terrain(MappedVoxels_Terrain, voxels.visibleTerrain.buffer.direct, voxels.visibleTerrain.bits)),
+						std::forward<Volumetric::voxelBufferReference_Static&& __restrict>(Volumetric::voxelBufferReference_Static(MappedVoxels_Static, voxels.visibleStatic.buffer.direct, voxels.visibleStatic.bits)),
+						std::forward<Volumetric::voxelBufferReference_Dynamic&& __restrict>(Volumetric::voxelBufferReference_Dynamic(MappedVoxels_Opaque, voxels.visibleDynamic.opaque.buffer.direct, voxels.visibleDynamic.opaque.bits)),
+						std::forward<Volumetric::voxelBufferReference_Dynamic&& __restrict>(Volumetric::voxelBufferReference_Dynamic(MappedVoxels_Trans, voxels.visibleDynamic.trans.buffer.direct, voxels.visibleDynamic.trans.bits)),
+						part
+					);
+				}
+
+				tTime const tRendered(high_resolution_clock::now());
+
+				size_t count_opaque(0), count_trans(0), count_static(0), count_terrain(0);
+				tbb::parallel_invoke(
+					[&] { count_opaque = StreamCompaction<VertexDecl::VoxelDynamic, Volumetric::dynamic_direct_buffer_size>(host_opaque, voxels.visibleDynamic.opaque.buffer.direct, MappedVoxels_Opaque - voxels.visibleDynamic.opaque.buffer.direct, voxels.visibleDynamic.opaque.bits); },
+					[&] { count_trans = StreamCompaction<VertexDecl::VoxelDynamic, Volumetric::dynamic_direct_buffer_size>(host_trans, voxels.visibleDynamic.trans.buffer.direct, MappedVoxels_Trans - voxels.visibleDynamic.trans.buffer.direct, voxels.visibleDynamic.trans.bits); },
+					[&] { count_static = StreamCompaction<VertexDecl::VoxelNormal, Volumetric::static_direct_buffer_size>(host_static, voxels.visibleStatic.buffer.direct, MappedVoxels_Static - voxels.visibleStatic.buffer.direct, voxels.visibleStatic.bits); },
+					[&] { count_terrain = StreamCompaction<VertexDecl::VoxelNormal, Volumetric::terrain_direct_buffer_size>(host_terrain, voxels.visibleTerrain.buffer.direct, Volumetric::terrain_direct_buffer_size, voxels.visibleTerrain.bits); }
+				);
+
+				tTime const tCompacted(high_resolution_clock::now());
+
+				tClear += tCleared - tStart;
+				tRender += tRendered - tCleared;
+				tCompaction += tCompacted - tRendered;
+				voxel_count += count_opaque + count_trans + count_static + count_terrain;
+
+				occupancy_terrain += bitOccupancy(voxels.visibleTerrain.bits);
+				occupancy_static += bitOccupancy(voxels.visibleStatic.bits);
+				occupancy_dynamic += bitOccupancy(voxels.visibleDynamic.opaque.bits) + bitOccupancy(voxels.visibleDynamic.trans.bits);
 			}
-			{
-				// Update Dynamic VertexBuffer Offsets for "Custom Voxel Shader Children"
-				// ########### only use [Volumetric::eVoxelType::opaque] even if the child is a transparent pipeline
-				// ########### the [Volumetric::eVoxelType::trans] is reserved for voxels belong to model instances on the grid and is soley for PARENT_TRANS usage
 
-				/* do not delete, required reference for custom voxel fragment shader implementation details
-				if (_activeRain) {
+			fp_seconds const tTotal(tRender + tCompaction);
+
+			FMT_LOG(PERF_LOG, "[{:d}] ({:d}, {:d})  {:n} voxels/frame  {:.1f} Mvoxels/s  clear {:d} us  render {:d} us  compaction {:d} us",
+				position, voxelStart.x, voxelStart.y, voxel_count / BENCHMARK_ITERATIONS, (double(voxel_count) / tTotal.count()) * 1e-6,
+				duration_cast<microseconds>(tClear).count() / BENCHMARK_ITERATIONS, duration_cast<microseconds>(tRender).count() / BENCHMARK_ITERATIONS, duration_cast<microseconds>(tCompaction).count() / BENCHMARK_ITERATIONS);
+			FMT_LOG(PERF_LOG, "      occupancy  terrain {:.2f}%  static {:.2f}%  dynamic {:.2f}%",
+				100.0 * double(occupancy_terrain / BENCHMARK_ITERATIONS) / double(Volumetric::terrain_direct_buffer_size),
+				100.0 * double(occupancy_static / BENCHMARK_ITERATIONS) / double(Volumetric::static_direct_buffer_size),
+				100.0 * double(occupancy_dynamic / BENCHMARK_ITERATIONS) / double(Volumetric::dynamic_direct_buffer_size << 1));
+		}
+
+		allocator_dynamic.deallocate(host_opaque, Volumetric::dynamic_direct_buffer_size);
+		allocator_dynamic.deallocate(host_trans, Volumetric::dynamic_direct_buffer_size);
+		allocator_normal.deallocate(host_static, Volumetric::static_direct_buffer_size);
+		allocator_normal.deallocate(host_terrain, Volumetric::terrain_direct_buffer_size);
+
+		BenchmarkRenderEnd();
+	}
+#endif
+#ifdef DEBUG_BENCHMARK_FRUSTUM_CULLING
+	// frustum culling benchmark - per object tests (current path) versus batched tests (8 objects at a time), same random objects around the current view.
+	void cVoxelWorld::Benchmark_FrustumCulling() const
+	{
+		static constexpr uint32_t const BENCHMARK_ITERATIONS = 16,
+			                            BENCHMARK_BATCHES = (1 << 20) / Volumetric::sSphereBatch::WIDTH; // 1M objects
+
+		tbb::cache_aligned_allocator< Volumetric::sSphereBatch > allocator_sphere;
+		tbb::cache_aligned_allocator< Volumetric::sAABBBatch > allocator_aabb;
+
+		Volumetric::sSphereBatch* const __restrict spheres(allocator_sphere.allocate(BENCHMARK_BATCHES));
+		Volumetric::sAABBBatch* const __restrict aabbs(allocator_aabb.allocate(BENCHMARK_BATCHES));
 
-					RenderRain(_activeRain, MappedVoxels_Dynamic[Volumetric::eVoxelType::opaque]);
+		for (uint32_t batch = 0; batch < BENCHMARK_BATCHES; ++batch) {
+			for (uint32_t i = 0; i < Volumetric::sSphereBatch::WIDTH; ++i) {
+
+				// visible volume is [-SCREEN_VOXELS ... SCREEN_VOXELS], half of the objects are outside
+				float const x((float)PsuedoRandomNumber32(-(int32_t)Iso::SCREEN_VOXELS_X, (int32_t)Iso::SCREEN_VOXELS_X)),
+					        y(-(float)PsuedoRandomNumber32(0, (int32_t)Iso::WORLD_MAX_HEIGHT)),
+					        z((float)PsuedoRandomNumber32(-(int32_t)Iso::SCREEN_VOXELS_Z, (int32_t)Iso::SCREEN_VOXELS_Z));
+
+				spheres[batch].x[i] = aabbs[batch].x[i] = x;
+				spheres[batch].y[i] = aabbs[batch].y[i] = y;
+				spheres[batch].z[i] = aabbs[batch].z[i] = z;
+
+				spheres[batch].radius[i] = Volumetric::volumetricVisibility::getVoxelRadius() * (float)PsuedoRandomNumber32(1, 8);
+				aabbs[batch].extent_x[i] = (float)PsuedoRandomNumber32(1, 16) * Iso::VOX_SIZE;
+				aabbs[batch].extent_y[i] = (float)PsuedoRandomNumber32(1, 16) * Iso::VOX_SIZE;
+				aabbs[batch].extent_z[i] = (float)PsuedoRandomNumber32(1, 16) * Iso::VOX_SIZE;
+			}
+		}
+
+		static constexpr double const object_count(double(BENCHMARK_BATCHES) * double(Volumetric::sSphereBatch::WIDTH) * double(BENCHMARK_ITERATIONS));
+
+		FMT_LOG(PERF_LOG, "frustum culling benchmark: {:d} objects x {:d} iterations", BENCHMARK_BATCHES * Volumetric::sSphereBatch::WIDTH, BENCHMARK_ITERATIONS);
+
+		{ // spheres
+			size_t visible_single(0), visible_batched(0);
+
+			tTime tStart(high_resolution_clock::now());
+			for (uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration) {
+				for (uint32_t batch = 0; batch < BENCHMARK_BATCHES; ++batch) {
+					for (uint32_t i = 0; i < Volumetric::sSphereBatch::WIDTH; ++i) {
+						visible_single += _Visibility.SphereTestFrustum(XMVectorSet(spheres[batch].x[i], spheres[batch].y[i], spheres[batch].z[i], 0.0f), spheres[batch].radius[i]);
+					}
 				}
-				{ // RAIN
-					VertexDecl::VoxelDynamic* const __restrict MappedVoxels_Dynamic_Current = MappedVoxels_Dynamic[Volumetric::eVoxelType::opaque];
-					size_t const current_dynamic_size = MappedVoxels_Dynamic_Current - running_offset_start;
-					// set the parent / main partition info
-					dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::VOXEL_SHADER_RAIN].active_vertex_count = (uint32_t const)current_dynamic_size;
-					dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::VOXEL_SHADER_RAIN].vertex_start_offset = (uint32_t const)running_offset_size;
-					running_offset_size += current_dynamic_size;
-					running_offset_start = MappedVoxels_Dynamic_Current;
-
-	#ifdef DEBUG_RAIN_COUNT
-					if (dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::VOXEL_SHADER_RAIN].active_vertex_count) {
-						FMT_NUKLEAR_DEBUG(false, "      {:d} rain voxels being rendered", dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::VOXEL_SHADER_RAIN].active_vertex_count);
+			}
+			fp_seconds const tSingle(high_resolution_clock::now() - tStart);
+
+			tStart = high_resolution_clock::now();
+			for (uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration) {
+				for (uint32_t batch = 0; batch < BENCHMARK_BATCHES; ++batch) {
+					visible_batched += __popcnt(_Visibility.SphereTestFrustum(spheres[batch]));
+				}
+			}
+			fp_seconds const tBatched(high_resolution_clock::now() - tStart);
+
+			FMT_LOG(PERF_LOG, "sphere  single {:.1f} Mobjects/s  batched {:.1f} Mobjects/s  ({:.2f}x)  visible {:d} / {:d}",
+				(object_count / tSingle.count()) * 1e-6, (object_count / tBatched.count()) * 1e-6, tSingle.count() / tBatched.count(), visible_single / BENCHMARK_ITERATIONS, visible_batched / BENCHMARK_ITERATIONS);
+		}
+
+		{ // aabbs
+			size_t visible_single(0), visible_batched(0);
+
+			tTime tStart(high_resolution_clock::now());
+			for (uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration) {
+				for (uint32_t batch = 0; batch < BENCHMARK_BATCHES; ++batch) {
+					for (uint32_t i = 0; i < Volumetric::sAABBBatch::WIDTH; ++i) {
+						visible_single += _Visibility.AABBTestFrustum(XMVectorSet(aabbs[batch].x[i], aabbs[batch].y[i], aabbs[batch].z[i], 0.0f), 
+							                                          XMVectorSet(aabbs[batch].extent_x[i], aabbs[batch].extent_y[i], aabbs[batch].extent_z[i], 0.0f));
+					}
+				}
+			}
+			fp_seconds const tSingle(high_resolution_clock::now() - tStart);
+
+			tStart = high_resolution_clock::now();
+			for (uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration) {
+				for (uint32_t batch = 0; batch < BENCHMARK_BATCHES; ++batch) {
+					visible_batched += __popcnt(_Visibility.AABBTestFrustum(aabbs[batch]));
+				}
+			}
+			fp_seconds const tBatched(high_resolution_clock::now() - tStart);
+
+			FMT_LOG(PERF_LOG, "aabb    single {:.1f} Mobjects/s  batched {:.1f} Mobjects/s  ({:.2f}x)  visible {:d} / {:d}",
+				(object_count / tSingle.count()) * 1e-6, (object_count / tBatched.count()) * 1e-6, tSingle.count() / tBatched.count(), visible_single / BENCHMARK_ITERATIONS, visible_batched / BENCHMARK_ITERATIONS);
+		}
+
+		allocator_sphere.deallocate(spheres, BENCHMARK_BATCHES);
+		allocator_aabb.deallocate(aabbs, BENCHMARK_BATCHES);
+	}
+#endif
+#ifdef DEBUG_BENCHMARK_MODEL_RENDER
+	// model render benchmark - every loaded model is rendered at the center of the visible volume with the packed path and the SoA (wide) path.
+	// output goes to the direct buffers like a normal frame, buffers are cleared afterwards.
+	void cVoxelWorld::Benchmark_ModelRender()
+	{
+		static constexpr uint32_t const BENCHMARK_ITERATIONS = 32;
+
+		BenchmarkRenderBegin();
+
+		XMVECTOR const xmOrigin(XMVectorZero()); // center of visible mini-grid
+		XMVECTOR const xmOrient(XMQuaternionRotationRollPitchYaw(0.0f, XM_PI * 0.23f, 0.0f));
+
+		auto const benchmark_models = [&](auto& __restrict models, auto const create_instance, std::string_view const label) {
+
+			size_t voxel_count(0), model_count(0);
+			nanoseconds tPacked{}, tStreams{};
+
+			for (auto const& model : models) {
+
+				if (!model._Streams.valid()) // only models that have both representations are compared
+					continue;
+
+				auto* const __restrict instance(create_instance(model));
+				uint32_t const vxl_count(instance->getCount());
+
+				for (uint32_t path = 0; path < 2; ++path) {
+
+					tTime const tStart(high_resolution_clock::now());
+
+					for (uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration) {
+
+						std::atomic<VertexDecl::VoxelNormal*> MappedVoxels_Static(voxels.visibleStatic.buffer.direct);
+						std::atomic<VertexDecl::VoxelDynamic*> MappedVoxels_Opaque(voxels.visibleDynamic.opaque.buffer.direct);
+						std::atomic<VertexDecl::VoxelDynamic*> MappedVoxels_Trans(voxels.visibleDynamic.trans.buffer.direct);
+
+						Volumetric::voxelBufferReference_Static statics(MappedVoxels_Static, voxels.visibleStatic.buffer.direct, voxels.visibleStatic.bits);
+						Volumetric::voxelBufferReference_Dynamic dynamics(MappedVoxels_Opaque, voxels.visibleDynamic.opaque.buffer.direct, voxels.visibleDynamic.opaque.bits);
+						Volumetric::voxelBufferReference_Dynamic trans(MappedVoxels_Trans, voxels.visibleDynamic.trans.buffer.direct, voxels.visibleDynamic.trans.bits);
+
+						tbb::affinity_partitioner part{};
+
+						if (0 == path) {
+							model.template Render<false, false, true>(xmOrigin, xmOrient, *instance, statics, dynamics, trans, part);
+						}
+						else {
+							model.template Render<false, false, false>(xmOrigin, xmOrient, *instance, statics, dynamics, trans, part);
+						}
+					}
+
+					nanoseconds const tElapsed(high_resolution_clock::now() - tStart);
+					if (0 == path) {
+						tPacked += tElapsed;
 					}
 					else {
-						FMT_NUKLEAR_DEBUG_OFF();
+						tStreams += tElapsed;
 					}
-	#endif
+				}
+
+				voxel_count += size_t(vxl_count) * BENCHMARK_ITERATIONS;
+				++model_count;
+
+				delete instance;
+			}
+
+			fp_seconds const fPacked(tPacked), fStreams(tStreams);
+
+			FMT_LOG(PERF_LOG, "{:s} models ({:d})  {:n} voxels  packed {:.1f} Mvoxels/s  streams {:.1f} Mvoxels/s  ({:.2f}x)",
+				label, model_count, voxel_count / BENCHMARK_ITERATIONS,
+				0.0 != fPacked.count() ? (double(voxel_count) / fPacked.count()) * 1e-6 : 0.0,
+				0.0 != fStreams.count() ? (double(voxel_count) / fStreams.count()) * 1e-6 : 0.0,
+				0.0 != fStreams.count() ? fPacked.count() / fStreams.count() : 0.0);
+		};
 
+		FMT_LOG(PERF_LOG, "model render benchmark: {:d} iterations per model per path", BENCHMARK_ITERATIONS);
+
+		benchmark_models(::_staticModels, [](Volumetric::voxB::voxelModel<Volumetric::voxB::STATIC> const& model) {
+			return(Volumetric::voxelModelInstance_Static::create(model, 0, point2D_t{}));
+		}, "static");
+
+		benchmark_models(::_dynamicModels, [](Volumetric::voxB::voxelModel<Volumetric::voxB::DYNAMIC> const& model) {
+			return(Volumetric::voxelModelInstance_Dynamic::create(model, 0, point2D_t{}));
+		}, "dynamic");
+
+		BenchmarkRenderEnd();
+	}
+#endif
+#ifdef DEBUG_BENCHMARK_MODEL_LOD
+	// model level of detail benchmark - every model that has downsampled levels is rendered at the center of the visible volume at several zoom factors,
+	// once at full resolution and once at the level selected for the zoom factor. output goes to the direct buffers like a normal frame, buffers are cleared afterwards.
+	void cVoxelWorld::Benchmark_ModelLOD()
+	{
+		static constexpr uint32_t const BENCHMARK_ITERATIONS = 32;
+		static constexpr float const BENCHMARK_ZOOM[]{ Globals::DEFAULT_ZOOM_SCALAR, Globals::DEFAULT_ZOOM_SCALAR * 2.0f, Globals::DEFAULT_ZOOM_SCALAR * 3.0f, Globals::MIN_ZOOM_FACTOR };
+
+		BenchmarkRenderBegin();
+
+		XMVECTOR const xmOrigin(XMVectorZero()); // center of visible mini-grid
+		XMVECTOR const xmOrient(XMQuaternionRotationRollPitchYaw(0.0f, XM_PI * 0.23f, 0.0f));
+
+		struct {
+			size_t      voxels_full, voxels_lod;
+			nanoseconds tFull, tLOD;
+		} results[_countof(BENCHMARK_ZOOM)]{};
+
+		size_t model_count(0);
+
+		auto const benchmark_models = [&](auto& __restrict models, auto const create_instance) {
+
+			for (auto const& model : models) {
+
+				if (!model._LOD[0].valid()) // only models that have downsampled levels are compared
+					continue;
+
+				auto* const __restrict instance(create_instance(model));
+
+				for (uint32_t zoom = 0; zoom < _countof(BENCHMARK_ZOOM); ++zoom) {
+
+					uint32_t const lod(model.selectLOD(BENCHMARK_ZOOM[zoom]));
+
+					for (uint32_t path = 0; path < 2; ++path) {
+
+						uint32_t const path_lod(0 == path ? 0 : lod);
+
+						tTime const tStart(high_resolution_clock::now());
+
+						for (uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration) {
+
+							std::atomic<VertexDecl::VoxelNormal*> MappedVoxels_Static(voxels.visibleStatic.buffer.direct);
+							std::atomic<VertexDecl::VoxelDynamic*> MappedVoxels_Opaque(voxels.visibleDynamic.opaque.buffer.direct);
+							std::atomic<VertexDecl::VoxelDynamic*> MappedVoxels_Trans(voxels.visibleDynamic.trans.buffer.direct);
+
+							Volumetric::voxelBufferReference_Static statics(MappedVoxels_Static, voxels.visibleStatic.buffer.direct, voxels.visibleStatic.bits);
+							Volumetric::voxelBufferReference_Dynamic dynamics(MappedVoxels_Opaque, voxels.visibleDynamic.opaque.buffer.direct, voxels.visibleDynamic.opaque.bits);
+							Volumetric::voxelBufferReference_Dynamic trans(MappedVoxels_Trans, voxels.visibleDynamic.trans.buffer.direct, voxels.visibleDynamic.trans.bits);
+
+							tbb::affinity_partitioner part{};
+
+							model.template Render<false, false>(xmOrigin, xmOrient, *instance, statics, dynamics, trans, part, path_lod);
+						}
+
+						nanoseconds const tElapsed(high_resolution_clock::now() - tStart);
+						size_t const vxl_count(0 == path_lod ? instance->getCount() : model._LOD[path_lod - 1].numVoxels);
+
+						if (0 == path) {
+							results[zoom].tFull += tElapsed;
+							results[zoom].voxels_full += vxl_count;
+						}
+						else {
+							results[zoom].tLOD += tElapsed;
+							results[zoom].voxels_lod += vxl_count;
+						}
+					}
 				}
-				*/
-				// todo add other children here for added partitions of dynamic voxel parent
-			}
-			{ // dynamic (transparents) ***MUST BE LAST DYNAMIC***
-				VertexDecl::VoxelDynamic* const MappedVoxels_Dynamic_End = MappedVoxels_Dynamic[Volumetric::eVoxelType::trans];
-				size_t activeSize = MappedVoxels_Dynamic_End - MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::trans];
-				voxels.visibleDynamic.trans.buffer.active_size = activeSize * sizeof(VertexDecl::VoxelDynamic); // direct buffer size
-
-				VertexDecl::VoxelDynamic* const __restrict Mapped_Staging_Voxels_Dynamic_Start = (VertexDecl::VoxelDynamic* const __restrict)voxels.visibleDynamic.trans.buffer.staging[resource_index].map();
-				//___memcpy_threaded<32>(Mapped_Staging_Voxels_Dynamic_Start, MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::trans], bytes);
-				activeSize = StreamCompaction<VertexDecl::VoxelDynamic, Volumetric::dynamic_direct_buffer_size>(Mapped_Staging_Voxels_Dynamic_Start, MappedVoxels_Dynamic_Start[Volumetric::eVoxelType::trans],
-					                                                                                            activeSize, voxels.visibleDynamic.trans.bits);
-				
-				voxels.visibleDynamic.trans.buffer.staging[resource_index].unmap();
-				voxels.visibleDynamic.trans.buffer.staging[resource_index].setActiveSizeBytes(activeSize * sizeof(VertexDecl::VoxelDynamic)); // staging buffer size
 
-				// set the parent / main partition info
-				dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::PARENT_TRANS].active_vertex_count = (uint32_t const)activeSize;
-				dynamic_partition_info_updater[eVoxelDynamicVertexBufferPartition::PARENT_TRANS].vertex_start_offset = (uint32_t const)running_offset_size;  // special handling injecting transparents into opaque / main part
-#ifdef DEBUG_VOXEL_BANDWIDTH
-				voxel_count += activeSize;
+				++model_count;
+
+				delete instance;
+			}
+		};
+
+		FMT_LOG(PERF_LOG, "model lod benchmark: {:d} iterations per model per zoom", BENCHMARK_ITERATIONS);
+
+		benchmark_models(::_staticModels, [](Volumetric::voxB::voxelModel<Volumetric::voxB::STATIC> const& model) {
+			return(Volumetric::voxelModelInstance_Static::create(model, 0, point2D_t{}));
+		});
+
+		benchmark_models(::_dynamicModels, [](Volumetric::voxB::voxelModel<Volumetric::voxB::DYNAMIC> const& model) {
+			return(Volumetric::voxelModelInstance_Dynamic::create(model, 0, point2D_t{}));
+		});
+
+		BenchmarkRenderEnd();
+
+		for (uint32_t zoom = 0; zoom < _countof(BENCHMARK_ZOOM); ++zoom) {
+
+			fp_seconds const fFull(results[zoom].tFull), fLOD(results[zoom].tLOD);
+
+			// voxels & times are per frame of all models
+			FMT_LOG(PERF_LOG, "zoom {:.2f}x  models ({:d})  full {:n} voxels {:.3f} ms  lod {:n} voxels {:.3f} ms  ({:.2f}x)",
+				BENCHMARK_ZOOM[zoom] / Globals::DEFAULT_ZOOM_SCALAR, model_count,
+				results[zoom].voxels_full, (fFull.count() * 1000.0) / BENCHMARK_ITERATIONS,
+				results[zoom].voxels_lod, (fLOD.count() * 1000.0) / BENCHMARK_ITERATIONS,
+				0.0 != fLOD.count() ? fFull.count() / fLOD.count() : 0.0);
+		}
+	}
 #endif
+#ifdef DEBUG_BENCHMARK_VOXEL_EVENTS
+	// voxel event benchmark - every live dynamic instance with a batched voxel event (cars, signage, ...) is rendered at the center of the visible volume,
+	// once with the event driven one voxel at a time (an indirect call per voxel, as before batching) and once batched.
+	// waits until the scene is busy enough, returns false until it has run. buffers are cleared afterwards.
+	bool const cVoxelWorld::Benchmark_VoxelEvents()
+	{
+		static constexpr uint32_t const BENCHMARK_ITERATIONS = 32,
+										BENCHMARK_MIN_INSTANCES = 64;
+
+		vector<Volumetric::voxelModelInstance_Dynamic*> instances;
+		size_t voxel_count(0);
+
+		for (auto const& instance : _hshVoxelModelInstances_Dynamic) { // contiguous, live instances only
+
+			if (instance.value && instance.value->hasVoxelBatchEvent()) {
+				instances.emplace_back(instance.value);
+				voxel_count += instance.value->getCount();
 			}
-		},
+		}
 
-		[&]{ // static
-			VertexDecl::VoxelNormal const* const MappedVoxels_Static_End = MappedVoxels_Static;
-			size_t activeSize = MappedVoxels_Static_End - MappedVoxels_Static_Start;
-			voxels.visibleStatic.buffer.active_size = activeSize * sizeof(VertexDecl::VoxelNormal); // direct buffer size
+		if (instances.size() < BENCHMARK_MIN_INSTANCES)
+			return(false);
 
-			VertexDecl::VoxelNormal* const __restrict Mapped_Staging_Voxels_Static_Start = (VertexDecl::VoxelNormal* const __restrict)voxels.visibleStatic.buffer.staging[resource_index].map();
-			//___memcpy_threaded<32>(Mapped_Staging_Voxels_Static_Start, MappedVoxels_Static_Start, activeSize * sizeof(VertexDecl::VoxelNormal));
-			activeSize = StreamCompaction<VertexDecl::VoxelNormal, Volumetric::static_direct_buffer_size>(Mapped_Staging_Voxels_Static_Start, MappedVoxels_Static_Start,
-				                                                                                          activeSize, voxels.visibleStatic.bits);
-			voxels.visibleStatic.buffer.staging[resource_index].unmap();
-			voxels.visibleStatic.buffer.staging[resource_index].setActiveSizeBytes(activeSize * sizeof(VertexDecl::VoxelNormal)); // staging buffer size
-			
-#ifdef DEBUG_VOXEL_BANDWIDTH
-			voxel_count += activeSize;
-#endif 
-		},
+		BenchmarkRenderBegin();
 
-		[&]{ // terrain
-			voxels.visibleTerrain.buffer.active_size = Volumetric::terrain_direct_buffer_size * sizeof(VertexDecl::VoxelNormal); // direct buffer size
+		XMVECTOR const xmOrigin(XMVectorZero()); // center of visible mini-grid
+		XMVECTOR const xmOrient(XMQuaternionRotationRollPitchYaw(0.0f, XM_PI * 0.23f, 0.0f));
 
-			VertexDecl::VoxelNormal* const __restrict Mapped_Staging_Voxels_Terrain_Start = (VertexDecl::VoxelNormal* const __restrict)voxels.visibleTerrain.buffer.staging[resource_index].map();
-			///___memcpy_threaded<32>(Mapped_Staging_Voxels_Terrain_Start, MappedVoxels_Terrain_Start, bytes);
-			size_t const activeSize = StreamCompaction<VertexDecl::VoxelNormal, Volumetric::terrain_direct_buffer_size>(Mapped_Staging_Voxels_Terrain_Start, MappedVoxels_Terrain_Start,
-				                                                                                                        Volumetric::terrain_direct_buffer_size, voxels.visibleTerrain.bits);
-			voxels.visibleTerrain.buffer.staging[resource_index].unmap();
-			voxels.visibleTerrain.buffer.staging[resource_index].setActiveSizeBytes(activeSize * sizeof(VertexDecl::VoxelNormal)); // staging buffer size
-			
-#ifdef DEBUG_VOXEL_BANDWIDTH
-			voxel_count += activeSize;
+		nanoseconds tPath[2]{}; // per voxel, batched
+
+		for (uint32_t path = 0; path < 2; ++path) {
+
+			for (auto* const instance : instances) {
+				instance->setPerVoxelEvents(0 == path);
+			}
+
+			tTime const tStart(high_resolution_clock::now());
+
+			for (uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration) {
+
+				std::atomic<VertexDecl::VoxelNormal*> MappedVoxels_Static(voxels.visibleStatic.buffer.direct);
+				std::atomic<VertexDecl::VoxelDynamic*> MappedVoxels_Opaque(voxels.visibleDynamic.opaque.buffer.direct);
+				std::atomic<VertexDecl::VoxelDynamic*> MappedVoxels_Trans(voxels.visibleDynamic.trans.buffer.direct);
+
+				Volumetric::voxelBufferReference_Static statics(MappedVoxels_Static, voxels.visibleStatic.buffer.direct, voxels.visibleStatic.bits);
+				Volumetric::voxelBufferReference_Dynamic dynamics(MappedVoxels_Opaque, voxels.visibleDynamic.opaque.buffer.direct, voxels.visibleDynamic.opaque.bits);
+				Volumetric::voxelBufferReference_Dynamic trans(MappedVoxels_Trans, voxels.visibleDynamic.trans.buffer.direct, voxels.visibleDynamic.trans.bits);
+
+				tbb::affinity_partitioner part{};
+
+				for (auto const* const instance : instances) {
+					instance->getModel().Render<false, false>(xmOrigin, xmOrient, *instance, statics, dynamics, trans, part);
+				}
+			}
+
+			tPath[path] = high_resolution_clock::now() - tStart;
+		}
+
+		for (auto* const instance : instances) {
+			instance->setPerVoxelEvents(false);
+		}
+
+		BenchmarkRenderEnd();
+
+		fp_seconds const fPerVoxel(tPath[0]), fBatched(tPath[1]);
+
+		// times are per frame of all instances
+		FMT_LOG(PERF_LOG, "voxel event benchmark: {:d} instances {:n} voxels  per voxel {:.3f} ms  batched {:.3f} ms  ({:.2f}x)",
+			instances.size(), voxel_count,
+			(fPerVoxel.count() * 1000.0) / BENCHMARK_ITERATIONS,
+			(fBatched.count() * 1000.0) / BENCHMARK_ITERATIONS,
+			0.0 != fBatched.count() ? fPerVoxel.count() / fBatched.count() : 0.0);
+
+		return(true);
+	}
 #endif
+#ifdef DEBUG_BENCHMARK_INSTANCE_LOOKUP
+	// instance lookup benchmark - slot map (current) versus the concurrent_unordered_map it replaced, same keys and same random access sequence.
+	// standalone containers, the world instance maps are not touched. Instance pointers are fake and never dereferenced.
+	void cVoxelWorld::Benchmark_InstanceLookup() const
+	{
+		static constexpr uint32_t const BENCHMARK_COUNTS[] = { 10000, 100000, 1000000 },
+			                            BENCHMARK_LOOKUPS = (1 << 22),
+			                            BENCHMARK_CHURN = (1 << 18),
+			                            BENCHMARK_ITERATED = (1 << 24); // total entries visited per container
+
+		using instance_t = Volumetric::voxelModelInstance_Static*;
+		using unordered_map = tbb::concurrent_unordered_map<uint32_t const, instance_t>;
+
+		auto const make_key = [](uint32_t const i) { return(uint32_t(i + 1) * 0x9e3779b1u); }; // odd multiplier is a bijection, unique & never zero
+		auto const make_instance = [](uint32_t const key) { return(reinterpret_cast<instance_t>(uintptr_t(key) << 4u)); };
+
+		FMT_LOG(PERF_LOG, "instance lookup benchmark: {:d} lookups, {:d} erase/insert pairs, {:d} entries iterated", BENCHMARK_LOOKUPS, BENCHMARK_CHURN, BENCHMARK_ITERATED);
+
+		for (uint32_t const count : BENCHMARK_COUNTS) {
+
+			vector<uint32_t> lookups(BENCHMARK_LOOKUPS), churn(BENCHMARK_CHURN);
+			for (auto& index : lookups) {
+				index = make_key(PsuedoRandomNumber32(0, count - 1));
+			}
+			for (auto& index : churn) {
+				index = PsuedoRandomNumber32(0, count - 1);
+			}
+			uint32_t const passes(std::max(1u, BENCHMARK_ITERATED / count));
+
+			fp_seconds tInsert[2]{}, tLookup[2]{}, tChurn[2]{}, tIterate[2]{};
+			uintptr_t checksum[2]{};
+
+			{ // slot map
+				mapVoxelModelInstancesStatic* __restrict map(new mapVoxelModelInstancesStatic);
+				vector<uint32_t> keys(count);
+
+				tTime tStart(high_resolution_clock::now());
+				for (uint32_t i = 0; i < count; ++i) {
+					keys[i] = make_key(i);
+					(*map)[keys[i]] = make_instance(keys[i]);
+				}
+				tInsert[0] = high_resolution_clock::now() - tStart;
+
+				tStart = high_resolution_clock::now();
+				for (uint32_t const key : lookups) {
+					checksum[0] += uintptr_t(*map->find(key));
+				}
+				tLookup[0] = high_resolution_clock::now() - tStart;
+
+				tStart = high_resolution_clock::now();
+				for (uint32_t pass = 0; pass < passes; ++pass) {
+					for (auto const& instance : *map) {
+						checksum[0] += uintptr_t(instance.value);
+					}
+				}
+				tIterate[0] = high_resolution_clock::now() - tStart;
+
+				tStart = high_resolution_clock::now();
+				for (uint32_t i = 0; i < BENCHMARK_CHURN; ++i) {
+					uint32_t& key(keys[churn[i]]);
+					map->erase(key);
+					key = make_key(count + i);
+					(*map)[key] = make_instance(key);
+				}
+				tChurn[0] = high_resolution_clock::now() - tStart;
+
+				SAFE_DELETE(map);
+			}
+
+			{ // concurrent_unordered_map
+				unordered_map* __restrict map(new unordered_map);
+				vector<uint32_t> keys(count);
+
+				tTime tStart(high_resolution_clock::now());
+				for (uint32_t i = 0; i < count; ++i) {
+					keys[i] = make_key(i);
+					(*map)[keys[i]] = make_instance(keys[i]);
+				}
+				tInsert[1] = high_resolution_clock::now() - tStart;
+
+				tStart = high_resolution_clock::now();
+				for (uint32_t const key : lookups) {
+					checksum[1] += uintptr_t(map->find(key)->second);
+				}
+				tLookup[1] = high_resolution_clock::now() - tStart;
+
+				tStart = high_resolution_clock::now();
+				for (uint32_t pass = 0; pass < passes; ++pass) {
+					for (auto const& instance : *map) {
+						checksum[1] += uintptr_t(instance.second);
+					}
+				}
+				tIterate[1] = high_resolution_clock::now() - tStart;
+
+				tStart = high_resolution_clock::now();
+				for (uint32_t i = 0; i < BENCHMARK_CHURN; ++i) {
+					uint32_t& key(keys[churn[i]]);
+					map->unsafe_erase(key);
+					key = make_key(count + i);
+					(*map)[key] = make_instance(key);
+				}
+				tChurn[1] = high_resolution_clock::now() - tStart;
+
+				SAFE_DELETE(map);
+			}
+
+			auto const mops = [](double const ops, fp_seconds const& t) { return(0.0 != t.count() ? (ops / t.count()) * 1e-6 : 0.0); };
+
+			FMT_LOG(PERF_LOG, "{:n} instances  slot map / unordered map  (Mops/s)", count);
+			FMT_LOG(PERF_LOG, "    insert  {:.1f} / {:.1f}  ({:.2f}x)", mops(count, tInsert[0]), mops(count, tInsert[1]), tInsert[1].count() / tInsert[0].count());
+			FMT_LOG(PERF_LOG, "    lookup  {:.1f} / {:.1f}  ({:.2f}x)", mops(BENCHMARK_LOOKUPS, tLookup[0]), mops(BENCHMARK_LOOKUPS, tLookup[1]), tLookup[1].count() / tLookup[0].count());
+			FMT_LOG(PERF_LOG, "    churn   {:.1f} / {:.1f}  ({:.2f}x)", mops(BENCHMARK_CHURN, tChurn[0]), mops(BENCHMARK_CHURN, tChurn[1]), tChurn[1].count() / tChurn[0].count());
+			FMT_LOG(PERF_LOG, "    iterate {:.1f} / {:.1f}  ({:.2f}x)", mops(double(passes) * count, tIterate[0]), mops(double(passes) * count, tIterate[1]), tIterate[1].count() / tIterate[0].count());
+
+			if (checksum[0] != checksum[1]) {
+				FMT_LOG_FAIL(PERF_LOG, "instance lookup benchmark checksum mismatch {:d} != {:d}", checksum[0], checksum[1]);
+			}
 		}
-	   ); // end parallel_invoke
-#ifdef DEBUG_VOXEL_BANDWIDTH
-		frameBandwidth(high_resolution_clock::now(), voxel_count);
+	}
 #endif
+#ifdef DEBUG_BENCHMARK_DIRTY_REGIONS
+	// edit to visible cost of height edits in the visible area - single voxel, road stroke and large area. incremental: the edit, the dirty region update
+	// (ground adjacency invalidation & picking pyramid) and then the visible ground as RenderGround reads it (cached). full: the same edit with the
+	// visible ground adjacency recomputed for every voxel and the picking pyramid rebuilt. the original heights are restored afterwards.
+	void cVoxelWorld::Benchmark_DirtyRegions() const
+	{
+		static constexpr uint32_t const ITERATIONS = 16,
+										ROAD_LENGTH = 128,
+										ROAD_WIDTH = 3,
+										AREA_SIZE = 256;
+
+		cVoxelWorld* const __restrict world(const_cast<cVoxelWorld* const>(this));
+
+		rect2D_t const visible(getVisibleGridBounds());
+		point2D_t const center(visible.center());
+
+		typedef struct sEdit {
+			char const*			name;
+			vector<point2D_t>	voxels;	// Grid Space (-x,-y) to (X, Y)
+		} edit;
+
+		edit edits[3]{ { "single voxel" }, { "road stroke" }, { "large area" } };
+
+		edits[0].voxels.emplace_back(center);
+		for (int32_t i = -int32_t(ROAD_LENGTH >> 1); i < int32_t(ROAD_LENGTH >> 1); ++i) {
+			for (int32_t w = 0; w < int32_t(ROAD_WIDTH); ++w) {
+				edits[1].voxels.emplace_back(p2D_add(center, point2D_t(i, (i >> 1) + w - int32_t(ROAD_WIDTH >> 1)))); // diagonal, crosses tiles in both x & y
+			}
+		}
+		for (int32_t y = -int32_t(AREA_SIZE >> 1); y < int32_t(AREA_SIZE >> 1); ++y) {
+			for (int32_t x = -int32_t(AREA_SIZE >> 1); x < int32_t(AREA_SIZE >> 1); ++x) {
+				edits[2].voxels.emplace_back(p2D_add(center, point2D_t(x, y)));
+			}
+		}
+
+		// the visible ground, as RenderGround reads it
+		auto const visible_ground = [&](bool const bCached) {
+			uint32_t checksum(0);
+			for (int32_t y = visible.top; y <= visible.bottom; ++y) {
+				for (int32_t x = visible.left; x <= visible.right; ++x) {
+					point2D_t const voxelIndex(getLocalVoxelIndexAt(point2D_t(x, y)));
+					checksum += (bCached ? groundAdjacencyCached(voxelIndex) : groundHashAdjacency(voxelIndex));
+				}
+			}
+			return(checksum);
+		};
+
+		FMT_LOG(PERF_LOG, "dirty region benchmark: {:d} iterations, visible area {:d}x{:d}", ITERATIONS, visible.width_height().x, visible.width_height().y);
+
+		picking::create(); // the incremental update only maintains a built pyramid
+		world->UpdateDirtyRegions(); // start clean
+		visible_ground(true);
+
+		for (edit const& e : edits) {
+
+			vector<uint32_t> original;
+			original.reserve(e.voxels.size());
+			for (point2D_t const voxelIndex : e.voxels) {
+				original.emplace_back(getVoxelHeightAt(voxelIndex));
+			}
+
+			auto const apply = [&](uint32_t const iteration) {
+				for (size_t i = 0; i < e.voxels.size(); ++i) {
+					setVoxelHeightAt(e.voxels[i], std::min(uint32_t(UINT16_MAX), original[i] + ((iteration + 1) << 6u)));
+				}
+			};
+
+			fp_seconds tEdit{}, tUpdate{}, tVisible{}, tFullUpdate{}, tFullVisible{};
+			size_t regions(0);
+			uint32_t checksum[2]{};
+
+			for (uint32_t iteration = 0; iteration < ITERATIONS; ++iteration) {
+
+				tTime tStart(high_resolution_clock::now());
+				apply(iteration);
+				tEdit += high_resolution_clock::now() - tStart;
+
+				tStart = high_resolution_clock::now();
+				world->UpdateDirtyRegions();
+				tUpdate += high_resolution_clock::now() - tStart;
+				regions += _dirtyRegions.size();
+
+				tStart = high_resolution_clock::now();
+				checksum[0] += visible_ground(true);
+				tVisible += high_resolution_clock::now() - tStart;
+			}
+
+			for (uint32_t iteration = 0; iteration < ITERATIONS; ++iteration) {
+
+				apply(iteration);
+				world->_streamingGrid.TakeDirtyRegions(world->_dirtyRegions); // discarded, everything is recomputed
+
+				tTime tStart(high_resolution_clock::now());
+				picking::create();
+				tFullUpdate += high_resolution_clock::now() - tStart;
+
+				tStart = high_resolution_clock::now();
+				checksum[1] += visible_ground(false);
+				tFullVisible += high_resolution_clock::now() - tStart;
+			}
+
+			// restore
+			for (size_t i = 0; i < e.voxels.size(); ++i) {
+				setVoxelHeightAt(e.voxels[i], original[i]);
+			}
+			world->UpdateDirtyRegions();
+
+			double const ms(1000.0 / double(ITERATIONS));
+			FMT_LOG(PERF_LOG, "  {:s} ({:d} voxels, {:.1f} regions)  edit {:.3f} ms  dirty update {:.3f} ms  visible ground {:.3f} ms  edit to visible {:.3f} ms  vs. full {:.3f} ms",
+				e.name, e.voxels.size(), double(regions) / double(ITERATIONS),
+				tEdit.count() * ms, tUpdate.count() * ms, tVisible.count() * ms,
+				(tEdit + tUpdate + tVisible).count() * ms, (tEdit + tFullUpdate + tFullVisible).count() * ms);
+
+			if (checksum[0] != checksum[1]) {
+				FMT_LOG_FAIL(PERF_LOG, "  {:s} cached ground adjacency differs from full recompute", e.name);
+			}
+		}
 	}
+#endif
+
 #ifndef NDEBUG // revert optimizations - affects debug builds only
 #pragma optimize( "", off )
 #endif
@@ -3679,8 +4704,21 @@ namespace world
 
 	void cVoxelWorld::Render(uint32_t const resource_index) const
 	{
+#ifdef DEBUG_BENCHMARK
+		if (!MinCity::isGraduallyStartingUp()) {
+			benchmarks::run(); // each registered benchmark runs once, see Initialize()
+		}
+#endif
 		RenderTask_Normal(resource_index);
 	}
+	void cVoxelWorld::RenderHeadless() const
+	{
+		// the stages of RenderTask_Normal that are not rendering, no benchmarks either (they use the direct buffers)
+		MinCity::VoxelWorld->GarbageCollect();
+		MinCity::VoxelWorld->UpdateDirtyRegions();
+		MinCity::VoxelWorld->Prefetch(oCamera.voxelIndex_TopLeft);
+		MinCity::Physics->AsyncClear(); // corresponding wait is in Update()
+	}
 	bool const cVoxelWorld::renderCompute(vku::compute_pass&& __restrict c, struct cVulkan::sCOMPUTEDATA const& __restrict render_data)
 	{
 		// texture shaders [[deprecated]]
@@ -4254,7 +5292,14 @@ namespace world
 	void cVoxelWorld::PreUpdate(bool const bPaused) // *** timing is unreliable in this function, do not use time in this function
 	{
 		// special input handling (required every frame) //
+		if (replay::isReplaying() || replay::isHeadless()) // hover raycast depends on the gpu readback, the journaled hover is injected instead (no readback at all headless)
+			return;
+
+		point2D_t const voxelIndexHoverLast(_voxelIndexHover);
 		HoverVoxel();
+		if (voxelIndexHoverLast != _voxelIndexHover) {
+			replay::Input(replay::eInput::HOVER, _voxelIndexHover.x, _voxelIndexHover.y);
+		}
 	}
 	bool const cVoxelWorld::UpdateOnce(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta, bool const bPaused)
 	{
@@ -4270,23 +5315,19 @@ namespace world
 
 			{ // static instance validation
 
-				using static_unordered_map = tbb::concurrent_unordered_map<uint32_t const, Volumetric::voxelModelInstance_Static*>;
-				for (static_unordered_map::const_iterator iter = _hshVoxelModelInstances_Static.cbegin();
-					iter != _hshVoxelModelInstances_Static.cend(); ++iter) {
+				for (auto const& instance : _hshVoxelModelInstances_Static) { // contiguous, live instances only
 
-					if (iter->second) {
-						iter->second->Validate();
+					if (instance.value) {
+						instance.value->Validate();
 					}
 				}
 			}
 			{ // dynamic instance validation
 
-				using dynamic_unordered_map = tbb::concurrent_unordered_map<uint32_t const, Volumetric::voxelModelInstance_Dynamic*>;
-				for (dynamic_unordered_map::const_iterator iter = _hshVoxelModelInstances_Dynamic.cbegin();
-					iter != _hshVoxelModelInstances_Dynamic.cend(); ++iter) {
+				for (auto const& instance : _hshVoxelModelInstances_Dynamic) { // contiguous, live instances only
 
-					if (iter->second) {
-						iter->second->Validate();
+					if (instance.value) {
+						instance.value->Validate();
 					}
 				}
 			}
@@ -5055,7 +6096,7 @@ namespace world
 
 				if (DeleteModelInstance_Static) { // if found static instance first remove from the lookup map
 
-					_hshVoxelModelInstances_Static[hash] = nullptr; // release ownership
+					*_hshVoxelModelInstances_Static.find(hash) = nullptr; // release ownership (slot is stable, any game object aliasing it sees nullptr)
 
 					rect2D_t const vLocalArea(DeleteModelInstance_Static->getModel()._LocalArea);
 
@@ -5079,7 +6120,7 @@ namespace world
 
 						if (DeleteModelInstance_Dynamic) {
 
-							_hshVoxelModelInstances_Dynamic[hash] = nullptr; // release ownership
+							*_hshVoxelModelInstances_Dynamic.find(hash) = nullptr; // release ownership (slot is stable, any game object aliasing it sees nullptr)
 
 							rect2D_t const vLocalArea(DeleteModelInstance_Dynamic->getModel()._LocalArea);
 
@@ -5117,11 +6158,11 @@ namespace world
 				if (0 != info.hash) { // sanity check
 
 					// erased // **** can only be done serially, no concurrent operations on maps can be happening ****
-					_hshVoxelModelRootIndex.unsafe_erase(info.hash); // does another search but is safer as iterators can become invalid if concurrent operations exist (they should NOT exist when calling this function)
+					_hshVoxelModelRootIndex.erase(info.hash); // tombstones the index entry and swaps the last live slot into the dense hole, no concurrent operations can exist when calling this function
 
 					if (info.dynamic) {
 						// erased // **** can only be done serially, no concurrent operations on maps can be happening ****
-						_hshVoxelModelInstances_Dynamic.unsafe_erase(info.hash); // does another search but is safer as iterators can become invalid if concurrent operations exist (they should NOT exist when calling this function)
+						_hshVoxelModelInstances_Dynamic.erase(info.hash); // tombstones the index entry and swaps the last live slot into the dense hole, no concurrent operations can exist when calling this function
 
 						// clear old area of the hash id only, this will also clear the owner/root voxel
 						world::resetVoxelsHashAt(info.area, info.hash, info.vR);
@@ -5131,7 +6172,7 @@ namespace world
 					}
 					else {
 						// erased // **** can only be done serially, no concurrent operations on maps can be happening ****
-						_hshVoxelModelInstances_Static.unsafe_erase(info.hash); // does another search but is safer as iterators can become invalid if concurrent operations exist (they should NOT exist when calling this function)
+						_hshVoxelModelInstances_Static.erase(info.hash); // tombstones the index entry and swaps the last live slot into the dense hole, no concurrent operations can exist when calling this function
 
 						// clear old area of the hash id only, this will also clear the owner/root voxel
 						world::resetVoxelsHashAt(info.area, info.hash);
@@ -5153,14 +6194,14 @@ namespace world
 		// cleanup all registered instances
 		for (auto& Instance : _hshVoxelModelInstances_Dynamic) {
 
-			auto pDel = Instance.second;
-			Instance.second = nullptr;
+			auto pDel = Instance.value;
+			Instance.value = nullptr;
 			SAFE_DELETE(pDel);
 		}
 		for (auto& Instance : _hshVoxelModelInstances_Static) {
 
-			auto pDel = Instance.second;
-			Instance.second = nullptr;
+			auto pDel = Instance.value;
+			Instance.value = nullptr;
 			SAFE_DELETE(pDel);
 		}
 	
@@ -5170,13 +6211,15 @@ namespace world
 		// Grid 
 		((StreamingGrid* const)::grid)->CleanUp();
 
-		_OpacityMap.release();
+		if (!replay::isHeadless()) { // gpu resources were never created
+			_OpacityMap.release();
 
-		for (uint32_t i = 0; i < vku::double_buffer<uint32_t>::count; ++i) {
-			voxels.visibleDynamic.opaque.buffer.staging[i].release();
-			voxels.visibleDynamic.trans.buffer.staging[i].release();
-			voxels.visibleStatic.buffer.staging[i].release();
-			voxels.visibleTerrain.buffer.staging[i].release();
+			for (uint32_t i = 0; i < vku::double_buffer<uint32_t>::count; ++i) {
+				voxels.visibleDynamic.opaque.buffer.staging[i].release();
+				voxels.visibleDynamic.trans.buffer.staging[i].release();
+				voxels.visibleStatic.buffer.staging[i].release();
+				voxels.visibleTerrain.buffer.staging[i].release();
+			}
 		}
 		if (voxels.visibleDynamic.opaque.bits) {
 			bit_row_atomic<Volumetric::dynamic_direct_buffer_size>::destroy(voxels.visibleDynamic.opaque.bits);
@@ -5211,6 +6254,8 @@ namespace world
 		}
 		*/
 
+		picking::release();
+		world::movers::clear();
 		if (_heightmap) {
 			ImagingDelete(_heightmap); _heightmap = nullptr;
 		}
@@ -5218,13 +6263,15 @@ namespace world
 			ImagingDelete(_blackbodyImage); _blackbodyImage = nullptr;
 		}
 		
-		_buffers.reset_subgroup_layer_count_max.release();
-		_buffers.reset_shared_buffer.release();
+		if (!replay::isHeadless()) {
+			_buffers.reset_subgroup_layer_count_max.release();
+			_buffers.reset_shared_buffer.release();
 
-		for (uint32_t resource_index = 0; resource_index < vku::double_buffer<uint32_t>::count; ++resource_index) {
-			
-			_buffers.subgroup_layer_count_max[resource_index].release();
-			_buffers.shared_buffer[resource_index].release();
+			for (uint32_t resource_index = 0; resource_index < vku::double_buffer<uint32_t>::count; ++resource_index) {
+
+				_buffers.subgroup_layer_count_max[resource_index].release();
+				_buffers.shared_buffer[resource_index].release();
+			}
 		}
 
 		supernoise::blue.Release();		
@@ -41,7 +41,7 @@ BETTER_ENUM(eMouseButtonState, uint32_t const,
 
 namespace world
 {
-	using mapRootIndex = tbb::concurrent_unordered_map<uint32_t const, point2D_t>;
+	using mapRootIndex = tSlotMap<point2D_t>;
 
 	struct model_state {
 		mapRootIndex const& __restrict					hshVoxelModelRootIndex;
@@ -88,6 +88,7 @@ namespace world
 		rect2D_t const __vectorcall			getVisibleGridBoundsClamped() const; // Grid Space (-x,-y) to (x, y) Coordinates Only
 		point2D_t const __vectorcall		getVisibleGridCenter() const; // Grid Space (-x,-y) to (x, y) Coordinates Only
 		point2D_t const	__vectorcall		getHoveredVoxelIndex() const { return(_voxelIndexHover); } // updated only when valid, always contains the last known good voxelIndex that is hovered by the mouse
+		void __vectorcall					setHoveredVoxelIndex(point2D_t const voxelIndex) { _voxelIndexHover = voxelIndex; } // replay only
 
 		v2_rotation_t const&				getYaw() const;
 		float const							getZoomFactor() const;
@@ -122,6 +123,8 @@ namespace world
 		void OnLoaded(tTime const& __restrict tNow);
 		void Clear();
 		void GarbageCollect(bool const bForce = false);
+		void UpdateDirtyRegions();
+		void Prefetch(point2D_t const voxelStart);
 
 		template<bool const bEnable = true> // eInputEnabledBits
 		uint32_t const InputEnable(uint32_t const bits); 
@@ -138,10 +141,12 @@ namespace world
 		void Update(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta, bool const bPaused, bool const bJustLoaded);												 //			1b.)
 		void __vectorcall UpdateUniformState(float const tRemainder);																											 //			2.)
 		void Render(uint32_t const resource_index) const;																														 //			3.)
+		void RenderHeadless() const; // replaces Render() when there is no Vulkan (-headless)
 
 		// #################
 		void NewWorld();
 		void ResetWorld();
+		void SnapshotWorld(); // main thread, captures the state SaveWorld() writes
 		void SaveWorld();
 		void LoadWorld();
 		bool const PreviewWorld(std::string_view const szCityName, CityInfo&& __restrict info, ImagingMemoryInstance* const __restrict load_thumbnail) const; // load_thumbnail is expected to be created already, of BGRA format and equal to thumbnail dimensions
@@ -300,6 +305,31 @@ namespace world
 		void OutputVoxelStats() const;
 		void RenderTask_Normal(uint32_t const resource_index) const;
 		void RenderTask_Minimap() const;
+#ifdef DEBUG_BENCHMARK_RENDER
+		void BenchmarkRenderBegin();
+		void BenchmarkRenderEnd();
+#endif
+#ifdef DEBUG_BENCHMARK_VOXEL_EMISSION
+		void Benchmark_VoxelEmission();
+#endif
+#ifdef DEBUG_BENCHMARK_FRUSTUM_CULLING
+		void Benchmark_FrustumCulling() const;
+#endif
+#ifdef DEBUG_BENCHMARK_MODEL_RENDER
+		void Benchmark_ModelRender();
+#endif
+#ifdef DEBUG_BENCHMARK_MODEL_LOD
+		void Benchmark_ModelLOD();
+#endif
+#ifdef DEBUG_BENCHMARK_VOXEL_EVENTS
+		bool const Benchmark_VoxelEvents();
+#endif
+#ifdef DEBUG_BENCHMARK_INSTANCE_LOOKUP
+		void Benchmark_InstanceLookup() const;
+#endif
+#ifdef DEBUG_BENCHMARK_DIRTY_REGIONS
+		void Benchmark_DirtyRegions() const;
+#endif
 		void GenerateGround();
 		
 		void UpdateCamera(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta);
@@ -310,8 +340,9 @@ namespace world
 		void CleanUpInstanceQueue();
 
 		// ###############
-		auto GridSnapshot() const -> std::pair<Iso::Voxel const* const __restrict, uint32_t const> const;
-		void GridSnapshotLoad(Iso::Voxel const* const __restrict new_grid);
+		bool const GridSave(std::wstring const& path);
+		bool const GridLoad(std::wstring const& path);
+		void GridLoadLegacy(Iso::Voxel const* const __restrict legacy_grid);
 		// ###############
 
 	private:
@@ -420,6 +451,9 @@ namespace world
 		world::model_state const download_model_state() const {
 			return(world::model_state( _hshVoxelModelRootIndex, _hshVoxelModelInstances_Static, _hshVoxelModelInstances_Dynamic ));
 		}
+		uint64_t const hash_grid() const { // voxels of the entire grid, see StreamingGrid::HashChunks
+			return(_streamingGrid.HashChunks());
+		}
 
 	public:
 		cVoxelWorld();
@@ -430,6 +464,7 @@ namespace world
 #endif
 
 	private:
+		vector<StreamingGrid::dirtyRegion> _dirtyRegions;
 		StreamingGrid _streamingGrid; // should be *last* member in class **********************************************************************************
 };
 
@@ -437,10 +472,7 @@ __inline point2D_t const* const __restrict cVoxelWorld::lookupVoxelModelInstance
 {
 	if (hash) {
 		// Get root voxel world coords
-		auto const iFoundIndex = _hshVoxelModelRootIndex.find(hash);
-		if (_hshVoxelModelRootIndex.cend() != iFoundIndex) {
-			return(&iFoundIndex->second);
-		}
+		return(_hshVoxelModelRootIndex.find(hash));
 	}
 	return(nullptr);
 }
@@ -448,10 +480,7 @@ __inline point2D_t * const __restrict cVoxelWorld::acquireVoxelModelInstanceRoot
 {
 	if (hash) {
 		// Get root voxel world coords
-		auto const iFoundIndex = _hshVoxelModelRootIndex.find(hash);
-		if (_hshVoxelModelRootIndex.cend() != iFoundIndex) {
-			return(&iFoundIndex->second);
-		}
+		return(_hshVoxelModelRootIndex.find(hash));
 	}
 	return(nullptr);
 }
@@ -462,9 +491,9 @@ __inline resolvedType<Dynamic, Volumetric::voxelModelInstance_Dynamic>* const __
 {
 	if (hash) {
 		// resolve model id for dimensions
-		auto const iFoundModel = _hshVoxelModelInstances_Dynamic.find(hash);
-		if (_hshVoxelModelInstances_Dynamic.cend() != iFoundModel) {
-			return(iFoundModel->second);
+		auto const* const pFoundModel = _hshVoxelModelInstances_Dynamic.find(hash);
+		if (pFoundModel) {
+			return(*pFoundModel);
 		}
 	}
 	return(nullptr);
@@ -474,9 +503,9 @@ __inline resolvedType<!Dynamic, Volumetric::voxelModelInstance_Static>* const __
 {
 	if (hash) {
 		// resolve model id for dimensions
-		auto const iFoundModel = _hshVoxelModelInstances_Static.find(hash);
-		if (_hshVoxelModelInstances_Static.cend() != iFoundModel) {
-			return(iFoundModel->second);
+		auto const* const pFoundModel = _hshVoxelModelInstances_Static.find(hash);
+		if (pFoundModel) {
+			return(*pFoundModel);
 		}
 	}
 	return(nullptr);
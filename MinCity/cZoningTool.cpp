@@ -5,6 +5,7 @@
 #include "MinCity.h"
 #include "prices.h"
 #include "gui.h"
+#include "undoJournal.h"
 
 static constexpr float const MIN_VISIBILITY = 0.95f;
 static constexpr float const GUI_HEIGHT = -100.0f;
@@ -265,7 +266,12 @@ void cZoningTool::commitZoneHistory() // commits current "zone" to grid
 	if (_ActivatedSubTool > 0) {
 		rect2D_t const finalArea(orientAreaToRect(_segmentVoxelIndex[0], _segmentVoxelIndex[1]));
 
+		undo::begin(eTools::ZONING);
+		undo::capture(finalArea);
+
 		world::zoning::zoneArea(finalArea, _ActivatedSubTool - 1);
+
+		undo::commit();
 	}
 }
 
@@ -0,0 +1,373 @@
+#include "pch.h"
+#include "codec.h"
+#include <density.h>	// https://github.com/centaurean/density - Density, fastest compression/decompression library out there with simple interface. must reproduce license file. attribution.
+
+#ifdef CODEC_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+#ifdef CODEC_ZSTD
+#include <zstd.h>
+#endif
+
+#pragma intrinsic(memcpy)
+
+namespace // private to this file (anonymous)
+{
+	static constexpr codec::selection const defaults[codec::eSite::_size_constant]{
+		{ codec::eCodec::DENSITY_CHAMELEON, 0 },	// GRID_CHUNK
+		{ codec::eCodec::DENSITY_CHEETAH, 0 },		// MODEL_CACHE
+		{ codec::eCodec::VOXEL_RLE, 0 }				// UNDO_JOURNAL
+	};
+
+	constinit static codec::selection selections[codec::eSite::_size_constant]{
+		defaults[0], defaults[1], defaults[2]
+	};
+
+	static constexpr size_t const
+		DENSITY_HEADER_SIZE = 8,		// density_header_size(), { version[3], algorithm, reserved[4] }
+		DENSITY_HEADER_ALGORITHM = 3;
+
+	// re-usable per thread context. only CHAMELEON is used with a context, CHEETAH and LION fail with "input buffer too small" when used with a context
+	static thread_local struct sDensityContext
+	{
+		density_context* context = nullptr;
+
+		density_context* const get() {
+			[[unlikely]] if (nullptr == context) {
+				context = density_alloc_context(DENSITY_ALGORITHM_CHAMELEON, false, scalable_malloc);
+			}
+			return(context);
+		}
+		~sDensityContext() {
+			if (context) {
+				density_free_context(context, scalable_free); context = nullptr;
+			}
+		}
+	} density_chameleon;
+
+#ifdef CODEC_ZSTD
+	static thread_local struct sZstdContext
+	{
+		ZSTD_CCtx* cctx = nullptr;
+		ZSTD_DCtx* dctx = nullptr;
+
+		~sZstdContext() {
+			if (cctx) {
+				ZSTD_freeCCtx(cctx); cctx = nullptr;
+			}
+			if (dctx) {
+				ZSTD_freeDCtx(dctx); dctx = nullptr;
+			}
+		}
+	} zstd;
+#endif
+
+	// VOXEL_RLE //
+	// [uint32_t bytes] [uint16_t stride] [run length stream]
+	// the records are transposed into byte planes first (byte 0 of every record, then byte 1 ...). Fields that are mostly constant or only
+	// vary slightly across neighbouring voxels become long runs. Stream: control byte c, c < 128 : c + 1 literal bytes follow, c >= 128 : next byte repeats c - 125 times (3 ... 130)
+	static constexpr size_t const
+		RLE_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint16_t),
+		RLE_MAX_LITERAL = 128,
+		RLE_MIN_REPEAT = 3,
+		RLE_MAX_REPEAT = 130;
+
+	static thread_local vector<uint8_t> rle_planes;
+
+	static size_t const rle_compress(uint8_t const* const __restrict src, size_t const bytes, uint8_t* const __restrict dst, size_t const capacity, uint32_t stride)
+	{
+		if (bytes > UINT32_MAX || capacity < RLE_HEADER_SIZE)
+			return(0);
+
+		if (0 == stride || stride > UINT16_MAX || 0 != (bytes % stride)) {
+			stride = 1;
+		}
+
+		// transpose to byte planes
+		size_t const count(bytes / stride);
+		rle_planes.resize(bytes);
+		uint8_t* const __restrict planes(rle_planes.data());
+
+		for (size_t i = 0; i < count; ++i) {
+			uint8_t const* const __restrict record(src + i * stride);
+			for (uint32_t b = 0; b < stride; ++b) {
+				planes[size_t(b) * count + i] = record[b];
+			}
+		}
+
+		uint32_t const header_bytes((uint32_t)bytes);
+		uint16_t const header_stride((uint16_t)stride);
+		memcpy(dst, &header_bytes, sizeof(header_bytes));
+		memcpy(dst + sizeof(header_bytes), &header_stride, sizeof(header_stride));
+
+		size_t o(RLE_HEADER_SIZE), i(0);
+
+		while (i < bytes) {
+
+			size_t run(1);
+			while (i + run < bytes && run < RLE_MAX_REPEAT && planes[i + run] == planes[i]) {
+				++run;
+			}
+
+			if (run >= RLE_MIN_REPEAT) {
+				if (o + 2 > capacity)
+					return(0);
+				dst[o++] = uint8_t(run + 125);
+				dst[o++] = planes[i];
+				i += run;
+				continue;
+			}
+
+			// literals until the next repeat begins
+			size_t const start(i);
+			size_t length(0);
+			while (i < bytes && length < RLE_MAX_LITERAL) {
+				if (i + 2 < bytes && planes[i] == planes[i + 1] && planes[i] == planes[i + 2])
+					break;
+				++i; ++length;
+			}
+
+			if (o + 1 + length > capacity)
+				return(0);
+			dst[o++] = uint8_t(length - 1);
+			memcpy(dst + o, planes + start, length);
+			o += length;
+		}
+
+		return(o);
+	}
+
+	static size_t const rle_decompress(uint8_t const* const __restrict src, size_t const size, uint8_t* const __restrict dst, size_t const capacity)
+	{
+		if (size < RLE_HEADER_SIZE)
+			return(0);
+
+		uint32_t bytes;
+		uint16_t stride;
+		memcpy(&bytes, src, sizeof(bytes));
+		memcpy(&stride, src + sizeof(bytes), sizeof(stride));
+
+		if (bytes > capacity || 0 == stride || 0 != (bytes % stride))
+			return(0);
+
+		// scatter the byte planes back into records while decoding
+		size_t const count(bytes / stride);
+		size_t index(0), plane(0), written(0);
+
+		auto const put = [&](uint8_t const value) {
+			dst[index * stride + plane] = value;
+			if (++index == count) {
+				index = 0;
+				++plane;
+			}
+		};
+
+		size_t i(RLE_HEADER_SIZE);
+		while (i < size && written < bytes) {
+
+			uint8_t const c(src[i++]);
+
+			if (c < RLE_MAX_LITERAL) {
+				size_t const length(size_t(c) + 1);
+				if (i + length > size || written + length > bytes)
+					return(0);
+				for (size_t l = 0; l < length; ++l) {
+					put(src[i + l]);
+				}
+				i += length;
+				written += length;
+			}
+			else {
+				size_t const length(size_t(c) - 125);
+				if (i >= size || written + length > bytes)
+					return(0);
+				uint8_t const value(src[i++]);
+				for (size_t l = 0; l < length; ++l) {
+					put(value);
+				}
+				written += length;
+			}
+		}
+
+		return(bytes == written ? written : 0);
+	}
+
+} // end ns
+
+namespace codec
+{
+	bool const available(uint32_t const codec)
+	{
+		switch (codec)
+		{
+		case eCodec::DENSITY_CHAMELEON:
+		case eCodec::DENSITY_CHEETAH:
+		case eCodec::DENSITY_LION:
+		case eCodec::VOXEL_RLE:
+			return(true);
+#ifdef CODEC_LZ4
+		case eCodec::LZ4:
+			return(true);
+#endif
+#ifdef CODEC_ZSTD
+		case eCodec::ZSTD:
+			return(true);
+#endif
+		default:
+			break;
+		}
+		return(false);
+	}
+
+	void select(uint32_t const site, uint32_t const codec, int32_t const level)
+	{
+		if (site >= eSite::_size_constant)
+			return;
+
+		if (!available(codec)) {
+			FMT_LOG_WARN(INFO_LOG, "codec {:d} is not available, {:s} uses {:s}", codec, eSite::_from_integral(site)._to_string(), name(defaults[site].codec));
+			selections[site] = defaults[site];
+			return;
+		}
+
+		selections[site] = selection{ codec, level };
+	}
+
+	selection const selected(uint32_t const site)
+	{
+		return(selections[site]);
+	}
+
+	size_t const compress_bound(uint32_t const codec, size_t const bytes)
+	{
+		switch (codec)
+		{
+		case eCodec::DENSITY_CHAMELEON:
+		case eCodec::DENSITY_CHEETAH:
+		case eCodec::DENSITY_LION:
+			return(density_compress_safe_size(bytes));
+		case eCodec::VOXEL_RLE:
+			return(RLE_HEADER_SIZE + bytes + (bytes + RLE_MAX_LITERAL - 1) / RLE_MAX_LITERAL);
+#ifdef CODEC_LZ4
+		case eCodec::LZ4:
+			return(LZ4_compressBound((int)bytes));
+#endif
+#ifdef CODEC_ZSTD
+		case eCodec::ZSTD:
+			return(ZSTD_compressBound(bytes));
+#endif
+		default:
+			break;
+		}
+		return(0);
+	}
+
+	size_t const decompress_bound(uint32_t const codec, size_t const bytes)
+	{
+		switch (codec)
+		{
+		case eCodec::DENSITY_CHAMELEON:
+		case eCodec::DENSITY_CHEETAH:
+		case eCodec::DENSITY_LION:
+			return(density_decompress_safe_size(bytes));
+		default:
+			break;
+		}
+		return(bytes); // exact
+	}
+
+	size_t const compress(selection const method, void const* const __restrict src, size_t const bytes, void* const __restrict dst, size_t const capacity, uint32_t const stride)
+	{
+		uint8_t const* const __restrict in((uint8_t const* const __restrict)src);
+		uint8_t* const __restrict out((uint8_t* const __restrict)dst);
+
+		switch (method.codec)
+		{
+		case eCodec::DENSITY_CHAMELEON: {
+			density_processing_result const result = density_compress_with_context(in, bytes, out, capacity, density_chameleon.get());
+			return(result.state ? 0 : result.bytesWritten);
+		}
+		case eCodec::DENSITY_CHEETAH:
+		case eCodec::DENSITY_LION: {
+			density_processing_result const result = density_compress(in, bytes, out, capacity, (eCodec::DENSITY_CHEETAH == method.codec ? DENSITY_ALGORITHM_CHEETAH : DENSITY_ALGORITHM_LION));
+			return(result.state ? 0 : result.bytesWritten);
+		}
+		case eCodec::VOXEL_RLE:
+			return(rle_compress(in, bytes, out, capacity, stride));
+#ifdef CODEC_LZ4
+		case eCodec::LZ4: {
+			int const written(method.level > 0 ? LZ4_compress_HC((char const*)in, (char*)out, (int)bytes, (int)capacity, method.level)
+				                               : LZ4_compress_default((char const*)in, (char*)out, (int)bytes, (int)capacity));
+			return(written > 0 ? size_t(written) : 0);
+		}
+#endif
+#ifdef CODEC_ZSTD
+		case eCodec::ZSTD: {
+			if (nullptr == zstd.cctx) {
+				zstd.cctx = ZSTD_createCCtx();
+			}
+			size_t const written(ZSTD_compressCCtx(zstd.cctx, out, capacity, in, bytes, (0 == method.level ? ZSTD_CLEVEL_DEFAULT : method.level)));
+			return(ZSTD_isError(written) ? 0 : written);
+		}
+#endif
+		default:
+			break;
+		}
+		return(0);
+	}
+
+	size_t const decompress(uint32_t const codec, void const* const __restrict src, size_t const bytes, void* const __restrict dst, size_t const capacity)
+	{
+		uint8_t const* const __restrict in((uint8_t const* const __restrict)src);
+		uint8_t* const __restrict out((uint8_t* const __restrict)dst);
+
+		switch (codec)
+		{
+		case eCodec::DENSITY_CHAMELEON:
+		case eCodec::DENSITY_CHEETAH:
+		case eCodec::DENSITY_LION: {
+			if (bytes <= DENSITY_HEADER_SIZE)
+				return(0);
+
+			density_processing_result result;
+			if (DENSITY_ALGORITHM_CHAMELEON == in[DENSITY_HEADER_ALGORITHM]) { // context skips the header
+				result = density_decompress_with_context(in + DENSITY_HEADER_SIZE, bytes - DENSITY_HEADER_SIZE, out, capacity, density_chameleon.get());
+			}
+			else {
+				result = density_decompress(in, bytes, out, capacity);
+			}
+			return(result.state ? 0 : result.bytesWritten);
+		}
+		case eCodec::VOXEL_RLE:
+			return(rle_decompress(in, bytes, out, capacity));
+#ifdef CODEC_LZ4
+		case eCodec::LZ4: {
+			int const written(LZ4_decompress_safe((char const*)in, (char*)out, (int)bytes, (int)capacity));
+			return(written > 0 ? size_t(written) : 0);
+		}
+#endif
+#ifdef CODEC_ZSTD
+		case eCodec::ZSTD: {
+			if (nullptr == zstd.dctx) {
+				zstd.dctx = ZSTD_createDCtx();
+			}
+			size_t const written(ZSTD_decompressDCtx(zstd.dctx, out, capacity, in, bytes));
+			return(ZSTD_isError(written) ? 0 : written);
+		}
+#endif
+		default:
+			break;
+		}
+		return(0);
+	}
+
+	std::string_view const name(uint32_t const codec)
+	{
+		if (codec < eCodec::_size_constant) {
+			return(eCodec::_from_integral(codec)._to_string());
+		}
+		return("unknown");
+	}
+
+} // end ns
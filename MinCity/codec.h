@@ -0,0 +1,53 @@
+#pragma once
+#include "globals.h"
+#include <string_view>
+
+// optional codecs, the library must be added to the include directories & linker inputs (lz4.lib / libzstd.lib)
+//#define CODEC_LZ4
+//#define CODEC_ZSTD
+
+// compression codecs, selectable per use-site. The codec id is stored with every compressed record, so records written with one codec
+// remain readable when the site is switched to another. Any density variant decodes data of any other density variant (the algorithm
+// is in the density header), records written before codec ids existed are density and read back as DENSITY_CHAMELEON (0).
+namespace codec
+{
+	BETTER_ENUM(eCodec, uint32_t const,
+
+		DENSITY_CHAMELEON = 0,
+		DENSITY_CHEETAH,
+		DENSITY_LION,
+		VOXEL_RLE,				// byte planes + run length, for arrays of fixed size records (Iso::Voxel, voxelDescPacked)
+		LZ4,					// level 0 = fast, > 0 = high compression level
+		ZSTD					// level 1 ... 22
+	);
+
+	BETTER_ENUM(eSite, uint32_t const,
+
+		GRID_CHUNK = 0,			// StreamingGrid chunks, in memory and .grid records
+		MODEL_CACHE,			// voxel model cache files
+		UNDO_JOURNAL			// before/after deltas of tool operations (see undoJournal.h)
+	);
+
+	typedef struct sSelection
+	{
+		uint32_t	codec;
+		int32_t		level;
+
+	} selection;
+
+	bool const available(uint32_t const codec);
+
+	// unavailable codecs fall back to the site default
+	void select(uint32_t const site, uint32_t const codec, int32_t const level = 0);
+	selection const selected(uint32_t const site);
+
+	size_t const compress_bound(uint32_t const codec, size_t const bytes);		// dst capacity required to compress bytes
+	size_t const decompress_bound(uint32_t const codec, size_t const bytes);	// dst capacity required to decompress to bytes
+
+	// both return the bytes written to dst, 0 on failure. stride is the size of one record (VOXEL_RLE only)
+	size_t const compress(selection const method, void const* const __restrict src, size_t const bytes, void* const __restrict dst, size_t const capacity, uint32_t const stride = 1);
+	size_t const decompress(uint32_t const codec, void const* const __restrict src, size_t const bytes, void* const __restrict dst, size_t const capacity);
+
+	std::string_view const name(uint32_t const codec);
+
+} // end ns
@@ -12,7 +12,7 @@ typedef struct voxelWorldDesc
 	char			tag[4];
 	uint64_t		secure_seed;
 	uint32_t		name_length;
-	size_t			grid_compressed_size;
+	size_t			grid_compressed_size;	// 0 = grid is stored in a seperate chunked .grid file (current), otherwise size of the legacy monolithic compressed grid that follows the thumbnail
 	uint32_t		voxel_count;
 	
 } voxelWorldDesc;
@@ -0,0 +1,286 @@
+/* Copyright (C) 20xx Jason Tully - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License
+ * http://www.supersinfulsilicon.com/
+ *
+This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/
+or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#include "pch.h"
+#include "deferredUpdate.h"
+#include "voxelModelInstance.h"
+#include "replay.h"
+#include <Math/superfastmath.h>
+
+namespace // private to this file (anonymous)
+{
+	typedef struct sSynchronize
+	{
+		Volumetric::voxelModelInstance_Dynamic*		instance;
+		XMFLOAT2A									location;		// x, z
+		v2_rotation_t								vYawFrom,		// yaw of the instance when the change was requested (the grid still has the area at this yaw)
+													vYaw;
+
+	} synchronizeCommand;
+
+	static world::deferred::commandBuffer<synchronizeCommand> _synchronize;
+
+#ifdef DEBUG_BENCHMARK_GAME_OBJECT_UPDATE
+	BETTER_ENUM(eFleet, uint32_t const,
+
+		CAR = 0,
+		COPTER,
+		SIGNAGE
+	);
+
+	typedef struct sFleetObject
+	{
+		XMFLOAT2A	location,		// car: on its lane, copter: orbit center
+					axis;			// car: direction, signage: yaw
+		float		angle,			// copter: along the orbit
+					speed;			// voxels per second, radians per second
+		point2D_t	root;
+		int32_t		half_length,
+					half_width;
+		uint32_t	id,
+					kind,
+					draws;
+
+	} fleetObject;
+
+	typedef struct sFleetCommand
+	{
+		uint32_t	id;
+		point2D_t	rootFrom, root;
+		point2D_t	extentFrom, extent;	// half extents of the footprint (axis aligned)
+
+	} fleetCommand;
+
+	static constexpr int32_t const SCRATCH_SIZE = 1024; // scratch grid, wraps
+
+	STATIC_INLINE_PURE point2D_t const extent_of(fleetObject const& __restrict o)
+	{
+		float const ax(SFM::abs(o.axis.x)), ay(SFM::abs(o.axis.y));
+
+		return(point2D_t(SFM::round_to_i32(ax * float(o.half_length) + ay * float(o.half_width)), SFM::round_to_i32(ay * float(o.half_length) + ax * float(o.half_width))));
+	}
+
+	// the shape of synchronize(), clears the footprint of the id at the old root and stamps it at the new one. overlapping footprints
+	// keep the last writer, so the grid depends on the order the commands are applied in.
+	STATIC_INLINE void stamp(uint32_t* const __restrict grid, fleetCommand const& __restrict c)
+	{
+		static constexpr uint32_t const MASK(SCRATCH_SIZE - 1);
+
+		for (int32_t y = c.rootFrom.y - c.extentFrom.y; y <= c.rootFrom.y + c.extentFrom.y; ++y) {
+			for (int32_t x = c.rootFrom.x - c.extentFrom.x; x <= c.rootFrom.x + c.extentFrom.x; ++x) {
+
+				uint32_t& __restrict cell(grid[(uint32_t(y) & MASK) * SCRATCH_SIZE + (uint32_t(x) & MASK)]);
+				if (c.id == cell) {
+					cell = 0;
+				}
+			}
+		}
+		for (int32_t y = c.root.y - c.extent.y; y <= c.root.y + c.extent.y; ++y) {
+			for (int32_t x = c.root.x - c.extent.x; x <= c.root.x + c.extent.x; ++x) {
+				grid[(uint32_t(y) & MASK) * SCRATCH_SIZE + (uint32_t(x) & MASK)] = c.id;
+			}
+		}
+	}
+
+	// the work of OnUpdate reduced to its shape - move, a keyed random draw, one transform change a frame
+	template<bool const Deferred>
+	STATIC_INLINE void update_fleet_object(fleetObject& __restrict o, float const dt, uint32_t* const __restrict grid, world::deferred::commandBuffer<fleetCommand>& __restrict commands)
+	{
+		point2D_t const extentFrom(extent_of(o));
+		XMFLOAT2A position;
+
+		switch (o.kind)
+		{
+		case eFleet::CAR:
+			if (0 == (replay::RandomKeyed(replay::eStream::CARS, o.id + (o.draws++ * 0x9e3779b9u)) & 255u)) { // u-turn
+				o.axis.x = -o.axis.x; o.axis.y = -o.axis.y;
+			}
+			o.location.x += o.axis.x * o.speed * dt;
+			o.location.y += o.axis.y * o.speed * dt;
+			position = o.location;
+			break;
+		case eFleet::COPTER:
+			o.angle += o.speed * dt;
+			o.axis = XMFLOAT2A(SFM::__cos(o.angle), SFM::__sin(o.angle));
+			position = XMFLOAT2A(o.location.x + o.axis.x * 32.0f, o.location.y + o.axis.y * 32.0f);
+			break;
+		case eFleet::SIGNAGE:
+		default:
+			o.angle += o.speed * dt;
+			o.axis = XMFLOAT2A(SFM::__cos(o.angle), SFM::__sin(o.angle));
+			position = o.location;
+			break;
+		}
+
+		fleetCommand const command{ o.id, o.root, point2D_t(SFM::round_to_i32(position.x), SFM::round_to_i32(position.y)), extentFrom, extent_of(o) };
+		o.root = command.root;
+
+		if constexpr (Deferred) {
+			commands.push(command);
+		}
+		else {
+			stamp(grid, command);
+		}
+	}
+
+	STATIC_INLINE_PURE uint64_t const hash_grid(vector<uint32_t> const& __restrict grid)
+	{
+		uint64_t hash(0xcbf29ce484222325ull); // fnv-1a
+		for (uint32_t const cell : grid) {
+			hash = (hash ^ cell) * 0x100000001b3ull;
+		}
+		return(hash);
+	}
+#endif
+
+} // end ns
+
+namespace world
+{
+	namespace deferred
+	{
+		void __vectorcall push(Volumetric::voxelModelInstance_Dynamic* const __restrict instance, FXMVECTOR xmLocation, v2_rotation_t const vYawFrom, v2_rotation_t const vYaw)
+		{
+			synchronizeCommand command{ instance, {}, vYawFrom, vYaw };
+			XMStoreFloat2A(&command.location, xmLocation);
+
+			_synchronize.push(command);
+		}
+
+		void apply()
+		{
+			// instances are never deleted during the parallel phase (destroy only schedules it), every pointer is still valid here
+			_synchronize.apply([](synchronizeCommand const& command) {
+				command.instance->synchronizeDeferred(XMLoadFloat2A(&command.location), command.vYawFrom, command.vYaw);
+			});
+		}
+
+#ifdef DEBUG_BENCHMARK_GAME_OBJECT_UPDATE
+		// headless fleets of cars, copters and signage. updated serially with their changes made inline (the current update loops), then two
+		// phase on 1 to N threads. the scratch grid after the last frame must be identical for every thread count.
+		void benchmark()
+		{
+			static constexpr uint32_t const FLEET[eFleet::_size_constant] = { 20000, 2000, 5000 }; // cars, copters, signage
+			static constexpr uint32_t const FRAMES = 64;
+			static constexpr float const DELTA = 1.0f / 60.0f;
+
+			uint32_t total(0);
+			for (uint32_t const count : FLEET) {
+				total += count;
+			}
+
+			vector<fleetObject> initial;
+			initial.reserve(total);
+			{
+				uint32_t state(0x9e3779b9u); // same fleets every run
+				auto const next = [&state]() {
+					state ^= state << 13u; state ^= state >> 17u; state ^= state << 5u;
+					return(state);
+				};
+
+				for (uint32_t kind = 0; kind < eFleet::_size_constant; ++kind) {
+					for (uint32_t i = 0; i < FLEET[kind]; ++i) {
+
+						fleetObject o{};
+						o.id = uint32_t(initial.size()) + 1;
+						o.kind = kind;
+						o.location = XMFLOAT2A(float(next() % uint32_t(SCRATCH_SIZE)), float(next() % uint32_t(SCRATCH_SIZE)));
+						o.angle = float(next() & 0xffffu) * (XM_2PI / 65536.0f);
+
+						switch (kind)
+						{
+						case eFleet::CAR:
+							o.axis = (next() & 1u) ? XMFLOAT2A((next() & 1u) ? 1.0f : -1.0f, 0.0f) : XMFLOAT2A(0.0f, (next() & 1u) ? 1.0f : -1.0f);
+							o.speed = 10.0f; o.half_length = 4; o.half_width = 1;
+							break;
+						case eFleet::COPTER:
+							o.speed = 0.5f; o.half_length = 3; o.half_width = 3;
+							break;
+						case eFleet::SIGNAGE:
+							o.speed = 1.0f; o.half_length = 2; o.half_width = 1;
+							break;
+						}
+						if (eFleet::CAR != kind) {
+							o.axis = XMFLOAT2A(SFM::__cos(o.angle), SFM::__sin(o.angle));
+						}
+						o.root = point2D_t(SFM::round_to_i32(o.location.x), SFM::round_to_i32(o.location.y));
+						initial.emplace_back(o);
+					}
+				}
+			}
+
+			vector<fleetObject> objects(total);
+			vector<fleetObject*> pointers(total);
+			vector<uint32_t> grid(size_t(SCRATCH_SIZE) * size_t(SCRATCH_SIZE));
+			commandBuffer<fleetCommand> commands;
+
+			auto const reset = [&]() {
+				std::copy(initial.cbegin(), initial.cend(), objects.begin());
+				std::fill(grid.begin(), grid.end(), 0);
+				for (uint32_t i = 0; i < total; ++i) {
+					pointers[i] = &objects[i];
+					fleetCommand const place{ objects[i].id, objects[i].root, objects[i].root, point2D_t{}, extent_of(objects[i]) };
+					stamp(grid.data(), place);
+				}
+			};
+
+			FMT_LOG(PERF_LOG, "game object update benchmark: {:d} cars  {:d} copters  {:d} signage, {:d} frames", FLEET[eFleet::CAR], FLEET[eFleet::COPTER], FLEET[eFleet::SIGNAGE], FRAMES);
+
+			reset();
+			tTime tStart(high_resolution_clock::now());
+			for (uint32_t frame = 0; frame < FRAMES; ++frame) {
+				for (uint32_t i = 0; i < total; ++i) {
+					update_fleet_object<false>(objects[i], DELTA, grid.data(), commands);
+				}
+			}
+			double const serial_ms(fp_seconds(high_resolution_clock::now() - tStart).count() * 1000.0 / double(FRAMES));
+			uint64_t const serial_hash(hash_grid(grid));
+
+			FMT_LOG(PERF_LOG, "serial (inline)  {:.3f} ms / frame", serial_ms);
+
+			int32_t const max_threads(tbb::this_task_arena::max_concurrency());
+			for (int32_t threads = 1; ; threads = SFM::min(threads << 1, max_threads)) { // 1, 2, 4 ... max
+
+				reset();
+				fp_seconds tUpdate{}, tApply{};
+
+				tbb::task_arena arena(threads);
+				arena.execute([&] {
+					for (uint32_t frame = 0; frame < FRAMES; ++frame) {
+
+						tTime tPhase(high_resolution_clock::now());
+						for_each(pointers.data(), total, [&](fleetObject& o) { update_fleet_object<true>(o, DELTA, nullptr, commands); });
+						tUpdate += high_resolution_clock::now() - tPhase;
+
+						tPhase = high_resolution_clock::now();
+						commands.apply([&](fleetCommand const& c) { stamp(grid.data(), c); });
+						tApply += high_resolution_clock::now() - tPhase;
+					}
+				});
+
+				double const update_ms(tUpdate.count() * 1000.0 / double(FRAMES)), apply_ms(tApply.count() * 1000.0 / double(FRAMES));
+
+				if (serial_hash == hash_grid(grid)) {
+					FMT_LOG_OK(PERF_LOG, "{:d} threads  update {:.3f} ms  apply {:.3f} ms  total {:.3f} ms / frame ({:.2f}x)",
+						threads, update_ms, apply_ms, update_ms + apply_ms, serial_ms / (update_ms + apply_ms));
+				}
+				else {
+					FMT_LOG_FAIL(PERF_LOG, "{:d} threads  update {:.3f} ms  apply {:.3f} ms  total {:.3f} ms / frame ({:.2f}x)  result differs from the serial update",
+						threads, update_ms, apply_ms, update_ms + apply_ms, serial_ms / (update_ms + apply_ms));
+				}
+
+				if (max_threads == threads)
+					break;
+			}
+		}
+#endif
+
+	} // end ns
+} // end ns
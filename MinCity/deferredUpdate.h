@@ -0,0 +1,136 @@
+#pragma once
+/* Copyright (C) 20xx Jason Tully - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License
+ * http://www.supersinfulsilicon.com/
+ *
+This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/
+or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+#include "globals.h"
+#include <Utility/class_helper.h>
+#include <Math/v2_rotation_t.h>
+#include <type_traits>
+
+// forward decl
+namespace Volumetric
+{
+	class voxelModelInstance_Dynamic;
+}
+
+// two phase game object updates. update<colony>() runs the OnUpdate of every object in a colony in parallel. changes to shared state (the grid
+// hashes and root voxel index of an instance, see voxelModelInstance_Dynamic::requestSynchronize) are not made inline while deferring, they are
+// recorded in per thread command buffers. the apply phase then makes them on the calling thread ordered by the position of the object in the colony
+// and the order the object made them - the same result as a serial update, independent of the thread count or scheduling.
+//
+// an object updated in parallel may only change its own state and instance, read shared state and draw keyed random numbers (replay::RandomKeyed).
+// the task scheduling and apply phase cost more than a trivial OnUpdate saves (light cones, thrusters, beacons), those colonies stay serial.
+//
+//		world::deferred::update<cCarGameObject>([&](cCarGameObject& car) { car.OnUpdate(tNow, tDelta); car.submitMover(); });
+namespace world
+{
+	namespace deferred
+	{
+		namespace internal
+		{
+			inline thread_local bool		deferring{};
+			inline thread_local uint32_t	object{},		// ordering key of the object being updated on this thread
+											command{};		// commands it has pushed so far
+		} // end ns
+
+		__inline bool const isDeferring() { return(internal::deferring); }
+
+		template<typename command_t>
+		class commandBuffer : no_copy
+		{
+			typedef struct sOrdered
+			{
+				uint64_t	key;
+				command_t	command;
+
+			} ordered;
+
+		public:
+			void push(command_t const& command)
+			{
+				uint64_t const key((uint64_t(internal::object) << 32ull) | uint64_t(internal::command++));
+
+				_local.local().emplace_back(ordered{ key, command });
+			}
+
+			// calling thread only, no concurrent push()
+			template<typename apply_function>
+			size_t const apply(apply_function&& func)
+			{
+				_ordered.clear();
+				for (auto& local : _local) {
+					_ordered.insert(_ordered.end(), local.cbegin(), local.cend());
+					local.clear();
+				}
+
+				tbb::parallel_sort(_ordered.begin(), _ordered.end(), [](ordered const& a, ordered const& b) { return(a.key < b.key); });
+
+				for (auto const& o : _ordered) {
+					func(o.command);
+				}
+				return(_ordered.size());
+			}
+
+		private:
+			tbb::enumerable_thread_specific<vector<ordered>, tbb::cache_aligned_allocator<vector<ordered>>, tbb::ets_key_per_instance>	_local; // per thread instance
+			vector<ordered>																												_ordered;
+		};
+
+		// parallel phase only, objects[i] is updated with the ordering key i. the key is saved / restored around each object so a thread
+		// that picks up another object while waiting inside an update (nested parallelism) keeps the right key.
+		template<typename object_t, typename update_function>
+		void for_each(object_t* const* const __restrict objects, uint32_t const count, update_function&& func)
+		{
+			tbb::parallel_for(tbb::blocked_range<uint32_t>(0, count), [&](tbb::blocked_range<uint32_t> const& r) {
+
+				for (uint32_t i = r.begin(); i != r.end(); ++i) {
+
+					bool const deferring(internal::deferring);
+					uint32_t const object(internal::object), command(internal::command);
+
+					internal::deferring = true; internal::object = i; internal::command = 0;
+
+					func(*objects[i]);
+
+					internal::deferring = deferring; internal::object = object; internal::command = command;
+				}
+			});
+		}
+
+		void __vectorcall push(Volumetric::voxelModelInstance_Dynamic* const __restrict instance, FXMVECTOR xmLocation, v2_rotation_t const vYawFrom, v2_rotation_t const vYaw); // x, z location
+		void apply(); // makes the recorded instance changes, in order
+
+		template<typename colony_t, typename update_function>
+		void update(update_function&& func)
+		{
+			using object_t = std::remove_reference_t<decltype(*colony_t::begin())>;
+
+			static vector<object_t*> objects; // main thread only
+			objects.clear();
+
+			for (auto it = colony_t::begin(); colony_t::end() != it; ++it) {
+				objects.emplace_back(&(*it));
+			}
+
+			for_each(objects.data(), (uint32_t)objects.size(), std::forward<update_function>(func));
+			apply();
+		}
+
+		template<typename colony_t>
+		void update(tTime const& __restrict tNow, fp_seconds const& __restrict tDelta)
+		{
+			update<colony_t>([&](auto& object) { object.OnUpdate(tNow, tDelta); });
+		}
+
+#ifdef DEBUG_BENCHMARK_GAME_OBJECT_UPDATE
+		void benchmark();
+#endif
+
+	} // end ns
+} // end ns
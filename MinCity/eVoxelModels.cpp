@@ -33,10 +33,12 @@ namespace { // local to this file only}
 
 namespace Volumetric
 {
-	// Parallezing furth the loading of individual VOX models (task per model) only oversaturates the cpu cores
-	// the scheduler is maxed when loading a model and culling voxels and generating adjacency
-	// static models and dynamic models are loaded in separate tasks already
-	// checked, and removing the task per model results in noticably faster loading of all voxel models
+	// Loading is split in two passes. First the model groups are queued in the required order, resolving the file(s) of each group.
+	// Then all individual .vox models are loaded in parallel (task per model). Each model still parallelizes internally (culling, adjacency) 
+	// so the scheduler balances the small models against the large ones instead of idling on the serial parts of each model (file io, sort).
+	// Sequences (vdb, gltf) share state internally, they are loaded serially and are already parallel internally.
+	// Finally the loaded models are committed serially in queued order, so the model offsets and identities are unchanged.
+	// .vox models are loaded from the memory mapped model archive (.v1xp) when it is current, see voxBinary.h
 
 	enum eModelFileType
 	{
@@ -46,6 +48,34 @@ namespace Volumetric
 		SEQUENCE_GLTF = 3
 	};
 	
+	template<bool const DYNAMIC>
+	struct sModelLoad
+	{
+		using voxModel = Volumetric::voxB::voxelModel<DYNAMIC>;
+
+		fs::path	path;
+		uint32_t	file_type;
+		uint32_t	args;
+
+		voxModel*	pVox;		// temporary, until committed
+		int			exists;
+		bool		archived;
+	};
+
+	template<bool const DYNAMIC>
+	struct sModelGroupLoad
+	{
+		ModelGroup* __restrict			 group;
+		vector< sModelLoad<DYNAMIC> >	 models;
+	};
+
+	namespace { // local to this file only
+
+		static inline vector< sModelGroupLoad<false> > _static_queue;
+		static inline vector< sModelGroupLoad<true> >  _dynamic_queue;
+
+	} // end ns
+
 	// this function is re-entrant for a group, appending correctly if called in such a way (eg. named files)
 	template<bool const DYNAMIC, uint32_t const FILE_TYPE = GROUP_VOX>
 	static void LoadModelGroup(std::string_view const folder_group, ModelGroup& __restrict groupInfo, uint32_t const args = 0)
@@ -78,112 +108,147 @@ namespace Volumetric
 			folder_path += L'/';
 		}
 
-		uint32_t modelCount(groupInfo.size); // start with current count
+		sModelGroupLoad<DYNAMIC> load{ &groupInfo };
 
-		// record offset once
-		if (0 == groupInfo.offset) {
-			if constexpr (DYNAMIC) {
-				groupInfo.offset = (uint32_t)_dynamicModels.size();
-			}
-			else {
-				groupInfo.offset = (uint32_t)_staticModels.size();
+		if constexpr (GROUP_VOX == FILE_TYPE) { // group folder operation (default)
+
+			for (auto const& entry : fs::directory_iterator(folder_path)) {
+
+				if (entry.exists() && !entry.is_directory()) {
+					if (stringconv::case_insensitive_compare(VOX_FILE_EXT, entry.path().extension().wstring())) // only vox files 
+					{
+						load.models.emplace_back(sModelLoad<DYNAMIC>{ entry.path(), SINGLE_VOX, args });
+					}
+				}
 			}
 		}
+		else { // single file or sequence
+			load.models.emplace_back(sModelLoad<DYNAMIC>{ folder_path, FILE_TYPE, args });
+		}
+
+		if constexpr (DYNAMIC) {
+			_dynamic_queue.emplace_back(std::move(load));
+		}
+		else {
+			_static_queue.emplace_back(std::move(load));
+		}
+	}
 
+	template<bool const DYNAMIC>
+	static void LoadModel(sModelLoad<DYNAMIC>& __restrict load, ModelGroup const& __restrict groupInfo)
+	{
 		using voxModel = Volumetric::voxB::voxelModel<DYNAMIC>;
 		using voxIdent = Volumetric::voxB::voxelModelIdent<DYNAMIC>;
 
-		if constexpr (SEQUENCE_GLTF == FILE_TYPE)
-		{
-			voxModel* __restrict pVox;
+		// final identity is given when the model is committed
+		load.pVox = new voxModel(voxIdent{ groupInfo.modelID, 0 });
 
-			if constexpr (DYNAMIC) {
-				pVox = &(*_dynamicModels.emplace_back(voxModel(voxIdent{ groupInfo.modelID, modelCount })));
-			}
-			else {
-				pVox = &(*_staticModels.emplace_back(voxModel(voxIdent{ groupInfo.modelID, modelCount })));
+		switch (load.file_type)
+		{
+		case SEQUENCE_GLTF:
+			load.exists = voxB::LoadGLTF(load.path, load.pVox, ((0 != load.args) ? load.args : Volumetric::MODEL_MAX_DIMENSION_XYZ));  // args maps to voxel resolution for GLTF, validation check on default value selects the maximum model dimensions for any type of voxel model (.vox (voxels) .vdb (voxels) .gltf (mesh->voxelized->voxels))
+			break;
+		case SEQUENCE_VDB:
+			load.exists = voxB::LoadVDB(load.path, load.pVox);
+			break;
+		default: // .vox
+			load.exists = voxB::LoadArchivedModel(load.path, load.pVox);
+			load.archived = (0 != load.exists);
+			if (!load.archived) {
+				load.exists = voxB::LoadVOX(load.path, load.pVox);
 			}
+			break;
+		}
+
+		if (load.exists) {
+			load.pVox->BuildStreams(); // SoA copy for the wide render path
+			load.pVox->BuildLOD();     // downsampled levels for zoomed out views
+		}
+	}
+
+	template<bool const DYNAMIC>
+	static void LoadQueuedModels(vector< sModelGroupLoad<DYNAMIC> >& __restrict queue)
+	{
+		vector< std::pair<sModelLoad<DYNAMIC>*, ModelGroup const*> > models, sequences;
 
-			int const exists = voxB::LoadGLTF(folder_path, pVox, ((0 != args) ? args : Volumetric::MODEL_MAX_DIMENSION_XYZ));  // args maps to voxel resolution for GLTF, validation check on default value selects the maximum model dimensions for any type of voxel model (.vox (voxels) .vdb (voxels) .gltf (mesh->voxelized->voxels))
-			if (exists) {
+		for (auto& load : queue) {
+			for (auto& model : load.models) {
 
-				// full sequence loaded into one model
-				++modelCount;
+				if (SEQUENCE_VDB == model.file_type || SEQUENCE_GLTF == model.file_type) {
+					sequences.emplace_back(&model, load.group);
+				}
+				else {
+					models.emplace_back(&model, load.group);
+				}
 			}
 		}
-		else if constexpr (SEQUENCE_VDB == FILE_TYPE)
-		{
-			voxModel* __restrict pVox;
 
-			if constexpr (DYNAMIC) {
-				pVox = &(*_dynamicModels.emplace_back(voxModel(voxIdent{ groupInfo.modelID, modelCount })));
-			}
-			else {
-				pVox = &(*_staticModels.emplace_back(voxModel(voxIdent{ groupInfo.modelID, modelCount })));
-			}
+		tbb::parallel_for(size_t(0), models.size(), [&models](size_t const i) {
 
-			int const exists = voxB::LoadVDB(folder_path, pVox);
-			if (exists) {
+			LoadModel<DYNAMIC>(*models[i].first, *models[i].second);
+		});
 
-				// full sequence loaded into one model
-				++modelCount;
-			}
+		for (auto const& [pModel, pGroup] : sequences) {
+
+			LoadModel<DYNAMIC>(*pModel, *pGroup);
 		}
-		else if constexpr (SINGLE_VOX == FILE_TYPE) { // file operation
+	}
 
-			voxModel* __restrict pVox;
+	template<bool const DYNAMIC>
+	static void CommitQueuedModels(vector< sModelGroupLoad<DYNAMIC> >& __restrict queue, vector<std::pair<fs::path, voxB::voxelModelBase const*>>& __restrict archive, bool& __restrict bArchiveCurrent)
+	{
+		using voxModel = Volumetric::voxB::voxelModel<DYNAMIC>;
+		using voxIdent = Volumetric::voxB::voxelModelIdent<DYNAMIC>;
 
-			if constexpr (DYNAMIC) {
-				pVox = &(*_dynamicModels.emplace_back(voxModel(voxIdent{ groupInfo.modelID, modelCount })));
-			}
-			else {
-				pVox = &(*_staticModels.emplace_back(voxModel(voxIdent{ groupInfo.modelID, modelCount })));
-			}
+		for (auto& load : queue) {
 
-			int const exists = voxB::LoadVOX(folder_path, pVox);
-			if (exists) {
+			ModelGroup& __restrict groupInfo(*load.group);
 
-				if (exists < 0) { // new vox model detected 
-																		// safe up-cast to base type
-					_new_models.emplace(newVoxelModel{ fs::path(folder_path).filename().string(), reinterpret_cast<voxB::voxelModelBase*>(pVox), DYNAMIC });  // reference to new dynamic or static model
-				}
+			uint32_t modelCount(groupInfo.size); // start with current count
 
-				++modelCount;
+			// record offset once
+			if (0 == groupInfo.offset) {
+				if constexpr (DYNAMIC) {
+					groupInfo.offset = (uint32_t)_dynamicModels.size();
+				}
+				else {
+					groupInfo.offset = (uint32_t)_staticModels.size();
+				}
 			}
-		}
-		else { // group folder operation (default)
-			
-			for (auto const& entry : fs::directory_iterator(folder_path)) {
 
-				if (entry.exists() && !entry.is_directory()) {
-					if (stringconv::case_insensitive_compare(VOX_FILE_EXT, entry.path().extension().wstring())) // only vox files 
-					{
-						voxModel* __restrict pVox;
+			for (auto& model : load.models) {
 
-						if constexpr (DYNAMIC) {
-							pVox = &(*_dynamicModels.emplace_back(voxModel(voxIdent{ groupInfo.modelID, modelCount })));
-						}
-						else {
-							pVox = &(*_staticModels.emplace_back(voxModel(voxIdent{ groupInfo.modelID, modelCount })));
-						}
+				if (model.exists) {
 
-						int const exists = voxB::LoadVOX(entry.path(), pVox);
-						if (exists) {
+					voxModel* __restrict pVox;
 
-							if (exists < 0) { // new vox model detected 
-																					// safe up-cast to base type
-								_new_models.emplace(newVoxelModel{ entry.path().filename().string(), reinterpret_cast<voxB::voxelModelBase*>(pVox), DYNAMIC });  // reference to new dynamic or static model
-							}
+					if constexpr (DYNAMIC) {
+						pVox = &(*_dynamicModels.emplace_back(voxModel(voxIdent{ groupInfo.modelID, modelCount }, std::move(*model.pVox))));
+					}
+					else {
+						pVox = &(*_staticModels.emplace_back(voxModel(voxIdent{ groupInfo.modelID, modelCount }, std::move(*model.pVox))));
+					}
 
-							++modelCount;
-						}
+					if (model.exists < 0) { // new vox model detected 
+																			// safe up-cast to base type
+						_new_models.emplace(newVoxelModel{ model.path.filename().string(), reinterpret_cast<voxB::voxelModelBase*>(pVox), DYNAMIC });  // reference to new dynamic or static model
 					}
+					else if (SINGLE_VOX == model.file_type) { // new models are not archived until they have been imported (cached .v1x)
+						archive.emplace_back(model.path, pVox);
+						bArchiveCurrent &= model.archived;
+					}
+
+					++modelCount;
 				}
+
+				SAFE_DELETE(model.pVox);
 			}
+
+			// update the count
+			groupInfo.size += modelCount;
 		}
-		
-		// update the count
-		groupInfo.size += modelCount;
+
+		queue.clear(); queue.shrink_to_fit();
 	}
 
 	template<bool const DYNAMIC>
@@ -279,9 +344,33 @@ namespace Volumetric
 
 		FMT_LOG(VOX_LOG, "loading voxel models.....");
 
+		tTime const tStart(high_resolution_clock::now());
+
+		bool const bArchiveOpen(voxB::OpenModelArchive());
+
+		// queue in order
 		bSuccess[0] = LoadAllStaticVoxelModels();
 		bSuccess[1] = LoadAllDynamicVoxelModels();
 
+		// load
+		tbb::parallel_invoke(
+			[] { LoadQueuedModels<false>(_static_queue); },
+			[] { LoadQueuedModels<true>(_dynamic_queue); }
+		);
+
+		// commit in order
+		vector<std::pair<fs::path, voxB::voxelModelBase const*>> archive;
+		bool bArchiveCurrent(bArchiveOpen);
+
+		CommitQueuedModels<false>(_static_queue, archive, bArchiveCurrent);
+		CommitQueuedModels<true>(_dynamic_queue, archive, bArchiveCurrent);
+
+		FMT_LOG(VOX_LOG, "voxel models loaded in {:d} ms ({:s} start)", duration_cast<milliseconds>(high_resolution_clock::now() - tStart).count(), (bArchiveCurrent ? "warm" : "cold"));
+
+		if (!bArchiveCurrent && !archive.empty()) { // rebuild archive, next start is warm
+			voxB::SaveModelArchive(archive);
+		}
+
 		if (bSuccess[0]) {
 			FMT_LOG_OK(VOX_LOG, "static models loaded");
 		}
@@ -307,5 +396,8 @@ namespace Volumetric
 		// controlled demolition 
 		_dynamicModels.clear(); _dynamicModels.shrink_to_fit();
 		_staticModels.clear(); _staticModels.shrink_to_fit();
+
+		// archived models reference the mapping, release last
+		voxB::CloseModelArchive();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "pch.h"
+#include "frameGraph.h"
+#include "performance.h"
+#include <tbb/flow_graph.h>
+
+namespace // private to this file (anonymous)
+{
+	constinit static framegraph::report last_report{};
+
+} // end ns
+
+namespace framegraph
+{
+	struct cFrameGraph::sFlow
+	{
+		tbb::flow::graph											g;
+		tbb::flow::broadcast_node<tbb::flow::continue_msg>			start;
+		vector<std::unique_ptr<tbb::flow::continue_node<tbb::flow::continue_msg>>>	nodes; // nodes are not movable, edges reference them
+
+		sFlow()
+			: start(g)
+		{}
+	};
+
+	cFrameGraph::cFrameGraph() = default;
+	cFrameGraph::~cFrameGraph() = default;
+
+	uint32_t const cFrameGraph::add(std::string_view const name, uint32_t const reads, uint32_t const writes, stage_function&& function)
+	{
+		uint32_t const index((uint32_t)_stages.size());
+
+		[[unlikely]] if (index >= report::MAX_STAGES) {
+			FMT_LOG_FAIL(PERF_LOG, "frame graph: stage limit ({:d}) reached, {:s} not added", report::MAX_STAGES, name);
+			return(index);
+		}
+
+		uint32_t predecessors(0);
+		for (uint32_t i = 0; i < index; ++i) {
+
+			stage const& __restrict earlier(_stages[i]);
+
+			if ((earlier.writes & (reads | writes)) | (earlier.reads & writes)) {
+				predecessors |= (1u << i);
+			}
+		}
+
+		_stages.emplace_back(stage{ name, reads, writes, std::forward<stage_function&&>(function), predecessors, {}, {} });
+		_flow.reset(); // stage addresses may have changed, rebuilt on the next run
+
+		return(index);
+	}
+
+	void cFrameGraph::run(bool const bSerial)
+	{
+		uint32_t const stage_count((uint32_t)_stages.size());
+
+		tTime const tFrameStart(high_resolution_clock::now());
+
+		if (bSerial) {
+
+			for (auto& __restrict s : _stages) {
+				s.tStart = high_resolution_clock::now();
+				s.function();
+				s.tEnd = high_resolution_clock::now();
+			}
+		}
+		else {
+			using namespace tbb::flow;
+
+			if (nullptr == _flow) {
+
+				_flow = std::make_unique<sFlow>();
+				_flow->nodes.reserve(stage_count);
+
+				for (auto& __restrict s : _stages) {
+
+					stage* const __restrict pStage(&s);
+
+					_flow->nodes.emplace_back(std::make_unique<continue_node<continue_msg>>(_flow->g, [pStage](continue_msg const&) {
+						pStage->tStart = high_resolution_clock::now();
+						pStage->function();
+						pStage->tEnd = high_resolution_clock::now();
+					}));
+				}
+
+				for (uint32_t i = 0; i < stage_count; ++i) {
+
+					uint32_t predecessors(_stages[i].predecessors);
+
+					if (0 == predecessors) {
+						make_edge(_flow->start, *_flow->nodes[i]);
+					}
+					else {
+						while (0 != predecessors) {
+							uint32_t const j(_tzcnt_u32(predecessors));
+							predecessors &= predecessors - 1;
+
+							make_edge(*_flow->nodes[j], *_flow->nodes[i]);
+						}
+					}
+				}
+			}
+
+			_flow->start.try_put(continue_msg());
+			_flow->g.wait_for_all();
+		}
+
+		resolve(tFrameStart, high_resolution_clock::now());
+
+		metrics::record(metrics::eTimer::STAGE_CRITICAL_PATH, duration_cast<microseconds>(_report.critical_path));
+		last_report = _report;
+	}
+
+	void cFrameGraph::resolve(tTime const tFrameStart, tTime const tFrameEnd)
+	{
+		// longest chain of dependent stages, stages are already in a topological order (predecessors always have a lower index)
+		uint32_t const stage_count((uint32_t)_stages.size());
+
+		nanoseconds longest[report::MAX_STAGES]{};
+		uint32_t    previous[report::MAX_STAGES]{};
+
+		_report = {};
+		_report.wall = tFrameEnd - tFrameStart;
+		_report.stage_count = stage_count;
+
+		uint32_t end(0);
+
+		for (uint32_t i = 0; i < stage_count; ++i) {
+
+			stage const& __restrict s(_stages[i]);
+			nanoseconds const elapsed(s.tEnd - s.tStart);
+
+			_report.work += elapsed;
+			_report.names[i] = s.name;
+
+			nanoseconds before{};
+			previous[i] = UINT32_MAX;
+
+			uint32_t predecessors(s.predecessors);
+			while (0 != predecessors) {
+				uint32_t const j(_tzcnt_u32(predecessors));
+				predecessors &= predecessors - 1;
+
+				if (longest[j] > before) {
+					before = longest[j];
+					previous[i] = j;
+				}
+			}
+
+			longest[i] = before + elapsed;
+			if (longest[i] > longest[end]) {
+				end = i;
+			}
+		}
+
+		if (0 == stage_count)
+			return;
+
+		_report.critical_path = longest[end];
+
+		// walk back from the last stage of the path
+		uint32_t reversed[report::MAX_STAGES], length(0);
+		for (uint32_t i = end; UINT32_MAX != i; i = previous[i]) {
+			reversed[length++] = i;
+		}
+		for (uint32_t i = 0; i < length; ++i) {
+			_report.path[i] = reversed[length - 1 - i];
+		}
+		_report.path_length = length;
+	}
+
+	std::string const sReport::toString() const
+	{
+		std::string chain;
+
+		for (uint32_t i = 0; i < path_length; ++i) {
+			if (0 != i) {
+				chain += " > ";
+			}
+			chain += names[path[i]];
+		}
+
+		return(fmt::format("wall {:d}us  critical path {:d}us  work {:d}us  [{:s}]",
+			duration_cast<microseconds>(wall).count(), duration_cast<microseconds>(critical_path).count(), duration_cast<microseconds>(work).count(), chain));
+	}
+
+	report const& last()
+	{
+		return(last_report);
+	}
+
+} // end ns
@@ -0,0 +1,94 @@
+#pragma once
+#include "globals.h"
+#include "tTime.h"
+#include <Utility/class_helper.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// explicit per frame dependency graph. Each stage declares the frame resources it reads and writes, edges are derived from the declarations
+// in the order the stages are added (read after write, write after read, write after write). Stages without a conflict run concurrently on
+// the tbb workers, everything else keeps the order it was added in. Every frame the duration of each stage is recorded and the critical
+// path - the chain of dependent stages that bounds the frame - is resolved and recorded with metrics (eTimer::STAGE_CRITICAL_PATH).
+// A graph is built once and run every frame, stages read their per frame inputs from state that outlives the graph.
+namespace framegraph
+{
+	BETTER_ENUM(eResource, uint32_t const,
+
+		STREAMING_GRID = 0,		// lru streaming grid chunks
+		DIRTY_REGIONS,			// dirty tile buffers and the data derived from them (ground adjacency, picking pyramid), single writer - the "dirty regions" stage
+		DIRECT_TERRAIN,			// direct buffers & bits, cleared by cVoxelWorld::AsyncClears, written by RenderGrid
+		DIRECT_STATIC,
+		DIRECT_DYNAMIC,
+		OPACITY,				// opacity map & light seeding
+		PHYSICS,				// force fields
+		STAGING_TERRAIN,		// staging buffers & partition info
+		STAGING_STATIC,
+		STAGING_DYNAMIC
+	);
+
+	STATIC_INLINE_PURE uint32_t const bit(uint32_t const resource) { return(1u << resource); }
+
+	static constexpr uint32_t const
+		DIRECT_ALL = (1u << eResource::DIRECT_TERRAIN) | (1u << eResource::DIRECT_STATIC) | (1u << eResource::DIRECT_DYNAMIC);
+
+	typedef struct sReport
+	{
+		static constexpr uint32_t const MAX_STAGES = 32;
+
+		nanoseconds wall,				// first stage start to last stage end
+					critical_path,		// sum of the stages on the critical path, the lower bound of wall
+					work;				// sum of all stages
+
+		uint32_t	stage_count,
+					path_length,
+					path[MAX_STAGES];	// stage indices, first to last
+
+		std::string_view names[MAX_STAGES];
+
+		std::string const toString() const; // "wall 812us  critical path 790us  work 1450us  [gc > render grid > compact static]"
+
+	} report;
+
+	class cFrameGraph : no_copy
+	{
+	public:
+		using stage_function = std::function<void()>;
+
+		bool const empty() const { return(_stages.empty()); }
+
+		// returns the stage index. name must outlive the graph (string literal)
+		uint32_t const add(std::string_view const name, uint32_t const reads, uint32_t const writes, stage_function&& function);
+
+		// executes all stages once, blocks until all are done. serial runs every stage on the calling thread in the order added (baseline).
+		void run(bool const bSerial = false);
+
+		report const& getReport() const { return(_report); }
+
+	private:
+		struct sFlow; // tbb flow graph of the stages, built on the first concurrent run
+		typedef struct sStage
+		{
+			std::string_view	name;
+			uint32_t			reads, writes;
+			stage_function		function;
+			uint32_t			predecessors;	// bit mask of stage indices
+			tTime				tStart, tEnd;
+
+		} stage;
+
+		vector<stage>			_stages;
+		std::unique_ptr<sFlow>	_flow;
+		report					_report{};
+
+		void resolve(tTime const tFrameStart, tTime const tFrameEnd);
+	public:
+		cFrameGraph();
+		~cFrameGraph();
+	};
+
+	// report of the last frame graph run on the main thread
+	report const& last();
+
+} // end ns
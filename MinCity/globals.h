@@ -97,6 +97,51 @@ extern void debug_out_nuklear_off();
 
 #endif // NDEBUG
 
+// benchmarks are run once at startup, results output to console. Only meaningful in release builds.
+//#define DEBUG_BENCHMARK_VOXEL_EMISSION
+//#define DEBUG_BENCHMARK_FRUSTUM_CULLING
+//#define DEBUG_BENCHMARK_ROUTE_QUERY
+//#define DEBUG_BENCHMARK_FORCE_FIELD
+//#define DEBUG_BENCHMARK_LIGHT_SEEDING
+//#define DEBUG_BENCHMARK_MODEL_RENDER
+//#define DEBUG_BENCHMARK_INSTANCE_LOOKUP
+//#define DEBUG_BENCHMARK_VOXEL_ADJACENCY
+//#define DEBUG_BENCHMARK_MODEL_LOD
+//#define DEBUG_BENCHMARK_CHUNK_CODECS
+//#define DEBUG_BENCHMARK_STREAMING_PAN
+//#define DEBUG_BENCHMARK_VOXEL_EVENTS
+//#define DEBUG_BENCHMARK_LIGHT_PROPAGATION
+//#define DEBUG_BENCHMARK_RAY_PICKING
+//#define DEBUG_BENCHMARK_DIRTY_REGIONS
+//#define DEBUG_BENCHMARK_TRAFFIC
+//#define DEBUG_BENCHMARK_GAME_OBJECT_UPDATE
+
+#if defined(DEBUG_BENCHMARK_VOXEL_EMISSION) \
+	|| defined(DEBUG_BENCHMARK_FRUSTUM_CULLING) \
+	|| defined(DEBUG_BENCHMARK_ROUTE_QUERY) \
+	|| defined(DEBUG_BENCHMARK_FORCE_FIELD) \
+	|| defined(DEBUG_BENCHMARK_LIGHT_SEEDING) \
+	|| defined(DEBUG_BENCHMARK_MODEL_RENDER) \
+	|| defined(DEBUG_BENCHMARK_INSTANCE_LOOKUP) \
+	|| defined(DEBUG_BENCHMARK_VOXEL_ADJACENCY) \
+	|| defined(DEBUG_BENCHMARK_MODEL_LOD) \
+	|| defined(DEBUG_BENCHMARK_CHUNK_CODECS) \
+	|| defined(DEBUG_BENCHMARK_STREAMING_PAN) \
+	|| defined(DEBUG_BENCHMARK_VOXEL_EVENTS) \
+	|| defined(DEBUG_BENCHMARK_LIGHT_PROPAGATION) \
+	|| defined(DEBUG_BENCHMARK_RAY_PICKING) \
+	|| defined(DEBUG_BENCHMARK_DIRTY_REGIONS) \
+	|| defined(DEBUG_BENCHMARK_TRAFFIC) \
+	|| defined(DEBUG_BENCHMARK_GAME_OBJECT_UPDATE)
+#define DEBUG_BENCHMARK		// any startup benchmark, see performance.h
+#endif
+#if defined(DEBUG_BENCHMARK_VOXEL_EMISSION) \
+	|| defined(DEBUG_BENCHMARK_MODEL_RENDER) \
+	|| defined(DEBUG_BENCHMARK_MODEL_LOD) \
+	|| defined(DEBUG_BENCHMARK_VOXEL_EVENTS)
+#define DEBUG_BENCHMARK_RENDER	// cpu render benchmarks, share the setup & teardown of the direct buffers (see cVoxelWorld::BenchmarkRenderBegin)
+#endif
+
 // **** global macro **** warning if debug options are enabled during release mode
 #if defined(DEBUG_DISABLE_MUSIC) \
 	|| defined(DEBUG_DEPTH_CUBE)					\
@@ -104,6 +149,7 @@ extern void debug_out_nuklear_off();
     || defined(VOX_DEBUG_ENABLED)					\
 	|| defined(DEBUG_PERFORMANCE_VOXEL_SUBMISSION)	\
 	|| defined(DEBUG_PERFORMANCE_VOXELINDEX_PIXMAP) \
+	|| defined(DEBUG_BENCHMARK) \
     || defined(DEBUG_OUTPUT_STREAMING_STATS) \
     || defined(DEBUG_VOXEL_BANDWIDTH) \
     || defined(TRACY_ENABLE) \
@@ -137,6 +183,7 @@ extern void debug_out_nuklear_off();
 #define VOX_LOG "VOX"
 #define TEX_LOG "TEX"
 #define AUDIO_LOG "AUDIO"
+#define PERF_LOG "PERF"
 
 // helper types
 #define read_only constexpr extern const __declspec(selectany)
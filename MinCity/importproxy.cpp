@@ -57,6 +57,11 @@ namespace Volumetric
 			model->_numVoxelsEmissive = numEmissive;
 			model->_numVoxelsTransparent = numTransparent;
 
+			// keep the SoA copy coherent with the changed materials
+			if (model->_Streams.valid()) {
+				model->BuildStreams();
+			}
+
 			if (material.Video) {
 				uvec4_t cube;
 				uvec4_v(_mm_sub_epi32(maxi.v, mini.v)).xyzw(cube);
@@ -94,6 +99,9 @@ namespace Volumetric
 					// model->_Features.videoscreen = nullptr;
 				}
 			}
+
+			// downsampled levels follow the changed materials (the import instance itself always renders full resolution, it has per voxel operations)
+			model->BuildLOD();
 			
 			active_color = *iter_current_color;
 		}
@@ -8,27 +8,6 @@ This work is licensed under the Creative Commons Attribution-NonCommercial-Share
 To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/
 or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
  */
-#include "streaming_sizes.h"
-
-template<typename T>
-INLINE_MEMFUNC __streaming_store_residual(T* const __restrict dest, T const* const __restrict src, uint32_t const index) // single usage (residual/remainder)
-{
-	//*(dest + index) = *(src + index);
-	_mm_stream_si64x((__int64* const __restrict)(dest + index), (__int64 const)*(src + index));
-}
-template<typename T, size_t const Size>
-INLINE_MEMFUNC __streaming_store(T* const __restrict dest, T const* const __restrict src, uint32_t const (& __restrict index)[Size]) // batches by size of 8, src should be recently cached values, dest is write-combined so the streaming stores are batched effectively here.
-{
-#pragma loop( ivdep )
-	for (uint32_t i = 0; i < Size; ++i) {
-
-		//*(dest + index[i]) = *(src + index[i]);
-		uint32_t const offset(index[i]);
-		_mm_stream_si64x((__int64* const __restrict)(dest + offset), (__int64 const)*(src + offset));
-	}
-}
-
-#include "sBatchedByIndex.h"
 #include "writeOnlyBuffer.h"
 #include "globals.h"
 #include <Math/superfastmath.h>
@@ -40,20 +19,6 @@ INLINE_MEMFUNC __streaming_store(T* const __restrict dest, T const* const __rest
 
 #pragma intrinsic(memcpy)
 #pragma intrinsic(memset)
-#pragma intrinsic(_InterlockedExchange64)
-#pragma intrinsic(_InterlockedXor64)
-#pragma intrinsic(_InterlockedOr64)
-
-using lightBatch = sBatchedByIndexReferenced<uint64_t, eStreamingBatchSize::LIGHTS>;
-
-namespace local
-{
-#ifdef __clang__
-	extern __declspec(selectany) inline constinit thread_local lightBatch lights{};
-#else
-	extern __declspec(selectany) inline constinit thread_local lightBatch lights;
-#endif
-}
 
 typedef tbb::enumerable_thread_specific< XMFLOAT3A, tbb::cache_aligned_allocator<XMFLOAT3A>, tbb::ets_key_per_instance > Bounds; // per thread instance
 
@@ -83,10 +48,8 @@ public:
 		_maximum = std::move<Bounds&&>(Bounds{});
 		_minimum = std::move<Bounds&&>(Bounds(_xmWorldLimitMax));
 
-		// clear internal atomic memory
-		___memset_threaded_stream<CACHE_LINE_BYTES>(_internal, 0, LightSize * LightSize * LightSize * sizeof(std::atomic_uint16_t), _block_size_atomic); // 700KB / thread (12 cores)
-		// clear internal cache
-		___memset_threaded_stream<CACHE_LINE_BYTES>(_cache, 0, LightSize * LightSize * LightSize * sizeof(PackedLight), _block_size_cache); // 2.7MB / thread (12 cores)
+		// thread local seed tiles are already clear, they are released by the reduction in commit()
+		
 		// clear staging buffer (right before usage)
 		if (_staging[resource_index]) {
 			___memset_threaded_stream<CACHE_LINE_BYTES>(_staging[resource_index], 0, LightSize * LightSize * LightSize * sizeof(PackedLight), _block_size_cache); // 2.7MB / thread (12 cores)
@@ -132,35 +95,146 @@ public:
 			new_min.xyzw(_min_extents);
 		}
 
-		// ensure all residual lights have been output //
-		for ( auto iter = _lights.reference().cbegin() ; iter != _lights.reference().cend() ; ++iter ) {
-			
-			auto& light(*iter);
-			light->out((uint64_t* const __restrict)_staging[_active_resource_index], (uint64_t const* const __restrict)_cache);
-		}
+		// resolve all thread local seeds into the staging buffer //
+		reduce(_staging[_active_resource_index]);
+		_mm_sfence(); // streaming stores complete before unmap
 		
 		_stagingBuffer[_active_resource_index].unmap();
 	}
 
-#ifdef DEBUG_PERF_LIGHT_RELOADS
-	static inline tbb::atomic<uint32_t>
-		num_lights = 0,
-		reloads = 0,
-		iteration_reload_max = 0,
-		reloads_counting = 0;
-#endif
-
-	// continous average!
-	//float addToAverage(float average, float size, float value)
-	//{
-	//	return (size * average + value) / (size + 1);
-	//}
 	// access - writeonly
-	// does not require mutex - data is inherntly ok out of order accumulation so it doesn't matter withe the accumulating average
-	// also the size is tracked atomically which makes this work flawlessly lock-free !!! proven with vtune. the streaming stores are also an atomic operation inherently.
+	// does not require mutex - every thread accumulates the sum of its seeds per light cell into its own tiles of 8x8x8 cells (allocated on first use).
+	// there are no atomics or shared cache lines while seeding, dense emissive areas no longer contend on the same light cell.
+	// commit() reduces the tiles of all threads in parallel, the average position & color of each light cell is then output to the staging buffer.
 
 	// there is no bounds checking, values are expected to be within bounds
 private:
+	static constexpr uint32_t const
+		TILE_BITS = 3,
+		TILE_SIZE = (1u << TILE_BITS),
+		TILE_MASK = TILE_SIZE - 1u,
+		TILE_CELLS = TILE_SIZE * TILE_SIZE * TILE_SIZE,
+		TILES_PER_AXIS = LightSize >> TILE_BITS,
+		TILE_COUNT = TILES_PER_AXIS * TILES_PER_AXIS * TILES_PER_AXIS;
+
+	typedef struct alignas(CACHE_LINE_BYTES) seed_tile
+	{
+		uint32_t	count[TILE_CELLS],
+					position[3][TILE_CELLS],	// sums of 10bpc components
+					color[3][TILE_CELLS];
+	} seed_tile;
+
+	typedef struct seed_accumulator
+	{
+		uint32_t* __restrict	directory = nullptr;	// tile index -> slot + 1, 0 = empty
+		vector<seed_tile*>		tiles;					// slots, kept for reuse frame to frame
+		uint32_t				used = 0;
+
+		seed_accumulator() = default;
+		~seed_accumulator()
+		{
+			for (auto* const tile : tiles) {
+				scalable_aligned_free(tile);
+			}
+			if (directory) {
+				scalable_aligned_free(directory); directory = nullptr;
+			}
+		}
+	} seed_accumulator;
+
+	using Seeds = tbb::enumerable_thread_specific< seed_accumulator, tbb::cache_aligned_allocator<seed_accumulator>, tbb::ets_key_per_instance >; // per thread instance
+
+	STATIC_INLINE_PURE uint32_t const get_tile_index(uint32_t const x, uint32_t const y, uint32_t const z) { // slices ordered by Y, same as the light volume
+		return(((y >> TILE_BITS) * TILES_PER_AXIS + (z >> TILE_BITS)) * TILES_PER_AXIS + (x >> TILE_BITS));
+	}
+	STATIC_INLINE_PURE uint32_t const get_cell_index(uint32_t const x, uint32_t const y, uint32_t const z) {
+		return(((y & TILE_MASK) << (TILE_BITS << 1u)) | ((z & TILE_MASK) << TILE_BITS) | (x & TILE_MASK));
+	}
+
+	__declspec(noinline) seed_tile* const __restrict allocate_tile(seed_accumulator& __restrict local, uint32_t const tile_index) const
+	{
+		[[unlikely]] if (nullptr == local.directory) {
+			local.directory = (uint32_t* __restrict)scalable_aligned_malloc(TILE_COUNT * sizeof(uint32_t), CACHE_LINE_BYTES);
+			memset(local.directory, 0, TILE_COUNT * sizeof(uint32_t));
+		}
+		if (local.used == local.tiles.size()) {
+			seed_tile* const tile((seed_tile*)scalable_aligned_malloc(sizeof(seed_tile), CACHE_LINE_BYTES));
+			memset(tile, 0, sizeof(seed_tile));
+			local.tiles.emplace_back(tile);
+		}
+		local.directory[tile_index] = ++local.used;
+
+		// the reduction only visits tiles that any thread has seeded
+		_touched[tile_index >> 6u].fetch_or(1ull << (tile_index & 63u), std::memory_order_relaxed);
+
+		return(local.tiles[local.used - 1u]);
+	}
+
+	// sums the tiles of all threads, outputs the average of each seeded light cell & releases the tiles for the next frame
+	__declspec(safebuffers) void __vectorcall reduce(PackedLight* const __restrict staging)
+	{
+		vector<uint32_t> touched;
+		for (uint32_t word = 0; word < ((TILE_COUNT + 63u) >> 6u); ++word) {
+
+			uint64_t bits(_touched[word].exchange(0, std::memory_order_relaxed));
+			while (bits) {
+				touched.emplace_back((word << 6u) + (uint32_t)_tzcnt_u64(bits));
+				bits &= bits - 1ull; // clear lowest set bit
+			}
+		}
+
+		tbb::parallel_for(size_t(0), touched.size(), [&](size_t const i) {
+
+			uint32_t const tile_index(touched[i]);
+			seed_tile sum; // each tile index is reduced by only one task, no synchronization required
+			memset(&sum, 0, sizeof(seed_tile));
+
+			for (auto& local : _seeds) {
+
+				if (nullptr == local.directory)
+					continue;
+
+				uint32_t const slot(local.directory[tile_index]);
+				if (0 == slot)
+					continue;
+
+				seed_tile* const __restrict tile(local.tiles[slot - 1u]);
+#pragma loop( ivdep )
+				for (uint32_t cell = 0; cell < TILE_CELLS; ++cell) {
+					sum.count[cell] += tile->count[cell];
+					sum.position[0][cell] += tile->position[0][cell]; sum.position[1][cell] += tile->position[1][cell]; sum.position[2][cell] += tile->position[2][cell];
+					sum.color[0][cell] += tile->color[0][cell]; sum.color[1][cell] += tile->color[1][cell]; sum.color[2][cell] += tile->color[2][cell];
+				}
+
+				memset(tile, 0, sizeof(seed_tile));
+				local.directory[tile_index] = 0;
+			}
+
+			uint32_t const tile_y((tile_index / (TILES_PER_AXIS * TILES_PER_AXIS)) << TILE_BITS),
+						   tile_z(((tile_index / TILES_PER_AXIS) % TILES_PER_AXIS) << TILE_BITS),
+						   tile_x((tile_index % TILES_PER_AXIS) << TILE_BITS);
+
+			for (uint32_t cell = 0; cell < TILE_CELLS; ++cell) {
+
+				uint32_t const count(sum.count[cell]);
+				if (0 == count)
+					continue;
+
+				uvec4_v const position(sum.position[0][cell] / count, sum.position[1][cell] / count, sum.position[2][cell] / count),
+							  color(sum.color[0][cell] / count, sum.color[1][cell] / count, sum.color[2][cell] / count);
+
+				uint32_t const x(tile_x + (cell & TILE_MASK)), z(tile_z + ((cell >> TILE_BITS) & TILE_MASK)), y(tile_y + (cell >> (TILE_BITS << 1u)));
+
+				// slices ordered by Y: (y * xMax * zMax) + (z * xMax) + x;
+				_mm_stream_si64x((__int64* const __restrict)(staging + ((y * LightSize * LightSize) + (z * LightSize) + x)), (__int64 const)pack_seed(position, color));
+			}
+		});
+
+		for (auto& local : _seeds) {
+			local.used = 0;
+		}
+	}
+
 	__declspec(safebuffers) __inline void __vectorcall updateBounds(FXMVECTOR position)
 	{
 		// max/min
@@ -247,134 +321,27 @@ private:
 		return(repacked.seed);
 	}
 
-	STATIC_INLINE_PURE void __vectorcall unpack_seed(uvec4_v& __restrict xyz, uvec4_v& __restrict rgb, uint64_t const seed) // relative position & hdr 10bpc rgb color out
+	__declspec(safebuffers) void __vectorcall seed_single(FXMVECTOR in, uvec4_t const& __restrict uiIndex, uint32_t const in_packed_color) const	// 3D emplace
 	{
-		seed_data repacked{};
-		repacked.seed = seed;
-
-		{ // 10bpc relative position
-			xyz = uvec4_v(repacked.x, (repacked.y_high << 5u) | repacked.y_low, repacked.z);
-		}
-
-		{ // 10bpc hdr color
-			rgb = uvec4_v(repacked.r, (repacked.g_high << 5u) | repacked.g_low, repacked.b);
-		}
-	}
-
-	__declspec(safebuffers) void __vectorcall seed_single(FXMVECTOR in, uint32_t const index, uint32_t const in_packed_color) const	// 3D emplace
-	{
-		// slices ordered by Z
-		// (z * xMax * yMax) + (y * xMax) + x;
-
-		// slices ordered by Y: <---- USING Y
-		// (y * xMax * zMax) + (z * xMax) + x;
-
-		// must be in world space (fractional component only)
-		//XMVECTOR ss = SFM::fract(in); // fractional coordinates of the light inside this area
-		//ss = XMVectorSubtract(ss, XMVectorReplicate(0.5f)); // convert to vector from middle of area to light
-		//XMVECTOR const tt = XMVector3LengthSq(ss); // d^2 -> d^2 + 1.0f -> 1.0f / (d^2 + 1.0f)
-		//float const dist(XMVectorGetX(tt));
-		//ss = SFM::rcp(XMVectorAdd(tt,XMVectorReplicate(1.0f))); // inverse squared distance of middle to light
-		
-		uvec4_t unpacked_rgb;
-		SFM::unpack_rgb_hdr(in_packed_color, unpacked_rgb);
-		XMVECTOR const rgb(uvec4_v(unpacked_rgb).v4f());
+		uvec4_t color;
+		SFM::unpack_rgb_hdr(in_packed_color, color);
 
 		// pre-transform / scale "in" (location) to increase precision - must rescale final decoded / unpacked value back to WorldLimits in shader
-		XMVECTOR const xyz(XMVectorScale(in, FDATA_MAX));
-
-		uint64_t original_seed = pack_seed(SFM::floor_to_u32(xyz), uvec4_v(rgb));
-
-		// concurrency safe version of: *(_cache + index) = seed;
-		std::atomic_uint16_t* const __restrict area(_internal + index);
-
-		uint32_t size(area->fetch_add(1, std::memory_order_relaxed));
-
-		__int64 prev_seed = _InterlockedExchange64((__int64 volatile* const)(_cache + index), (__int64 const)original_seed); // new light ?
-		while (0 != prev_seed) { // existing light
-			uvec4_v position, color;
-			unpack_seed(position, color, (uint64_t)prev_seed);
-			// * existing light is already attenuated if it was added already...
-			XMVECTOR const xmSize(_mm_cvtepi32_ps(_mm_set1_epi32(size)));
-			XMVECTOR const xmInvSizePlusOne(SFM::rcp(XMVectorAdd(xmSize, XMVectorReplicate(1.0f))));
-			
-			//  (size * average + value) / (size + 1)  [continous average]
-			XMVECTOR const xmPosition = XMVectorMultiply(SFM::__fma(position.v4f(), xmSize, xyz), xmInvSizePlusOne);
-			position = SFM::floor_to_u32(xmPosition);
-			
-			//  (size * average + value) / (size + 1)  [continous average]
-			XMVECTOR const xmColor = XMVectorMultiply(SFM::__fma(color.v4f(), xmSize, rgb), xmInvSizePlusOne);
-			color = SFM::floor_to_u32(xmColor);
-
-			// update
-			uint64_t const new_seed = pack_seed(position, color);
-			prev_seed = _InterlockedExchange64((__int64 volatile* const)(_cache + index), (__int64 const)new_seed);
-			if (prev_seed == (__int64 const)original_seed)
-				break; // done, 2 atomic operations are paired properly as one atomic operation
-
-			// prev seed has been updated, redo from latest atomic value
-			original_seed = new_seed;
-			size = area->load(std::memory_order_relaxed); // resync size
-		}
+		uvec4_t position;
+		SFM::floor_to_u32(XMVectorScale(in, FDATA_MAX)).xyzw(position);
 
-		local::lights.emplace_back((uint64_t* const __restrict)_staging[_active_resource_index], (uint64_t const* const __restrict)_cache, index);
+		seed_accumulator& __restrict local(const_cast<Seeds&>(_seeds).local());
 
-	}
-
-	/*
-	template<bool const fractional>
-	__declspec(safebuffers) void __vectorcall seed_single(FXMVECTOR in, uint32_t const index, uint32_t const in_packed_color) const	// 3D emplace
-	{
-		static constexpr fptr const to_u32(getRoundingFunction<fractional>());
-
-		// slices ordered by Z
-		// (z * xMax * yMax) + (y * xMax) + x;
-
-		// slices ordered by Y: <---- USING Y
-		// (y * xMax * zMax) + (z * xMax) + x;
-        
-		// pack position + color
-		uvec4_t unpacked_rgb;
-		SFM::unpack_rgb_hdr(in_packed_color, unpacked_rgb);
-		uvec4_v rgb(unpacked_rgb);
-
-		// pre-transform / scale "in" (location) to increase precision - must rescale final decoded / unpacked value back to WorldLimits in shader
-		XMVECTOR const xyz(XMVectorScale(XMVectorMultiply(in, _xmInvWorldLimitMax), FDATA_MAX));
+		uint32_t const tile_index(get_tile_index(uiIndex.x, uiIndex.y, uiIndex.z));
+		uint32_t const slot(local.directory ? local.directory[tile_index] : 0);
 
-		if constexpr (fractional) {
-
-			XMVECTOR const xmNorm(SFM::fract(in));
-			XMVECTOR const xmDSquared(XMVectorAdd(XMVector3Dot(xmNorm,xmNorm), XMVectorReplicate(1.0f)));
-
-			rgb = SFM::floor_to_u32(XMVectorDivide(rgb.v4f(), xmDSquared));
-		}
-		
-		uint64_t original_seed = pack_seed(to_u32(xyz), rgb);
-		
-		// concurrency safe version of: *(_cache + index) = seed;
-		
-		__int64 prev_seed = _InterlockedExchange64((__int64 volatile* const)(_cache + index), (__int64 const)original_seed); // new light ?
-		while (0 != prev_seed) { // existing light
-			uvec4_v position, color;
-			unpack_seed(position, color, (uint64_t)prev_seed);
-
-			// blend
-			position = to_u32(SFM::lerp(position.v4f(), xyz, 0.5f));                                                                                          
-			color = SFM::floor_to_u32(SFM::lerp(color.v4f(), rgb.v4f(), 0.5f));
-
-			// update
-			uint64_t const new_seed = pack_seed(position, color);
-			prev_seed = _InterlockedExchange64((__int64 volatile* const)(_cache + index), (__int64 const)new_seed);
-			if (prev_seed == original_seed)
-				break; // done, 2 atomic operations are paired properly as one atomic operation
-
-			// prev seed has been updated, redo from latest atomic value
-			original_seed = new_seed;
-		}
+		seed_tile* const __restrict tile(slot ? local.tiles[slot - 1u] : allocate_tile(local, tile_index));
+		uint32_t const cell(get_cell_index(uiIndex.x, uiIndex.y, uiIndex.z));
 
-		local::lights.emplace_back((uint64_t* const __restrict)_staging[_active_resource_index], (uint64_t const* const __restrict)_cache, index);
+		++tile->count[cell];
+		tile->position[0][cell] += position.x; tile->position[1][cell] += position.y; tile->position[2][cell] += position.z;
+		tile->color[0][cell] += color.r; tile->color[1][cell] += color.g; tile->color[2][cell] += color.b;
 	}
-	*/
 
 	// there is no bounds checking, values are expected to be within bounds.
 public:
@@ -398,11 +365,6 @@ public:
 		[[unlikely]] if (0 == srgbColor)
 			return; // the volume bounds are still updated
 
-		// thread_local init (only happens once/thread)
-		[[unlikely]] if (!local::lights.referenced()) {
-			const_cast<lightBuffer3D<PackedLight, LightSize, Size>* const __restrict>(this)->_lights.reference(&local::lights);
-		}
-
 		xmPosition = XMVectorMultiply(_xmInvWorldLimitMax, xmPosition); // normalize world space position
 
 		// transform normalized world space position [0.0f...1.0f] to light space position [0.0f...128.0f]
@@ -419,39 +381,75 @@ public:
 		SFM::floor_to_u32(xmIndex).xyzw(uiIndex);
 
 		// swizzle position to remap position to texture matched xzy rather than xyz
-		seed_single(XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Z, XM_SWIZZLE_Y, XM_SWIZZLE_W>(xmPosition), (uiIndex.y * LightSize * LightSize) + (uiIndex.z * LightSize) + uiIndex.x, ImagingSRGBtoLinear(srgbColor)); // faster, accurate lut srgb-->linear conversion required
+		seed_single(XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Z, XM_SWIZZLE_Y, XM_SWIZZLE_W>(xmPosition), uiIndex, ImagingSRGBtoLinear(srgbColor)); // faster, accurate lut srgb-->linear conversion required
 	}
 
 	void create(size_t const hardware_concurrency)
 	{
-		size_t size(0);
-
-		size = LightSize * LightSize * LightSize * sizeof(std::atomic_uint16_t);
-		_internal = (std::atomic_uint16_t * __restrict)scalable_aligned_malloc(size, CACHE_LINE_BYTES); // *bugfix - over-aligned for best performance and to prevent false sharing
-		_block_size_atomic = (uint32_t)(size / hardware_concurrency);
-
-		size = LightSize * LightSize * LightSize * sizeof(PackedLight);
-		_cache = (PackedLight * __restrict)scalable_aligned_malloc(size, CACHE_LINE_BYTES); // *bugfix - over-aligned for best performance (wc copy) and to prevent false sharing
+		size_t const size(LightSize * LightSize * LightSize * sizeof(PackedLight));
 		_block_size_cache = (uint32_t)(size / hardware_concurrency);
 
-		_lights.reserve(hardware_concurrency); // one thread local reference / thread
+#ifdef DEBUG_BENCHMARK_LIGHT_SEEDING
+		benchmark(hardware_concurrency);
+#endif
 
 		clear(1); clear(0); // *bugfix - setup first active resource index to be ready
 	}
 
-	lightBuffer3D(vku::double_buffer<vku::GenericBuffer> const& stagingBuffer_)
-		: _stagingBuffer(stagingBuffer_), _internal(nullptr), _cache(nullptr), _active_resource_index(0), _maximum{}, _minimum(_xmWorldLimitMax), _block_size_atomic(0), _block_size_cache(0),
-		_max_extents{ 1, 1, 1, 0 }, _min_extents{} // *bugfix - initialize initial extents to min volume (prevents an intermittent copy attempt of zero volume on startup)
-	{}
-	~lightBuffer3D()
+#ifdef DEBUG_BENCHMARK_LIGHT_SEEDING
+	// contention benchmark, a dense emissive area (every seed lands in a small block of light cells) seeded from 1 to N threads
+	void benchmark(size_t const hardware_concurrency)
 	{
-		if (_internal) {
-			scalable_aligned_free(_internal); _internal = nullptr;
+		static constexpr uint32_t const SEED_COUNT = 1 << 22,
+										HOTSPOT_SIZE = 16;		// light cells per axis
+		static constexpr uint32_t const SEED_COLOR = 0x00ff00ff; // neon
+
+		float const fHotspot(float(HOTSPOT_SIZE) * float(Size) / float(LightSize));
+
+		vector<XMFLOAT4A> positions(SEED_COUNT);
+		for (auto& position : positions) {
+			position = XMFLOAT4A(PsuedoRandomFloat() * fHotspot, PsuedoRandomFloat() * fHotspot, PsuedoRandomFloat() * fHotspot, 0.0f);
 		}
-		if (_cache) {
-			scalable_aligned_free(_cache); _cache = nullptr;
+
+		PackedLight* const __restrict scratch((PackedLight*)scalable_aligned_malloc(LightSize * LightSize * LightSize * sizeof(PackedLight), CACHE_LINE_BYTES));
+
+		FMT_LOG(PERF_LOG, "light seeding benchmark: {:d} seeds into {:d}^3 light cells", SEED_COUNT, HOTSPOT_SIZE);
+
+		for (size_t threads = 1; ; threads = std::min(threads << 1, hardware_concurrency)) { // 1, 2, 4 ... always ends on all threads
+
+			tbb::task_arena arena((int)threads);
+
+			fp_seconds tSeed{}, tReduce{};
+			arena.execute([&] {
+
+				tTime tStart(high_resolution_clock::now());
+				tbb::parallel_for(tbb::blocked_range<uint32_t>(0, SEED_COUNT, 1024), [&](tbb::blocked_range<uint32_t> const& r) {
+					for (uint32_t i = r.begin(); i < r.end(); ++i) {
+						seed(XMLoadFloat4A(&positions[i]), SEED_COLOR);
+					}
+				});
+				tSeed = high_resolution_clock::now() - tStart;
+
+				tStart = high_resolution_clock::now();
+				reduce(scratch);
+				tReduce = high_resolution_clock::now() - tStart;
+			});
+
+			FMT_LOG(PERF_LOG, "{:d} threads  {:.1f} M seeds/s  reduce {:d} us", threads, (double(SEED_COUNT) / tSeed.count()) * 1e-6, duration_cast<microseconds>(tReduce).count());
+
+			if (hardware_concurrency == threads)
+				break;
 		}
+
+		scalable_aligned_free(scratch);
 	}
+#endif
+
+	lightBuffer3D(vku::double_buffer<vku::GenericBuffer> const& stagingBuffer_)
+		: _stagingBuffer(stagingBuffer_), _staging{}, _touched{}, _active_resource_index(0), _maximum{}, _minimum(_xmWorldLimitMax), _block_size_cache(0),
+		_max_extents{ 1, 1, 1, 0 }, _min_extents{} // *bugfix - initialize initial extents to min volume (prevents an intermittent copy attempt of zero volume on startup)
+	{}
+	~lightBuffer3D() = default;
 
 private:
 	lightBuffer3D(lightBuffer3D const&) = delete;
@@ -459,13 +457,11 @@ private:
 	void operator=(lightBuffer3D const&) = delete;
 	void operator=(lightBuffer3D&&) = delete;
 private:
-	std::atomic_uint16_t* __restrict								    _internal;
-	PackedLight* __restrict											_cache;
 	PackedLight* __restrict									        _staging[2];
 	vku::double_buffer<vku::GenericBuffer> const& __restrict        _stagingBuffer;
 
-	using lightBatchReferences = references<lightBatch>;
-	lightBatchReferences									 _lights{};
+	Seeds															_seeds;
+	mutable std::atomic_uint64_t									_touched[(TILE_COUNT + 63u) >> 6u];	// tiles seeded by any thread this frame
 
 	Bounds 								  _maximum,		// ** xzy form for all bounds / extents !!!
 		                                  _minimum;
@@ -474,8 +470,7 @@ private:
 		                                  _min_extents;
 
 	uint32_t							  _active_resource_index;
-	uint32_t				              _block_size_atomic,
-		                                  _block_size_cache;
+	uint32_t				              _block_size_cache;
 };
 
 
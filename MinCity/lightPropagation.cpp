@@ -0,0 +1,478 @@
+/* Copyright (C) 20xx Jason Tully - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License
+ * http://www.supersinfulsilicon.com/
+ *
+This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/
+or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#include "pch.h"
+#include "lightPropagation.h"
+#include "IsoVoxel.h"
+#include "MinCity.h"
+#include <Math/superfastmath.h>
+
+#pragma intrinsic(memcpy)
+#pragma intrinsic(memset)
+
+namespace // private to this file (anonymous)
+{
+	using namespace DirectX;
+	using namespace DirectX::PackedVector;
+
+	static constexpr float const FDATA_MAX = 1023.0f,				// 10 bits per component, same as lightBuffer3D
+								 INV_FDATA_MAX = 1.0f / FDATA_MAX,
+								 MAGIC_SCALAR = 1.0f / 8.0f;		// light.glsl (COMPUTE_SCALE/8.0f)
+
+	static constexpr uint32_t const FILTER_SAMPLES = 15,			// light.comp FILTER, self + 14 neighbours
+									LANES = 8;						// voxels per jump flood iteration (AVX2)
+
+	// texel layout (lightBuffer3D::seed_data), the low 32 bits are the color, the high 32 bits are the position
+	//   0xxxxxxxxxxyyyyy 0yyyyyzzzzzzzzzz 0rrrrrrrrrrggggg 0gggggbbbbbbbbbb
+	STATIC_INLINE_PURE uint32_t const pack10(uint32_t const a, uint32_t const b, uint32_t const c)
+	{
+		return(((a & 0x3ffu) << 21u) | ((b & 0x3e0u) << 11u) | ((b & 0x1fu) << 10u) | (c & 0x3ffu));
+	}
+	STATIC_INLINE_PURE XMVECTOR const XM_CALLCONV unpack10(uint32_t const packed) // normalized [0.0f...1.0f]
+	{
+		return(XMVectorScale(XMVectorSet(float((packed >> 21u) & 0x3ffu), float(((packed >> 11u) & 0x3e0u) | ((packed >> 10u) & 0x1fu)), float(packed & 0x3ffu), 0.0f), INV_FDATA_MAX));
+	}
+
+	STATIC_INLINE_PURE float const attenuation(float const light_distance)
+	{
+		return(1.0f / (light_distance * light_distance + 1.0f));
+	}
+
+	// toroidal (wrap-around) distance, input & output normalized
+	STATIC_INLINE_PURE float const XM_CALLCONV emitter_to_distance(FXMVECTOR emitter_location, FXMVECTOR current_location)
+	{
+		XMVECTOR const dv(XMVectorAbs(XMVectorSubtract(emitter_location, current_location)));
+
+		return(XMVectorGetX(XMVector3Length(XMVectorMin(dv, XMVectorSubtract(XMVectorSplatOne(), dv)))));
+	}
+
+	STATIC_INLINE_PURE uint32_t const getStepMax(uint32_t const size) // same as volumetricOpacity
+	{
+		uint32_t step(1);
+		while (((step << 1) < size)) {
+			step <<= 1;
+		}
+		return(step);
+	}
+
+	// 8 texels (2 x 4) -> low (color) & high (position) 32 bits, in texel order
+	STATIC_INLINE void __vectorcall split(__m256i const a, __m256i const b, __m256i& __restrict lo, __m256i& __restrict hi)
+	{
+		lo = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+		hi = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+	}
+
+	// squared toroidal distance of 8 emitters to 8 voxel locations, 1.0f (the maximum) for texels that are not emitters
+	// the jump flood only compares distances, squared distance selects the same emitter
+	STATIC_INLINE_PURE __m256 const __vectorcall distance_squared(__m256i const lo, __m256i const hi, __m256 const cx, __m256 const cy, __m256 const cz)
+	{
+		__m256i const mask10(_mm256_set1_epi32(0x3ff));
+		__m256 const scale(_mm256_set1_ps(INV_FDATA_MAX)), one(_mm256_set1_ps(1.0f)), sign(_mm256_set1_ps(-0.0f));
+
+		__m256 const ex(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(hi, 21), mask10)), scale)),
+					 ey(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(hi, 11), _mm256_set1_epi32(0x3e0)), _mm256_and_si256(_mm256_srli_epi32(hi, 10), _mm256_set1_epi32(0x1f)))), scale)),
+					 ez(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(hi, mask10)), scale));
+
+		__m256 dx(_mm256_andnot_ps(sign, _mm256_sub_ps(ex, cx))),
+			   dy(_mm256_andnot_ps(sign, _mm256_sub_ps(ey, cy))),
+			   dz(_mm256_andnot_ps(sign, _mm256_sub_ps(ez, cz)));
+
+		// toroidal (wrap-around)
+		dx = _mm256_min_ps(dx, _mm256_sub_ps(one, dx));
+		dy = _mm256_min_ps(dy, _mm256_sub_ps(one, dy));
+		dz = _mm256_min_ps(dz, _mm256_sub_ps(one, dz));
+
+		__m256 const d2(_mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx))));
+		__m256 const empty(_mm256_castsi256_ps(_mm256_cmpeq_epi32(lo, _mm256_setzero_si256()))); // no color, not an emitter
+
+		return(_mm256_blendv_ps(d2, one, empty));
+	}
+
+	// seed stage, temporal blend of the light color. the color of a light cell eases toward the new color based on how far its emitter moved since the last frame.
+	static void blend_seeds(uint64_t const* const __restrict seeds, uint64_t const* const __restrict last, uint64_t* const __restrict out, uint32_t const size, float const light_scale)
+	{
+		size_t const slice_voxels(size_t(size) * size_t(size));
+
+		tbb::parallel_for(tbb::blocked_range<uint32_t>(0, size), [&](tbb::blocked_range<uint32_t> const& r) {
+
+			for (size_t i = r.begin() * slice_voxels; i < r.end() * slice_voxels; ++i) {
+
+				uint64_t const now(seeds[i]), before(last[i]);
+
+				if (0 == (now | before)) { // empty light cell, same result as the blend
+					out[i] = 0;
+					continue;
+				}
+
+				uint32_t const now_position(uint32_t(now >> 32u));
+
+				float const t(attenuation(emitter_to_distance(unpack10(uint32_t(before >> 32u)), unpack10(now_position)) * light_scale) * 0.5f + 0.5f);
+
+				XMFLOAT4A color;
+				XMStoreFloat4A(&color, XMVectorScale(XMVectorLerp(unpack10(uint32_t(before)), unpack10(uint32_t(now)), t), FDATA_MAX));
+
+				out[i] = (uint64_t(now_position) << 32u) | uint64_t(pack10(uint32_t(color.x), uint32_t(color.y), uint32_t(color.z)));
+			}
+		});
+	}
+
+	// one jump flood pass, every voxel takes the nearest emitter of itself & its 26 neighbours at a distance of step
+	// jitter is the output ping-pong index, the shader offsets the voxel location by it on x & y
+	static void jump_flood(uint64_t const* const __restrict in, uint64_t* const __restrict out, uint32_t const size, uint32_t const height, int32_t const step, uint32_t const jitter)
+	{
+		float const inv_size(1.0f / float(size));
+
+		tbb::parallel_for(tbb::blocked_range<uint32_t>(0, height), [&](tbb::blocked_range<uint32_t> const& r) {
+
+			__m256i const lane_index(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)), xmSize(_mm256_set1_epi32(int32_t(size)));
+			__m256 const lane_offset(_mm256_cvtepi32_ps(lane_index)), xmInvSize(_mm256_set1_ps(inv_size));
+
+			for (uint32_t z = r.begin(); z < r.end(); ++z) { // slices ordered by Y
+
+				__m256 const cz(_mm256_set1_ps(float(z) * inv_size));
+
+				for (uint32_t y = 0; y < size; ++y) {
+
+					__m256 const cy(_mm256_set1_ps(float(y + jitter) * inv_size));
+
+					for (uint32_t x = 0; x < size; x += LANES) {
+
+						__m256 const cx(_mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps(float(x + jitter)), lane_offset), xmInvSize));
+						size_t const index((size_t(z) * size + y) * size + x);
+
+						// self
+						__m256i best_a(_mm256_load_si256((__m256i const* const)(in + index))), best_b(_mm256_load_si256((__m256i const* const)(in + index + 4)));
+						__m256 best;
+						{
+							__m256i lo, hi;
+							split(best_a, best_b, lo, hi);
+							best = distance_squared(lo, hi, cx, cy, cz);
+						}
+
+						for (int32_t dz = -step; dz <= step; dz += step) {
+
+							int32_t const nz(int32_t(z) + dz);
+							if (nz < 0 || nz >= int32_t(size))
+								continue;
+
+							for (int32_t dy = -step; dy <= step; dy += step) {
+
+								int32_t const ny(int32_t(y) + dy);
+								if (ny < 0 || ny >= int32_t(size))
+									continue;
+
+								for (int32_t dx = -step; dx <= step; dx += step) {
+
+									if (0 == (dx | dy | dz)) // self
+										continue;
+
+									int32_t const nx(int32_t(x) + dx);
+									if (nx + int32_t(LANES) <= 0 || nx >= int32_t(size))
+										continue;
+
+									uint64_t const* const __restrict src(in + ((ptrdiff_t(nz) * size + ny) * size + nx));
+									__m256i a, b;
+
+									if (nx >= 0 && (nx + int32_t(LANES)) <= int32_t(size)) {
+										a = _mm256_loadu_si256((__m256i const* const)src);
+										b = _mm256_loadu_si256((__m256i const* const)(src + 4));
+									}
+									else { // lanes outside of the volume read zero (not an emitter), same as an out of bounds texelFetch
+										__m256i const lx(_mm256_add_epi32(_mm256_set1_epi32(nx), lane_index));
+										__m256i const valid(_mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), lx), _mm256_cmpgt_epi32(xmSize, lx)));
+
+										a = _mm256_maskload_epi64((long long const* const)src, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(valid)));
+										b = _mm256_maskload_epi64((long long const* const)(src + 4), _mm256_cvtepi32_epi64(_mm256_extracti128_si256(valid, 1)));
+									}
+
+									__m256i lo, hi;
+									split(a, b, lo, hi);
+
+									__m256 const d(distance_squared(lo, hi, cx, cy, cz));
+									__m256i const closer(_mm256_castps_si256(_mm256_cmp_ps(d, best, _CMP_LT_OQ)));
+
+									best = _mm256_min_ps(best, d);
+									best_a = _mm256_blendv_epi8(best_a, a, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(closer)));
+									best_b = _mm256_blendv_epi8(best_b, b, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(closer, 1)));
+								}
+							}
+						}
+
+						_mm256_store_si256((__m256i* const)(out + index), best_a);
+						_mm256_store_si256((__m256i* const)(out + index + 4), best_b);
+					}
+				}
+			}
+		});
+	}
+
+	// filter stage, final distance & direction and color
+	// in light.comp every neighbour sample only replaces the warp if it is closer, however sample_warp() measures the distance of the current warp (not the sample)
+	// so no sample ever replaces it and each of the 15 samples accumulates the attenuated color of the voxels own emitter. it is evaluated here in closed form.
+	static void filter(Volumetric::jfa::lightVolumeCPU& __restrict volume, uint64_t const* const __restrict in, float const light_scale)
+	{
+		uint32_t const size(volume.light_size);
+		float const inv_size(1.0f / float(size));
+
+		tbb::parallel_for(tbb::blocked_range<uint32_t>(0, size), [&](tbb::blocked_range<uint32_t> const& r) {
+
+			XMVECTOR const xmHalf(XMVectorReplicate(0.5f));
+
+			for (uint32_t z = r.begin(); z < r.end(); ++z) {
+				for (uint32_t y = 0; y < size; ++y) {
+
+					size_t i((size_t(z) * size + y) * size);
+
+					for (uint32_t x = 0; x < size; ++x, ++i) {
+
+						uint64_t const warp(in[i]);
+
+						XMVECTOR const location(unpack10(uint32_t(warp >> 32u)));
+						XMVECTOR const uvw(XMVectorScale(XMVectorSubtract(XMVectorSet(float(x), float(y), float(z), 0.0f), xmHalf), inv_size)); // -0.5 for trilinear sampling
+
+						float const distance(emitter_to_distance(location, uvw)),
+									current_distance(std::min(1.0f, distance));
+
+						XMVECTOR const color(XMVectorScale(unpack10(uint32_t(warp)), float(FILTER_SAMPLES) * attenuation(distance * light_scale * MAGIC_SCALAR)));
+
+						XMStoreHalf4(&volume.Color[i], XMVectorSetW(color, current_distance));
+						XMStoreUShortN4(&volume.DistanceDirection[i], XMVectorSetW(location, current_distance));
+					}
+				}
+			}
+		});
+	}
+
+} // end ns
+
+namespace Volumetric
+{
+	namespace jfa
+	{
+		bool const create(lightVolumeCPU& __restrict volume, uint32_t const light_size, uint32_t const world_size)
+		{
+			if (light_size < LANES || 0 != (light_size & (light_size - 1u)) || 0 == world_size) {
+				FMT_LOG_FAIL(TEX_LOG, "cpu light volume, size {:d} must be a power of 2 and at least {:d}", light_size, LANES);
+				return(false);
+			}
+
+			size_t const voxels(size_t(light_size) * size_t(light_size) * size_t(light_size));
+
+			volume.PingPong[0].assign(voxels, 0);
+			volume.PingPong[1].assign(voxels, 0);
+			volume.Last.assign(voxels, 0);
+			volume.DistanceDirection.assign(voxels, XMUSHORTN4{});
+			volume.Color.assign(voxels, XMHALF4{});
+
+			volume.light_size = light_size;
+			volume.world_size = world_size;
+			volume.last_output_index = 1;
+
+			return(true);
+		}
+
+		void release(lightVolumeCPU& __restrict volume)
+		{
+			for (uint32_t i = 0; i < 2; ++i) {
+				volume.PingPong[i].clear(); volume.PingPong[i].shrink_to_fit();
+			}
+			volume.Last.clear(); volume.Last.shrink_to_fit();
+			volume.DistanceDirection.clear(); volume.DistanceDirection.shrink_to_fit();
+			volume.Color.clear(); volume.Color.shrink_to_fit();
+
+			volume.light_size = volume.world_size = 0;
+		}
+
+		void propagate(lightVolumeCPU& __restrict volume, uint64_t const* const __restrict seeds, uint32_t const height)
+		{
+			uint32_t const size(volume.light_size);
+			if (0 == size)
+				return;
+
+			// jump flood only covers the dispatch height (multiple of 8), seed & filter always cover the whole volume - same as the compute shaders
+			uint32_t const jfa_height(0 == height ? size : std::min(size, (height + 7u) & ~7u));
+			float const light_scale(SFM::__sqrt(3.0f * float(volume.world_size) * float(volume.world_size)) * Iso::MINI_VOX_SIZE); // WorldLength * VOX_SIZE
+
+			// Seed and 1+JFA (error correction)
+			uint32_t const seed_output(!volume.last_output_index);
+
+			blend_seeds(seeds, volume.Last.data(), volume.PingPong[!seed_output].data(), size, light_scale);
+			jump_flood(volume.PingPong[!seed_output].data(), volume.PingPong[seed_output].data(), size, size, 1, seed_output);
+
+			// ( JFA ) //
+			uint32_t step(getStepMax(size) >> 1);
+			uint32_t uPing(seed_output), uPong(!seed_output);
+
+			while (0 != step) {
+
+				jump_flood(volume.PingPong[uPing].data(), volume.PingPong[uPong].data(), size, jfa_height, int32_t(step), uPong);
+
+				std::swap(uPing, uPong);
+				step >>= 1; // halving
+			}
+
+			// Filter
+			filter(volume, volume.PingPong[uPing].data(), light_scale);
+
+			// seeds of this frame are the "last" of the next frame
+			memcpy(volume.Last.data(), seeds, volume.Last.size() * sizeof(uint64_t));
+
+			volume.last_output_index = uPong;
+		}
+
+		verifyResult const verify(lightVolumeCPU const& __restrict volume, uint64_t const* const __restrict seeds, size_t const max_samples, float const tolerance)
+		{
+			verifyResult result{};
+
+			uint32_t const size(volume.light_size);
+			size_t const voxels(size_t(size) * size_t(size) * size_t(size));
+
+			if (0 == voxels || 0 == max_samples)
+				return(result);
+
+			// every emitter position, a light cell without color is not an emitter
+			vector<uint32_t> positions;
+			for (size_t i = 0; i < voxels; ++i) {
+				if (0 != uint32_t(seeds[i])) {
+					positions.emplace_back(uint32_t(seeds[i] >> 32u));
+				}
+			}
+			std::sort(positions.begin(), positions.end());
+			positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+			if (positions.empty())
+				return(result);
+
+			vector<XMFLOAT3A> emitters(positions.size());
+			for (size_t i = 0; i < positions.size(); ++i) {
+				XMStoreFloat3A(&emitters[i], unpack10(positions[i]));
+			}
+
+			// every voxel, or an evenly spread subset of them
+			size_t const count(std::min(voxels, max_samples)),
+						 stride(voxels / count);
+			float const inv_size(1.0f / float(size));
+
+			result = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, count), verifyResult{}, [&](tbb::blocked_range<size_t> const& r, verifyResult partial) {
+
+				XMVECTOR const xmHalf(XMVectorReplicate(0.5f));
+
+				for (size_t sample = r.begin(); sample < r.end(); ++sample) {
+
+					size_t const i(sample * stride);
+					uint32_t const x(uint32_t(i % size)), y(uint32_t((i / size) % size)), z(uint32_t(i / (size_t(size) * size_t(size))));
+
+					XMVECTOR const uvw(XMVectorScale(XMVectorSubtract(XMVectorSet(float(x), float(y), float(z), 0.0f), xmHalf), inv_size)); // same location as the filter stage
+
+					float nearest(1.0f);
+					for (auto const& emitter : emitters) {
+						nearest = std::min(nearest, emitter_to_distance(XMLoadFloat3A(&emitter), uvw));
+					}
+
+					XMFLOAT4A found;
+					XMStoreFloat4A(&found, XMLoadUShortN4(&volume.DistanceDirection[i]));
+
+					uint32_t const found_position(pack10(uint32_t(SFM::floor(found.x * FDATA_MAX + 0.5f)), uint32_t(SFM::floor(found.y * FDATA_MAX + 0.5f)), uint32_t(SFM::floor(found.z * FDATA_MAX + 0.5f))));
+					float const error(found.w - nearest);
+
+					partial.max_error_distance = std::max(partial.max_error_distance, error);
+
+					if (error > tolerance || !std::binary_search(positions.cbegin(), positions.cend(), found_position)) {
+						++partial.mismatched;
+					}
+					++partial.voxels;
+				}
+
+				return(partial);
+
+			}, [](verifyResult const& a, verifyResult const& b) {
+
+				return(verifyResult{ a.voxels + b.voxels, a.mismatched + b.mismatched, std::max(a.max_error_distance, b.max_error_distance) });
+			});
+
+			return(result);
+		}
+
+#ifdef DEBUG_BENCHMARK_LIGHT_PROPAGATION
+		// light volume size vs. time, the same synthetic lights (one per 8x8x8 light cells) at every size. the output of each size is then verified
+		// against an exhaustive search over the lights (see verify), there is no stored reference that could go stale.
+		void benchmark(uint32_t const light_size, uint32_t const world_size)
+		{
+			static constexpr uint32_t const MIN_SIZE = 32,
+											MAX_SIZE = 256,		// ~700MB of volumes at 256
+											WARMUP_FRAMES = 2,
+											FRAMES = 8;
+			static constexpr size_t const VERIFY_SAMPLES = 64 * 64 * 64; // every voxel up to 64^3
+
+			FMT_LOG(PERF_LOG, "light propagation benchmark (cpu): {:d} frames per volume size, {:d} threads", FRAMES, tbb::this_task_arena::max_concurrency());
+
+			for (uint32_t size = MIN_SIZE; size <= MAX_SIZE; size <<= 1) {
+
+				lightVolumeCPU volume;
+				if (!create(volume, size, std::max(1u, uint32_t((uint64_t(world_size) * size) / light_size)))) // same world to light volume ratio
+					continue;
+
+				vector_aligned<uint64_t, CACHE_LINE_BYTES> seeds(size_t(size) * size_t(size) * size_t(size), 0);
+				{
+					uint32_t state(0x9e3779b9u); // fixed, the same lights every run
+					auto const next = [&state]() {
+						state ^= state << 13u; state ^= state >> 17u; state ^= state << 5u;
+						return(state);
+					};
+
+					uint32_t const lights(std::max(1u, (size * size * size) >> 9u));
+					for (uint32_t i = 0; i < lights; ++i) {
+
+						uint32_t const x(next() % size), y(next() % size), z(next() % size);
+
+						// position inside of the light cell, normalized & packed as lightBuffer3D does
+						auto const position = [&](uint32_t const cell) {
+							return(uint32_t(SFM::floor((float(cell) + float(next() & 0xffffu) / 65536.0f) / float(size) * FDATA_MAX)));
+						};
+						uint32_t const px(position(x)), py(position(y)), pz(position(z));
+
+						seeds[(size_t(z) * size + y) * size + x] = (uint64_t(pack10(px, py, pz)) << 32u) | uint64_t(pack10(next() | 1u, next() | 1u, next() | 1u));
+					}
+				}
+
+				for (uint32_t frame = 0; frame < WARMUP_FRAMES; ++frame) {
+					propagate(volume, seeds.data());
+				}
+
+				tTime const tStart(high_resolution_clock::now());
+				for (uint32_t frame = 0; frame < FRAMES; ++frame) {
+					propagate(volume, seeds.data());
+				}
+				fp_seconds const tElapsed(high_resolution_clock::now() - tStart);
+
+				double const voxels(double(size) * double(size) * double(size));
+				FMT_LOG(PERF_LOG, "{:d}^3  {:.2f} ms / frame  {:.1f} M voxels/s", size, (tElapsed.count() * 1000.0) / double(FRAMES), (voxels * double(FRAMES) / tElapsed.count()) * 1e-6);
+
+				// the jump flood measures from a location up to ~2.2 voxels from the filter's (jitter on x & y, the filter's -0.5), which can
+				// change the nearest distance by at most twice that. positions are 10 bits.
+				float const tolerance(4.5f / float(size) + 2.0f * INV_FDATA_MAX);
+
+				verifyResult const result(verify(volume, seeds.data(), VERIFY_SAMPLES, tolerance));
+
+				if (0 == result.voxels) {
+					FMT_LOG_FAIL(PERF_LOG, "{:d}^3 not verified", size);
+				}
+				else if (0 == result.mismatched) {
+					FMT_LOG_OK(PERF_LOG, "{:d}^3 matches exhaustive search ({:n} voxels), max distance error {:.5f}", size, result.voxels, result.max_error_distance);
+				}
+				else {
+					FMT_LOG_FAIL(PERF_LOG, "{:d}^3 {:d} of {:d} voxels differ from exhaustive search, max distance error {:.5f}", size, result.mismatched, result.voxels, result.max_error_distance);
+				}
+			}
+		}
+#endif
+
+	} // end ns
+} // end ns
@@ -0,0 +1,67 @@
+#pragma once
+/* Copyright (C) 20xx Jason Tully - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License
+ * http://www.supersinfulsilicon.com/
+ *
+This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/
+or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+#include "globals.h"
+#include <Utility/class_helper.h>
+#include <DirectXPackedVector.h>
+
+// cpu implementation of the jump flood light propagation (light.comp), the same SEED -> JFA ping-pong -> FILTER pipeline that volumetricOpacity
+// records as compute. it consumes the light probe map exactly as lightBuffer3D stages it (packed 10bpc position & color, slices ordered by Y)
+// and outputs the same lightmap (distance & direction, color) in the same layout & formats as voxelLightmapSet.
+// multithreaded over slices, the jump flood is 8 voxels at a time (AVX2). there is no gpu dependency, so it can serve as the golden reference
+// for the compute shaders and as a lighting backend when compute is unavailable.
+//
+//		Volumetric::jfa::lightVolumeCPU volume;
+//		Volumetric::jfa::create(volume, LightSize, Size);
+//		...
+//		Volumetric::jfa::propagate(volume, seeds);	// every frame, seeds are the reduced light probe map
+//		volume.DistanceDirection, volume.Color		// output
+namespace Volumetric
+{
+	namespace jfa
+	{
+		typedef struct sLightVolumeCPU : no_copy
+		{
+			vector_aligned<uint64_t, CACHE_LINE_BYTES>								PingPong[2],	// packed light probe texels
+																					Last;			// seeds of the previous frame (temporal blend in the seed stage)
+
+			vector_aligned<DirectX::PackedVector::XMUSHORTN4, CACHE_LINE_BYTES>		DistanceDirection;	// final output, rgba16 unorm (emitter location, distance)
+			vector_aligned<DirectX::PackedVector::XMHALF4, CACHE_LINE_BYTES>		Color;				// final output, rgba16f  (light color, distance)
+
+			uint32_t	light_size = 0,				// uniform light volume size, power of 2
+						world_size = 0,				// uniform world volume size
+						last_output_index = 1;		// same initial state as volumetricOpacity
+
+		} lightVolumeCPU;
+
+		bool const create(lightVolumeCPU& __restrict volume, uint32_t const light_size, uint32_t const world_size);
+		void release(lightVolumeCPU& __restrict volume);
+
+		// one frame. height limits the jump flood to the lower slices that contain lights (dispatch height), 0 = whole volume
+		void propagate(lightVolumeCPU& __restrict volume, uint64_t const* const __restrict seeds, uint32_t const height = 0);
+
+		// verification of the output against an exhaustive search over the seeds, independent of the jump flood. for every sampled voxel the emitter
+		// found must be one of the seeds, and its distance may exceed the distance of the nearest seed by no more than the tolerance (normalized)
+		typedef struct sVerifyResult
+		{
+			size_t		voxels,				// sampled
+						mismatched;			// emitter is not a seed, or is farther than the nearest seed + tolerance
+			float		max_error_distance;
+
+		} verifyResult;
+
+		verifyResult const verify(lightVolumeCPU const& __restrict volume, uint64_t const* const __restrict seeds, size_t const max_samples, float const tolerance);
+
+#ifdef DEBUG_BENCHMARK_LIGHT_PROPAGATION
+		void benchmark(uint32_t const light_size, uint32_t const world_size);
+#endif
+
+	} // end ns
+} // end ns
@@ -8,7 +8,7 @@
 #include <filesystem>
 #include <vector>
 #include <Utility/stringconv.h>
-#include <density.h>	// https://github.com/centaurean/density - Density, fastest compression/decompression library out there with simple interface. must reproduce license file. attribution.
+#include "codec.h"
 #include "cNonUpdateableGameObject.h"
 
 namespace fs = std::filesystem;
@@ -217,24 +217,41 @@ namespace world
 
 							MinCity::DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(30));
 
-							// read compressed grid, using decompression - its already memory mapped
+							bool bGridLoaded(false);
 
-							// Determine safe buffer sizes
-							size_t const decompress_safe_size = density_decompress_safe_size(gridSz);
+							if (0 == headerChunk.grid_compressed_size) { // chunked grid file
 
-							uint8_t* __restrict outDecompressed((uint8_t * __restrict)scalable_malloc(decompress_safe_size));
+								fs::path gridPath(path);
+								gridPath.replace_extension(GRID_FILE_EXT);
 
-							density_processing_result const result = density_decompress((uint8_t* const __restrict) & pReadPointer[0], headerChunk.grid_compressed_size, outDecompressed, decompress_safe_size);
+								bGridLoaded = GridLoad(gridPath.wstring());
+							}
+							else { // legacy - read compressed grid, using decompression - its already memory mapped
 
-							if (!result.state) {
+								// Determine safe buffer sizes
+								size_t const decompress_safe_size = codec::decompress_bound(codec::eCodec::DENSITY_CHEETAH, gridSz);
 
-								InitializeRandomNumberGenerators(headerChunk.secure_seed); // use the seed the city was saved with for program (deterministic random state) now
+								uint8_t* __restrict outDecompressed((uint8_t * __restrict)scalable_malloc(decompress_safe_size));
 
-								MinCity::DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(50));
+								// legacy grid blob is always density
+								if (0 != codec::decompress(codec::eCodec::DENSITY_CHEETAH, &pReadPointer[0], headerChunk.grid_compressed_size, outDecompressed, decompress_safe_size)) {
 
-								cVoxelWorld::GridSnapshotLoad((Iso::Voxel const* const __restrict)outDecompressed);
-								pReadPointer += headerChunk.grid_compressed_size;
+									GridLoadLegacy((Iso::Voxel const* const __restrict)outDecompressed);
+									pReadPointer += headerChunk.grid_compressed_size;
+									bGridLoaded = true;
+								}
+
+								if (outDecompressed) {
+									scalable_free(outDecompressed);
+									outDecompressed = nullptr;
+								}
+							}
 
+							if (bGridLoaded) {
+
+								InitializeRandomNumberGenerators(headerChunk.secure_seed); // use the seed the city was saved with for program (deterministic random state) now
+
+								MinCity::DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(50));
 								MinCity::DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(70));
 
 								{
@@ -354,11 +371,6 @@ namespace world
 								}
 								MinCity::DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(100));
 							}
-
-							if (outDecompressed) {
-								scalable_free(outDecompressed);
-								outDecompressed = nullptr;
-							}
 						}
 					}
 				}
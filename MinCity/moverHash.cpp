@@ -0,0 +1,426 @@
+/* Copyright (C) 20xx Jason Tully - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License
+ * http://www.supersinfulsilicon.com/
+ *
+This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/
+or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#include "pch.h"
+#include "moverHash.h"
+#include <Math/superfastmath.h>
+#include <bit>
+
+namespace // private to this file (anonymous)
+{
+	static constexpr uint32_t const CELL_SHIFT = 3;									// cells are 8x8 voxels, a car touches 1 - 4 cells
+	static constexpr float const INV_CELL_SIZE = 1.0f / float(1u << CELL_SHIFT);
+
+	typedef struct sBox // oriented box, Grid Space (-x,-y) to (X, Y)
+	{
+		float	cx, cy,			// center
+				ax, ay,			// normalized axis (length), width is along the perpendicular
+				hl, hw;			// half length, half width
+
+	} box;
+
+	typedef struct sEntry
+	{
+		uint64_t	key;		// cell
+		uint32_t	index;		// mover
+
+	} entry;
+
+	typedef struct sCell
+	{
+		uint64_t	key;
+		uint32_t	begin,		// [begin, end) of the sorted entries
+					end;		// 0 = empty slot
+
+	} cell;
+
+	typedef struct sCellRect
+	{
+		int32_t		left, top,
+					right, bottom; // inclusive
+
+	} cellRect;
+
+	static struct sMoverHash
+	{
+		tbb::concurrent_vector<world::movers::mover>	submitted;	// poses for the next frame
+		vector<world::movers::mover>					movers;		// this frame
+		vector<uint32_t>								first;		// first entry of each mover (prefix sum of the cells it touches)
+		vector<entry>									entries;	// sorted by cell
+		vector<cell>									table;		// open addressing, cell key to its entries
+		uint32_t										mask = 0;
+
+	} _hash;
+
+	STATIC_INLINE_PURE uint64_t const cell_key(int32_t const x, int32_t const y)
+	{
+		return((uint64_t(uint32_t(y)) << 32ull) | uint64_t(uint32_t(x)));
+	}
+
+	STATIC_INLINE_PURE uint32_t const cell_slot(uint64_t const key, uint32_t const mask)
+	{
+		return(uint32_t((key * 0x9E3779B97F4A7C15ull) >> 32ull) & mask);
+	}
+
+	STATIC_INLINE_PURE box const to_box(world::movers::mover const& __restrict m)
+	{
+		return(box{ m.location.x, m.location.y, m.axis.x, m.axis.y, m.half_length, m.half_width });
+	}
+
+	// projection radius of the box onto the axis (x, y)
+	STATIC_INLINE_PURE float const radius(box const& __restrict b, float const x, float const y)
+	{
+		return(b.hl * SFM::abs(b.ax * x + b.ay * y) + b.hw * SFM::abs(b.ay * x - b.ax * y));
+	}
+
+	// separating axis test, boxes that only touch do not overlap
+	STATIC_INLINE_PURE bool const overlap(box const& __restrict a, box const& __restrict b)
+	{
+		float const dx(b.cx - a.cx), dy(b.cy - a.cy);
+		float const axes[4][2] = { { a.ax, a.ay }, { -a.ay, a.ax }, { b.ax, b.ay }, { -b.ay, b.ax } };
+
+		for (uint32_t i = 0; i < 4; ++i) {
+
+			float const x(axes[i][0]), y(axes[i][1]);
+
+			if (SFM::abs(dx * x + dy * y) >= radius(a, x, y) + radius(b, x, y)) {
+				return(false);
+			}
+		}
+		return(true);
+	}
+
+	// cells touched by the axis aligned bounds of the box
+	STATIC_INLINE_PURE cellRect const cells_of(box const& __restrict b)
+	{
+		float const ex(b.hl * SFM::abs(b.ax) + b.hw * SFM::abs(b.ay)),
+					ey(b.hl * SFM::abs(b.ay) + b.hw * SFM::abs(b.ax));
+
+		return(cellRect{ int32_t(SFM::floor((b.cx - ex) * INV_CELL_SIZE)), int32_t(SFM::floor((b.cy - ey) * INV_CELL_SIZE)),
+						 int32_t(SFM::floor((b.cx + ex) * INV_CELL_SIZE)), int32_t(SFM::floor((b.cy + ey) * INV_CELL_SIZE)) });
+	}
+
+	STATIC_INLINE_PURE uint32_t const cell_count(cellRect const& __restrict c)
+	{
+		return(uint32_t(c.right - c.left + 1) * uint32_t(c.bottom - c.top + 1));
+	}
+
+	STATIC_INLINE cell const* const __restrict find_cell(uint64_t const key)
+	{
+		if (_hash.table.empty())
+			return(nullptr);
+
+		uint32_t slot(cell_slot(key, _hash.mask));
+		for (;;) {
+			cell const& c(_hash.table[slot]);
+			if (0 == c.end)
+				return(nullptr);
+			if (key == c.key)
+				return(&c);
+			slot = (slot + 1) & _hash.mask;
+		}
+	}
+
+	STATIC_INLINE bool const query(box const& __restrict b, uint32_t const excludeHash, bool const stoppedOnly)
+	{
+		cellRect const c(cells_of(b));
+
+		for (int32_t y = c.top; y <= c.bottom; ++y) {
+			for (int32_t x = c.left; x <= c.right; ++x) {
+
+				cell const* const found(find_cell(cell_key(x, y)));
+				if (nullptr == found)
+					continue;
+
+				for (uint32_t e = found->begin; e < found->end; ++e) {
+
+					world::movers::mover const& m(_hash.movers[_hash.entries[e].index]);
+
+					if (excludeHash == m.hash || (stoppedOnly && !m.stopped))
+						continue;
+
+					if (overlap(b, to_box(m))) {
+						return(true); // a mover touching several cells is found more than once, it doesn't matter for a yes/no query
+					}
+				}
+			}
+		}
+		return(false);
+	}
+
+	STATIC_INLINE_PURE box const __vectorcall sweep_box(FXMVECTOR xmFrom, FXMVECTOR xmTo, float const half_width)
+	{
+		XMVECTOR const xmDelta(XMVectorSubtract(xmTo, xmFrom));
+		float const length(XMVectorGetX(XMVector2Length(xmDelta)));
+
+		XMFLOAT2A center, axis(1.0f, 0.0f);
+		XMStoreFloat2A(&center, XMVectorScale(XMVectorAdd(xmFrom, xmTo), 0.5f));
+		if (length > 0.0f) {
+			XMStoreFloat2A(&axis, XMVectorScale(xmDelta, 1.0f / length));
+		}
+
+		return(box{ center.x, center.y, axis.x, axis.y, length * 0.5f, half_width });
+	}
+
+	STATIC_INLINE_PURE box const __vectorcall area_box(rect2D_t const voxelArea)
+	{
+		// voxel centers are at integer coordinates, the area covers half a voxel beyond them on every side
+		return(box{ float(voxelArea.left + voxelArea.right) * 0.5f, float(voxelArea.top + voxelArea.bottom) * 0.5f, 1.0f, 0.0f,
+					float(voxelArea.right - voxelArea.left + 1) * 0.5f, float(voxelArea.bottom - voxelArea.top + 1) * 0.5f });
+	}
+
+} // end ns
+
+namespace world
+{
+	namespace movers
+	{
+		void __vectorcall submit(mover const& __restrict m)
+		{
+			_hash.submitted.push_back(m);
+		}
+
+		// parallel except the (linear) insertion of the distinct cells into the table. must not be called concurrently with submit() or any query.
+		void rebuild()
+		{
+			uint32_t const count((uint32_t)_hash.submitted.size());
+
+			_hash.movers.resize(count);
+			_hash.first.resize(size_t(count) + 1);
+
+			tbb::parallel_for(tbb::blocked_range<uint32_t>(0, count), [&](tbb::blocked_range<uint32_t> const& r) {
+				for (uint32_t i = r.begin(); i != r.end(); ++i) {
+					_hash.movers[i] = _hash.submitted[i];
+					_hash.first[i] = cell_count(cells_of(to_box(_hash.movers[i])));
+				}
+			});
+			_hash.submitted.clear();
+
+			// exclusive prefix sum
+			uint32_t total(0);
+			for (uint32_t i = 0; i < count; ++i) {
+				uint32_t const cells(_hash.first[i]);
+				_hash.first[i] = total;
+				total += cells;
+			}
+			_hash.first[count] = total;
+
+			_hash.entries.resize(total);
+			tbb::parallel_for(tbb::blocked_range<uint32_t>(0, count), [&](tbb::blocked_range<uint32_t> const& r) {
+				for (uint32_t i = r.begin(); i != r.end(); ++i) {
+
+					cellRect const c(cells_of(to_box(_hash.movers[i])));
+					entry* __restrict out(&_hash.entries[_hash.first[i]]);
+
+					for (int32_t y = c.top; y <= c.bottom; ++y) {
+						for (int32_t x = c.left; x <= c.right; ++x) {
+							*out++ = entry{ cell_key(x, y), i };
+						}
+					}
+				}
+			});
+
+			tbb::parallel_sort(_hash.entries.begin(), _hash.entries.end(), [](entry const& a, entry const& b) {
+				return(a.key < b.key || (a.key == b.key && a.index < b.index));
+			});
+
+			uint32_t distinct(0);
+			for (uint32_t e = 0; e < total; ++e) {
+				distinct += uint32_t(0 == e || _hash.entries[e].key != _hash.entries[e - 1].key);
+			}
+
+			uint32_t const capacity(std::bit_ceil(SFM::max(16u, distinct << 1u))); // load factor <= 0.5
+			_hash.table.resize(capacity);
+			std::fill(_hash.table.begin(), _hash.table.end(), cell{});
+			_hash.mask = capacity - 1;
+
+			for (uint32_t e = 0; e < total; ) {
+
+				uint64_t const key(_hash.entries[e].key);
+				uint32_t const begin(e);
+				while (e < total && key == _hash.entries[e].key) {
+					++e;
+				}
+
+				uint32_t slot(cell_slot(key, _hash.mask));
+				while (0 != _hash.table[slot].end) {
+					slot = (slot + 1) & _hash.mask;
+				}
+				_hash.table[slot] = cell{ key, begin, e };
+			}
+		}
+
+		void clear()
+		{
+			_hash.submitted.clear();
+			_hash.movers.clear();
+			_hash.first.clear();
+			_hash.entries.clear();
+			_hash.table.clear();
+			_hash.mask = 0;
+		}
+
+		bool const __vectorcall sweep(FXMVECTOR xmFrom, FXMVECTOR xmTo, float const half_width, uint32_t const excludeHash, bool const stoppedOnly)
+		{
+			return(query(sweep_box(xmFrom, xmTo, half_width), excludeHash, stoppedOnly));
+		}
+
+		bool const __vectorcall overlaps(rect2D_t const voxelArea, uint32_t const excludeHash, bool const stoppedOnly)
+		{
+			return(query(area_box(voxelArea), excludeHash, stoppedOnly));
+		}
+
+#ifdef DEBUG_BENCHMARK_TRAFFIC
+		// headless traffic, synthetic cars on a lattice of two lane roads with no world or model instances behind them. every frame mirrors the car
+		// update: every car submits its pose, the hash is rebuilt, every car tests the voxel ahead of it (continuous collision) and moves if it is clear.
+		// the same tests against every other car (the cost without the hash) are timed for a sample of the cars and scaled to all of them, the sampled
+		// results must be identical.
+		void benchmark()
+		{
+			static constexpr uint32_t const CAR_COUNTS[] = { 1000, 10000, 50000 };
+			static constexpr uint32_t const FRAMES = 64,
+											BRUTE_FORCE_INTERVAL = 8,	// frames
+											BRUTE_FORCE_SAMPLES = 1024;	// cars
+			static constexpr int32_t const AREA = 2048,					// voxels, roads every ROAD_SPACING voxels in both directions
+										   ROAD_SPACING = 16,
+										   LANE_OFFSET = 2;
+			static constexpr float const HALF_LENGTH = 4.0f, HALF_WIDTH = 1.5f,
+										 SPEED = 10.0f / 60.0f;			// voxels per frame
+
+			clear(); // the benchmark owns the hash until it is done, the cars resubmit next frame
+
+			FMT_LOG(PERF_LOG, "traffic benchmark: {:d}x{:d} voxels, {:d} frames", AREA, AREA, FRAMES);
+
+			for (uint32_t const count : CAR_COUNTS) {
+
+				uint32_t state(0x9e3779b9u); // same traffic every run
+				auto const next = [&state]() {
+					state ^= state << 13u; state ^= state >> 17u; state ^= state << 5u;
+					return(state);
+				};
+
+				vector<mover> cars(count);
+				for (uint32_t i = 0; i < count; ++i) {
+					mover& car(cars[i]);
+
+					int32_t const road((int32_t(next() % uint32_t(AREA / ROAD_SPACING)) * ROAD_SPACING) - (AREA >> 1));
+					float const along(float(int32_t(next() % uint32_t(AREA)) - (AREA >> 1)));
+					float const direction((next() & 1u) ? 1.0f : -1.0f); // lane (right hand traffic)
+
+					if (next() & 1u) { // horizontal road
+						car.location = XMFLOAT2A(along, float(road) + direction * float(LANE_OFFSET));
+						car.axis = XMFLOAT2A(direction, 0.0f);
+					}
+					else {
+						car.location = XMFLOAT2A(float(road) - direction * float(LANE_OFFSET), along);
+						car.axis = XMFLOAT2A(0.0f, direction);
+					}
+					car.half_length = HALF_LENGTH;
+					car.half_width = HALF_WIDTH;
+					car.hash = i + 1;
+					car.stopped = false;
+				}
+
+				vector<uint8_t> blocked(count), brute(count);
+				fp_seconds tRebuild{}, tQuery{}, tBrute{}, tTotal{};
+				uint32_t brute_frames(0), mismatched(0), stopped(0);
+
+				for (uint32_t frame = 0; frame < FRAMES; ++frame) {
+
+					tTime const tFrame(high_resolution_clock::now());
+					fp_seconds tSample{}; // excluded from the frame
+
+					for (uint32_t i = 0; i < count; ++i) {
+						submit(cars[i]);
+					}
+
+					tTime tStart(high_resolution_clock::now());
+					rebuild();
+					tRebuild += fp_seconds(high_resolution_clock::now() - tStart);
+
+					tStart = high_resolution_clock::now();
+					for (uint32_t i = 0; i < count; ++i) {
+						XMVECTOR const xmLocation(XMLoadFloat2A(&cars[i].location)), xmAxis(XMLoadFloat2A(&cars[i].axis));
+						XMVECTOR const xmFront(XMVectorAdd(xmLocation, XMVectorScale(xmAxis, HALF_LENGTH)));
+
+						blocked[i] = sweep(xmFront, XMVectorAdd(xmFront, xmAxis), 0.5f, cars[i].hash);
+					}
+					tQuery += fp_seconds(high_resolution_clock::now() - tStart);
+
+					if (0 == (frame % BRUTE_FORCE_INTERVAL)) {
+						uint32_t const step(SFM::max(1u, count / BRUTE_FORCE_SAMPLES));
+
+						tStart = high_resolution_clock::now();
+						for (uint32_t i = 0; i < count; i += step) {
+							XMVECTOR const xmLocation(XMLoadFloat2A(&cars[i].location)), xmAxis(XMLoadFloat2A(&cars[i].axis));
+							XMVECTOR const xmFront(XMVectorAdd(xmLocation, XMVectorScale(xmAxis, HALF_LENGTH)));
+							box const b(sweep_box(xmFront, XMVectorAdd(xmFront, xmAxis), 0.5f));
+
+							bool bBlocked(false);
+							for (uint32_t j = 0; j < count; ++j) {
+								if (j != i && overlap(b, to_box(_hash.movers[j]))) {
+									bBlocked = true;
+									break;
+								}
+							}
+							brute[i] = bBlocked;
+						}
+						tSample = high_resolution_clock::now() - tStart;
+
+						uint32_t samples(0);
+						for (uint32_t i = 0; i < count; i += step) {
+							mismatched += uint32_t(brute[i] != blocked[i]);
+							++samples;
+						}
+						tBrute += tSample * (double(count) / double(samples));
+						++brute_frames;
+					}
+
+					stopped = 0;
+					for (uint32_t i = 0; i < count; ++i) {
+						mover& car(cars[i]);
+
+						car.stopped = blocked[i];
+						if (!car.stopped) {
+							// wrap around the area
+							car.location.x = car.location.x + car.axis.x * SPEED;
+							car.location.y = car.location.y + car.axis.y * SPEED;
+							if (car.location.x >= float(AREA >> 1)) car.location.x -= float(AREA);
+							else if (car.location.x < -float(AREA >> 1)) car.location.x += float(AREA);
+							if (car.location.y >= float(AREA >> 1)) car.location.y -= float(AREA);
+							else if (car.location.y < -float(AREA >> 1)) car.location.y += float(AREA);
+						}
+						else {
+							++stopped;
+						}
+					}
+
+					tTotal += fp_seconds(high_resolution_clock::now() - tFrame) - tSample;
+				}
+
+				double const rebuild_ms(tRebuild.count() * 1000.0 / double(FRAMES)), query_ms(tQuery.count() * 1000.0 / double(FRAMES)),
+							 total_ms(tTotal.count() * 1000.0 / double(FRAMES)), brute_ms(tBrute.count() * 1000.0 / double(brute_frames));
+
+				if (0 == mismatched) {
+					FMT_LOG_OK(PERF_LOG, "{:d} cars  frame {:.3f} ms  (rebuild {:.3f} ms  ccd {:.3f} ms)  all pairs ccd {:.3f} ms ({:.1f}x)  {:d} stopped",
+						count, total_ms, rebuild_ms, query_ms, brute_ms, brute_ms / query_ms, stopped);
+				}
+				else {
+					FMT_LOG_FAIL(PERF_LOG, "{:d} cars  frame {:.3f} ms  (rebuild {:.3f} ms  ccd {:.3f} ms)  all pairs ccd {:.3f} ms ({:.1f}x)  {:d} stopped  {:d} tests differ",
+						count, total_ms, rebuild_ms, query_ms, brute_ms, brute_ms / query_ms, stopped, mismatched);
+				}
+			}
+
+			clear();
+		}
+#endif
+
+	} // end ns
+} // end ns
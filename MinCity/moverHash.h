@@ -0,0 +1,50 @@
+#pragma once
+/* Copyright (C) 20xx Jason Tully - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License
+ * http://www.supersinfulsilicon.com/
+ *
+This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/
+or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+#include "globals.h"
+#include <Math/point2D_t.h>
+
+// uniform spatial hash of all dynamic movers (cars) for the frame. movers submit their pose as they update, rebuild() at the start of the next
+// frame sorts them by grid cell (parallel) so queries only test the movers in the cells they touch. a mover is an oriented box in grid space,
+// queries are exact box/box overlap tests (separating axis).
+//
+//		world::movers::submit(mover);							// every mover, every frame (concurrent)
+//		world::movers::rebuild();								// once per frame, before any queries
+//		world::movers::sweep(xmFrom, xmTo, half_width, hash);	// continuous collision, spawn space, etc.
+namespace world
+{
+	namespace movers
+	{
+		typedef struct sMover
+		{
+			XMFLOAT2A	location,		// Grid Space (-x,-y) to (X, Y), center
+						axis;			// normalized, along the length
+			float		half_length,
+						half_width;
+			uint32_t	hash;			// model instance hash
+			bool		stopped;
+
+		} mover;
+
+		void __vectorcall submit(mover const& __restrict m);
+		void rebuild();
+		void clear();
+
+		// true if any mover (except excludeHash) overlaps a box of half_width swept from xmFrom to xmTo, Grid Space (-x,-y) to (X, Y)
+		bool const __vectorcall sweep(FXMVECTOR xmFrom, FXMVECTOR xmTo, float const half_width, uint32_t const excludeHash = 0, bool const stoppedOnly = false);
+		// true if any mover (except excludeHash) overlaps the voxels of the area (inclusive), Grid Space (-x,-y) to (X, Y)
+		bool const __vectorcall overlaps(rect2D_t const voxelArea, uint32_t const excludeHash = 0, bool const stoppedOnly = false);
+
+#ifdef DEBUG_BENCHMARK_TRAFFIC
+		void benchmark();
+#endif
+
+	} // end ns
+} // end ns
@@ -1,6 +1,307 @@
 #include "pch.h"
 #include "performance.h"
+#include <algorithm>
 
+namespace // private to this file (anonymous)
+{
+	typedef struct sSample
+	{
+		uint64_t frame;
+		uint64_t counters[metrics::eCounter::_size_constant];     // delta this frame
+		int64_t  gauges[metrics::eGauge::_size_constant];         // value at end of frame
+		uint32_t timer_count[metrics::eTimer::_size_constant],    // delta this frame
+			     timer_sum[metrics::eTimer::_size_constant];      // microseconds this frame
+
+	} sSample;
+
+	typedef struct sTotals
+	{
+		uint64_t counters[metrics::eCounter::_size_constant];
+		uint64_t timer_count[metrics::eTimer::_size_constant],
+			     timer_sum[metrics::eTimer::_size_constant];
+
+	} sTotals;
+
+	constinit static struct no_vtable sRegistry
+	{
+		std::atomic<metrics::internal::sShard*> shards[metrics::MAX_SHARDS + 1]; // last slot is the shared overflow shard
+		std::atomic_uint32_t                    shard_count;
+		std::atomic_flag                        overflow_lock;
+
+		// main thread only //
+		sTotals                                 last;
+		uint64_t                                frame;
+		sSample                                 history[metrics::HISTORY_FRAMES];
+
+	} registry{};
+
+	static void __vectorcall gather(sTotals& __restrict totals)
+	{
+		using namespace metrics;
+
+		memset(&totals, 0, sizeof(totals));
+
+		uint32_t const shard_count(std::min(MAX_SHARDS + 1, registry.shard_count.load(std::memory_order_acquire)));
+		for (uint32_t i = 0; i < shard_count; ++i) {
+
+			internal::sShard const* const __restrict s(registry.shards[i].load(std::memory_order_acquire));
+			[[unlikely]] if (nullptr == s) { // slot reserved, shard not yet published
+				continue;
+			}
+
+			for (uint32_t c = 0; c < eCounter::_size_constant; ++c) {
+				totals.counters[c] += internal::read(s->counters[c]);
+			}
+			for (uint32_t t = 0; t < eTimer::_size_constant; ++t) {
+				totals.timer_count[t] += internal::read(s->timer_count[t]);
+				totals.timer_sum[t] += internal::read(s->timer_sum[t]);
+			}
+		}
+	}
+
+	// upper bound in microseconds of the bucket containing the percentile
+	static uint64_t const percentile(uint64_t const (&__restrict buckets)[metrics::HISTOGRAM_BUCKETS], uint64_t const total, double const p)
+	{
+		uint64_t const target((uint64_t)std::ceil(double(total) * p));
+		uint64_t running(0);
+
+		for (uint32_t b = 0; b < metrics::HISTOGRAM_BUCKETS; ++b) {
+			running += buckets[b];
+			if (running >= target && 0 != running) {
+				return(1ull << b);
+			}
+		}
+		return(1ull << (metrics::HISTOGRAM_BUCKETS - 1));
+	}
+} // end ns
+
+namespace metrics
+{
+	namespace internal
+	{
+		sShard* const __restrict acquire_shard()
+		{
+			uint32_t const slot(registry.shard_count.fetch_add(1, std::memory_order_relaxed));
+
+			[[unlikely]] if (slot >= MAX_SHARDS) { // shared, writes may race - counts are approximate for these threads only
+
+				while (registry.overflow_lock.test_and_set(std::memory_order_acquire)) {
+					_mm_pause();
+				}
+
+				sShard* __restrict s(registry.shards[MAX_SHARDS].load(std::memory_order_relaxed));
+				if (nullptr == s) {
+					s = (sShard* const)scalable_aligned_malloc(sizeof(sShard), CACHE_LINE_BYTES);
+					memset(s, 0, sizeof(sShard));
+					registry.shards[MAX_SHARDS].store(s, std::memory_order_release);
+				}
+
+				registry.overflow_lock.clear(std::memory_order_release);
+				return(tls_shard = s);
+			}
+
+			sShard* const __restrict s((sShard* const)scalable_aligned_malloc(sizeof(sShard), CACHE_LINE_BYTES));
+			memset(s, 0, sizeof(sShard));
+			registry.shards[slot].store(s, std::memory_order_release);
+
+			return(tls_shard = s);
+		}
+	} // end ns internal
+
+	void tick()
+	{
+		scoped_timer const timer(eTimer::METRICS_TICK);
+
+		sTotals totals;
+		gather(totals);
+
+		sSample& __restrict sample(registry.history[registry.frame & (HISTORY_FRAMES - 1)]);
+		sample.frame = registry.frame;
+
+		for (uint32_t c = 0; c < eCounter::_size_constant; ++c) {
+			sample.counters[c] = totals.counters[c] - registry.last.counters[c];
+		}
+		for (uint32_t g = 0; g < eGauge::_size_constant; ++g) {
+			sample.gauges[g] = internal::gauges[g].load(std::memory_order_relaxed);
+		}
+		for (uint32_t t = 0; t < eTimer::_size_constant; ++t) {
+			sample.timer_count[t] = (uint32_t)(totals.timer_count[t] - registry.last.timer_count[t]);
+			sample.timer_sum[t] = (uint32_t)(totals.timer_sum[t] - registry.last.timer_sum[t]);
+		}
+
+		registry.last = totals;
+		++registry.frame;
+	}
+
+	bool const dump(std::wstring const& path)
+	{
+		uint64_t const frames(std::min(registry.frame, (uint64_t)HISTORY_FRAMES)),
+			           first(registry.frame - frames);
+
+		{ // history //
+			FILE* stream(nullptr);
+			if (0 != _wfopen_s(&stream, (path + L".csv").c_str(), L"wt") || nullptr == stream) {
+				FMT_LOG_FAIL(PERF_LOG, "unable to write metrics history");
+				return(false);
+			}
+
+			fmt::print(stream, "frame");
+			for (auto const counter : eCounter::_values()) {
+				fmt::print(stream, ",{:s}", counter._to_string());
+			}
+			for (auto const gauge : eGauge::_values()) {
+				fmt::print(stream, ",{:s}", gauge._to_string());
+			}
+			for (auto const timer : eTimer::_values()) {
+				fmt::print(stream, ",{:s}_count,{:s}_us", timer._to_string(), timer._to_string());
+			}
+			fmt::print(stream, "\n");
+
+			for (uint64_t f = first; f < registry.frame; ++f) {
+
+				sSample const& __restrict sample(registry.history[f & (HISTORY_FRAMES - 1)]);
+
+				fmt::print(stream, "{:d}", sample.frame);
+				for (uint32_t c = 0; c < eCounter::_size_constant; ++c) {
+					fmt::print(stream, ",{:d}", sample.counters[c]);
+				}
+				for (uint32_t g = 0; g < eGauge::_size_constant; ++g) {
+					fmt::print(stream, ",{:d}", sample.gauges[g]);
+				}
+				for (uint32_t t = 0; t < eTimer::_size_constant; ++t) {
+					fmt::print(stream, ",{:d},{:d}", sample.timer_count[t], sample.timer_sum[t]);
+				}
+				fmt::print(stream, "\n");
+			}
+
+			fclose(stream);
+		}
+
+		{ // summary //
+			FILE* stream(nullptr);
+			if (0 != _wfopen_s(&stream, (path + L".json").c_str(), L"wt") || nullptr == stream) {
+				FMT_LOG_FAIL(PERF_LOG, "unable to write metrics summary");
+				return(false);
+			}
+
+			// merge all shards for the lifetime totals & histograms
+			internal::sShard merged{};
+			uint32_t const shard_count(std::min(MAX_SHARDS + 1, registry.shard_count.load(std::memory_order_acquire)));
+			for (uint32_t i = 0; i < shard_count; ++i) {
+
+				internal::sShard const* const __restrict s(registry.shards[i].load(std::memory_order_acquire));
+				if (nullptr == s) {
+					continue;
+				}
+				for (uint32_t c = 0; c < eCounter::_size_constant; ++c) {
+					merged.counters[c] += internal::read(s->counters[c]);
+				}
+				for (uint32_t t = 0; t < eTimer::_size_constant; ++t) {
+					merged.timer_count[t] += internal::read(s->timer_count[t]);
+					merged.timer_sum[t] += internal::read(s->timer_sum[t]);
+					merged.timer_max[t] = std::max(merged.timer_max[t], internal::read(s->timer_max[t]));
+					for (uint32_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+						merged.buckets[t][b] += internal::read(s->buckets[t][b]);
+					}
+				}
+			}
+
+			fmt::print(stream, "{{\n  \"frames\": {:d},\n  \"history_frames\": {:d},\n", registry.frame, frames);
+
+			// cost of metrics relative to frame time over the lifetime
+			uint64_t const frame_us(merged.timer_sum[eTimer::FRAME]),
+				           tick_us(merged.timer_sum[eTimer::METRICS_TICK]);
+			fmt::print(stream, "  \"overhead_percent\": {:.4f},\n", 0 != frame_us ? (double(tick_us) / double(frame_us)) * 100.0 : 0.0);
+
+			fmt::print(stream, "  \"counters\": {{");
+			for (uint32_t c = 0; c < eCounter::_size_constant; ++c) {
+				fmt::print(stream, "{:s}\n    \"{:s}\": {:d}", (0 == c ? "" : ","), eCounter::_from_integral(c)._to_string(), merged.counters[c]);
+			}
+			fmt::print(stream, "\n  }},\n  \"gauges\": {{");
+			for (uint32_t g = 0; g < eGauge::_size_constant; ++g) {
+				fmt::print(stream, "{:s}\n    \"{:s}\": {:d}", (0 == g ? "" : ","), eGauge::_from_integral(g)._to_string(), internal::gauges[g].load(std::memory_order_relaxed));
+			}
+			fmt::print(stream, "\n  }},\n  \"timers\": {{");
+
+			vector<uint32_t> per_frame;
+			per_frame.reserve(frames);
+
+			for (uint32_t t = 0; t < eTimer::_size_constant; ++t) {
+
+				uint64_t const count(merged.timer_count[t]);
+
+				// percentiles of the per frame total over the rolling history
+				per_frame.clear();
+				for (uint64_t f = first; f < registry.frame; ++f) {
+					per_frame.emplace_back(registry.history[f & (HISTORY_FRAMES - 1)].timer_sum[t]);
+				}
+				std::sort(per_frame.begin(), per_frame.end());
+				auto const frame_percentile = [&](double const p) -> uint32_t {
+					return(per_frame.empty() ? 0 : per_frame[std::min(per_frame.size() - 1, size_t(double(per_frame.size()) * p))]);
+				};
+
+				fmt::print(stream, "{:s}\n    \"{:s}\": {{ \"count\": {:d}, \"total_us\": {:d}, \"mean_us\": {:.2f}, \"max_us\": {:d}, "
+					               "\"p50_us\": {:d}, \"p90_us\": {:d}, \"p99_us\": {:d}, "
+					               "\"frame_p50_us\": {:d}, \"frame_p99_us\": {:d}, \"buckets\": [",
+					(0 == t ? "" : ","), eTimer::_from_integral(t)._to_string(),
+					count, merged.timer_sum[t], 0 != count ? double(merged.timer_sum[t]) / double(count) : 0.0, merged.timer_max[t],
+					percentile(merged.buckets[t], count, 0.5), percentile(merged.buckets[t], count, 0.9), percentile(merged.buckets[t], count, 0.99),
+					frame_percentile(0.5), frame_percentile(0.99));
+
+				for (uint32_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+					fmt::print(stream, "{:s}{:d}", (0 == b ? "" : ","), merged.buckets[t][b]);
+				}
+				fmt::print(stream, "] }}");
+			}
+			fmt::print(stream, "\n  }}\n}}\n");
+
+			fclose(stream);
+		}
+
+		FMT_LOG(PERF_LOG, "metrics dumped, {:d} frames", frames);
+		return(true);
+	}
+
+} // end ns metrics
+
+
+#ifdef DEBUG_BENCHMARK
+namespace // private to this file (anonymous)
+{
+	typedef struct sBenchmark
+	{
+		std::string_view				name;
+		std::function<bool()>		benchmark;
+
+	} sBenchmark;
+
+	static vector<sBenchmark> pending;
+} // end ns
+
+namespace benchmarks
+{
+	void add(std::string_view const name, std::function<bool()>&& benchmark)
+	{
+		pending.emplace_back(sBenchmark{ name, std::move(benchmark) });
+	}
+
+	void run()
+	{
+		[[likely]] if (pending.empty())
+			return;
+
+		for (auto b = pending.begin(); b != pending.end(); ) {
+			if (b->benchmark()) { // results are output by the benchmark itself
+				FMT_LOG_OK(PERF_LOG, "{:s} benchmark", b->name);
+				b = pending.erase(b);
+			}
+			else {
+				++b;
+			}
+		}
+	}
+} // end ns benchmarks
+#endif
 
 #ifdef PERFORMANCE_TRACKING_ENABLED
 
@@ -1,5 +1,147 @@
 #pragma once
 #include "globals.h"
+#include "tTime.h"
+#include <atomic>
+#include <string>
+
+// always-on runtime metrics. counters, gauges and timers (fixed log2 microsecond bucket histograms) are written to a per-thread shard
+// owned by the calling thread - no locks or interlocked operations on the hot path. tick() is called once per frame on the main thread,
+// folding the shards into a rolling history of the last HISTORY_FRAMES frames. dump() writes the history as csv and a summary as json.
+namespace metrics
+{
+	BETTER_ENUM(eCounter, uint32_t const,
+
+		CHUNKS_OPENED = 0,
+		CHUNKS_CLOSED,
+		CHUNK_BYTES_RECLAIMED,
+		CHUNKS_PREFETCHED,
+		CHUNK_PREFETCH_HITS,	// prefetched chunks that were later accessed
+		CHUNK_MISSES,
+		CHUNKS_CLONED			// copy-on-write during a save (see StreamingGrid::Snapshot)
+	);
+
+	BETTER_ENUM(eGauge, uint32_t const,
+
+		VOXELS_TERRAIN = 0,
+		VOXELS_STATIC,
+		VOXELS_DYNAMIC_OPAQUE,
+		VOXELS_DYNAMIC_TRANS,
+		CHUNKS_RESIDENT,
+		SNAPSHOT_BYTES,			// memory held by chunks preserved for a save in progress
+		UNDO_JOURNAL_BYTES		// compressed undo/redo history held in memory (see undoJournal.h)
+	);
+
+	BETTER_ENUM(eTimer, uint32_t const,
+
+		FRAME = 0,
+		UPDATE_WORLD,
+		SIMULATION_TICK,
+		STAGE_RESOURCES,
+		STAGE_CRITICAL_PATH,	// longest chain of dependent stages in the frame graph (see frameGraph.h)
+		GARBAGE_COLLECT,
+		VULKAN_RENDER,
+		CHUNK_STALL,
+		SAVE_STALL,				// main thread time to capture a consistent save
+		METRICS_TICK
+	);
+
+	static constexpr uint32_t const
+		HISTOGRAM_BUCKETS = 24,   // bucket b holds durations in [2^(b-1), 2^b) microseconds, bucket 0 is < 1us, last bucket is open ended (>= ~4s)
+		HISTORY_FRAMES = 1024,    // must be a power of 2
+		MAX_SHARDS = 256;         // threads beyond this share one overflow shard (approximate)
+
+	static_assert(0 == (HISTORY_FRAMES & (HISTORY_FRAMES - 1)));
+
+	namespace internal
+	{
+		typedef struct alignas(CACHE_LINE_BYTES) sShard
+		{
+			uint64_t counters[eCounter::_size_constant];
+			uint64_t timer_count[eTimer::_size_constant],
+				     timer_sum[eTimer::_size_constant],   // microseconds
+				     timer_max[eTimer::_size_constant];   // microseconds
+			uint64_t buckets[eTimer::_size_constant][HISTOGRAM_BUCKETS];
+
+		} sShard;
+
+		inline thread_local constinit sShard* tls_shard{};
+		inline constinit std::atomic_int64_t gauges[eGauge::_size_constant]{};
+
+		sShard* const __restrict acquire_shard(); // registers the calling thread
+
+		STATIC_INLINE sShard* const __restrict shard() {
+			sShard* __restrict s(tls_shard);
+			[[unlikely]] if (nullptr == s) {
+				s = acquire_shard();
+			}
+			return(s);
+		}
+		// only the owning thread writes to its shard, tick() & dump() read concurrently. relaxed atomic_ref keeps the values tear free without a locked instruction.
+		STATIC_INLINE void add(uint64_t& __restrict target, uint64_t const amount) {
+			std::atomic_ref<uint64_t> const ref(target);
+			ref.store(ref.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+		}
+		STATIC_INLINE uint64_t const read(uint64_t const& __restrict source) {
+			return(std::atomic_ref<uint64_t const>(source).load(std::memory_order_relaxed));
+		}
+	} // end ns internal
+
+	STATIC_INLINE void count(uint32_t const counter, uint64_t const amount = 1) {
+		internal::add(internal::shard()->counters[counter], amount);
+	}
+
+	STATIC_INLINE void gauge(uint32_t const gauge, int64_t const value) {
+		internal::gauges[gauge].store(value, std::memory_order_relaxed);
+	}
+
+	STATIC_INLINE void record(uint32_t const timer, microseconds const elapsed) {
+		internal::sShard* const __restrict s(internal::shard());
+		uint64_t const us((uint64_t)std::max(0ll, (long long)elapsed.count()));
+		uint32_t const bucket(std::min(HISTOGRAM_BUCKETS - 1u, uint32_t(64u - (uint32_t)_lzcnt_u64(us))));
+
+		internal::add(s->timer_count[timer], 1);
+		internal::add(s->timer_sum[timer], us);
+		internal::add(s->buckets[timer][bucket], 1);
+		if (us > s->timer_max[timer]) {
+			std::atomic_ref<uint64_t>(s->timer_max[timer]).store(us, std::memory_order_relaxed);
+		}
+	}
+
+	class scoped_timer : no_copy
+	{
+	public:
+		__forceinline explicit scoped_timer(uint32_t const timer)
+			: _tStart(high_resolution_clock::now()), _timer(timer)
+		{}
+		__forceinline ~scoped_timer() {
+			record(_timer, duration_cast<microseconds>(high_resolution_clock::now() - _tStart));
+		}
+	private:
+		tTime const    _tStart;
+		uint32_t const _timer;
+	};
+
+	// once per frame, main thread only
+	void tick();
+
+	// writes <path>.csv (per frame history, oldest first) and <path>.json (summary with percentiles), main thread only
+	bool const dump(std::wstring const& path);
+
+} // end ns metrics
+
+#ifdef DEBUG_BENCHMARK
+#include <functional>
+
+// startup benchmarks (DEBUG_BENCHMARK_* in globals.h). each feature registers its benchmark once when it is initialized, run() is called every frame
+// by the main thread once startup has finished - a benchmark runs once and is dropped, or stays registered until it returns true (waits on the scene).
+// results are output to the console. main thread only.
+namespace benchmarks
+{
+	void add(std::string_view const name, std::function<bool()>&& benchmark);	// true once the benchmark has run
+	void run();
+
+} // end ns benchmarks
+#endif
 
 #ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
 #define PERFORMANCE_TRACKING_ENABLED
@@ -7,7 +149,6 @@
 #endif
 
 #ifdef PERFORMANCE_TRACKING_ENABLED
-#include "tTime.h"
 #include <tbb/tbb.h>
 #include <set>
 
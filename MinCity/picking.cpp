@@ -0,0 +1,409 @@
+/* Copyright (C) 20xx Jason Tully - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License
+ * http://www.supersinfulsilicon.com/
+ *
+This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/
+or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#include "pch.h"
+#include "picking.h"
+#include "IsoVoxel.h"
+#include "MinCity.h"
+#include <Imaging/Imaging/Imaging.h>
+#include <Math/superfastmath.h>
+
+namespace // private to this file (anonymous)
+{
+	static constexpr uint32_t const BASE_SHIFT = 3,											// first level of the pyramid is 8x8 voxels
+									WIDTH_MASK = Iso::WORLD_GRID_WIDTH - 1,
+									HEIGHT_MASK = Iso::WORLD_GRID_HEIGHT - 1;
+
+	static constexpr int32_t const VOXEL_LEVEL = 0;											// level 0 is the heightmap itself, pyramid levels start at 1
+
+	static constexpr double const EPSILON = 1.0e-6;											// t bias into the next cell, also the minimum step
+
+	typedef struct sLevel
+	{
+		vector_aligned<uint16_t, CACHE_LINE_BYTES>	max;		// maximum heightstep of each cell
+		uint32_t									shift,		// log2 of the cell size in voxels
+													width,
+													height;
+
+		__declspec(safebuffers) uint16_t const get(int64_t const u, int64_t const v) const {	// unwrapped cell coordinates
+			return(max[size_t((uint32_t(v) & (height - 1)) * width + (uint32_t(u) & (width - 1)))]);
+		}
+
+	} level;
+
+	constinit static struct sPyramid
+	{
+		level*				levels = nullptr;	// levels[0] is unused (heightmap)
+		std::atomic_int32_t	top = 0;			// index of the last level, 0 = not built
+
+	} _pyramid{};
+
+	static tbb::spin_mutex _build;				// the first picks may be concurrent (batch)
+
+	STATIC_INLINE_PURE uint32_t const level_shift(int32_t const index)
+	{
+		return(VOXEL_LEVEL == index ? 0 : (BASE_SHIFT + uint32_t(index - 1)));
+	}
+
+	STATIC_INLINE uint16_t const* const __restrict heightmap()
+	{
+		ImagingMemoryInstance const* const image(Iso::Voxel::HeightMap());
+
+		return(image ? (uint16_t const* const __restrict)image->block : nullptr);
+	}
+
+	// max of a first level cell, directly from the heightmap
+	STATIC_INLINE uint16_t const reduce_voxels(uint16_t const* const __restrict heights, uint32_t const x, uint32_t const y)
+	{
+		static constexpr uint32_t const SIZE = (1u << BASE_SHIFT);
+
+		uint32_t maximum(0);
+		for (uint32_t row = 0; row < SIZE; ++row) {
+			uint16_t const* const __restrict line(heights + size_t((y << BASE_SHIFT) + row) * Iso::WORLD_GRID_WIDTH + (x << BASE_SHIFT));
+			for (uint32_t col = 0; col < SIZE; ++col) {
+				maximum = std::max(maximum, uint32_t(line[col]));
+			}
+		}
+		return(uint16_t(maximum));
+	}
+	// max of 2x2 cells of the level below
+	STATIC_INLINE uint16_t const reduce_cells(level const& __restrict below, uint32_t const x, uint32_t const y)
+	{
+		size_t const index(size_t(y << 1u) * below.width + (x << 1u));
+
+		return(std::max(std::max(below.max[index], below.max[index + 1]), std::max(below.max[index + below.width], below.max[index + below.width + 1])));
+	}
+
+	// ray in local voxel space, t along the ray. cells wrap around the world, the coordinates of the ray do not.
+	typedef struct sRayLocal
+	{
+		double	ou, oh, ov,
+				du, dh, dv;
+
+		double const u(double const t) const { return(ou + du * t); }
+		double const h(double const t) const { return(oh + dh * t); }
+		double const v(double const t) const { return(ov + dv * t); }
+
+	} rayLocal;
+
+	// exit of the cell [cell << shift, (cell + 1) << shift) along one axis
+	STATIC_INLINE_PURE double const cell_exit(double const o, double const d, int64_t const cell, uint32_t const shift)
+	{
+		if (d > 0.0) {
+			return((double((cell + 1) << shift) - o) / d);
+		}
+		else if (d < 0.0) {
+			return((double(cell << shift) - o) / d);
+		}
+		return(DBL_MAX);
+	}
+
+	// Hierarchical = false is the plain voxel by voxel march (2D DDA over the heightmap), the reference & baseline for the pyramid.
+	template<bool const Hierarchical>
+	__declspec(safebuffers) static picking::hit const __vectorcall traverse(picking::ray const& __restrict r)
+	{
+		picking::hit result{ {}, r.max_distance, false };
+
+		uint16_t const* const __restrict heights(heightmap());
+		if (nullptr == heights)
+			return(result);
+
+		int32_t const top(Hierarchical ? _pyramid.top.load(std::memory_order_acquire) : VOXEL_LEVEL);
+		if constexpr (Hierarchical) {
+			if (VOXEL_LEVEL == top)
+				return(result);
+		}
+
+		// local voxel space, voxel (0,0) covers [0,1)
+		rayLocal const ray{ double(r.origin.x) + 0.5 + double(Iso::WORLD_GRID_HALF_WIDTH), double(r.origin.y), double(r.origin.z) + 0.5 + double(Iso::WORLD_GRID_HALF_HEIGHT),
+							double(r.direction.x), double(r.direction.y), double(r.direction.z) };
+
+		// clip to the slab of terrain, [0, highest terrain], the march gets the same start so the comparison is only the traversal
+		double const slab_top(Iso::getRealHeight(VOXEL_LEVEL != _pyramid.top ? _pyramid.levels[_pyramid.top].get(0, 0) : Iso::heightstep(UINT16_MAX)));
+		double t(0.0), t_end(double(r.max_distance));
+
+		if (ray.oh > slab_top) {
+			if (ray.dh >= 0.0)
+				return(result); // above & going up
+			t = (slab_top - ray.oh) / ray.dh;
+		}
+		if (ray.dh < 0.0) {
+			t_end = std::min(t_end, -ray.oh / ray.dh); // terrain is never below zero
+		}
+
+		int32_t current(top);
+
+		while (t < t_end) {
+
+			double const t_sample(t + EPSILON);
+			int64_t const iu((int64_t)std::floor(ray.u(t_sample))),
+						  iv((int64_t)std::floor(ray.v(t_sample)));
+
+			uint32_t const shift(level_shift(current));
+			int64_t const cu(iu >> shift), cv(iv >> shift);
+
+			uint32_t const heightstep(VOXEL_LEVEL == current ? heights[size_t((uint32_t(iv) & HEIGHT_MASK) * Iso::WORLD_GRID_WIDTH + (uint32_t(iu) & WIDTH_MASK))]
+																 : _pyramid.levels[current].get(cu, cv));
+			double const cell_top(Iso::getRealHeight(Iso::heightstep(heightstep)));
+
+			double const t_exit(std::min(t_end, std::min(cell_exit(ray.ou, ray.du, cu, shift), cell_exit(ray.ov, ray.dv, cv, shift))));
+
+			// lowest point of the ray inside of this cell
+			double const ray_low(ray.dh < 0.0 ? ray.h(t_exit) : ray.h(t));
+
+			if (ray_low > cell_top) { // entire cell is below the ray, skip it
+
+				double const t_next(std::max(t_exit, t + EPSILON));
+
+				if constexpr (Hierarchical) {
+					if (current < top) { // only go up once the ray leaves the parent cell, otherwise the parent would just send it back down
+						uint32_t const parent_shift(level_shift(current + 1));
+						double const t_parent(t_next + EPSILON);
+						if ((((int64_t)std::floor(ray.u(t_parent))) >> parent_shift) != (iu >> parent_shift) ||
+							(((int64_t)std::floor(ray.v(t_parent))) >> parent_shift) != (iv >> parent_shift)) {
+							++current;
+						}
+					}
+				}
+				t = t_next;
+				continue;
+			}
+
+			if (VOXEL_LEVEL != current) { // some voxel in this cell may be hit
+				--current;
+				continue;
+			}
+
+			// hit, the ray either enters the side of the voxel column or comes down on top of it
+			double const t_hit((ray.h(t) <= cell_top || ray.dh >= 0.0) ? t : std::max(t, (cell_top - ray.oh) / ray.dh));
+
+			result.voxelIndex = point2D_t(int32_t(uint32_t(iu) & WIDTH_MASK) - int32_t(Iso::WORLD_GRID_HALF_WIDTH), int32_t(uint32_t(iv) & HEIGHT_MASK) - int32_t(Iso::WORLD_GRID_HALF_HEIGHT));
+			result.distance = float(t_hit);
+			result.hit = true;
+			break;
+		}
+
+		return(result);
+	}
+
+} // end ns
+
+namespace picking
+{
+	void create()
+	{
+		release();
+
+		uint16_t const* const __restrict heights(heightmap());
+		if (nullptr == heights)
+			return;
+
+		int32_t count(0);
+		while ((Iso::WORLD_GRID_HEIGHT >> level_shift(count + 1)) >= 1u) {
+			++count;
+		}
+
+		_pyramid.levels = new level[count + 1];
+
+		for (int32_t index = 1; index <= count; ++index) {
+
+			level& __restrict l(_pyramid.levels[index]);
+			l.shift = level_shift(index);
+			l.width = Iso::WORLD_GRID_WIDTH >> l.shift;
+			l.height = Iso::WORLD_GRID_HEIGHT >> l.shift;
+			l.max.resize(size_t(l.width) * size_t(l.height));
+
+			tbb::parallel_for(tbb::blocked_range<uint32_t>(0, l.height), [&](tbb::blocked_range<uint32_t> const& r) {
+
+				for (uint32_t y = r.begin(); y < r.end(); ++y) {
+					for (uint32_t x = 0; x < l.width; ++x) {
+						l.max[size_t(y) * l.width + x] = (1 == index ? reduce_voxels(heights, x, y) : reduce_cells(_pyramid.levels[index - 1], x, y));
+					}
+				}
+			});
+		}
+
+		// the top level is a single row of cells, reduce it to one cell so the traversal can start with the whole world
+		{
+			level& __restrict l(_pyramid.levels[count]);
+			uint16_t const maximum(*std::max_element(l.max.cbegin(), l.max.cend()));
+			l.max.clear(); l.max.resize(size_t(l.width) * size_t(l.height), maximum);
+		}
+		_pyramid.top.store(count, std::memory_order_release);
+
+		FMT_LOG(GAME_LOG, "picking pyramid: {:d} levels, {:d}x{:d} voxels per cell at the first level", count, (1u << BASE_SHIFT), (1u << BASE_SHIFT));
+	}
+
+	void invalidate()
+	{
+		release();
+	}
+
+	void release()
+	{
+		if (_pyramid.levels) {
+			delete[] _pyramid.levels; _pyramid.levels = nullptr;
+		}
+		_pyramid.top = 0;
+	}
+
+	// cells covering the area are reduced again, then their parents up to the top. the area is chunk tile aligned (8x8), the same as the first level.
+	void __vectorcall updateArea(rect2D_t const voxelAreaLocal)
+	{
+		int32_t const top(_pyramid.top);
+		if (VOXEL_LEVEL == top)
+			return;
+
+		uint16_t const* const __restrict heights(heightmap());
+		if (nullptr == heights)
+			return;
+
+		uint32_t x0(uint32_t(voxelAreaLocal.left) >> BASE_SHIFT), y0(uint32_t(voxelAreaLocal.top) >> BASE_SHIFT),
+				 x1(uint32_t(voxelAreaLocal.right) >> BASE_SHIFT), y1(uint32_t(voxelAreaLocal.bottom) >> BASE_SHIFT);
+
+		for (int32_t index = 1; index < top; ++index) { // the top level is always the max of the whole world
+
+			level& __restrict l(_pyramid.levels[index]);
+
+			for (uint32_t y = y0; y <= y1; ++y) {
+				for (uint32_t x = x0; x <= x1; ++x) {
+					l.max[size_t(y) * l.width + x] = (1 == index ? reduce_voxels(heights, x, y) : reduce_cells(_pyramid.levels[index - 1], x, y));
+				}
+			}
+			x0 >>= 1u; y0 >>= 1u; x1 >>= 1u; y1 >>= 1u;
+		}
+
+		level& __restrict l(_pyramid.levels[top]);
+		level const& __restrict below(_pyramid.levels[top - 1]);
+		uint16_t const maximum(*std::max_element(below.max.cbegin(), below.max.cend()));
+		std::fill(l.max.begin(), l.max.end(), maximum);
+	}
+
+	ray const __vectorcall rayFromWorld(FXMVECTOR xmOrigin, FXMVECTOR xmDirection, float const max_distance)
+	{
+		// world space is relative to the camera origin & -Y is up
+		XMVECTOR const xmGridOrigin(XMVectorMultiply(XMVectorAdd(xmOrigin, world::getOrigin()), XMVectorSet(1.0f, -1.0f, 1.0f, 0.0f)));
+		XMVECTOR const xmGridDirection(XMVector3Normalize(XMVectorMultiply(xmDirection, XMVectorSet(1.0f, -1.0f, 1.0f, 0.0f))));
+
+		ray r;
+		XMStoreFloat3A(&r.origin, xmGridOrigin);
+		XMStoreFloat3A(&r.direction, xmGridDirection);
+		r.max_distance = max_distance;
+
+		return(r);
+	}
+
+	// the pyramid is only built once something picks
+	static void build_once()
+	{
+		if (VOXEL_LEVEL == _pyramid.top.load(std::memory_order_acquire)) {
+
+			tbb::spin_mutex::scoped_lock lock(_build);
+
+			if (VOXEL_LEVEL == _pyramid.top.load(std::memory_order_acquire)) {
+				create();
+			}
+		}
+	}
+
+	hit const __vectorcall pick(ray const& __restrict r)
+	{
+		build_once();
+
+		return(traverse<true>(r));
+	}
+
+	void pick(ray const* const __restrict rays, hit* const __restrict hits, size_t const count)
+	{
+		build_once();
+
+		tbb::parallel_for(tbb::blocked_range<size_t>(0, count), [&](tbb::blocked_range<size_t> const& r) {
+
+			for (size_t i = r.begin(); i < r.end(); ++i) {
+				hits[i] = traverse<true>(rays[i]);
+			}
+		});
+	}
+
+#ifdef DEBUG_BENCHMARK_RAY_PICKING
+	// picks per second of the pyramid vs. the voxel march, the same rays along the view direction spread over the area visible at several zoom levels.
+	// both are single threaded, then the batch api on all threads. any pick that differs between the two is counted, it should always be zero.
+	void benchmark(FXMVECTOR xmViewDirection, point2D_t const center)
+	{
+		static constexpr uint32_t const RAYS = 1u << 16u;
+		static constexpr int32_t const FOOTPRINTS[] = { 64, 256, 1024, 4096 };	// visible voxels across, zoomed in to zoomed out
+		static constexpr float const DISTANCE = Iso::WORLD_MAX_HEIGHT * 4.0f;
+
+		build_once(); // outside of the timing, the march also clips to the top of the pyramid
+
+		FMT_LOG(PERF_LOG, "ray picking benchmark: {:d} rays per footprint, {:d} threads", RAYS, tbb::this_task_arena::max_concurrency());
+
+		XMVECTOR const xmDirection(XMVectorMultiply(XMVector3Normalize(xmViewDirection), XMVectorSet(1.0f, -1.0f, 1.0f, 0.0f))); // grid space
+
+		vector<ray> rays(RAYS);
+		vector<hit> march(RAYS), hierarchical(RAYS), batch(RAYS);
+
+		for (int32_t const footprint : FOOTPRINTS) {
+
+			uint32_t state(0x9e3779b9u); // same rays every run
+			auto const next = [&state]() {
+				state ^= state << 13u; state ^= state >> 17u; state ^= state << 5u;
+				return(state);
+			};
+
+			for (uint32_t i = 0; i < RAYS; ++i) {
+				// start well above the terrain, backed out along the view direction from a point in the footprint
+				XMVECTOR const xmTarget(XMVectorSet(float(center.x + int32_t(next() % uint32_t(footprint)) - (footprint >> 1)), 0.0f,
+													float(center.y + int32_t(next() % uint32_t(footprint)) - (footprint >> 1)), 0.0f));
+				XMVECTOR const xmOrigin(XMVectorAdd(XMVectorSubtract(xmTarget, XMVectorScale(xmDirection, DISTANCE)), XMVectorSet(0.0f, Iso::WORLD_MAX_HEIGHT, 0.0f, 0.0f)));
+
+				XMStoreFloat3A(&rays[i].origin, xmOrigin);
+				XMStoreFloat3A(&rays[i].direction, xmDirection);
+				rays[i].max_distance = DISTANCE * 2.0f;
+			}
+
+			tTime tStart(high_resolution_clock::now());
+			for (uint32_t i = 0; i < RAYS; ++i) {
+				march[i] = traverse<false>(rays[i]);
+			}
+			fp_seconds const tMarch(high_resolution_clock::now() - tStart);
+
+			tStart = high_resolution_clock::now();
+			for (uint32_t i = 0; i < RAYS; ++i) {
+				hierarchical[i] = pick(rays[i]);
+			}
+			fp_seconds const tHierarchical(high_resolution_clock::now() - tStart);
+
+			tStart = high_resolution_clock::now();
+			pick(rays.data(), batch.data(), RAYS);
+			fp_seconds const tBatch(high_resolution_clock::now() - tStart);
+
+			uint32_t mismatched(0);
+			for (uint32_t i = 0; i < RAYS; ++i) {
+				if (march[i].hit != hierarchical[i].hit || (march[i].hit && march[i].voxelIndex != hierarchical[i].voxelIndex)
+					|| batch[i].hit != hierarchical[i].hit || batch[i].voxelIndex != hierarchical[i].voxelIndex) {
+					++mismatched;
+				}
+			}
+
+			double const march_rate(double(RAYS) / tMarch.count()), hierarchical_rate(double(RAYS) / tHierarchical.count()), batch_rate(double(RAYS) / tBatch.count());
+			if (0 == mismatched) {
+				FMT_LOG_OK(PERF_LOG, "{:d}x{:d} footprint  march {:.2f} M picks/s  pyramid {:.2f} M picks/s ({:.1f}x)  batch {:.2f} M picks/s",
+					footprint, footprint, march_rate * 1e-6, hierarchical_rate * 1e-6, hierarchical_rate / march_rate, batch_rate * 1e-6);
+			}
+			else {
+				FMT_LOG_FAIL(PERF_LOG, "{:d}x{:d} footprint  march {:.2f} M picks/s  pyramid {:.2f} M picks/s ({:.1f}x)  batch {:.2f} M picks/s  {:d} picks differ",
+					footprint, footprint, march_rate * 1e-6, hierarchical_rate * 1e-6, hierarchical_rate / march_rate, batch_rate * 1e-6, mismatched);
+			}
+		}
+	}
+#endif
+
+} // end ns
@@ -0,0 +1,46 @@
+#pragma once
+#include "globals.h"
+#include <Math/point2D_t.h>
+
+// cpu ray picking against the terrain. a max height pyramid over the heightmap (each level holds the maximum heightstep of 2x2 cells of the level below,
+// the first level 8x8 voxels) lets a ray skip whole regions that are lower than the ray in one step, it only descends to the voxels near the surface.
+// the pyramid is built by the first pick after the world is loaded, then kept current by the dirty regions of height edits (once per frame). until something
+// picks there is no pyramid and nothing to maintain. rays wrap around the world the same as the grid.
+//
+// rays are in grid space: x, y (height, real height units of Iso::getRealHeight(), up is positive), z (grid y)
+//		picking::hit const h(picking::pick(picking::rayFromWorld(xmOrigin, xmDirection, distance)));	// camera (world space) ray
+//		picking::pick(rays, hits, count);																// many rays (tools, line of sight), parallel
+namespace picking
+{
+	typedef struct sRay
+	{
+		XMFLOAT3A	origin,
+					direction;		// normalized
+		float		max_distance;
+
+	} ray;
+
+	typedef struct sHit
+	{
+		point2D_t	voxelIndex;		// Grid Space (-x,-y) to (X, Y)
+		float		distance;		// along the ray
+		bool		hit;
+
+	} hit;
+
+	void invalidate();	// the heightmap was replaced (new world / load), the next pick rebuilds the pyramid
+	void create();		// builds the pyramid from the heightmap now, instead of on the next pick
+	void release();
+
+	void __vectorcall updateArea(rect2D_t const voxelAreaLocal); // Grid Space (0,0) to (X, Y), heights changed in the area (dirty regions, once per frame), nothing if the pyramid is not built
+
+	ray const __vectorcall rayFromWorld(FXMVECTOR xmOrigin, FXMVECTOR xmDirection, float const max_distance); // World Space (-Y up, relative to the camera origin) to grid space
+
+	hit const __vectorcall pick(ray const& __restrict r);
+	void pick(ray const* const __restrict rays, hit* const __restrict hits, size_t const count);
+
+#ifdef DEBUG_BENCHMARK_RAY_PICKING
+	void benchmark(FXMVECTOR xmViewDirection, point2D_t const center); // world space view direction, Grid Space (-x,-y) to (X, Y) center
+#endif
+
+} // end ns
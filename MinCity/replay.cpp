@@ -0,0 +1,386 @@
+#include "pch.h"
+#include "replay.h"
+#include "MinCity.h"
+#include "cVoxelWorld.h"
+#include "cUserInterface.h"
+#include "cCity.h"
+
+namespace // private to this file (anonymous)
+{
+	static constexpr uint32_t const
+		JOURNAL_MAGIC = 0x4a52434d,		// "MCRJ"
+		JOURNAL_VERSION = 1;
+
+	typedef struct sJournalHeader
+	{
+		uint32_t magic, version;
+		uint64_t seed, ticks, input_count, name_count;
+
+	} sJournalHeader;
+
+	constinit static struct sState
+	{
+		bool			deterministic, headless, serial, recording, replaying, injecting, diverged;
+		uint64_t		seed, max_ticks, divergence_tick;
+		size_t			input_cursor, event_cursor;
+		FILE*			ticks_csv;
+
+	} state{};
+
+	static std::wstring							journal_path;
+	static vector<replay::input>				journal_inputs;
+	static vector<std::string>					journal_names;
+	static vector<uint64_t>						journal_hashes;
+
+	STATIC_INLINE bool const is_event(uint32_t const type)
+	{
+		return(type >= replay::eInput::TOOL);
+	}
+
+	STATIC_INLINE uint64_t const combine(uint64_t const h, uint64_t const v)
+	{
+		return(replay::internal::mix(h ^ (v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2))));
+	}
+
+	// order independent hash of the simulation state, the model maps are hashed as a sum of per entry hashes so their iteration order does not matter. the grid (every voxel) by the cached chunk crcs
+	static uint64_t const hash_state()
+	{
+		uint64_t h(0);
+
+		world::model_state const models(MinCity::VoxelWorld->download_model_state());
+
+		for (auto const& root : models.hshVoxelModelRootIndex) {
+			h += combine(combine(root.key, uint32_t(root.value.x)), uint32_t(root.value.y));
+		}
+		for (auto const& instance : models.hshVoxelModelInstances_Static) {
+			if (instance.value) {
+				h += combine(1, instance.key);
+			}
+		}
+		for (auto const& instance : models.hshVoxelModelInstances_Dynamic) {
+			if (instance.value) {
+				XMFLOAT3A vLocation;
+				XMStoreFloat3A(&vLocation, instance.value->getLocation());
+
+				uint32_t bits[3];
+				memcpy(bits, &vLocation, sizeof(bits));
+				h += combine(combine(combine(combine(2, instance.key), bits[0]), bits[1]), bits[2]);
+			}
+		}
+
+		h = combine(h, MinCity::VoxelWorld->hash_grid());
+		h = combine(h, MinCity::City->getPopulation());
+		h = combine(h, uint64_t(MinCity::City->getCash()));
+
+		return(h);
+	}
+
+	static void seed_streams(uint64_t const master)
+	{
+		for (uint32_t i = 0; i < replay::eStream::_size_constant; ++i) {
+			replay::internal::seeds[i] = replay::internal::mix(master + uint64_t(i + 1) * 0x9e3779b97f4a7c15ull);
+			replay::internal::draws[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	static bool const load_journal(std::wstring const& path)
+	{
+		FILE* stream(nullptr);
+		if (0 != _wfopen_s(&stream, path.c_str(), L"rb") || nullptr == stream) {
+			FMT_LOG_FAIL(GAME_LOG, "unable to open replay journal");
+			return(false);
+		}
+
+		bool bOk(false);
+		sJournalHeader header{};
+		if (1 == fread(&header, sizeof(header), 1, stream) && JOURNAL_MAGIC == header.magic && JOURNAL_VERSION == header.version) {
+
+			journal_inputs.resize(header.input_count);
+			journal_hashes.resize(header.ticks);
+
+			bOk = (header.input_count == fread(journal_inputs.data(), sizeof(replay::input), header.input_count, stream));
+
+			for (uint64_t i = 0; bOk && i < header.name_count; ++i) {
+				uint32_t length(0);
+				bOk = (1 == fread(&length, sizeof(length), 1, stream));
+				if (bOk) {
+					std::string name(length, '\0');
+					bOk = (length == fread(name.data(), 1, length, stream));
+					journal_names.emplace_back(std::move(name));
+				}
+			}
+
+			bOk = bOk && (header.ticks == fread(journal_hashes.data(), sizeof(uint64_t), header.ticks, stream));
+			state.seed = header.seed;
+		}
+		fclose(stream);
+
+		if (!bOk) {
+			FMT_LOG_FAIL(GAME_LOG, "replay journal is corrupt or of a different version");
+		}
+		return(bOk);
+	}
+
+	static bool const save_journal(std::wstring const& path)
+	{
+		FILE* stream(nullptr);
+		if (0 != _wfopen_s(&stream, path.c_str(), L"wb") || nullptr == stream) {
+			FMT_LOG_FAIL(GAME_LOG, "unable to write replay journal");
+			return(false);
+		}
+
+		sJournalHeader const header{ JOURNAL_MAGIC, JOURNAL_VERSION, state.seed, journal_hashes.size(), journal_inputs.size(), journal_names.size() };
+		fwrite(&header, sizeof(header), 1, stream);
+		fwrite(journal_inputs.data(), sizeof(replay::input), journal_inputs.size(), stream);
+		for (auto const& name : journal_names) {
+			uint32_t const length((uint32_t)name.length());
+			fwrite(&length, sizeof(length), 1, stream);
+			fwrite(name.data(), 1, length, stream);
+		}
+		fwrite(journal_hashes.data(), sizeof(uint64_t), journal_hashes.size(), stream);
+		fclose(stream);
+
+		return(true);
+	}
+
+	static void apply(replay::input const& in)
+	{
+		using namespace replay;
+
+		state.injecting = true;
+
+		switch (in.type)
+		{
+		case eInput::KEY:
+			MinCity::VoxelWorld->OnKey(in.a, 0 != (in.b & 1), 0 != (in.b & 2));
+			break;
+		case eInput::MOUSE_MOTION:
+			MinCity::VoxelWorld->OnMouseMotion(XMVectorSet(in.x, in.y, 0.0f, 0.0f), 0 != in.a);
+			break;
+		case eInput::MOUSE_LEFT:
+			MinCity::VoxelWorld->OnMouseLeft(in.a);
+			break;
+		case eInput::MOUSE_RIGHT:
+			MinCity::VoxelWorld->OnMouseRight(in.a);
+			break;
+		case eInput::MOUSE_LEFT_CLICK:
+			MinCity::VoxelWorld->OnMouseLeftClick();
+			break;
+		case eInput::MOUSE_RIGHT_CLICK:
+			MinCity::VoxelWorld->OnMouseRightClick();
+			break;
+		case eInput::MOUSE_SCROLL:
+			MinCity::VoxelWorld->OnMouseScroll(in.x);
+			break;
+		case eInput::MOUSE_INACTIVE:
+			MinCity::VoxelWorld->OnMouseInactive();
+			break;
+		case eInput::HOVER:
+			MinCity::VoxelWorld->setHoveredVoxelIndex(point2D_t(in.a, in.b));
+			break;
+		case eInput::TOOL:
+			if (in.b < 0) {
+				MinCity::UserInterface->setActivatedTool(in.a);
+			}
+			else {
+				MinCity::UserInterface->setActivatedTool(in.a, uint32_t(in.b));
+			}
+			break;
+		case eInput::EVENT_NEW:
+			MinCity::DispatchEvent(eEvent::NEW);
+			break;
+		case eInput::EVENT_LOAD:
+			if (in.a >= 0 && size_t(in.a) < journal_names.size()) {
+				MinCity::setCityName(journal_names[in.a]);
+				MinCity::DispatchEvent(eEvent::LOAD);
+			}
+			break;
+		}
+
+		state.injecting = false;
+	}
+
+	// replays all journal entries of the current tick matching the phase (input or event), in recorded order
+	static void inject(size_t& __restrict cursor, bool const events)
+	{
+		uint64_t const tick(replay::tick());
+
+		while (cursor < journal_inputs.size()) {
+
+			replay::input const& in(journal_inputs[cursor]);
+			if (in.tick > tick) {
+				break;
+			}
+			++cursor;
+
+			if (is_event(in.type) == events) {
+				apply(in);
+			}
+		}
+	}
+} // end ns
+
+namespace replay
+{
+	bool const Initialize(int const argc, wchar_t const* const* const argv)
+	{
+		bool bOk(true), bSeeded(false);
+
+		for (int i = 1; i < argc; ++i) {
+
+			std::wstring_view const arg(argv[i]);
+			bool const bHasValue(i + 1 < argc);
+
+			if (L"-seed" == arg && bHasValue) {
+				state.deterministic = bSeeded = true;
+				state.seed = std::wcstoull(argv[++i], nullptr, 10);
+			}
+			else if (L"-record" == arg && bHasValue) {
+				state.deterministic = state.recording = true;
+				journal_path = argv[++i];
+			}
+			else if (L"-replay" == arg && bHasValue) {
+				state.deterministic = state.replaying = true;
+				journal_path = argv[++i];
+			}
+			else if (L"-ticks" == arg && bHasValue) {
+				state.max_ticks = std::wcstoull(argv[++i], nullptr, 10);
+			}
+			else if (L"-headless" == arg) {
+				state.headless = true;
+			}
+			else if (L"-serial" == arg) {
+				state.serial = true;
+			}
+		}
+
+		if (state.recording && state.replaying) {
+			FMT_LOG_FAIL(GAME_LOG, "-record and -replay are exclusive, replaying only");
+			state.recording = false;
+		}
+
+		if (state.replaying) {
+			bOk = load_journal(journal_path);
+			if (bOk && 0 == state.max_ticks) {
+				state.max_ticks = journal_hashes.size();
+			}
+		}
+		else if (!bSeeded) { // recording without a seed, or not deterministic - streams are still used, seeded differently every run
+			state.seed = high_resolution_clock::now().time_since_epoch().count();
+		}
+
+		seed_streams(state.seed);
+
+		if (state.recording | state.replaying) {
+			std::wstring const csv_path(journal_path + (state.recording ? L".ticks.csv" : L".replay.csv"));
+			if (0 != _wfopen_s(&state.ticks_csv, csv_path.c_str(), L"wt") || nullptr == state.ticks_csv) {
+				FMT_LOG_WARN(GAME_LOG, "unable to write tick record");
+				state.ticks_csv = nullptr;
+			}
+			else {
+				fmt::print(state.ticks_csv, "tick,hash,cost_us\n");
+			}
+
+			FMT_LOG(GAME_LOG, "{:s} seed {:d}{:s}", (state.recording ? "recording" : "replaying"), state.seed, (state.headless ? " headless" : ""));
+		}
+
+		return(bOk);
+	}
+
+	int const CleanUp()
+	{
+		if (state.ticks_csv) {
+			fclose(state.ticks_csv);
+			state.ticks_csv = nullptr;
+		}
+
+		if (state.recording) {
+			save_journal(journal_path);
+			FMT_LOG(GAME_LOG, "recorded {:d} ticks, {:d} inputs", journal_hashes.size(), journal_inputs.size());
+		}
+		else if (state.replaying) {
+			if (state.diverged) {
+				FMT_LOG_FAIL(GAME_LOG, "replay diverged at tick {:d}", state.divergence_tick);
+				return(1);
+			}
+			FMT_LOG_OK(GAME_LOG, "replay matched {:d} ticks", std::min(internal::tick, (uint64_t)journal_hashes.size()));
+		}
+
+		return(0);
+	}
+
+	bool const isDeterministic() { return(state.deterministic); }
+	bool const isHeadless() { return(state.headless); }
+	bool const isSerial() { return(state.serial); }
+	bool const isRecording() { return(state.recording); }
+	bool const isReplaying() { return(state.replaying); }
+
+	void InjectInput()
+	{
+		if (state.replaying) {
+			inject(state.input_cursor, false);
+		}
+	}
+
+	void InjectEvents()
+	{
+		if (state.replaying) {
+			inject(state.event_cursor, true);
+		}
+	}
+
+	void EndTick(nanoseconds const tCost)
+	{
+		if (state.recording | state.replaying) {
+
+			uint64_t const hash(hash_state());
+
+			if (state.recording) {
+				journal_hashes.emplace_back(hash);
+			}
+			else if (!state.diverged && internal::tick < journal_hashes.size() && hash != journal_hashes[internal::tick]) {
+				state.diverged = true;
+				state.divergence_tick = internal::tick;
+				FMT_LOG_FAIL(GAME_LOG, "replay diverged at tick {:d} {:#x} != {:#x}", internal::tick, hash, journal_hashes[internal::tick]);
+			}
+
+			if (state.ticks_csv) {
+				fmt::print(state.ticks_csv, "{:d},{:016x},{:d}\n", internal::tick, hash, duration_cast<microseconds>(tCost).count());
+			}
+		}
+
+		++internal::tick;
+	}
+
+	bool const isFinished()
+	{
+		return(0 != state.max_ticks && internal::tick >= state.max_ticks);
+	}
+
+	bool const Input(input const& in)
+	{
+		if (state.replaying) {
+			return(state.injecting); // live input is dropped
+		}
+		if (state.recording) {
+			journal_inputs.emplace_back(in);
+		}
+		return(true);
+	}
+
+	bool const Input(uint32_t const type, int32_t const a, int32_t const b, float const x, float const y)
+	{
+		return(Input(input{ internal::tick, type, a, b, x, y }));
+	}
+
+	bool const Event(uint32_t const type, std::string_view const name)
+	{
+		int32_t index(0);
+		if (state.recording && !name.empty()) {
+			index = (int32_t)journal_names.size();
+			journal_names.emplace_back(name);
+		}
+		return(Input(type, index));
+	}
+
+} // end ns
@@ -0,0 +1,131 @@
+#pragma once
+#include "globals.h"
+#include "tTime.h"
+#include <atomic>
+#include <string>
+
+// deterministic simulation & replay. Every simulation subsystem draws from its own seeded random stream instead of the global
+// generator, so a run is reproducible from the seed alone. In deterministic mode the world clock advances exactly one fixed step
+// (fixed_delta_duration) per frame, independent of wall clock time.
+//
+// command line (all optional):
+//		-seed <n>		deterministic mode with seed n
+//		-record <file>	deterministic mode, journals all input & events and the state hash of every tick to <file>
+//		-replay <file>	deterministic mode, replays <file> bit-exactly ignoring live input, reports the first tick whose state hash diverges
+//		-headless		no window is created and Vulkan is never initialized, only the simulation runs (saves have a black thumbnail)
+//		-ticks <n>		shutdown after n ticks (replay defaults to the length of the journal)
+//		-serial			frame graph stages run one after the other on the main thread (baseline for the concurrent schedule, see frameGraph.h)
+//
+// every tick writes "tick,hash,cost_us" to <file>.ticks.csv (record) or <file>.replay.csv (replay), so two runs can be compared
+// with a plain diff. The process exit code is non-zero when a replay diverged.
+namespace replay
+{
+	BETTER_ENUM(eStream, uint32_t const,
+
+		SIMULATION = 0,
+		ZONING,
+		CITY,
+		CARS,
+		WORLD
+	);
+
+	BETTER_ENUM(eInput, uint32_t const,
+
+		KEY = 0,				// a = key, b = down | (ctrl << 1)
+		MOUSE_MOTION,			// x, y = mouse position, a = ignore
+		MOUSE_LEFT,				// a = eMouseButtonState
+		MOUSE_RIGHT,			// a = eMouseButtonState
+		MOUSE_LEFT_CLICK,
+		MOUSE_RIGHT_CLICK,
+		MOUSE_SCROLL,			// x = delta
+		MOUSE_INACTIVE,
+		HOVER,					// a, b = hovered voxel index, the hover raycast reads back from the gpu so it is replayed rather than recomputed
+		TOOL,					// a = tool, b = subtool (-1 if none)
+		EVENT_NEW,				// processed with the event queue
+		EVENT_LOAD				// processed with the event queue, a = index of city name
+	);
+
+	typedef struct sInput	// fixed size journal record
+	{
+		uint64_t	tick;	// simulation ticks completed when the input happened
+		uint32_t	type;
+		int32_t		a, b;
+		float		x, y;
+
+	} input;
+
+	namespace internal
+	{
+		inline constinit uint64_t				  seeds[eStream::_size_constant]{};
+		inline constinit std::atomic_uint64_t	  draws[eStream::_size_constant]{};
+		inline constinit uint64_t				  tick{};
+
+		STATIC_INLINE_PURE uint64_t const mix(uint64_t z) // splitmix64 finalizer
+		{
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			return(z ^ (z >> 31));
+		}
+	} // end ns
+
+	// startup, before MinCity::Initialize
+	bool const Initialize(int const argc, wchar_t const* const* const argv);
+	int const CleanUp(); // returns the process exit code
+
+	bool const isDeterministic();
+	bool const isHeadless();
+	bool const isSerial();
+	bool const isRecording();
+	bool const isReplaying();
+	__inline uint64_t const tick() { return(internal::tick); }
+
+	// main loop
+	void InjectInput();							// replay: input for the current tick, right after live input would be processed
+	void InjectEvents();						// replay: events for the current tick, before the event queue is processed
+	void EndTick(nanoseconds const tCost);		// hashes state, writes/compares the tick record, advances the tick
+	bool const isFinished();					// requested tick count reached or journal exhausted
+
+	// input journal - returns false when live input must be dropped (replaying), records the input when recording
+	bool const Input(input const& in);
+	bool const Input(uint32_t const type, int32_t const a = 0, int32_t const b = 0, float const x = 0.0f, float const y = 0.0f);
+	bool const Event(uint32_t const type, std::string_view const name = std::string_view{});
+
+	// random streams. sequential draws are deterministic when the order of draws on a stream is, use keyed draws from parallel code.
+	__inline uint32_t const RandomNumber32(uint32_t const stream)
+	{
+		uint64_t const draw(internal::draws[stream].fetch_add(1, std::memory_order_relaxed));
+		return(uint32_t(internal::mix(internal::seeds[stream] + draw * 0x9e3779b97f4a7c15ull) >> 32));
+	}
+	__inline int32_t const RandomNumber32(uint32_t const stream, int32_t const minimum, int32_t const maximum) // inclusive
+	{
+		uint64_t const range(uint64_t(int64_t(maximum) - int64_t(minimum)) + 1ull);
+		return(minimum + int32_t((uint64_t(RandomNumber32(stream)) * range) >> 32));
+	}
+	__inline bool const Random5050(uint32_t const stream)
+	{
+		return(RandomNumber32(stream) >> 31);
+	}
+	__inline float const RandomFloat(uint32_t const stream) // [0.0f ... 1.0f)
+	{
+		return(float(RandomNumber32(stream) >> 8) * (1.0f / 16777216.0f));
+	}
+	// independent of draw order, same (stream, tick, key) always returns the same value
+	__inline uint32_t const RandomKeyed(uint32_t const stream, uint32_t const key)
+	{
+		return(uint32_t(internal::mix(internal::seeds[stream] ^ internal::mix((internal::tick << 32) | key)) >> 32));
+	}
+
+	// UniformRandomBitGenerator for std::shuffle etc.
+	typedef struct sStreamEngine
+	{
+		using result_type = uint32_t;
+
+		static constexpr result_type const min() { return(0); }
+		static constexpr result_type const max() { return(UINT32_MAX); }
+		result_type const operator()() const { return(RandomNumber32(stream)); }
+
+		uint32_t const stream;
+
+	} stream_engine;
+
+} // end ns
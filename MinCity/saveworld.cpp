@@ -5,9 +5,9 @@
 #include "data.h"
 #include "CityInfo.h"
 #include "cCity.h"
+#include "replay.h"
 #include <filesystem>
 #include <stdio.h> // C File I/O is 10x faster than C++ file stream I/O
-#include <density.h>	// https://github.com/centaurean/density - Density, fastest compression/decompression library out there with simple interface. must reproduce license file. attribution.
 #include <Imaging/Imaging/Imaging.h>
 #include "cNonUpdateableGameObject.h"
 #include <Utility/stringconv.h>
@@ -75,24 +75,24 @@ namespace world
 
 		// verify good
 		// exists
-		if (nullptr != iter->second) {
+		if (nullptr != iter->value) {
 
-			uint32_t const gameobject_type = iter->second->getOwnerGameObjectType();
+			uint32_t const gameobject_type = iter->value->getOwnerGameObjectType();
 			// all filtered types *even NoOwner types (eg.) lampposts)
 			if (!filter_static(gameobject_type)) // only filtered
 				return;
 
-			auto const& iterFind = world_model_state.hshVoxelModelRootIndex.find(hash);
-			if (world_model_state.hshVoxelModelRootIndex.cend() != iterFind) {
+			point2D_t const* const rootIndex = world_model_state.hshVoxelModelRootIndex.find(hash);
+			if (nullptr != rootIndex) {
 
-				data_models.emplace_back(hash, gameobject_type, iter->second->getModel().identity());
-				data_rootIndex.emplace_back(hash, iterFind->second); // add to buffer of saved root indices
+				data_models.emplace_back(hash, gameobject_type, iter->value->getModel().identity());
+				data_rootIndex.emplace_back(hash, *rootIndex); // add to buffer of saved root indices
 
 				// *set additional varying data
 
 				// set gameobject specific data
 				if (types::game_object_t::NoOwner != gameobject_type) {
-					BufferGameObject<Volumetric::voxelModelInstance_Static>(hash, iter->second, data_gameobjects);
+					BufferGameObject<Volumetric::voxelModelInstance_Static>(hash, iter->value, data_gameobjects);
 				}
 			}
 		}
@@ -122,33 +122,76 @@ namespace world
 
 		// verify good
 		// exists
-		if (nullptr != iter->second) {
+		if (nullptr != iter->value) {
 
-			uint32_t const gameobject_type = iter->second->getOwnerGameObjectType();
+			uint32_t const gameobject_type = iter->value->getOwnerGameObjectType();
 			// all filtered types *even NoOwner types (eg.) lampposts)
 			if (!filter_dynamic(gameobject_type)) // only filtered
 				return;
 
-			auto const& iterFind = world_model_state.hshVoxelModelRootIndex.find(hash);
-			if (world_model_state.hshVoxelModelRootIndex.cend() != iterFind) {
+			point2D_t const* const rootIndex = world_model_state.hshVoxelModelRootIndex.find(hash);
+			if (nullptr != rootIndex) {
 
-				data_models.emplace_back(hash, gameobject_type, iter->second->getModel().identity());
-				data_rootIndex.emplace_back(hash, iterFind->second); // add to buffer of saved root indices
+				data_models.emplace_back(hash, gameobject_type, iter->value->getModel().identity());
+				data_rootIndex.emplace_back(hash, *rootIndex); // add to buffer of saved root indices
 
 				// *set additional varying data
-				XMStoreFloat3(&data_models.back().location, iter->second->getLocation());
-				XMStoreFloat3(&data_models.back().roll, iter->second->getRoll().data());
-				XMStoreFloat3(&data_models.back().pitch, iter->second->getPitch().data());
-				XMStoreFloat3(&data_models.back().yaw, iter->second->getYaw().data());
+				XMStoreFloat3(&data_models.back().location, iter->value->getLocation());
+				XMStoreFloat3(&data_models.back().roll, iter->value->getRoll().data());
+				XMStoreFloat3(&data_models.back().pitch, iter->value->getPitch().data());
+				XMStoreFloat3(&data_models.back().yaw, iter->value->getYaw().data());
 				
 				// set gameobject specific data
 				if (types::game_object_t::NoOwner != gameobject_type) {
-					BufferGameObject<Volumetric::voxelModelInstance_Dynamic>(hash, iter->second, data_gameobjects);
+					BufferGameObject<Volumetric::voxelModelInstance_Dynamic>(hash, iter->value, data_gameobjects);
 				}
 			}
 		}
 	}
 
+	// consistent state captured on the main thread by SnapshotWorld(), written in the background by SaveWorld()
+	static struct sSaveSnapshot
+	{
+		vector<model_state_instance_static>		models_static;
+		vector<model_state_instance_dynamic>	models_dynamic;
+		vector<model_root_index>				rootIndex;
+		vector<uint8_t>							gameobjects;
+		CityInfo								info;
+
+		void clear() {
+			models_static.clear(); models_dynamic.clear(); rootIndex.clear(); gameobjects.clear();
+			info = {};
+		}
+
+	} save_snapshot{};
+
+	// *main thread, between frames* - the grid snapshot is O(1) (copy-on-write), the instance tables are small in comparison and are buffered here
+	// so game objects can keep changing while the save is written.
+	void cVoxelWorld::SnapshotWorld()
+	{
+		_streamingGrid.Snapshot();
+
+		save_snapshot.clear();
+		save_snapshot.info = MinCity::City->getInfo();
+
+		// parse all voxelmodel instances
+		// match the hash id for found root voxels to voxelmodel
+		// buffer the relation between hash id and the corresponding voxel model identity
+		auto const world_model_state(download_model_state());
+
+		// do all static //
+		for (mapVoxelModelInstancesStatic::const_iterator iter = world_model_state.hshVoxelModelInstances_Static.cbegin(); iter != world_model_state.hshVoxelModelInstances_Static.cend(); ++iter) {
+
+			BufferStaticModelInstance(iter->key, world_model_state, iter, save_snapshot.models_static, save_snapshot.rootIndex, save_snapshot.gameobjects);
+		}
+
+		// do required dynamic //
+		for (mapVoxelModelInstancesDynamic::const_iterator iter = world_model_state.hshVoxelModelInstances_Dynamic.cbegin(); iter != world_model_state.hshVoxelModelInstances_Dynamic.cend(); ++iter) {
+
+			BufferDynamicModelInstance(iter->key, world_model_state, iter, save_snapshot.models_dynamic, save_snapshot.rootIndex, save_snapshot.gameobjects);
+		}
+	}
+
 	void cVoxelWorld::SaveWorld()
 	{
 		std::string_view const szCityName(MinCity::getCityName());
@@ -163,26 +206,20 @@ namespace world
 
 			MinCity::DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(10));
 
-			// structured binding
-			auto const [snapshot, voxel_count] = GridSnapshot();
-
-			MinCity::DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(20));
-
-			size_t const gridSz(sizeof(Iso::Voxel) * voxel_count);
+			// grid is saved seperately, chunk by chunk - only chunks modified since the last save are re-written
+			fs::path gridPath(savePath);
+			gridPath.replace_extension(GRID_FILE_EXT);
 
-			// Determine safe buffer sizes
-			size_t const compress_safe_size = density_compress_safe_size(gridSz);
+			bool const bGridSaved(GridSave(gridPath.wstring()));
 
-			uint8_t* __restrict outCompressed((uint8_t * __restrict)scalable_malloc(compress_safe_size));
+			_streamingGrid.ReleaseSnapshot(); // grid is written, preserved chunks are no longer needed
 
-			density_processing_result const result = density_compress((uint8_t* const __restrict)&snapshot[0], gridSz, outCompressed, compress_safe_size, DENSITY_ALGORITHM_CHEETAH);
-
-			if (!result.state) {
+			if (bGridSaved) {
 
 				MinCity::DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(50));
 
 				//write file header
-				voxelWorldDesc const header{ { 'C', '1', 'T', 'Y' }, GetSecureSeed(), uint32_t(szCityName.length()), result.bytesWritten, voxel_count };
+				voxelWorldDesc const header{ { 'C', '1', 'T', 'Y' }, GetSecureSeed(), uint32_t(szCityName.length()), 0 /* chunked grid file*/, Iso::WORLD_GRID_WIDTH * Iso::WORLD_GRID_HEIGHT };
 
 				_fwrite_nolock(&header, sizeof(voxelWorldDesc), 1, stream);
 
@@ -190,7 +227,7 @@ namespace world
 				_fwrite_nolock(szCityName.data(), sizeof(szCityName.data()[0]), szCityName.length(), stream);
 
 				// write city info
-				_fwrite_nolock(&MinCity::City->getInfo(), sizeof(CityInfo), 1, stream);
+				_fwrite_nolock(&save_snapshot.info, sizeof(CityInfo), 1, stream);
 
 				// reserve space needed for offscreen image capture
 				constexpr uint32_t const offscreen_image_size(offscreen_thumbnail_width * offscreen_thumbnail_height * sizeof(uint32_t));
@@ -200,84 +237,37 @@ namespace world
 					_putc_nolock(0, stream); // clearing reserved space
 				}
 
-				// write the grid
-				_fwrite_nolock(&outCompressed[0], sizeof(outCompressed[0]), header.grid_compressed_size, stream);
-
 				MinCity::DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(70));
-				// parse all grid voxels looking for voxelmodel instances
-				// match the hash id for found root voxels to voxelmodel
-				// write the relation between hash id and the corresponding voxel model identity
-
-				auto const world_model_state(MinCity::VoxelWorld->download_model_state());
-
-				vector<uint8_t> data_gameobjects;
-				{
-					vector<model_root_index> data_rootIndex;
-
-					{ // do all static //
-						vector<model_state_instance_static> data_models_static;
-						for (mapVoxelModelInstancesStatic::const_iterator iter = world_model_state.hshVoxelModelInstances_Static.cbegin(); iter != world_model_state.hshVoxelModelInstances_Static.cend(); ++iter) {
 
-							BufferStaticModelInstance(iter->first, world_model_state, iter, data_models_static, data_rootIndex, data_gameobjects);
-						}
-
-						// write the static model instances and associated game objects
-						size_t const count(data_models_static.size());
-						_fwrite_nolock(&count, sizeof(size_t), 1, stream);
-						_fwrite_nolock(data_models_static.data(), sizeof(model_state_instance_static), count, stream);
-					}
-
-					{ // do required dynamic //
-						vector<model_state_instance_dynamic> data_models_dynamic;
-						for (mapVoxelModelInstancesDynamic::const_iterator iter = world_model_state.hshVoxelModelInstances_Dynamic.cbegin(); iter != world_model_state.hshVoxelModelInstances_Dynamic.cend(); ++iter) {
-
-							BufferDynamicModelInstance(iter->first, world_model_state, iter, data_models_dynamic, data_rootIndex, data_gameobjects);
-						}
+				{ // write the static model instances and associated game objects
+					size_t const count(save_snapshot.models_static.size());
+					_fwrite_nolock(&count, sizeof(size_t), 1, stream);
+					_fwrite_nolock(save_snapshot.models_static.data(), sizeof(model_state_instance_static), count, stream);
+				}
 
-						// write the dynamic model instances and associated game objects
-						size_t const count(data_models_dynamic.size());
-						_fwrite_nolock(&count, sizeof(size_t), 1, stream);
-						_fwrite_nolock(data_models_dynamic.data(), sizeof(model_state_instance_dynamic), count, stream);
-					}
+				{ // write the dynamic model instances and associated game objects
+					size_t const count(save_snapshot.models_dynamic.size());
+					_fwrite_nolock(&count, sizeof(size_t), 1, stream);
+					_fwrite_nolock(save_snapshot.models_dynamic.data(), sizeof(model_state_instance_dynamic), count, stream);
+				}
 
-					// finally write finished model root indices
-					size_t const count(data_rootIndex.size());
+				{ // finally write finished model root indices
+					size_t const count(save_snapshot.rootIndex.size());
 					_fwrite_nolock(&count, sizeof(size_t), 1, stream);
-					_fwrite_nolock(data_rootIndex.data(), sizeof(model_root_index), count, stream);
+					_fwrite_nolock(save_snapshot.rootIndex.data(), sizeof(model_root_index), count, stream);
 				}
 
-				// *last* write gameobject specific data
-				size_t const count(data_gameobjects.size());
-				_fwrite_nolock(&count, sizeof(size_t), 1, stream);
-				_fwrite_nolock(data_gameobjects.data(), count, 1, stream);
+				{ // *last* write gameobject specific data
+					size_t const count(save_snapshot.gameobjects.size());
+					_fwrite_nolock(&count, sizeof(size_t), 1, stream);
+					_fwrite_nolock(save_snapshot.gameobjects.data(), count, 1, stream);
+				}
 
 				// write file delimiter (null, 64bytes in length) //
 				for (uint32_t i = 0; i < file_delim_zero_count; ++i) {
 					_putc_nolock(0, stream);
 				}
 
-				/*
-				Iso::Voxel const* pVoxels(&snapshot[0]);
-				for (size_t voxel = 0; voxel < voxel_count; ++voxel) {
-
-					Iso::Voxel const* const pVoxel = pVoxels;
-					++pVoxels;
-
-					if (pVoxel) {
-						Iso::Voxel const oVoxel(*pVoxel);
-
-						if (Iso::isOwnerAny(oVoxel)) {
-
-							// skipping ground
-							for (uint32_t i = Iso::STATIC_HASH; i < Iso::HASH_COUNT; ++i) {
-
-							}
-							//Iso::serialize();
-						}
-					}
-				}
-				*/
-
 				// This is the last file save operation always //
 
 				// move file pointer back to reserved offscreen image area
@@ -286,14 +276,19 @@ namespace world
 				point2D_t const frameBufferSz(MinCity::getFramebufferSize());
 				Imaging offscreen_image = ImagingNew(eIMAGINGMODE::MODE_BGRX, frameBufferSz.x, frameBufferSz.y);
 
-				// wait until the offscreen capture is copied from gpu
-				std::atomic_flag& OffscreenCapturedFlag(MinCity::Vulkan->getOffscreenCopyStatus());
-				while( OffscreenCapturedFlag.test_and_set() ) {	// OffscreenCapturedFlag is clear upon copy completion
-					_mm_pause(); // this is an actual tight loop instance where _mm_pause() can be used. Note it used to be 10 cycles for this instruction on x86-64 processors. recent Intel Skylake processors has increased that to 140 cycles + increased latency.
-				}                // So In general _mm_pause should no longer be used to hint to the processor that it's in a tight loop. https://graphitemaster.github.io/fibers/
+				if (!(replay::isHeadless() | replay::isDeterministic())) { // see OnSave
+					// wait until the offscreen capture is copied from gpu
+					std::atomic_flag& OffscreenCapturedFlag(MinCity::Vulkan->getOffscreenCopyStatus());
+					while( OffscreenCapturedFlag.test_and_set() ) {	// OffscreenCapturedFlag is clear upon copy completion
+						_mm_pause(); // this is an actual tight loop instance where _mm_pause() can be used. Note it used to be 10 cycles for this instruction on x86-64 processors. recent Intel Skylake processors has increased that to 140 cycles + increased latency.
+					}                // So In general _mm_pause should no longer be used to hint to the processor that it's in a tight loop. https://graphitemaster.github.io/fibers/
 
-				// safe to query the data from offscreen buffer
-				MinCity::Vulkan->queryOffscreenBuffer((uint32_t * const __restrict)offscreen_image->block);
+					// safe to query the data from offscreen buffer
+					MinCity::Vulkan->queryOffscreenBuffer((uint32_t * const __restrict)offscreen_image->block);
+				}
+				else { // no offscreen capture, black thumbnail
+					memset(offscreen_image->block, 0, size_t(frameBufferSz.x) * size_t(frameBufferSz.y) * sizeof(uint32_t));
+				}
 
 				// resample to thumbnail size
 				Imaging scaled_offscreen_image = ImagingResample(offscreen_image, offscreen_thumbnail_width, offscreen_thumbnail_height, IMAGING_TRANSFORM_BICUBIC);
@@ -317,16 +312,13 @@ namespace world
 				// done!
 				MinCity::DispatchEvent(eEvent::PAUSE_PROGRESS, new uint32_t(100));
 			}
-
-			if (outCompressed) {
-				scalable_free(outCompressed);
-				outCompressed = nullptr;
-			}
-			// release mem for the grid copy
-			if (snapshot) {
-				scalable_free(const_cast<Iso::Voxel*>(snapshot));
+			else {
+				_fclose_nolock(stream);
 			}
 		}
+
+		_streamingGrid.ReleaseSnapshot(); // always, even if the save failed (no-op if already released)
+		save_snapshot.clear();
 	}
 
 
@@ -0,0 +1,458 @@
+#include "pch.h"
+#include "undoJournal.h"
+#include "IsoVoxel.h"
+#include "world.h"
+#include "MinCity.h"
+#include "cAbstractToolMethods.h"
+#include "codec.h"
+#include "performance.h"
+#include <deque>
+#include <algorithm>
+#include <filesystem>
+
+#pragma intrinsic(memcpy)
+#pragma intrinsic(memcmp)
+
+namespace // private to this file (anonymous)
+{
+	static constexpr int64_t const RESIDENT = -1;
+
+	typedef struct sCaptured
+	{
+		Iso::Voxel	voxel;			// before
+		point2D_t	voxelIndex;
+
+	} captured;
+
+	typedef struct sOperation
+	{
+		vector<uint8_t>	data;			// [compressed indices][compressed before voxels, after voxels], empty while spilled
+		int64_t			spill_offset;	// RESIDENT or offset in the spill file
+		uint32_t		bytes,			// compressed size of data
+						index_bytes,	// compressed size of the indices
+						voxel_count,
+						tool,
+						codec;
+
+	} operation;
+
+	static struct sJournal
+	{
+		std::deque<operation>					undoable,	// oldest first, the spilled operations are always a prefix of undoable
+												redoable;	// always resident
+		vector_aligned<captured>				pending;
+		uint32_t								tool = 0;
+		bool									recording = false;
+
+		size_t									memory_cap = (8 << 20),
+												spill_cap = (64 << 20),
+												resident_bytes = 0,
+												spilled_bytes = 0,
+												evicted = 0,
+												last_voxels = 0,
+												last_bytes = 0;
+
+		FILE*									spill = nullptr;
+		int64_t									spill_begin = 0,	// [spill_begin, spill_end) holds the spilled operations, the spill file is a stack
+												spill_end = 0;		// popped from the end by undo, evicted from the beginning
+	} journal;
+
+	static std::wstring const spill_path()
+	{
+		std::wstring path(MinCity::getUserFolder());
+		path += VIRTUAL_DIR;
+		path += L"undo.journal";
+
+		return(path);
+	}
+
+	static bool const open_spill()
+	{
+		if (nullptr == journal.spill) {
+			if (0 != _wfopen_s(&journal.spill, spill_path().c_str(), L"w+bS") || nullptr == journal.spill) {
+				journal.spill = nullptr;
+				FMT_LOG_FAIL(GAME_LOG, "undo journal, unable to open spill file");
+				return(false);
+			}
+			journal.spill_begin = journal.spill_end = 0;
+		}
+		return(true);
+	}
+
+	static void close_spill()
+	{
+		if (journal.spill) {
+			fclose(journal.spill); journal.spill = nullptr;
+
+			std::error_code error{};
+			std::filesystem::remove(spill_path(), error);
+		}
+		journal.spill_begin = journal.spill_end = 0;
+		journal.spilled_bytes = 0;
+	}
+
+	static bool const spill_out(operation& op)
+	{
+		if (0 == journal.spill_cap || !open_spill())
+			return(false);
+
+		if (0 != _fseeki64(journal.spill, journal.spill_end, SEEK_SET) || op.bytes != fwrite(op.data.data(), 1, op.bytes, journal.spill))
+			return(false);
+
+		op.spill_offset = journal.spill_end;
+		journal.spill_end += op.bytes;
+		journal.spilled_bytes += op.bytes;
+		journal.resident_bytes -= op.bytes;
+		vector<uint8_t>().swap(op.data);
+
+		return(true);
+	}
+
+	static bool const spill_in(operation& op) // only the newest spilled operation (the end of the spill file)
+	{
+		op.data.resize(op.bytes);
+
+		if (0 != _fseeki64(journal.spill, op.spill_offset, SEEK_SET) || op.bytes != fread(op.data.data(), 1, op.bytes, journal.spill)) {
+			vector<uint8_t>().swap(op.data);
+			return(false);
+		}
+
+		journal.spill_end = op.spill_offset;
+		journal.spilled_bytes -= op.bytes;
+		journal.resident_bytes += op.bytes;
+		op.spill_offset = RESIDENT;
+
+		if (0 == journal.spilled_bytes) {
+			journal.spill_begin = journal.spill_end = 0;
+		}
+		return(true);
+	}
+
+	static void evict_oldest()
+	{
+		operation const& op(journal.undoable.front());
+
+		if (RESIDENT != op.spill_offset) {
+			journal.spilled_bytes -= op.bytes;
+			journal.spill_begin = op.spill_offset + op.bytes;
+
+			if (0 == journal.spilled_bytes) {
+				journal.spill_begin = journal.spill_end = 0;
+			}
+		}
+		else {
+			journal.resident_bytes -= op.bytes;
+		}
+
+		journal.undoable.pop_front();
+		++journal.evicted;
+	}
+
+	static void compact_spill() // moves the spilled operations to the beginning of the spill file, every move is to a lower offset so it is done in place
+	{
+		vector<uint8_t> buffer;
+		int64_t offset(0);
+
+		for (auto& op : journal.undoable) {
+
+			if (RESIDENT == op.spill_offset)
+				break;
+
+			buffer.resize(op.bytes);
+			if (0 != _fseeki64(journal.spill, op.spill_offset, SEEK_SET) || op.bytes != fread(buffer.data(), 1, op.bytes, journal.spill) ||
+				0 != _fseeki64(journal.spill, offset, SEEK_SET) || op.bytes != fwrite(buffer.data(), 1, op.bytes, journal.spill)) {
+				FMT_LOG_FAIL(GAME_LOG, "undo journal, unable to compact spill file");
+				return;
+			}
+
+			op.spill_offset = offset;
+			offset += op.bytes;
+		}
+
+		journal.spill_begin = 0;
+		journal.spill_end = offset;
+	}
+
+	static void enforce_caps()
+	{
+		// memory cap - oldest resident operations are spilled, or evicted if they cannot be spilled. the newest operation always stays resident.
+		while (journal.resident_bytes > journal.memory_cap) {
+
+			size_t oldest(0);
+			while (oldest < journal.undoable.size() && RESIDENT != journal.undoable[oldest].spill_offset) {
+				++oldest;
+			}
+
+			if (oldest + 1 >= journal.undoable.size()) // only the newest (or nothing) is resident in the undo history, the remainder is redo history
+				break;
+
+			if (!spill_out(journal.undoable[oldest])) {
+
+				for (size_t i = 0; i <= oldest; ++i) { // history must stay contiguous, everything older goes with it
+					evict_oldest();
+				}
+			}
+		}
+
+		// spill cap
+		while (journal.spilled_bytes > journal.spill_cap && !journal.undoable.empty() && RESIDENT != journal.undoable.front().spill_offset) {
+			evict_oldest();
+		}
+
+		if (journal.spill && journal.spill_begin > (int64_t)journal.spill_cap) {
+			compact_spill();
+		}
+
+		metrics::gauge(metrics::eGauge::UNDO_JOURNAL_BYTES, (int64_t)journal.resident_bytes);
+	}
+
+	// every voxel must still be in the state the operation left it in (undo) or the state it was undone to (redo). the simulation may have built
+	// on the area since (instances are not journaled), writing the other state back over that would orphan them - the operation is refused instead
+	// and stays where it is, it can be retried once the area is back in that state.
+	static bool const apply(operation const& op, bool const bAfter)
+	{
+		size_t const index_raw(op.voxel_count * sizeof(point2D_t)),
+					 voxel_raw(op.voxel_count * 2 * sizeof(Iso::Voxel));
+
+		vector<uint8_t> indices(codec::decompress_bound(op.codec, index_raw)),
+						voxels(codec::decompress_bound(op.codec, voxel_raw));
+
+		if (index_raw != codec::decompress(op.codec, op.data.data(), op.index_bytes, indices.data(), indices.size())
+			|| voxel_raw != codec::decompress(op.codec, op.data.data() + op.index_bytes, op.bytes - op.index_bytes, voxels.data(), voxels.size())) {
+
+			FMT_LOG_FAIL(GAME_LOG, "undo journal, {:s} operation is corrupt", eTools::_from_integral(op.tool)._to_string());
+			return(false);
+		}
+
+		size_t const half(op.voxel_count * sizeof(Iso::Voxel));
+		uint8_t const* const __restrict pExpected(voxels.data() + (bAfter ? 0 : half)),	// current state
+					 * const __restrict pTarget(voxels.data() + (bAfter ? half : 0));	// state written
+
+		uint32_t changed(0);
+		for (uint32_t i = 0; i < op.voxel_count; ++i) {
+
+			point2D_t voxelIndex;
+			memcpy(&voxelIndex, indices.data() + i * sizeof(point2D_t), sizeof(point2D_t));
+
+			Iso::Voxel const oVoxel(world::getVoxelAt(voxelIndex));
+			changed += (0 != memcmp(&oVoxel, pExpected + i * sizeof(Iso::Voxel), sizeof(Iso::Voxel)));
+		}
+
+		if (0 != changed) {
+			FMT_LOG_FAIL(GAME_LOG, "undo journal, {:s} area has changed since ({:d} of {:d} voxels), cannot {:s}", eTools::_from_integral(op.tool)._to_string(), changed, op.voxel_count, bAfter ? "redo" : "undo");
+			return(false);
+		}
+
+		for (uint32_t i = 0; i < op.voxel_count; ++i) {
+
+			point2D_t voxelIndex;
+			Iso::Voxel oVoxel;
+
+			memcpy(&voxelIndex, indices.data() + i * sizeof(point2D_t), sizeof(point2D_t));
+			memcpy(&oVoxel, pTarget + i * sizeof(Iso::Voxel), sizeof(Iso::Voxel));
+
+			world::setVoxelAt(voxelIndex, std::forward<Iso::Voxel const&& __restrict>(oVoxel));
+		}
+
+		return(true);
+	}
+
+	static void clear_redo()
+	{
+		for (auto const& op : journal.redoable) {
+			journal.resident_bytes -= op.bytes;
+		}
+		journal.redoable.clear();
+	}
+
+} // end ns
+
+namespace undo
+{
+	void configure(size_t const memory_cap, size_t const spill_cap)
+	{
+		journal.memory_cap = memory_cap;
+		journal.spill_cap = spill_cap;
+
+		enforce_caps();
+	}
+
+	void begin(uint32_t const tool)
+	{
+		journal.pending.clear();
+		journal.tool = tool;
+		journal.recording = true;
+	}
+
+	void __vectorcall capture(point2D_t const voxelIndex)
+	{
+		if (journal.recording) {
+			journal.pending.emplace_back(captured{ world::getVoxelAt(voxelIndex), voxelIndex });
+		}
+	}
+
+	void __vectorcall capture(rect2D_t area)
+	{
+		if (journal.recording) {
+
+			// clamp to world/minmax coords
+			area = r2D_clamp(area, point2D_t(Iso::MIN_VOXEL_COORD_U, Iso::MIN_VOXEL_COORD_V), point2D_t(Iso::MAX_VOXEL_COORD_U, Iso::MAX_VOXEL_COORD_V));
+
+			point2D_t voxelIndex;
+			for (voxelIndex.y = area.top; voxelIndex.y < area.bottom; ++voxelIndex.y) {
+				for (voxelIndex.x = area.left; voxelIndex.x < area.right; ++voxelIndex.x) {
+					capture(voxelIndex);
+				}
+			}
+		}
+	}
+
+	bool const commit()
+	{
+		if (!journal.recording)
+			return(false);
+
+		journal.recording = false;
+
+		// the first capture of a voxel is the state before the operation
+		auto& pending(journal.pending);
+		std::stable_sort(pending.begin(), pending.end(), [](captured const& lhs, captured const& rhs) { return(lhs.voxelIndex < rhs.voxelIndex); });
+		pending.erase(std::unique(pending.begin(), pending.end(), [](captured const& lhs, captured const& rhs) { return(lhs.voxelIndex == rhs.voxelIndex); }), pending.end());
+
+		// only the voxels that changed are kept, as structure of arrays so the codec sees each field of the voxel as a run
+		vector<point2D_t> indices;
+		vector_aligned<Iso::Voxel> voxels, after;
+		indices.reserve(pending.size()); voxels.reserve(pending.size() << 1); after.reserve(pending.size());
+
+		for (auto const& capture : pending) {
+
+			Iso::Voxel const oVoxel(world::getVoxelAt(capture.voxelIndex));
+
+			if (0 != memcmp(&oVoxel, &capture.voxel, sizeof(Iso::Voxel))) {
+				indices.emplace_back(capture.voxelIndex);
+				voxels.emplace_back(capture.voxel);
+				after.emplace_back(oVoxel);
+			}
+		}
+		pending.clear();
+
+		if (indices.empty())
+			return(false);
+
+		voxels.insert(voxels.end(), after.cbegin(), after.cend());
+
+		uint32_t const voxel_count((uint32_t)indices.size());
+		size_t const index_raw(voxel_count * sizeof(point2D_t)),
+					 voxel_raw(voxel_count * 2 * sizeof(Iso::Voxel));
+
+		codec::selection const method(codec::selected(codec::eSite::UNDO_JOURNAL));
+
+		operation op{};
+		op.spill_offset = RESIDENT;
+		op.tool = journal.tool;
+		op.codec = method.codec;
+		op.voxel_count = voxel_count;
+		op.data.resize(codec::compress_bound(method.codec, index_raw) + codec::compress_bound(method.codec, voxel_raw));
+
+		size_t const index_bytes(codec::compress(method, indices.data(), index_raw, op.data.data(), op.data.size(), sizeof(point2D_t)));
+		size_t const voxel_bytes(0 == index_bytes ? 0 : codec::compress(method, voxels.data(), voxel_raw, op.data.data() + index_bytes, op.data.size() - index_bytes, sizeof(Iso::Voxel)));
+
+		if (0 == voxel_bytes) {
+			FMT_LOG_FAIL(GAME_LOG, "undo journal, unable to compress {:s} operation", eTools::_from_integral(op.tool)._to_string());
+			return(false);
+		}
+
+		op.index_bytes = (uint32_t)index_bytes;
+		op.bytes = (uint32_t)(index_bytes + voxel_bytes);
+		op.data.resize(op.bytes);
+		op.data.shrink_to_fit();
+
+		// a new operation invalidates the redo history
+		clear_redo();
+
+		journal.last_voxels = voxel_count;
+		journal.last_bytes = op.bytes;
+		journal.resident_bytes += op.bytes;
+
+		FMT_LOG(GAME_LOG, "undo journal, {:s} {:d} voxels {:d} bytes ({:d} uncompressed)", eTools::_from_integral(op.tool)._to_string(), voxel_count, op.bytes, index_raw + voxel_raw);
+
+		journal.undoable.emplace_back(std::move(op));
+
+		enforce_caps();
+
+		return(true);
+	}
+
+	void cancel()
+	{
+		journal.recording = false;
+		journal.pending.clear();
+	}
+
+	bool const undo()
+	{
+		if (journal.recording || journal.undoable.empty())
+			return(false);
+
+		operation& op(journal.undoable.back());
+
+		if (RESIDENT != op.spill_offset && !spill_in(op)) {
+			FMT_LOG_FAIL(GAME_LOG, "undo journal, unable to read spilled {:s} operation", eTools::_from_integral(op.tool)._to_string());
+			return(false);
+		}
+
+		if (!apply(op, false))
+			return(false);
+
+		FMT_LOG(GAME_LOG, "undo {:s} {:d} voxels", eTools::_from_integral(op.tool)._to_string(), op.voxel_count);
+
+		journal.redoable.emplace_back(std::move(op));
+		journal.undoable.pop_back();
+
+		enforce_caps();
+
+		return(true);
+	}
+
+	bool const redo()
+	{
+		if (journal.recording || journal.redoable.empty())
+			return(false);
+
+		operation& op(journal.redoable.back());
+
+		if (!apply(op, true))
+			return(false);
+
+		FMT_LOG(GAME_LOG, "redo {:s} {:d} voxels", eTools::_from_integral(op.tool)._to_string(), op.voxel_count);
+
+		journal.undoable.emplace_back(std::move(op));
+		journal.redoable.pop_back();
+
+		enforce_caps();
+
+		return(true);
+	}
+
+	void clear()
+	{
+		cancel();
+
+		journal.undoable.clear();
+		journal.redoable.clear();
+
+		close_spill();
+
+		journal.resident_bytes = 0;
+		journal.evicted = 0;
+		journal.last_voxels = journal.last_bytes = 0;
+
+		metrics::gauge(metrics::eGauge::UNDO_JOURNAL_BYTES, 0);
+	}
+
+	stats const getStats()
+	{
+		return(stats{ journal.undoable.size(), journal.redoable.size(), journal.resident_bytes, journal.spilled_bytes, journal.evicted, journal.last_voxels, journal.last_bytes });
+	}
+
+} // end ns
@@ -0,0 +1,51 @@
+#pragma once
+#include "globals.h"
+#include <Math/point2D_t.h>
+
+// undo / redo journal of committed tool operations. Each operation is stored as the before & after state of
+// only the ground voxels it changed, compressed with the codec selected for codec::eSite::UNDO_JOURNAL. Undo & redo decompress one delta and
+// write it back, independent of the length of the session. The memory held by the journal is capped ([STORAGE_SETTINGS] UNDO_MEMORY_MB),
+// beyond the cap the oldest operations are spilled to a file in the virtual folder, beyond the spill cap (UNDO_SPILL_MB) the oldest
+// operations are evicted and can no longer be undone. The newest operation always stays in memory.
+//
+// main thread only:
+//		undo::begin(eTools::ZONING);
+//		undo::capture(area);		// before state of every voxel that may change
+//		...							// modify the grid
+//		undo::commit();				// after state is read back, unchanged voxels are dropped
+//
+// undo / redo only write an operation back if every voxel it changed is still in the state it expects, the operation is refused otherwise
+// (e.g. the simulation has built on a zone since). Only the grid is journaled, cash is not.
+//
+// the zoning tool is the only tool journaled. roads (cRoadTool) are not part of the build and demolition (eTools::DEMO) has no implementation,
+// either would journal the same way when they exist.
+namespace undo
+{
+	typedef struct sStats
+	{
+		size_t	undoable,
+				redoable,
+				resident_bytes,		// compressed, in memory
+				spilled_bytes,		// compressed, in the spill file
+				evicted,			// operations dropped because of the caps
+				last_voxels,		// voxels changed by the last recorded operation
+				last_bytes;			// compressed size of the last recorded operation
+
+	} stats;
+
+	void configure(size_t const memory_cap, size_t const spill_cap); // in bytes, spill_cap of 0 disables spilling (oldest operations are evicted)
+
+	void begin(uint32_t const tool);
+	void __vectorcall capture(point2D_t const voxelIndex);
+	void __vectorcall capture(rect2D_t area);
+	bool const commit();	// false if the operation did not change anything
+	void cancel();
+
+	bool const undo();		// false if there is nothing to undo or the operation was refused
+	bool const redo();
+
+	void clear();			// all operations & the spill file are released (new / load / shutdown)
+
+	stats const getStats();
+
+} // end ns
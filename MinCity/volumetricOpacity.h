@@ -12,6 +12,7 @@ or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
 #include "cVulkan.h"
 
 #include "lightBuffer3D.h"
+#include "lightPropagation.h"
 
 #include <vku/vku_addon.hpp>
 #include "IsoCamera.h"
@@ -267,6 +268,10 @@ namespace Volumetric
 			
 			MappedVoxelLights.create(hardware_concurrency); // prepares/clears buffers/memory
 
+#ifdef DEBUG_BENCHMARK_LIGHT_PROPAGATION
+			jfa::benchmark(LightSize, Size); // cpu reference of the compute light propagation, volume sizes vs. time & reference volumes
+#endif
+
 			for (uint32_t i = 0; i < 2; ++i) {
 				PingPongMap[i] = new vku::TextureImageStorage3D(vk::ImageUsageFlagBits::eSampled, device,
 					LightSize, LightSize, LightSize, 1U, vk::Format::eR16G16B16A16Unorm, false, true);
@@ -25,6 +25,25 @@ namespace Volumetric
 
 	);
 	
+	// batches for the 8-wide frustum tests, structure of arrays. unused lanes can be left as is, only the bits of used lanes in the returned mask are valid.
+	typedef struct alignas(32) sSphereBatch
+	{
+		static constexpr uint32_t const WIDTH = 8;
+
+		float x[WIDTH], y[WIDTH], z[WIDTH],
+			  radius[WIDTH];
+
+	} sSphereBatch;
+
+	typedef struct alignas(32) sAABBBatch
+	{
+		static constexpr uint32_t const WIDTH = 8;
+
+		float x[WIDTH], y[WIDTH], z[WIDTH],					// center
+			  extent_x[WIDTH], extent_y[WIDTH], extent_z[WIDTH];
+
+	} sAABBBatch;
+
 	class alignas(16) volumetricVisibility
 	{
 		static constexpr float const ERROR_COMPENSATION = 1.05; // 5% error removed          // radius - hardcoded values are checked on init to be correct for a matching voxel size. If mismatched, an error is logged (debug builds only)
@@ -46,6 +65,12 @@ namespace Volumetric
 		__inline bool const XM_CALLCONV AABBTestFrustum(FXMVECTOR const xmPosition, FXMVECTOR const xmExtents) const;
 		template <bool const skip_near_plane = false>
 		__inline int const XM_CALLCONV AABBIntersectFrustum(FXMVECTOR const xmPosition, FXMVECTOR const xmExtents) const;
+
+		// batched - 8 objects against all planes at once. returns bitmask, bit i set if object i is visible (inside or intersecting)
+		template <bool const skip_near_plane = false>
+		__inline uint32_t const SphereTestFrustum(sSphereBatch const& __restrict batch) const;
+		template <bool const skip_near_plane = false>
+		__inline uint32_t const AABBTestFrustum(sAABBBatch const& __restrict batch) const;
 		
 		void XM_CALLCONV UpdateFrustum(FXMMATRIX const xmView, float const ZoomFactor, size_t const framecount);
 
@@ -180,4 +205,82 @@ namespace Volumetric
 	{
 		return(0 != AABBIntersectFrustum<skip_near_plane>(xmPosition, xmExtents));
 	}
+
+	// batched tests are the same tests as above, 8 objects per plane instead of 1 object per plane (dot product).
+	// planes are splatted, objects are structure of arrays, so each plane is 3 fma + 1 compare for all 8 objects.
+#if defined(__AVX2__)
+	template <bool const skip_near_plane>
+	__inline uint32_t const volumetricVisibility::SphereTestFrustum(sSphereBatch const& __restrict batch) const
+	{
+		__m256 const x(_mm256_load_ps(batch.x)), y(_mm256_load_ps(batch.y)), z(_mm256_load_ps(batch.z));
+		__m256 const radius(_mm256_mul_ps(_mm256_load_ps(batch.radius), _mm256_set1_ps(-ERROR_COMPENSATION)));	// must negate radius here for sphere frustum test, allow error % over
+
+		__m256 outside(_mm256_setzero_ps());
+
+#pragma loop( no_vector )
+		for (uint32_t plane = (skip_near_plane ? ePlane::P_FAR : ePlane::P_NEAR); plane <= ePlane::P_BOTTOM; ++plane) {
+
+			__m256 dist(_mm256_fmadd_ps(x, _mm256_broadcast_ss(&_Plane[plane].x), _mm256_broadcast_ss(&_Plane[plane].w)));
+			dist = _mm256_fmadd_ps(y, _mm256_broadcast_ss(&_Plane[plane].y), dist);
+			dist = _mm256_fmadd_ps(z, _mm256_broadcast_ss(&_Plane[plane].z), dist);
+
+			// If the sphere is outside any plane it is outside.
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, radius, _CMP_LT_OQ));
+		}
+
+		return(~uint32_t(_mm256_movemask_ps(outside)) & 0xffu);
+	}
+
+	template <bool const skip_near_plane>
+	__inline uint32_t const volumetricVisibility::AABBTestFrustum(sAABBBatch const& __restrict batch) const
+	{
+		__m256 const ec(_mm256_set1_ps(ERROR_COMPENSATION)); // allow error % over 
+		__m256 const x(_mm256_load_ps(batch.x)), y(_mm256_load_ps(batch.y)), z(_mm256_load_ps(batch.z));
+		__m256 const extent_x(_mm256_mul_ps(_mm256_load_ps(batch.extent_x), ec)), extent_y(_mm256_mul_ps(_mm256_load_ps(batch.extent_y), ec)), extent_z(_mm256_mul_ps(_mm256_load_ps(batch.extent_z), ec));
+		__m256 const abs_mask(_mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+
+		__m256 outside(_mm256_setzero_ps());
+
+#pragma loop( no_vector )
+		for (uint32_t plane = (skip_near_plane ? ePlane::P_FAR : ePlane::P_NEAR); plane <= ePlane::P_BOTTOM; ++plane) {
+
+			__m256 const px(_mm256_broadcast_ss(&_Plane[plane].x)), py(_mm256_broadcast_ss(&_Plane[plane].y)), pz(_mm256_broadcast_ss(&_Plane[plane].z));
+
+			__m256 dist(_mm256_fmadd_ps(x, px, _mm256_broadcast_ss(&_Plane[plane].w)));
+			dist = _mm256_fmadd_ps(y, py, dist);
+			dist = _mm256_fmadd_ps(z, pz, dist);
+
+			__m256 radius(_mm256_mul_ps(extent_x, _mm256_and_ps(px, abs_mask)));
+			radius = _mm256_fmadd_ps(extent_y, _mm256_and_ps(py, abs_mask), radius);
+			radius = _mm256_fmadd_ps(extent_z, _mm256_and_ps(pz, abs_mask), radius);
+
+			// If the box is outside any plane it is outside.
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, _mm256_xor_ps(radius, _mm256_set1_ps(-0.0f)), _CMP_LT_OQ));
+		}
+
+		return(~uint32_t(_mm256_movemask_ps(outside)) & 0xffu);
+	}
+#else // scalar fallback
+	template <bool const skip_near_plane>
+	__inline uint32_t const volumetricVisibility::SphereTestFrustum(sSphereBatch const& __restrict batch) const
+	{
+		uint32_t mask(0);
+
+		for (uint32_t i = 0; i < sSphereBatch::WIDTH; ++i) {
+			mask |= uint32_t(SphereTestFrustum<skip_near_plane>(XMVectorSet(batch.x[i], batch.y[i], batch.z[i], 0.0f), batch.radius[i])) << i;
+		}
+		return(mask);
+	}
+
+	template <bool const skip_near_plane>
+	__inline uint32_t const volumetricVisibility::AABBTestFrustum(sAABBBatch const& __restrict batch) const
+	{
+		uint32_t mask(0);
+
+		for (uint32_t i = 0; i < sAABBBatch::WIDTH; ++i) {
+			mask |= uint32_t(AABBTestFrustum<skip_near_plane>(XMVectorSet(batch.x[i], batch.y[i], batch.z[i], 0.0f), XMVectorSet(batch.extent_x[i], batch.extent_y[i], batch.extent_z[i], 0.0f))) << i;
+		}
+		return(mask);
+	}
+#endif
 }
@@ -25,11 +25,12 @@ The VOX, VDB, GLTF File format is Copyright to their respectful owners.
 #include <filesystem>
 #include <stdio.h> // C File I/O is 10x faster than C++ file stream I/O
 #include <Utility/stringconv.h>
+#include <Utility/class_helper.h>
 #include <gltf/gltf.h>
 
 #pragma intrinsic(memset)
 
-#include <density.h>	// https://github.com/centaurean/density - Density, fastest compression/decompression library out there with simple interface. must reproduce license file. attribution.
+#include "codec.h"
 
 // openvdb uses boost, openvdb modified to not use any RTTI
 #define OPENVDB_USE_SSE42
@@ -124,6 +125,7 @@ typedef struct ChunkVoxels : ChunkHeader
 ------------------------------------------------------------------------------ -
 */
 static constexpr uint32_t const PALETTE_SZ = 256;
+static constexpr uint32_t const CACHE_CODEC_SHIFT = 56; // cache files store the compressed size of the voxels with the codec id in the high byte
 
 constinit static inline uint32_t const default_palette[PALETTE_SZ] = {
 	0x00000000, 0xffffffff, 0xffccffff, 0xff99ffff, 0xff66ffff, 0xff33ffff, 0xff00ffff, 0xffffccff, 0xffccccff, 0xff99ccff, 0xff66ccff, 0xff33ccff, 0xff00ccff, 0xffff99ff, 0xffcc99ff, 0xff9999ff,
@@ -171,6 +173,117 @@ STATIC_INLINE bool const CompareTag( uint32_t const TagSz, uint8_t const * __res
 	return(true);
 }
 
+////// ADJACENCY ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// bit-packed occupancy of a model volume, each row of x is packed into 64 bit words. The six neighbour masks of all 64 voxels in a word are
+// resolved at once - x neighbours by shifting the row word (carrying the edge bit of the adjoining word), y & z neighbours are the words at the
+// same x in the adjoining rows. Voxels are processed in parallel ranges, which are slabs for the sorted (y, z, x) voxel order used everywhere,
+// and the masks are only rebuilt when a range moves to the next word. Output is identical to encode_adjacency() with a model_volume.
+typedef struct sAdjacencyVolume : no_copy
+{
+	static constexpr uint32_t const
+		DIMENSION = Volumetric::MODEL_MAX_DIMENSION_XYZ,
+		WORDS = DIMENSION >> 6u,						// words per row
+		ROW_STRIDE = WORDS,								// z
+		SLAB_STRIDE = DIMENSION * WORDS;				// y
+	static constexpr size_t const
+		SIZE = size_t(DIMENSION) * SLAB_STRIDE * sizeof(uint64_t);	// 2 MB
+
+	static_assert(0 == (DIMENSION & 63u), "model dimension must be a multiple of 64");
+
+	uint64_t* const __restrict occupancy;		// [y][z][WORDS]
+
+	STATIC_INLINE_PURE uint32_t const index(uint32_t const x, uint32_t const y, uint32_t const z) { return(y * SLAB_STRIDE + z * ROW_STRIDE + (x >> 6u)); }
+
+	__inline void set(uint32_t const x, uint32_t const y, uint32_t const z) // thread safe
+	{
+		std::atomic_ref<uint64_t>(occupancy[index(x, y, z)]).fetch_or(1ull << (x & 63u), std::memory_order_relaxed);
+	}
+
+	void clear() { memset(occupancy, 0, SIZE); }
+
+	// the six neighbour masks of the word at index. bit n of a mask is set if that neighbour of voxel (word * 64 + n) is occupied
+	typedef struct sMasks
+	{
+		uint64_t left, right, front, back, below, above;
+
+		// adjacency of voxel at bit (x & 63) of the word these masks were built for
+		__inline uint32_t const adjacency(uint32_t const bit) const
+		{
+			return((uint32_t((left  >> bit) & 1ull) << Volumetric::adjacency::left)  |
+				   (uint32_t((right >> bit) & 1ull) << Volumetric::adjacency::right) |
+				   (uint32_t((front >> bit) & 1ull) << Volumetric::adjacency::front) |
+				   (uint32_t((back  >> bit) & 1ull) << Volumetric::adjacency::back)  |
+				   (uint32_t((below >> bit) & 1ull) << Volumetric::adjacency::below) |
+				   (uint32_t((above >> bit) & 1ull) << Volumetric::adjacency::above));
+		}
+	} masks;
+
+	__inline masks const build(uint32_t const x, uint32_t const y, uint32_t const z) const
+	{
+		uint32_t const w(x >> 6u);
+		uint64_t const* const __restrict word(occupancy + index(x, y, z));
+
+		return(masks{
+			(*word << 1u) | (0 != w ? word[-1] >> 63u : 0ull),								// x - 1
+			(*word >> 1u) | (WORDS - 1 != w ? word[1] << 63u : 0ull),						// x + 1
+			(0 != z ? word[-int32_t(ROW_STRIDE)] : 0ull),									// z - 1
+			(DIMENSION - 1 != z ? word[ROW_STRIDE] : 0ull),									// z + 1
+			(0 != y ? word[-int32_t(SLAB_STRIDE)] : 0ull),									// y - 1
+			(DIMENSION - 1 != y ? word[SLAB_STRIDE] : 0ull)									// y + 1
+		});
+	}
+
+	// sets the occupancy of all voxels passing the filter, then encodes the adjacency of all voxels passing the filter
+	template<typename filter_function>
+	void encode(voxelDescPacked* const __restrict pVoxels, uint32_t const numVoxels, filter_function&& filter)
+	{
+		static constexpr uint32_t const GRAIN_SIZE = 4096u;
+
+		tbb::parallel_for(tbb::blocked_range<uint32_t>(0u, numVoxels, GRAIN_SIZE), [&](tbb::blocked_range<uint32_t> const& r) {
+
+			for (uint32_t i = r.begin(); i < r.end(); ++i) {
+				if (filter(pVoxels[i])) {
+					set(pVoxels[i].x, pVoxels[i].y, pVoxels[i].z);
+				}
+			}
+		});
+
+		tbb::parallel_for(tbb::blocked_range<uint32_t>(0u, numVoxels, GRAIN_SIZE), [&](tbb::blocked_range<uint32_t> const& r) {
+
+			uint32_t last(UINT32_MAX);
+			masks current{};
+
+			for (uint32_t i = r.begin(); i < r.end(); ++i) {
+
+				voxelDescPacked& __restrict voxel(pVoxels[i]);
+
+				if (filter(voxel)) {
+					uint32_t const x(voxel.x), y(voxel.y), z(voxel.z);
+					uint32_t const word(index(x, y, z));
+
+					if (word != last) { // next 64 voxels
+						current = build(x, y, z);
+						last = word;
+					}
+					voxel.setAdjacency(current.adjacency(x & 63u));
+				}
+			}
+		});
+	}
+
+	sAdjacencyVolume()
+		: occupancy((uint64_t* const __restrict)scalable_aligned_malloc(SIZE, CACHE_LINE_BYTES))
+	{
+		clear();
+	}
+	~sAdjacencyVolume()
+	{
+		scalable_aligned_free(occupancy);
+	}
+
+} adjacency_volume;
+
 ////// VOX /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // builds the voxel model, loading from magicavoxel .vox format, returning the model with the voxel traversal
@@ -300,11 +413,9 @@ static bool const LoadVOX(voxelModelBase* const __restrict pDestMem, uint8_t con
 	allVoxels.reserve(numVoxels); allVoxels.resize(numVoxels);
 	
 	{ // adjacency
-		using model_volume = Volumetric::voxB::model_volume;
 
 		// Here: accurate counts, cull voxels & encode adjacency w/ consideration of transparency, optimize model.
-		model_volume* __restrict bits(nullptr);
-		bits = model_volume::create();
+		adjacency_volume volume;
 
 		{ // adjacency
 
@@ -316,7 +427,7 @@ static bool const LoadVOX(voxelModelBase* const __restrict pDestMem, uint8_t con
 
 			} p = { allVoxels.data(), pVoxelRoot, pPaletteRoot };
 
-			tbb::parallel_for(uint32_t(0), numVoxels, [&p, &bits](uint32_t const i) {
+			tbb::parallel_for(uint32_t(0), numVoxels, [&p](uint32_t const i) {
 
 				VoxelData const curVoxel(*(p.pVoxelData + i));
 
@@ -328,22 +439,10 @@ static bool const LoadVOX(voxelModelBase* const __restrict pDestMem, uint8_t con
 
 				p.pVoxels[i] = std::move<voxelDescPacked&&>(voxelDescPacked(voxCoord(curVoxel.x, curVoxel.z, curVoxel.y), // *note -> swizzle of y and z here
 					                                                        0, color));
-
-				bits->set_bit(curVoxel.x, curVoxel.z, curVoxel.y); // *note -> swizzle of y and z here also required
 			});
 
 			// encode adjacency
-			tbb::parallel_for(uint32_t(0), numVoxels, [&p, &bits](uint32_t const i) {
-				uvec4_v const localIndex(p.pVoxels[i].x, p.pVoxels[i].y, p.pVoxels[i].z);
-
-				p.pVoxels[i].setAdjacency(encode_adjacency(localIndex, bits)); // apply adjacency
-			});
-		}
-
-		// cleanup, volume no longer required - adjacency is encoded
-		if (bits) {
-			model_volume::destroy(bits);
-			bits = nullptr;
+			volume.encode(p.pVoxels, numVoxels, [](voxelDescPacked const& __restrict) { return(true); });
 		}
 	}
 
@@ -416,7 +515,20 @@ using model_volume = Volumetric::voxB::model_volume;
 // A VecVoxels has a separate std::vector<T> per thread
 typedef tbb::enumerable_thread_specific< vector<voxelDescPacked>, tbb::cache_aligned_allocator<vector<voxelDescPacked>>, tbb::ets_key_per_instance > VecVoxels;
 
-static void ComputeAdjacency(model_volume* const __restrict bits, Volumetric::voxB::voxelDescPacked* const __restrict pVoxels, uint32_t const numVoxels)
+static void ComputeAdjacency(adjacency_volume& __restrict volume, Volumetric::voxB::voxelDescPacked* const __restrict pVoxels, uint32_t const numVoxels)
+{
+	// compute adjacency, also taking transparency into account
+	volume.encode(pVoxels, numVoxels, [](voxelDescPacked& __restrict voxel) {
+
+		voxel.Hidden = false; // always false here on save, ensure hidden is not set on any voxel b4 saving file
+
+		// *only if not transparent - this excludes transparent voxels so that when adjacency is considered for neighbours of any voxel, it now leaves the transparent ones out of the adjacency calculation.
+		// transparent voxels keep their existing adjacency, as they are not considered for adjacency re-calculation.
+		return(!voxel.Transparent);
+	});
+}
+#ifdef DEBUG_BENCHMARK_VOXEL_ADJACENCY
+static void ComputeAdjacencyReference(model_volume* const __restrict bits, Volumetric::voxB::voxelDescPacked* const __restrict pVoxels, uint32_t const numVoxels)
 {
 	// compute adjacency, also taking transparency into account
 
@@ -444,6 +556,7 @@ static void ComputeAdjacency(model_volume* const __restrict bits, Volumetric::vo
 		});
 	}
 }
+#endif
 static auto const OptimizeVoxels(Volumetric::voxB::voxelDescPacked* const pVoxels, uint32_t numVoxels)
 {
 	// accurate counts - now only the culled set of voxels.
@@ -464,10 +577,9 @@ static auto const OptimizeVoxels(Volumetric::voxB::voxelDescPacked* const pVoxel
 	}
 
 	// culling requires current adjacency first
-	model_volume* __restrict bits(nullptr);
-	bits = model_volume::create();
+	adjacency_volume volume;
 
-	ComputeAdjacency(bits, pVoxels, numVoxels);
+	ComputeAdjacency(volume, pVoxels, numVoxels);
 
 	// for final count of voxels (culled set)
 	uint32_t numVoxelsEmissive(0),
@@ -516,16 +628,10 @@ static auto const OptimizeVoxels(Volumetric::voxB::voxelDescPacked* const pVoxel
 		}
 	}
 
-	bits->clear(); // reset volume
+	volume.clear(); // reset volume
 
 	// *bugfix - must update adjacency to culled set of voxels once again to be correct. (accounts for voxels removed after adjacency was encoded in a neighbouring voxel)
-	ComputeAdjacency(bits, pVoxels, numVoxels);
-
-	// cleanup, volume no longer required - adjacency is encoded
-	if (bits) {
-		model_volume::destroy(bits);
-		bits = nullptr;
-	}
+	ComputeAdjacency(volume, pVoxels, numVoxels);
 
 	// Sort the voxels by y "slices", then z "rows", then x "columns"
 	tbb::parallel_sort(pVoxels, pVoxelLast);
@@ -736,6 +842,335 @@ int const LoadVOX(std::filesystem::path const path, voxelModelBase* const __rest
 	return(0); // fail
 }
 
+////////// V1XP (model archive) /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// all cached .vox models packed into one file. the archive is mapped once at startup (copy-on-write, as some models are modified in place after loading) and the 
+// voxel arrays of the models are used directly from the mapping. no parsing, allocation or copying of voxels on a warm start.
+//
+// [sModelArchiveHeader] [sModelArchiveEntry * count (sorted by key)] [record 0] [record 1] ....
+// record: [voxelModelDescHeader] [voxelScreen (optional feature)] [padding to cache line] [voxelDescPacked * numVoxels]
+//
+typedef struct sModelArchiveHeader
+{
+	static constexpr uint32_t const VERSION = 1;
+
+	char	 fileTypeTag[4];
+	uint32_t version;
+	uint32_t count;
+	
+	// last
+	uint32_t reserved = 0;
+
+} sModelArchiveHeader;
+
+typedef struct sModelArchiveEntry
+{
+	uint64_t key;		// hash of source path
+	uint64_t offset;	// file offset of record (voxelModelDescHeader)
+
+} sModelArchiveEntry;
+
+namespace { // anonymous - local to this file only
+
+	static inline struct { // not constinit, INVALID_HANDLE_VALUE is not a constant expression
+
+		HANDLE						hFile{ INVALID_HANDLE_VALUE },
+									hMapping{ nullptr };
+		uint8_t const* __restrict	base{ nullptr };
+		size_t						size{};
+		sModelArchiveEntry const*	entries{ nullptr };
+		uint32_t					count{};
+		fs::file_time_type			modifytime{};
+
+	} _archive{};
+
+} // end ns
+
+static std::wstring const getModelArchivePath()
+{
+	std::wstring szArchivePathFilename(VOX_CACHE_DIR);
+	szArchivePathFilename += L"models";
+	szArchivePathFilename += V1XP_FILE_EXT;
+
+	return(szArchivePathFilename);
+}
+
+STATIC_INLINE_PURE uint64_t const getModelArchiveKey(std::filesystem::path const& path)
+{
+	// fnv-1a over the source path (folder + stem), extension is not part of the key
+	std::wstring const szKey(path.parent_path().wstring() + L'/' + path.stem().wstring());
+
+	uint64_t hash(14695981039346656037ULL);
+	for (wchar_t const c : szKey) {
+		hash ^= (uint64_t)c;
+		hash *= 1099511628211ULL;
+	}
+	return(hash);
+}
+
+STATIC_INLINE_PURE uint64_t const getModelArchiveVoxelsOffset(uint64_t const offset, uint8_t const features)
+{
+	uint64_t voxels_offset(offset + sizeof(voxelModelDescHeader));
+	if (voxelModelFeatures::VIDEOSCREEN == (features & voxelModelFeatures::VIDEOSCREEN)) {
+		voxels_offset += sizeof(voxelScreen);
+	}
+	return((voxels_offset + (CACHE_LINE_BYTES - 1)) & ~uint64_t(CACHE_LINE_BYTES - 1));
+}
+
+bool const OpenModelArchive()
+{
+	std::wstring const szArchivePathFilename(getModelArchivePath());
+	
+	{ // a rebuilt archive is written alongside the mapped one, it replaces the current archive here before it is mapped
+		std::wstring const szRebuiltPathFilename(szArchivePathFilename + L".new");
+
+		if (fs::exists(szRebuiltPathFilename)) {
+			if (!MoveFileExW(szRebuiltPathFilename.c_str(), szArchivePathFilename.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+				FMT_LOG_FAIL(VOX_LOG, "unable to replace model archive: {:s}", stringconv::ws2s(szArchivePathFilename));
+			}
+		}
+	}
+
+	if (!fs::exists(szArchivePathFilename)) {
+		return(false);
+	}
+
+	_archive.hFile = CreateFileW(szArchivePathFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (INVALID_HANDLE_VALUE != _archive.hFile) {
+
+		LARGE_INTEGER size{};
+		if (GetFileSizeEx(_archive.hFile, &size) && size.QuadPart > (LONGLONG)sizeof(sModelArchiveHeader)) {
+
+			// copy-on-write, pages modified at runtime become private to the process, the file is never written
+			_archive.hMapping = CreateFileMappingW(_archive.hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+			if (_archive.hMapping) {
+
+				_archive.base = (uint8_t const* __restrict)MapViewOfFile(_archive.hMapping, FILE_MAP_COPY, 0, 0, 0);
+				if (_archive.base) {
+					_archive.size = (size_t)size.QuadPart;
+
+					uint8_t const* pReadPointer(_archive.base);
+
+					// Check Header
+					static constexpr uint32_t const  TAG_LN = 4;
+					static constexpr char const      TAG_V1XP[TAG_LN] = { 'V', '1', 'X', 'P' };
+
+					if (CompareTag(_countof(TAG_V1XP), pReadPointer, TAG_V1XP)) {
+
+						sModelArchiveHeader const headerChunk{};
+
+						ReadData((void* const __restrict)&headerChunk, pReadPointer, sizeof(headerChunk));
+
+						// Ensure valid
+						if (sModelArchiveHeader::VERSION == headerChunk.version 
+							&& (sizeof(sModelArchiveHeader) + uint64_t(headerChunk.count) * sizeof(sModelArchiveEntry)) <= _archive.size) {
+
+							_archive.entries = reinterpret_cast<sModelArchiveEntry const*>(pReadPointer + sizeof(sModelArchiveHeader));
+							_archive.count = headerChunk.count;
+							_archive.modifytime = fs::last_write_time(szArchivePathFilename);
+
+							FMT_LOG_OK(VOX_LOG, " < {:s} > mapped, {:d} models", stringconv::ws2s(szArchivePathFilename), _archive.count);
+							return(true);
+						}
+					}
+
+					FMT_LOG_FAIL(VOX_LOG, "unable to parse model archive: {:s}", stringconv::ws2s(szArchivePathFilename));
+				}
+			}
+		}
+	}
+
+	FMT_LOG_FAIL(VOX_LOG, "unable to open or mmap model archive: {:s}", stringconv::ws2s(szArchivePathFilename));
+
+	CloseModelArchive();
+	return(false);
+}
+
+int const LoadArchivedModel(std::filesystem::path const path, voxelModelBase* const __restrict pDestMem)
+{
+	if (nullptr == _archive.entries) {
+		return(0);
+	}
+
+	uint64_t const key(getModelArchiveKey(path));
+
+	sModelArchiveEntry const* const pEnd(_archive.entries + _archive.count);
+	sModelArchiveEntry const* const pEntry(std::lower_bound(_archive.entries, pEnd, key, [](sModelArchiveEntry const& entry, uint64_t const key) { return(entry.key < key); }));
+
+	if (pEnd == pEntry || key != pEntry->key) {
+		return(0); // not in archive
+	}
+
+	{ // archived copy must be newer than both the source .vox and the cached .v1x (modified by import)
+		std::wstring szOrigPathFilename(path.wstring().substr(0, path.wstring().find_last_of(L'/') + 1)); // isolate path to just the folder
+		szOrigPathFilename += path.stem();
+		szOrigPathFilename += VOX_FILE_EXT;
+
+		std::wstring szCachedPathFilename(VOX_CACHE_DIR);
+		szCachedPathFilename += path.stem();
+		szCachedPathFilename += V1X_FILE_EXT;
+
+		std::error_code error{};
+		auto const voxmodifytime = fs::last_write_time(szOrigPathFilename, error);
+		if (!error && voxmodifytime >= _archive.modifytime) {
+			return(0);
+		}
+		auto const cachedmodifytime = fs::last_write_time(szCachedPathFilename, error);
+		if (!error && cachedmodifytime >= _archive.modifytime) {
+			return(0);
+		}
+	}
+
+	if ((pEntry->offset + sizeof(voxelModelDescHeader)) > _archive.size) {
+		return(0);
+	}
+
+	uint8_t const* pReadPointer(_archive.base + pEntry->offset);
+
+	voxelModelDescHeader const headerChunk{};
+
+	ReadData((void* const __restrict)&headerChunk, pReadPointer, sizeof(headerChunk));
+
+	uint64_t const voxels_offset(getModelArchiveVoxelsOffset(pEntry->offset, headerChunk.features));
+
+	// Ensure valid
+	if (0 == headerChunk.numVoxels || headerChunk.dimensionX >= Volumetric::MODEL_MAX_DIMENSION_XYZ
+		|| headerChunk.dimensionY >= Volumetric::MODEL_MAX_DIMENSION_XYZ
+		|| headerChunk.dimensionZ >= Volumetric::MODEL_MAX_DIMENSION_XYZ
+		|| (voxels_offset + uint64_t(headerChunk.numVoxels) * sizeof(voxelDescPacked)) > _archive.size) {
+		return(0);
+	}
+
+	pReadPointer += sizeof(headerChunk);
+
+	if (voxelModelFeatures::VIDEOSCREEN == (headerChunk.features & voxelModelFeatures::VIDEOSCREEN)) {
+
+		if (nullptr == pDestMem->_Features.videoscreen) {
+			voxelScreen readScreen;
+
+			ReadData((void* const __restrict)&readScreen, pReadPointer, sizeof(readScreen));
+
+			// validate the input before allocating memory (protection)
+			if (readScreen.screen_rect.left < readScreen.screen_rect.right && readScreen.screen_rect.top < readScreen.screen_rect.bottom) { // simple but effective vallidation of data
+				pDestMem->_Features.videoscreen = new voxelScreen(readScreen);
+			}
+			else {
+				return(0);
+			}
+		}
+	}
+
+	pDestMem->_numVoxels = headerChunk.numVoxels;
+
+	uvec4_v xmDimensions(headerChunk.dimensionX, headerChunk.dimensionY, headerChunk.dimensionZ);
+
+	xmDimensions.xyzw(pDestMem->_maxDimensions);
+
+	XMVECTOR const maxDimensions(xmDimensions.v4f());
+	XMStoreFloat3A(&pDestMem->_maxDimensionsInv, XMVectorReciprocal(maxDimensions));
+
+	pDestMem->_numVoxelsEmissive = headerChunk.numVoxelsEmissive;
+	pDestMem->_numVoxelsTransparent = headerChunk.numVoxelsTransparent;
+
+	// zero-copy, voxels are used directly from the mapping
+	pDestMem->_Voxels = reinterpret_cast<voxelDescPacked const* __restrict>(_archive.base + voxels_offset);
+
+	pDestMem->ComputeLocalAreaAndExtents();
+
+	return(1);
+}
+
+bool const SaveModelArchive(vector<std::pair<std::filesystem::path, voxelModelBase const*>> const& models)
+{
+	// the current archive is mapped, so the new archive is written alongside it and replaces it on the next OpenModelArchive()
+	std::wstring const szRebuiltPathFilename(getModelArchivePath() + L".new");
+
+	vector<sModelArchiveEntry> entries;
+	entries.reserve(models.size());
+
+	// offsets are assigned in the order of the models, entries are sorted by key afterwards
+	uint64_t offset(sizeof(sModelArchiveHeader) + models.size() * sizeof(sModelArchiveEntry));
+	for (auto const& [path, pModel] : models) {
+
+		offset = (offset + (CACHE_LINE_BYTES - 1)) & ~uint64_t(CACHE_LINE_BYTES - 1);
+		entries.emplace_back(sModelArchiveEntry{ getModelArchiveKey(path), offset });
+
+		offset = getModelArchiveVoxelsOffset(offset, (uint8_t)(pModel->_Features.videoscreen ? voxelModelFeatures::VIDEOSCREEN : 0)) 
+			     + uint64_t(pModel->_numVoxels) * sizeof(voxelDescPacked);
+	}
+
+	FILE* stream(nullptr);
+	if ((0 == _wfopen_s(&stream, szRebuiltPathFilename.c_str(), L"wbS")) && stream) {
+
+		static constexpr uint8_t const padding[CACHE_LINE_BYTES]{};
+
+		{
+			vector<sModelArchiveEntry> sorted(entries);
+			std::sort(sorted.begin(), sorted.end(), [](sModelArchiveEntry const& lhs, sModelArchiveEntry const& rhs) { return(lhs.key < rhs.key); });
+
+			sModelArchiveHeader const header{ { 'V', '1', 'X', 'P' }, sModelArchiveHeader::VERSION, (uint32_t)sorted.size() };
+			_fwrite_nolock(&header, sizeof(sModelArchiveHeader), 1, stream);
+			_fwrite_nolock(sorted.data(), sizeof(sModelArchiveEntry), sorted.size(), stream);
+		}
+
+		uint64_t written(sizeof(sModelArchiveHeader) + models.size() * sizeof(sModelArchiveEntry));
+		for (size_t i = 0; i < models.size(); ++i) {
+
+			voxelModelBase const* const __restrict pModel(models[i].second);
+
+			_fwrite_nolock(padding, 1, (size_t)(entries[i].offset - written), stream);
+
+			voxelModelDescHeader const header{ { 'V', '1', 'X', ' ' }, pModel->_numVoxels,
+																	(uint8_t)pModel->_maxDimensions.x,
+																	(uint8_t)pModel->_maxDimensions.y,
+																	(uint8_t)pModel->_maxDimensions.z,
+																	pModel->_numVoxelsEmissive, pModel->_numVoxelsTransparent,
+																	(uint8_t)((pModel->_Features.videoscreen ? voxelModelFeatures::VIDEOSCREEN : 0)) };
+			_fwrite_nolock(&header, sizeof(voxelModelDescHeader), 1, stream);
+			written = entries[i].offset + sizeof(voxelModelDescHeader);
+
+			if (pModel->_Features.videoscreen) {
+				_fwrite_nolock(pModel->_Features.videoscreen, sizeof(voxelScreen), 1, stream);
+				written += sizeof(voxelScreen);
+			}
+
+			uint64_t const voxels_offset(getModelArchiveVoxelsOffset(entries[i].offset, header.features));
+			_fwrite_nolock(padding, 1, (size_t)(voxels_offset - written), stream);
+
+			_fwrite_nolock(&pModel->_Voxels[0], sizeof(voxelDescPacked), pModel->_numVoxels, stream);
+			written = voxels_offset + uint64_t(pModel->_numVoxels) * sizeof(voxelDescPacked);
+		}
+
+		_fclose_nolock(stream);
+
+		FMT_LOG_OK(VOX_LOG, "model archive saved, {:d} models, {:d} bytes", models.size(), written);
+		return(true);
+	}
+
+	FMT_LOG_FAIL(VOX_LOG, "unable to save model archive: {:s}", stringconv::ws2s(szRebuiltPathFilename));
+	return(false);
+}
+
+bool const isArchivedMemory(void const* const __restrict p)
+{
+	uint8_t const* const __restrict address((uint8_t const*)p);
+
+	return(_archive.base && address >= _archive.base && address < (_archive.base + _archive.size));
+}
+
+void CloseModelArchive()
+{
+	if (_archive.base) {
+		UnmapViewOfFile(_archive.base);
+	}
+	if (_archive.hMapping) {
+		CloseHandle(_archive.hMapping);
+	}
+	if (INVALID_HANDLE_VALUE != _archive.hFile) {
+		CloseHandle(_archive.hFile);
+	}
+	_archive = {};
+}
+
 ////////// VDB ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 typedef struct vdbFrameData
 {
@@ -1016,18 +1451,20 @@ static bool const SaveV1XACachedFile(std::wstring_view const path, voxelModelBas
 
 		// compression
 		// Determine safe buffer sizes
+		codec::selection const method(codec::selected(codec::eSite::MODEL_CACHE));
 		size_t const data_size(sizeof(voxelDescPacked) * pDestMem->_numVoxels);
-		size_t const compress_safe_size = density_compress_safe_size(data_size);
+		size_t const compress_safe_size = codec::compress_bound(method.codec, data_size);
 
 		uint8_t* __restrict outCompressed((uint8_t * __restrict)scalable_malloc(compress_safe_size));
 
-		density_processing_result const result = density_compress((uint8_t* const __restrict)&pDestMem->_Voxels[0], data_size, outCompressed, compress_safe_size, DENSITY_ALGORITHM_CHEETAH);
+		size_t const compressed_size = codec::compress(method, &pDestMem->_Voxels[0], data_size, outCompressed, compress_safe_size, sizeof(voxelDescPacked));
 
 		bool bReturn(true);
 
-		if (!result.state) {
-			_fwrite_nolock(&result.bytesWritten, sizeof(result.bytesWritten), 1, stream);
-			_fwrite_nolock(&outCompressed[0], sizeof(outCompressed[0]), result.bytesWritten, stream);
+		if (0 != compressed_size) {
+			uint64_t const size_and_codec(uint64_t(compressed_size) | (uint64_t(method.codec) << CACHE_CODEC_SHIFT)); // codec id in the high byte, always zero (density) in older cache files
+			_fwrite_nolock(&size_and_codec, sizeof(size_and_codec), 1, stream);
+			_fwrite_nolock(&outCompressed[0], sizeof(outCompressed[0]), compressed_size, stream);
 		}
 		else {
 
@@ -1167,20 +1604,20 @@ bool const LoadV1XACachedFile(std::wstring_view const path, voxelModelBase* cons
 					
 					// decompression
 					// Determine safe buffer sizes
-					size_t compressed_size;
-					ReadData((void* const __restrict)&compressed_size, pReadPointer, sizeof(compressed_size));
-					pReadPointer += sizeof(compressed_size);
+					uint64_t size_and_codec;
+					ReadData((void* const __restrict)&size_and_codec, pReadPointer, sizeof(size_and_codec));
+					pReadPointer += sizeof(size_and_codec);
 					
+					uint32_t const compressed_codec(uint32_t(size_and_codec >> CACHE_CODEC_SHIFT));
+					size_t const compressed_size(size_and_codec & ((1ull << CACHE_CODEC_SHIFT) - 1ull));
 					size_t const decompressed_size(pDestMem->_numVoxels * sizeof(voxelDescPacked));
-					size_t const decompress_safe_size = density_decompress_safe_size(decompressed_size);
+					size_t const decompress_safe_size = codec::decompress_bound(compressed_codec, decompressed_size);
 
 					uint8_t* __restrict outDecompressed((uint8_t * __restrict)scalable_malloc(decompress_safe_size));
 
-					density_processing_result const result = density_decompress((uint8_t* const __restrict)&pReadPointer[0], compressed_size, outDecompressed, decompress_safe_size);
-
 					bool bReturn(true);
 					
-					if (!result.state) {
+					if (decompressed_size == codec::decompress(compressed_codec, &pReadPointer[0], compressed_size, outDecompressed, decompress_safe_size)) {
 
 						pDestMem->_Voxels = (voxelDescPacked* const __restrict)scalable_aligned_malloc(sizeof(voxelDescPacked) * pDestMem->_numVoxels, CACHE_LINE_BYTES);
 						memcpy((void* __restrict)pDestMem->_Voxels, outDecompressed, decompressed_size);
@@ -2224,14 +2661,253 @@ void voxelModelBase::ComputeLocalAreaAndExtents()
 	_Radius = XMVectorGetX(XMVector3Length(xmExtents));
 }
 
+static void build_streams(voxelStreams& __restrict streams, voxelDescPacked const* const __restrict voxels, uint32_t const count)
+{
+	// one allocation, each stream is 32 byte aligned and padded so the wide render path can always load a full group of 8
+	size_t const stride((size_t)SFM::roundToMultipleOf<true>((int64_t)(count + voxelStreams::STREAM_PADDING), (int64_t)32));
+	uint8_t* __restrict block(const_cast<uint8_t* __restrict>(streams.x));
+	
+	if (nullptr == block) {
+		block = (uint8_t* __restrict)scalable_aligned_malloc(stride * (5 + sizeof(uint32_t)), CACHE_LINE_BYTES);
+	} // otherwise refreshed in place (voxel count must not have changed), eg.) materials changed by the ImportProxy
+
+	uint8_t* const __restrict x(block);
+	uint8_t* const __restrict y(block + stride);
+	uint8_t* const __restrict z(block + stride * 2);
+	uint8_t* const __restrict adjacency(block + stride * 3);
+	uint8_t* const __restrict material(block + stride * 4);
+	uint32_t* const __restrict color((uint32_t* const __restrict)(block + stride * 5));
+
+	tbb::parallel_for(tbb::blocked_range<uint32_t>(0, count), [&](tbb::blocked_range<uint32_t> const& r) {
+
+		for (uint32_t i = r.begin(); i < r.end(); ++i) {
+
+			voxelDescPacked const voxel(voxels[i]);
+
+			x[i] = uint8_t(voxel.Data);
+			y[i] = uint8_t(voxel.Data >> 8u);
+			z[i] = uint8_t(voxel.Data >> 16u);
+			adjacency[i] = uint8_t(voxel.Data >> 24u);
+			material[i] = uint8_t(voxel.RGBM >> 24u);
+			color[i] = voxel.RGBM & 0x00ffffffu;
+		}
+	});
+
+	// padding is zeroed, padded lanes are masked by the render path
+	size_t const padding(stride - count);
+	for (uint32_t stream = 0; stream < 5; ++stream) {
+		memset(block + stride * stream + count, 0, padding);
+	}
+	memset(color + count, 0, padding * sizeof(uint32_t));
+
+	streams.x = x;
+	streams.y = y;
+	streams.z = z;
+	streams.adjacency = adjacency;
+	streams.material = material;
+	streams.color = color;
+}
+
+void voxelModelBase::BuildStreams()
+{
+	if (nullptr == _Voxels || 0 == _numVoxels)
+		return;
+
+	build_streams(_Streams, _Voxels, _numVoxels);
+}
+
+static void release_lod(voxelLOD& __restrict level)
+{
+	if (level.valid()) {
+		scalable_aligned_free(const_cast<voxelDescPacked * __restrict>(level.voxels));
+	}
+	if (level.streams.valid()) { // all streams share the allocation of x
+		scalable_aligned_free(const_cast<uint8_t * __restrict>(level.streams.x));
+	}
+	level = {};
+}
+
+// each level is downsampled from the full resolution voxels. All voxels of a block (2x2x2 or 4x4x4) become one voxel, occupied if any voxel
+// in the block is. The block takes the color & material of the most common color in the block, only emissive voxels are considered if the block
+// contains any so that lights are never lost. The level is then culled and its adjacency recomputed at the resolution of the level.
+void voxelModelBase::BuildLOD()
+{
+	static constexpr uint32_t const MIN_VOXELS = 512; // not worth downsampling below
+
+	for (uint32_t i = 0; i < LOD_LEVELS; ++i) {
+		release_lod(_LOD[i]);
+	}
+
+	if (nullptr == _Voxels || _numVoxels < MIN_VOXELS || _Features.sequence || _Features.videoscreen) // single frame models only, videoscreens are addressed per voxel
+		return;
+
+	uint32_t const numVoxels(_numVoxels);
+	vector<uint64_t> blocks(numVoxels);
+	vector<voxelDescPacked> lodVoxels;
+
+	for (uint32_t i = 0; i < LOD_LEVELS; ++i) {
+
+		uint32_t const shift(i + 1);
+
+		// (block, voxel) pairs, once sorted the voxels of a block are contiguous
+		tbb::parallel_for(tbb::blocked_range<uint32_t>(0u, numVoxels), [&](tbb::blocked_range<uint32_t> const& r) {
+
+			for (uint32_t vxl = r.begin(); vxl < r.end(); ++vxl) {
+				voxelDescPacked const voxel(_Voxels[vxl]);
+				uint64_t const key(((voxel.y >> shift) << 16u) | ((voxel.z >> shift) << 8u) | (voxel.x >> shift));
+				blocks[vxl] = (key << 32u) | vxl;
+			}
+		});
+		tbb::parallel_sort(blocks.begin(), blocks.end());
+
+		lodVoxels.clear();
+
+		for (uint32_t begin = 0; begin < numVoxels; ) {
+
+			uint64_t const key(blocks[begin] >> 32u);
+			uint32_t end(begin + 1);
+			bool bEmissive(_Voxels[uint32_t(blocks[begin])].Emissive);
+
+			while (end < numVoxels && key == (blocks[end] >> 32u)) {
+				bEmissive |= _Voxels[uint32_t(blocks[end])].Emissive;
+				++end;
+			}
+
+			// majority color
+			uint32_t representative(uint32_t(blocks[begin])), majority(0);
+			for (uint32_t candidate = begin; candidate < end; ++candidate) {
+
+				voxelDescPacked const voxel(_Voxels[uint32_t(blocks[candidate])]);
+				if (bEmissive & !voxel.Emissive)
+					continue;
+
+				uint32_t votes(0);
+				for (uint32_t other = begin; other < end; ++other) {
+					votes += (voxel.Color == _Voxels[uint32_t(blocks[other])].Color);
+				}
+				if (votes > majority) {
+					majority = votes;
+					representative = uint32_t(blocks[candidate]);
+				}
+			}
+
+			voxelDescPacked voxel(_Voxels[representative]);
+			voxel.x = uint8_t(key);
+			voxel.y = uint8_t(key >> 16u);
+			voxel.z = uint8_t(key >> 8u);
+			voxel.Video = 0;
+			lodVoxels.emplace_back(voxel);
+
+			begin = end;
+		}
+
+		// cull & adjacency at the resolution of the level
+		auto const [numVoxelsLOD, numVoxelsEmissiveLOD, numVoxelsTransparentLOD] = OptimizeVoxels(lodVoxels.data(), (uint32_t)lodVoxels.size());
+
+		if (0 == numVoxelsLOD)
+			break;
+
+		// back to model coordinates, snapped to the origin of the block
+		voxelDescPacked* const __restrict voxels((voxelDescPacked* const __restrict)scalable_aligned_malloc(sizeof(voxelDescPacked) * numVoxelsLOD, CACHE_LINE_BYTES));
+		for (uint32_t vxl = 0; vxl < numVoxelsLOD; ++vxl) {
+			voxelDescPacked voxel(lodVoxels[vxl]);
+			voxel.x = uint8_t(voxel.x << shift);
+			voxel.y = uint8_t(voxel.y << shift);
+			voxel.z = uint8_t(voxel.z << shift);
+			voxels[vxl] = voxel;
+		}
+
+		voxelLOD& __restrict level(_LOD[i]);
+		level.voxels = voxels;
+		level.numVoxels = numVoxelsLOD;
+		level.numVoxelsTransparent = numVoxelsTransparentLOD;
+		build_streams(level.streams, voxels, numVoxelsLOD);
+	}
+}
+
 voxelModelBase::~voxelModelBase()
 {
-	if (_Voxels) {
+	if (_Voxels && !isArchivedMemory(_Voxels)) { // voxels of an archived model are owned by the model archive mapping
 		scalable_aligned_free(const_cast<voxelDescPacked * __restrict>(_Voxels));
 	}
 	_Voxels = nullptr;
+
+	if (_Streams.valid()) { // all streams share the allocation of x
+		scalable_aligned_free(const_cast<uint8_t * __restrict>(_Streams.x));
+	}
+	_Streams = {};
+
+	for (uint32_t i = 0; i < LOD_LEVELS; ++i) {
+		release_lod(_LOD[i]);
+	}
 }
 
+#ifdef DEBUG_BENCHMARK_VOXEL_ADJACENCY
+// adjacency of every loaded model (imported from .vox, .vdb & .glb), the per voxel model_volume path vs the bit-packed path. Both paths must produce identical voxels.
+void BenchmarkAdjacency()
+{
+	static constexpr uint32_t const BENCHMARK_ITERATIONS = 8;
+
+	size_t voxel_count(0), model_count(0), mismatches(0);
+	nanoseconds tReference{}, tPacked{};
+
+	vector<voxelDescPacked> reference, packed;
+	adjacency_volume volume;
+	model_volume* __restrict bits(model_volume::create());
+
+	auto const benchmark_model = [&](voxelModelBase const& __restrict model) {
+
+		if (nullptr == model._Voxels || 0 == model._numVoxels)
+			return;
+
+		uint32_t const numVoxels(model._numVoxels);
+		reference.assign(model._Voxels, model._Voxels + numVoxels);
+		packed.assign(model._Voxels, model._Voxels + numVoxels);
+
+		for (uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration) {
+
+			tTime tStart(high_resolution_clock::now());
+			bits->clear();
+			ComputeAdjacencyReference(bits, reference.data(), numVoxels);
+			tReference += high_resolution_clock::now() - tStart;
+
+			tStart = high_resolution_clock::now();
+			volume.clear();
+			ComputeAdjacency(volume, packed.data(), numVoxels);
+			tPacked += high_resolution_clock::now() - tStart;
+		}
+
+		for (uint32_t i = 0; i < numVoxels; ++i) {
+			mismatches += (reference[i].Data != packed[i].Data) | (reference[i].RGBM != packed[i].RGBM);
+		}
+
+		voxel_count += size_t(numVoxels) * BENCHMARK_ITERATIONS;
+		++model_count;
+	};
+
+	for (auto const& model : ::_staticModels) {
+		benchmark_model(model);
+	}
+	for (auto const& model : ::_dynamicModels) {
+		benchmark_model(model);
+	}
+
+	model_volume::destroy(bits);
+
+	fp_seconds const fReference(tReference), fPacked(tPacked);
+
+	FMT_LOG(PERF_LOG, "voxel adjacency benchmark: models ({:d})  {:n} voxels  model_volume {:.1f} Mvoxels/s  bit-packed {:.1f} Mvoxels/s  ({:.2f}x)",
+		model_count, voxel_count / BENCHMARK_ITERATIONS,
+		0.0 != fReference.count() ? (double(voxel_count) / fReference.count()) * 1e-6 : 0.0,
+		0.0 != fPacked.count() ? (double(voxel_count) / fPacked.count()) * 1e-6 : 0.0,
+		0.0 != fPacked.count() ? fReference.count() / fPacked.count() : 0.0);
+
+	if (0 != mismatches) {
+		FMT_LOG_FAIL(PERF_LOG, "voxel adjacency benchmark: {:d} voxels differ", mismatches);
+	}
+}
+#endif
+
 } // end namespace voxB
 } // end namespace Volumetric
 
@@ -25,6 +25,7 @@ The VOX File format is Copyright to their respectful owners.
 #define VDB_FILE_EXT L".vdb"
 #define V1XA_FILE_EXT L".v1xa"
 #define GLTF_FILE_EXT L".gltf"
+#define V1XP_FILE_EXT L".v1xp"
 
 namespace Volumetric
 {
@@ -45,6 +46,20 @@ int const LoadVOX(std::filesystem::path const path, voxelModelBase* const __rest
 
 bool const SaveV1XCachedFile(std::wstring_view const path, voxelModelBase* const __restrict pDestMem); // for ImportProxy Usage
 
+// model archive (.v1xp) - all cached .vox models packed into a single file that is memory mapped (copy-on-write) for the lifetime of the models.
+// voxel arrays of models loaded from the archive point directly into the mapping, no allocation or copy is done.
+bool const OpenModelArchive(); // returns false if the archive does not exist or is invalid, all models will then load from .vox / .v1x
+// returns 1 if the model was loaded from the archive, 0 if the model is not in the archive or the archived copy is older than the source .vox or .v1x
+int const LoadArchivedModel(std::filesystem::path const path, voxelModelBase* const __restrict pDestMem);
+// writes a new archive of all the models passed in (source path, model) - safe to call while the current archive is open
+bool const SaveModelArchive(vector<std::pair<std::filesystem::path, voxelModelBase const*>> const& models);
+bool const isArchivedMemory(void const* const __restrict p);
+void CloseModelArchive(); // only after all models have been released
+
+#ifdef DEBUG_BENCHMARK_VOXEL_ADJACENCY
+void BenchmarkAdjacency(); // run once, after all models are loaded. results output to console
+#endif
+
 
 } // end namespace voxB
 
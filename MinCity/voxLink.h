@@ -25,6 +25,7 @@ namespace Volumetric
 		voxelVisibility const& __restrict	Visibility;
 
 		XMFLOAT3A const& __restrict         fractional_offset;
+		float const& __restrict             zoom;				// camera zoom factor, selects model level of detail
 
 	} voxLink;
 
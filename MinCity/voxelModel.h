@@ -273,6 +273,60 @@ namespace voxB
 		
 	} voxelDescPacked;
 
+	// structure of arrays copy of a models' voxels, built once at load time for the wide (8 voxels / iteration) render path.
+	// streams are padded by STREAM_PADDING elements so a partial group of 8 at the end can be loaded without bounds checks.
+	typedef struct voxelStreams
+	{
+		static constexpr uint32_t const STREAM_PADDING = 8;
+
+		uint8_t const* __restrict  x;
+		uint8_t const* __restrict  y;
+		uint8_t const* __restrict  z;
+		uint8_t const* __restrict  adjacency;  // high byte of voxelDescPacked::Data (adjacency, hidden)
+		uint8_t const* __restrict  material;   // high byte of voxelDescPacked::RGBM (video, emissive, transparent, metallic, roughness)
+		uint32_t const* __restrict color;      // rgb
+
+		__forceinline bool const valid() const { return(nullptr != x); }
+
+		__forceinline voxelDescPacked const unpack(uint32_t const index) const {
+			voxelDescPacked voxel;
+			voxel.Data = uint32_t(x[index]) | (uint32_t(y[index]) << 8u) | (uint32_t(z[index]) << 16u) | (uint32_t(adjacency[index]) << 24u);
+			voxel.RGBM = color[index] | (uint32_t(material[index]) << 24u);
+			return(voxel);
+		}
+
+	} voxelStreams;
+
+	// block of voxels handed to a batched voxel event function (see voxelModelInstance::setVoxelBatchEventFunction), one call per block instead of one
+	// indirect call per voxel. structure of arrays so an event can transform a whole block with simd. index_x/y/z is the position in the visible mini-grid
+	// and may be modified (moves the voxel), voxel holds color & flags and may be modified (Hidden removes the voxel), vxl_index is read only.
+	typedef struct alignas(32) voxelEventBatch
+	{
+		static constexpr uint32_t const CAPACITY = 64; // multiple of 8
+
+		float			index_x[CAPACITY],
+						index_y[CAPACITY],
+						index_z[CAPACITY];
+		voxelDescPacked	voxel[CAPACITY];
+		uint32_t		vxl_index[CAPACITY];
+		uint32_t		count = 0;
+
+	} voxelEventBatch;
+
+	// downsampled copy of a models' voxels (see BuildLOD). Voxels keep model coordinates snapped to the origin of their block,
+	// the render path offsets them to the block center and the vertex shader scales the voxel by the block size.
+	typedef struct voxelLOD
+	{
+		voxelDescPacked const* __restrict   voxels;
+		voxelStreams                        streams;
+
+		uint32_t		numVoxels,
+						numVoxelsTransparent;
+
+		__forceinline bool const valid() const { return(nullptr != voxels); }
+
+	} voxelLOD;
+
 	using model_volume = bit_volume<Volumetric::MODEL_MAX_DIMENSION_XYZ, Volumetric::MODEL_MAX_DIMENSION_XYZ, Volumetric::MODEL_MAX_DIMENSION_XYZ>; // 2 MB
 
 	STATIC_INLINE_PURE uint32_t const __vectorcall encode_adjacency(uvec4_v const xmIndex, model_volume const* const __restrict bits) // *note - good only for model max size dimensions
@@ -338,7 +392,14 @@ namespace voxB
 	
 	typedef struct voxelModelBase
 	{		
+		static constexpr uint32_t const LOD_LEVELS = 2;	// 2x, 4x
+
+		// zoom factor (higher values are farther away) at which each level replaces the level before it
+		static constexpr float const LOD_ZOOM[LOD_LEVELS]{ Globals::DEFAULT_ZOOM_SCALAR * 2.0f, Globals::DEFAULT_ZOOM_SCALAR * 3.0f };
+
 		voxelDescPacked const* __restrict   _Voxels;			// Finalized linear array of voxels (constant readonly memory)
+		voxelStreams                        _Streams;           // optional SoA copy of _Voxels (see BuildStreams), render uses the packed array if not built
+		voxelLOD                            _LOD[LOD_LEVELS];   // optional downsampled levels (see BuildLOD), level n is 2^(n+1) voxels wide
 
 		uint32_t 		_numVoxels;						// # of voxels activated
 		uint32_t		_numVoxelsEmissive;
@@ -353,18 +414,20 @@ namespace voxB
 		voxelModelFeatures _Features;
 		
 		inline voxelModelBase() 
-			: _maxDimensions{}, _maxDimensionsInv{}, _Extents{}, _Radius{}, _numVoxels(0), _numVoxelsEmissive(0), _numVoxelsTransparent(0), _Voxels(nullptr)
+			: _maxDimensions{}, _maxDimensionsInv{}, _Extents{}, _Radius{}, _numVoxels(0), _numVoxelsEmissive(0), _numVoxelsTransparent(0), _Voxels(nullptr), _Streams{}, _LOD{}
 		{}
 
 		voxelModelBase(voxelModelBase&& src)
 			: _maxDimensions(src._maxDimensions), _maxDimensionsInv(src._maxDimensionsInv), _Extents(src._Extents), _Radius(src._Radius), _LocalArea(src._LocalArea), _Features(std::move(src._Features)),
-			_numVoxels(src._numVoxels), _numVoxelsEmissive(src._numVoxelsEmissive), _numVoxelsTransparent(src._numVoxelsTransparent), _Voxels(nullptr)
+			_numVoxels(src._numVoxels), _numVoxelsEmissive(src._numVoxelsEmissive), _numVoxelsTransparent(src._numVoxelsTransparent), _Voxels(nullptr), _Streams{}, _LOD{}
 		{
 			std::swap<voxelDescPacked const* __restrict>(_Voxels, src._Voxels);
+			std::swap<voxelStreams>(_Streams, src._Streams);
+			std::swap(_LOD, src._LOD);
 		}
 
 		voxelModelBase(uint32_t const width, uint32_t const height, uint32_t const depth)
-			: _maxDimensions{}, _maxDimensionsInv{}, _Extents{}, _Radius{}, _numVoxels(0), _numVoxelsEmissive(0), _numVoxelsTransparent(0), _Voxels(nullptr)
+			: _maxDimensions{}, _maxDimensionsInv{}, _Extents{}, _Radius{}, _numVoxels(0), _numVoxelsEmissive(0), _numVoxelsTransparent(0), _Voxels(nullptr), _Streams{}, _LOD{}
 		{
 			vec4_v const maxDimensions(width, height, depth);
 			
@@ -379,6 +442,18 @@ namespace voxB
 		}
 		
 		void ComputeLocalAreaAndExtents();
+		void BuildStreams(); // defined in voxBinary.cpp - _Voxels must not change after the streams are built
+		void BuildLOD();     // defined in voxBinary.cpp - single frame models only, rebuilds all levels if called again
+
+		// highest level available for the zoom factor, 0 is full resolution
+		__inline uint32_t const selectLOD(float const zoom) const
+		{
+			uint32_t lod(0);
+			while (lod < LOD_LEVELS && zoom >= LOD_ZOOM[lod] && _LOD[lod].valid()) {
+				++lod;
+			}
+			return(lod);
+		}
 
 		~voxelModelBase(); // defined at end of voxBinary.cpp
 
@@ -407,17 +482,22 @@ namespace voxB
 			: voxelModelBase(std::forward<voxelModel<Dynamic>&&>(src)), _identity(src._identity)
 		{}
 
+		voxelModel(voxelModelIdent<Dynamic>&& identity, voxelModel<Dynamic>&& src) // move with new identity (models are loaded before their final identity is known)
+			: voxelModelBase(std::forward<voxelModel<Dynamic>&&>(src)), _identity(std::forward<voxelModelIdent<Dynamic>&&>(identity))
+		{}
+
 		voxelModel(uint32_t const width, uint32_t const height, uint32_t const depth)
 			: voxelModelBase(width, height, depth), _identity{ 0, 0 }
 		{}
 
-		template<bool const EmissionOnly, bool const Faded>
+		template<bool const EmissionOnly, bool const Faded, bool const Packed = false> // Packed forces the packed voxel path even if the model has streams
 		__inline void XM_CALLCONV Render(FXMVECTOR xmVoxelOrigin, FXMVECTOR xmVoxelOrient, 
 										 voxelModelInstance<Dynamic> const& __restrict instance,
 										 voxelBufferReference_Static& __restrict statics,
 										 voxelBufferReference_Dynamic& __restrict dynamics,
 										 voxelBufferReference_Dynamic& __restrict trans,
-										 tbb::affinity_partitioner& __restrict part) const;
+										 tbb::affinity_partitioner& __restrict part,
+										 uint32_t const lod = 0) const; // level of detail, see selectLOD
 
 	private:
 		voxelModel(voxelModel<Dynamic> const&) = delete; 
@@ -442,13 +522,14 @@ namespace voxB
 #pragma optimize( "s", on )
 #endif
 	template<bool const Dynamic>
-	template<bool const EmissionOnly, bool const Faded>
+	template<bool const EmissionOnly, bool const Faded, bool const Packed>
 	__inline void XM_CALLCONV voxelModel<Dynamic>::Render(FXMVECTOR xmVoxelOrigin, FXMVECTOR xmVoxelOrient,
 														  voxelModelInstance<Dynamic> const& __restrict instance,
 														  voxelBufferReference_Static& __restrict statics,
 														  voxelBufferReference_Dynamic& __restrict dynamics,
 														  voxelBufferReference_Dynamic& __restrict trans,
-														  tbb::affinity_partitioner& __restrict part) const
+														  tbb::affinity_partitioner& __restrict part,
+														  uint32_t const lod) const
 	{
 		typedef struct no_vtable sRenderFuncBlockChunk {
 
@@ -457,6 +538,7 @@ namespace voxB
 			[[maybe_unused]] XMVECTOR const                                         xmVoxelOrient;
 			uint32_t const                                                          vxl_offset;
 			voxB::voxelDescPacked const* const __restrict  			                voxelsIn;
+			voxB::voxelStreams const& __restrict                                    streams;
 			VertexDecl::VoxelNormal* const __restrict          		                voxels_static;
 			VertexDecl::VoxelDynamic* const __restrict		                        voxels_dynamic;
 			VertexDecl::VoxelDynamic* const __restrict		                        voxels_trans;
@@ -469,6 +551,9 @@ namespace voxB
 			[[maybe_unused]] float const Sign;  // packing/encoding of quaternion and color
 			float const		YDimension;
 			uint32_t const	Transparency;
+			XMVECTOR const  xmLODBias;		// block origin to block center
+			uint32_t const  LODHash;
+			bool const		Batched;		// instance has a batched voxel event
 
 #ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
 			PerformanceType& PerformanceCounters;
@@ -479,6 +564,8 @@ namespace voxB
 			__forceinline explicit sRenderFuncBlockChunk(FXMVECTOR xmVoxelOrigin_, FXMVECTOR xmVoxelOrient_,
 				uint32_t const vxl_offset_,
 				voxB::voxelDescPacked const* const __restrict& __restrict voxelsIn_,
+				voxB::voxelStreams const& __restrict streams_,
+				uint32_t const lod_,
 				VertexDecl::VoxelNormal* const __restrict& __restrict voxels_static_,
 				VertexDecl::VoxelDynamic* const __restrict& __restrict voxels_dynamic_,
 				VertexDecl::VoxelDynamic* const __restrict& __restrict voxels_trans_,
@@ -492,7 +579,7 @@ namespace voxB
 			) 
 				:
 				xmVoxelOrigin(xmVoxelOrigin_), xmVoxelOrient(xmVoxelOrient_), vxl_offset(vxl_offset_),
-				voxelsIn(voxelsIn_), 
+				voxelsIn(voxelsIn_), streams(streams_),
 				voxels_static(voxels_static_), voxels_dynamic(voxels_dynamic_), voxels_trans(voxels_trans_),
 				voxels_static_bits(std::forward<bit_row_reference_atomic<static_direct_buffer_size>&&>(voxels_static_bits_)),
 				voxels_dynamic_bits(std::forward<bit_row_reference_atomic<dynamic_direct_buffer_size>&&>(voxels_dynamic_bits_)),
@@ -502,6 +589,9 @@ namespace voxB
 				maxDimensions(uvec4_v(instance_.getModel()._maxDimensions).v4f()),
 				YDimension(XMVectorGetY(maxDimensions)),
 				Transparency(instance_.getTransparency()),
+				xmLODBias(XMVectorSetW(XMVectorReplicate(float((1u << lod_) - 1u) * 0.5f), 0.0f)),
+				LODHash(lod_ << 15),
+				Batched(instance_.hasVoxelBatchEvent()),
 				Sign((XMVectorGetW(xmVoxelOrient_) < 0.0f) ? -1.0f : 1.0f) // trick, the first 3 components x,y,z are sent to vertex shader where the quaternion is then decoded. see uniforms.vert - decode_quaternion() [bandwidth optimization]
 #ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION                                  // default is positive. the sign is packed into color. *color* must not equal zero for sign to be preserved
 				, PerformanceCounters(PerformanceCounters_)
@@ -509,7 +599,7 @@ namespace voxB
 			{}
 			sRenderFuncBlockChunk(sRenderFuncBlockChunk const& rhs)
 				: xmVoxelOrigin(rhs.xmVoxelOrigin), xmVoxelOrient(rhs.xmVoxelOrient), vxl_offset(rhs.vxl_offset),
-				voxelsIn(rhs.voxelsIn),
+				voxelsIn(rhs.voxelsIn), streams(rhs.streams),
 				voxels_static(rhs.voxels_static), voxels_dynamic(rhs.voxels_dynamic), voxels_trans(rhs.voxels_trans),
 				voxels_static_bits(std::forward<bit_row_reference_atomic<static_direct_buffer_size>&&>(rhs.voxels_static_bits)),
 				voxels_dynamic_bits(std::forward<bit_row_reference_atomic<dynamic_direct_buffer_size>&&>(rhs.voxels_dynamic_bits)),
@@ -519,33 +609,166 @@ namespace voxB
 				maxDimensions(rhs.maxDimensions),
 				YDimension(rhs.YDimension),
 				Transparency(rhs.Transparency),
+				xmLODBias(rhs.xmLODBias),
+				LODHash(rhs.LODHash),
+				Batched(rhs.Batched),
 				Sign(rhs.Sign)
 #ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION                                    
 				, PerformanceCounters(rhs.PerformanceCounters)
 #endif
 			{}
 
-			void operator()(tbb::blocked_range<uint32_t> const& r) const {
+		private:
+			typedef struct no_vtable sLocalBatches {
 
-#ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
-				PerformanceType::reference local_perf = PerformanceCounters.local();
-				tTime const tStartOp = high_resolution_clock::now();
+				using VoxelLocalBatchNormal = sBatchedByIndexOut<VertexDecl::VoxelNormal, eStreamingBatchSize::MODEL>;
+				using VoxelLocalBatchDynamic = sBatchedByIndexOut<VertexDecl::VoxelDynamic, eStreamingBatchSize::MODEL>;
 
-				++local_perf.operations;
-#endif
-				struct no_vtable {
-					    
-					using VoxelLocalBatchNormal = sBatchedByIndexOut<VertexDecl::VoxelNormal, eStreamingBatchSize::MODEL>;
-					using VoxelLocalBatchDynamic = sBatchedByIndexOut<VertexDecl::VoxelDynamic, eStreamingBatchSize::MODEL>;
+				std::conditional_t<Dynamic, VoxelLocalBatchDynamic, VoxelLocalBatchNormal> voxels{};
+				VoxelLocalBatchDynamic voxels_trans{};
+				voxB::voxelEventBatch events;		// only used by instances with a batched voxel event
+			} sLocalBatches;
 
-					std::conditional_t<Dynamic, VoxelLocalBatchDynamic, VoxelLocalBatchNormal> voxels{};
-					VoxelLocalBatchDynamic voxels_trans{};
-				} local; // *bugfix - no need for thread_local global variable(s), skips the lookup (hashmap for thread_locals) aswell. this reserve a little stack memory instead.
+			// voxel is inside the visible mini-grid, per voxel operations & submission are the same for the packed and the wide path
+			__forceinline void XM_CALLCONV emit(FXMVECTOR xmIndexIn, voxB::voxelDescPacked voxel, uint32_t const vxl, sLocalBatches& __restrict local) const
+			{
+				if (Batched) { // deferred until the block is full, see flush()
+					voxB::voxelEventBatch& __restrict events(local.events);
+					uint32_t const i(events.count);
+
+					events.index_x[i] = XMVectorGetX(xmIndexIn);
+					events.index_y[i] = XMVectorGetY(xmIndexIn);
+					events.index_z[i] = XMVectorGetZ(xmIndexIn);
+					events.voxel[i] = voxel;
+					events.vxl_index[i] = vxl;
+
+					if (voxB::voxelEventBatch::CAPACITY == ++events.count) {
+						flush(local);
+					}
+					return;
+				}
 
-				uint32_t const // pull out into registers from memory
-					vxl_begin(r.begin()),
-					vxl_end(r.end());
+				XMVECTOR xmIndex(xmIndexIn);
+
+				voxel = instance.OnVoxel(xmIndex, voxel, vxl);  // per voxel operations!
+
+				submit(xmIndex, voxel, vxl, local);
+			}
+
+			// one batched voxel event for all the gathered voxels, then each is submitted
+			__forceinline void flush(sLocalBatches& __restrict local) const
+			{
+				voxB::voxelEventBatch& __restrict events(local.events);
+
+				if (0 == events.count)
+					return;
+
+				instance.OnVoxelBatch(events);  // per block operations!
+
+				for (uint32_t i = 0; i < events.count; ++i) {
+					submit(XMVectorSet(events.index_x[i], events.index_y[i], events.index_z[i], 0.0f), events.voxel[i], events.vxl_index[i], local);
+				}
+
+				events.count = 0;
+			}
 
+			__forceinline void XM_CALLCONV submit(FXMVECTOR xmIndex, voxB::voxelDescPacked const voxel, uint32_t const vxl, sLocalBatches& __restrict local) const
+			{
+				if (voxel.Hidden)
+					return;
+
+				uint32_t const color(voxel.getColor()); // (srgb 8bpc)
+				bool const seed_a_light(voxel.Emissive & !Faded); // only on successful bounds check can an actual light be added safetly
+
+				// update xmStreamOut if xmIndex is modified in instance.OnVoxel
+				XMVECTOR const xmStreamOut(SFM::__fms(xmIndex, Volumetric::_xmInvTransformToIndexScale, _xmTransformToIndexBiasOverScale));
+
+				constexpr bool const faded = Faded;
+				constexpr bool const emission_only = EmissionOnly; // so that compiler can know beforehand that this is specifically compile-time and the below 
+				                                                   // if statement can combine with a non-constexpr (seed_a_light). The if statewment drops the "if constexpr" safetly here.
+				                                                   // https://stackoverflow.com/questions/55492042/combining-if-constexpr-with-non-const-condition
+				// finally submit voxel //
+				if constexpr (!emission_only) {
+
+					// Build hash //
+
+					// ** see uniforms.vert for definition of constants used here **
+					uint32_t hash(voxel.getAdjacency());                //           0000 0000 0011 1111
+					hash |= (seed_a_light << 6);			            //           0000 0000 01xx xxxx    // no light, no emission
+					hash |= (voxel.Metallic << 7);						// 0000 0000 0000 xxxx 1xxx xxxx
+					hash |= (voxel.Roughness << 8);						// 0000 0000 0000 1111 xxxx xxxx
+					hash |= LODHash;									// 0000 0000 0000 0001 1xxx xxxx xxxx xxxx (level of detail)
+
+					uint32_t const index(vxl - vxl_offset);
+
+					// transparency cannot be dynamically set, as the number of transparent voxels for the entire voxel model must be known and its already registered.
+					if (!(faded | voxel.Transparent)) {
+						
+						if constexpr (Dynamic) {
+
+							local.voxels.emplace_back(            
+								voxels_dynamic, index,
+								xmStreamOut,
+								XMVectorSetW(xmVoxelOrient, Sign * (float)SFM::max(1u, color)),  // ensure color not equal to zero so packed sign is valid, srgb is passed to vertex shader which converts it to linear; which is faster than here with cpu
+								hash
+							);
+							voxels_dynamic_bits.set_bit(index);
+						}
+						else {
+							local.voxels.emplace_back(
+								voxels_static, index,
+								xmStreamOut,
+								XMVectorSet(0.0f, 0.0f, 0.0f, (float)color),
+								hash
+							);
+							voxels_static_bits.set_bit(index);
+						}
+
+					}
+					else { // transparency enabled
+
+						hash |= ((Transparency >> 6) << 13);				// 0000 0000 011U xxxx xxxx xxxx
+
+						if constexpr (Dynamic) {
+
+							local.voxels_trans.emplace_back(
+								voxels_trans, index,
+								xmStreamOut,
+								XMVectorSetW(xmVoxelOrient, Sign * (float)SFM::max(1u, color)),  // ensure color not equal to zero so packed sign is valid, srgb is passed to vertex shader which converts it to linear; which is faster than here with cpu
+								hash
+							);
+
+						}
+						else { // sneaky override for *static* transparent voxels
+
+							local.voxels_trans.emplace_back(
+								voxels_trans, index,
+								xmStreamOut,
+								XMVectorSet(0.0f, 0.0f, 0.0f, (float)color),
+								hash
+							);
+
+						}
+						voxels_trans_bits.set_bit(index);
+					}
+				}
+
+				if (seed_a_light) {										  // crash prevented at beginning of function
+
+					// the *World position* of the light is stored, so it should be used with a corresponding *world* point in calculations
+					// te lightmap volume however is sampled with the uv relative coordinates of a range between 0...VOXEL_MINIGRID_VISIBLE_X
+					// and is in the fragment shaderrecieved swizzled in xzy form
+					VolumetricLink->Opacity.getMappedVoxelLights().seed(xmIndex, color);
+				}
+			}
+
+			// packed path - one voxelDescPacked per iteration
+			__forceinline void render_packed(uint32_t const vxl_begin, uint32_t const vxl_end, sLocalBatches& __restrict local
+#ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
+				, PerformanceType::reference local_perf
+#endif
+			) const
+			{
 				voxB::voxelDescPacked const* __restrict pVoxelsIn(voxelsIn + vxl_begin);
 
 				constexpr uint32_t const PREFETCH_ELEMENTS = CACHE_LINE_BYTES / sizeof(voxB::voxelDescPacked);
@@ -563,125 +786,155 @@ namespace voxB
 						prefetch_count = PREFETCH_ELEMENTS;
 					}
 
-					voxB::voxelDescPacked voxel(*pVoxelsIn); // copy out reduces accesses to memory, and its a small very small size structure
+					voxB::voxelDescPacked const voxel(*pVoxelsIn); // copy out reduces accesses to memory, and its a small very small size structure
 					++pVoxelsIn; // sequentially accessed for maximum cache prediction
 
-					XMVECTOR xmMiniVox = getMiniVoxelGridIndex(maxDimensions, maxDimensionsInv, _mm_cvtepi32_ps(voxel.getPosition()));
+					XMVECTOR xmMiniVox = getMiniVoxelGridIndex(maxDimensions, maxDimensionsInv, XMVectorAdd(_mm_cvtepi32_ps(voxel.getPosition()), xmLODBias));
 
 					if constexpr (Dynamic) { // rotation quaternion (optimized out depending on "Dynamic")
 						// orient voxel by quaternion
 						xmMiniVox = v3_rotate(xmMiniVox, xmVoxelOrient);
 					}
 
-					XMVECTOR xmStreamOut = XMVectorAdd(xmVoxelOrigin, XMVectorScale(XMVectorSetY(xmMiniVox, SFM::__fms(YDimension, -0.5f, XMVectorGetY(xmMiniVox))), Iso::MINI_VOX_STEP)); // relative to current ROOT voxel origin, precise height offset for center of model
-					//xmStreamOut = XMVectorAdd(xmStreamOut, XMLoadFloat3A(&VolumetricLink->fractional_offset));
-
-					XMVECTOR xmIndex(XMVectorMultiplyAdd(xmStreamOut, Volumetric::_xmTransformToIndexScale, Volumetric::_xmTransformToIndexBias));
+					XMVECTOR const xmStreamOut = XMVectorAdd(xmVoxelOrigin, XMVectorScale(XMVectorSetY(xmMiniVox, SFM::__fms(YDimension, -0.5f, XMVectorGetY(xmMiniVox))), Iso::MINI_VOX_STEP)); // relative to current ROOT voxel origin, precise height offset for center of model
 
-					uint32_t color(0);
-					bool seed_a_light(false);
+					XMVECTOR const xmIndex(XMVectorMultiplyAdd(xmStreamOut, Volumetric::_xmTransformToIndexScale, Volumetric::_xmTransformToIndexBias));
 
 					[[likely]] if (XMVector3GreaterOrEqual(xmIndex, XMVectorZero())
 						&& XMVector3Less(xmIndex, Volumetric::VOXEL_MINIGRID_VISIBLE_XYZ)) // prevent crashes if index is negative or outside of bounds of visible mini-grid : voxel vertex shader depends on this clipping!
 					{
-						voxel = instance.OnVoxel(xmIndex, voxel, vxl);  // per voxel operations!
-
-						if (voxel.Hidden)
-							continue;
-
-						color = voxel.getColor(); // (srgb 8bpc)
-						seed_a_light = (voxel.Emissive & !Faded); // only on successful bounds check can an actual light be added safetly
-
-						// update xmStreamOut if xmIndex is modified in instance.OnVoxel
-						xmStreamOut = SFM::__fms(xmIndex, Volumetric::_xmInvTransformToIndexScale, _xmTransformToIndexBiasOverScale);
-					}
-					else {
-						continue;
+						emit(xmIndex, voxel, vxl, local);
 					}
+#ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
+					local_perf.iteration_duration = std::max(local_perf.iteration_duration, high_resolution_clock::now() - tStartIter);
+#endif
+				} // end for
+			}
 
-					constexpr bool const faded = Faded;
-					constexpr bool const emission_only = EmissionOnly; // so that compiler can know beforehand that this is specifically compile-time and the below 
-					                                                   // if statement can combine with a non-constexpr (seed_a_light). The if statewment drops the "if constexpr" safetly here.
-					                                                   // https://stackoverflow.com/questions/55492042/combining-if-constexpr-with-non-const-condition
-					// finally submit voxel //
-					if constexpr (!emission_only) {
-
-						// Build hash //
-
-						// ** see uniforms.vert for definition of constants used here **
-						uint32_t hash(voxel.getAdjacency());                //           0000 0000 0011 1111
-						hash |= (seed_a_light << 6);			            //           0000 0000 01xx xxxx    // no light, no emission
-						hash |= (voxel.Metallic << 7);						// 0000 0000 0000 xxxx 1xxx xxxx
-						hash |= (voxel.Roughness << 8);						// 0000 0000 0000 1111 xxxx xxxx
-
-						uint32_t const index(vxl - vxl_offset);
-
-						// transparency cannot be dynamically set, as the number of transparent voxels for the entire voxel model must be known and its already registered.
-						if (!(faded | voxel.Transparent)) {
-							
-							if constexpr (Dynamic) {
-
-								local.voxels.emplace_back(            
-									voxels_dynamic, index,
-									xmStreamOut,
-									XMVectorSetW(xmVoxelOrient, Sign * (float)SFM::max(1u, color)),  // ensure color not equal to zero so packed sign is valid, srgb is passed to vertex shader which converts it to linear; which is faster than here with cpu
-									hash
-								);
-								voxels_dynamic_bits.set_bit(index);
-							}
-							else {
-								local.voxels.emplace_back(
-									voxels_static, index,
-									xmStreamOut,
-									XMVectorSet(0.0f, 0.0f, 0.0f, (float)color),
-									hash
-								);
-								voxels_static_bits.set_bit(index);
-							}
+			// wide path - 8 voxels per iteration from the SoA streams. position transform & bounds test are done for all 8 lanes at once,
+			// only the lanes inside the visible mini-grid are unpacked and submitted.
+			__forceinline void render_streams(uint32_t const vxl_begin, uint32_t const vxl_end, sLocalBatches& __restrict local
+#ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
+				, PerformanceType::reference local_perf
+#endif
+			) const
+			{
+				__m256 const
+					vInvX(_mm256_set1_ps(XMVectorGetX(maxDimensionsInv))), vInvY(_mm256_set1_ps(XMVectorGetY(maxDimensionsInv))), vInvZ(_mm256_set1_ps(XMVectorGetZ(maxDimensionsInv))),
+					vDimX(_mm256_set1_ps(XMVectorGetX(maxDimensions))), vDimY(_mm256_set1_ps(XMVectorGetY(maxDimensions))), vDimZ(_mm256_set1_ps(XMVectorGetZ(maxDimensions))),
+					vOriginX(_mm256_set1_ps(XMVectorGetX(xmVoxelOrigin))), vOriginY(_mm256_set1_ps(XMVectorGetY(xmVoxelOrigin))), vOriginZ(_mm256_set1_ps(XMVectorGetZ(xmVoxelOrigin))),
+					vHalf(_mm256_set1_ps(0.5f)),
+					vLODBias(_mm256_set1_ps(XMVectorGetX(xmLODBias))),
+					vHeightOffset(_mm256_set1_ps(YDimension * -0.5f)),
+					vStep(_mm256_set1_ps(Iso::MINI_VOX_STEP)),
+					vScaleX(_mm256_set1_ps(XMVectorGetX(Volumetric::_xmTransformToIndexScale))), vScaleY(_mm256_set1_ps(XMVectorGetY(Volumetric::_xmTransformToIndexScale))), vScaleZ(_mm256_set1_ps(XMVectorGetZ(Volumetric::_xmTransformToIndexScale))),
+					vBiasX(_mm256_set1_ps(XMVectorGetX(Volumetric::_xmTransformToIndexBias))), vBiasY(_mm256_set1_ps(XMVectorGetY(Volumetric::_xmTransformToIndexBias))), vBiasZ(_mm256_set1_ps(XMVectorGetZ(Volumetric::_xmTransformToIndexBias))),
+					vMaxX(_mm256_set1_ps(XMVectorGetX(Volumetric::VOXEL_MINIGRID_VISIBLE_XYZ))), vMaxY(_mm256_set1_ps(XMVectorGetY(Volumetric::VOXEL_MINIGRID_VISIBLE_XYZ))), vMaxZ(_mm256_set1_ps(XMVectorGetZ(Volumetric::VOXEL_MINIGRID_VISIBLE_XYZ))),
+					vZero(_mm256_setzero_ps());
+
+				[[maybe_unused]] __m256 vQx, vQy, vQz, vQw;
+				if constexpr (Dynamic) {
+					vQx = _mm256_set1_ps(XMVectorGetX(xmVoxelOrient));
+					vQy = _mm256_set1_ps(XMVectorGetY(xmVoxelOrient));
+					vQz = _mm256_set1_ps(XMVectorGetZ(xmVoxelOrient));
+					vQw = _mm256_set1_ps(XMVectorGetW(xmVoxelOrient));
+				}
 
-						}
-						else { // transparency enabled
+				alignas(32) float index_x[8], index_y[8], index_z[8];
 
-							hash |= ((Transparency >> 6) << 13);				// 0000 0000 011U xxxx xxxx xxxx
+				for (uint32_t vxl = vxl_begin; vxl < vxl_end; vxl += 8) {
+#ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
+					tTime const tStartIter = high_resolution_clock::now();
+					++local_perf.iterations;
+#endif
+					// streams are padded, a partial group at the end is masked below
+					__m256 const vX(_mm256_add_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const*)(streams.x + vxl)))), vLODBias)),
+						         vY(_mm256_add_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const*)(streams.y + vxl)))), vLODBias)),
+						         vZ(_mm256_add_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const*)(streams.z + vxl)))), vLODBias));
+
+					// getMiniVoxelGridIndex
+					__m256 vMiniX(_mm256_mul_ps(_mm256_fmsub_ps(vX, vInvX, vHalf), vDimX)),
+						   vMiniY(_mm256_mul_ps(_mm256_fmsub_ps(vY, vInvY, vHalf), vDimY)),
+						   vMiniZ(_mm256_mul_ps(_mm256_fmsub_ps(vZ, vInvZ, vHalf), vDimZ));
+
+					if constexpr (Dynamic) { // rotation by quaternion, v' = v + w * t + cross(q, t) where t = 2 * cross(q, v)
+						__m256 const vTx(_mm256_add_ps(_mm256_fmsub_ps(vQy, vMiniZ, _mm256_mul_ps(vQz, vMiniY)), _mm256_fmsub_ps(vQy, vMiniZ, _mm256_mul_ps(vQz, vMiniY)))),
+							         vTy(_mm256_add_ps(_mm256_fmsub_ps(vQz, vMiniX, _mm256_mul_ps(vQx, vMiniZ)), _mm256_fmsub_ps(vQz, vMiniX, _mm256_mul_ps(vQx, vMiniZ)))),
+							         vTz(_mm256_add_ps(_mm256_fmsub_ps(vQx, vMiniY, _mm256_mul_ps(vQy, vMiniX)), _mm256_fmsub_ps(vQx, vMiniY, _mm256_mul_ps(vQy, vMiniX))));
+
+						vMiniX = _mm256_add_ps(_mm256_fmadd_ps(vQw, vTx, vMiniX), _mm256_fmsub_ps(vQy, vTz, _mm256_mul_ps(vQz, vTy)));
+						vMiniY = _mm256_add_ps(_mm256_fmadd_ps(vQw, vTy, vMiniY), _mm256_fmsub_ps(vQz, vTx, _mm256_mul_ps(vQx, vTz)));
+						vMiniZ = _mm256_add_ps(_mm256_fmadd_ps(vQw, vTz, vMiniZ), _mm256_fmsub_ps(vQx, vTy, _mm256_mul_ps(vQy, vTx)));
+					}
 
-							if constexpr (Dynamic) {
+					// relative to current ROOT voxel origin, precise height offset for center of model
+					__m256 const vIndexX(_mm256_fmadd_ps(_mm256_fmadd_ps(vMiniX, vStep, vOriginX), vScaleX, vBiasX)),
+						         vIndexY(_mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_sub_ps(vHeightOffset, vMiniY), vStep, vOriginY), vScaleY, vBiasY)),
+						         vIndexZ(_mm256_fmadd_ps(_mm256_fmadd_ps(vMiniZ, vStep, vOriginZ), vScaleZ, vBiasZ));
 
-								local.voxels_trans.emplace_back(
-									voxels_trans, index,
-									xmStreamOut,
-									XMVectorSetW(xmVoxelOrient, Sign * (float)SFM::max(1u, color)),  // ensure color not equal to zero so packed sign is valid, srgb is passed to vertex shader which converts it to linear; which is faster than here with cpu
-									hash
-								);
+					// inside of visible mini-grid
+					__m256 const vInside(_mm256_and_ps(_mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(vIndexX, vZero, _CMP_GE_OQ), _mm256_cmp_ps(vIndexX, vMaxX, _CMP_LT_OQ)),
+						                                             _mm256_and_ps(_mm256_cmp_ps(vIndexY, vZero, _CMP_GE_OQ), _mm256_cmp_ps(vIndexY, vMaxY, _CMP_LT_OQ))),
+						                               _mm256_and_ps(_mm256_cmp_ps(vIndexZ, vZero, _CMP_GE_OQ), _mm256_cmp_ps(vIndexZ, vMaxZ, _CMP_LT_OQ))));
 
-							}
-							else { // sneaky override for *static* transparent voxels
+					uint32_t const remaining(vxl_end - vxl);
+					uint32_t lanes(uint32_t(_mm256_movemask_ps(vInside)) & (remaining < 8 ? ((1u << remaining) - 1u) : 0xffu));
 
-								local.voxels_trans.emplace_back(
-									voxels_trans, index,
-									xmStreamOut,
-									XMVectorSet(0.0f, 0.0f, 0.0f, (float)color),
-									hash
-								);
+					if (0 != lanes) {
+						_mm256_store_ps(index_x, vIndexX);
+						_mm256_store_ps(index_y, vIndexY);
+						_mm256_store_ps(index_z, vIndexZ);
 
-							}
-							voxels_trans_bits.set_bit(index);
-						}
-					}
+						do {
+							uint32_t const lane(_tzcnt_u32(lanes));
+							lanes &= lanes - 1;
 
-					if (seed_a_light) {										  // crash prevented at beginning of function
+							emit(XMVectorSet(index_x[lane], index_y[lane], index_z[lane], 0.0f), streams.unpack(vxl + lane), vxl + lane, local);
 
-						// the *World position* of the light is stored, so it should be used with a corresponding *world* point in calculations
-						// te lightmap volume however is sampled with the uv relative coordinates of a range between 0...VOXEL_MINIGRID_VISIBLE_X
-						// and is in the fragment shaderrecieved swizzled in xzy form
-						VolumetricLink->Opacity.getMappedVoxelLights().seed(xmIndex, color);
+						} while (0 != lanes);
 					}
 #ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
 					local_perf.iteration_duration = std::max(local_perf.iteration_duration, high_resolution_clock::now() - tStartIter);
 #endif
 				} // end for
+			}
+
+		public:
+			void operator()(tbb::blocked_range<uint32_t> const& r) const {
+
+#ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
+				PerformanceType::reference local_perf = PerformanceCounters.local();
+				tTime const tStartOp = high_resolution_clock::now();
+
+				++local_perf.operations;
+#endif
+				sLocalBatches local; // *bugfix - no need for thread_local global variable(s), skips the lookup (hashmap for thread_locals) aswell. this reserve a little stack memory instead.
+
+				uint32_t const // pull out into registers from memory
+					vxl_begin(r.begin()),
+					vxl_end(r.end());
+
+				if (!Packed && streams.valid()) {
+					render_streams(vxl_begin, vxl_end, local
+#ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
+						, local_perf
+#endif
+					);
+				}
+				else {
+					render_packed(vxl_begin, vxl_end, local
+#ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
+						, local_perf
+#endif
+					);
+				}
 
 				// ####################################################################################################################
 				// ensure all batches are  output (residual/remainder)
+				if (Batched) {
+					flush(local);
+				}
+
 				if constexpr (Dynamic) {
 					local.voxels.out(voxels_dynamic);
 				}
@@ -706,8 +959,11 @@ namespace voxB
 		VertexDecl::VoxelDynamic* pVoxelsOutDynamic{};
 		VertexDecl::VoxelDynamic* pVoxelsOutTrans{};
 
-		uint32_t const vxl_count(instance.getCount());
-		uint32_t const vxl_transparent_count(instance.getTransparentCount());
+		// downsampled level replaces the voxels of the instance entirely (single frame instances only, see voxelModelInstance::getLOD)
+		voxelLOD const* const __restrict level(0 != lod ? &_LOD[lod - 1] : nullptr);
+
+		uint32_t const vxl_count(level ? level->numVoxels : instance.getCount());
+		uint32_t const vxl_transparent_count(level ? level->numVoxelsTransparent : instance.getTransparentCount());
 
 		// *bugfix
 		// reserve enough memory in the direct buffer for direct addressing output
@@ -737,12 +993,14 @@ namespace voxB
 #ifdef DEBUG_PERFORMANCE_VOXEL_SUBMISSION
 		PerformanceType PerformanceCounters;
 #endif
-		uint32_t const vxl_offset(instance.getOffset());
+		uint32_t const vxl_offset(level ? 0 : instance.getOffset());
+		voxelDescPacked const* const __restrict voxels(level ? level->voxels : _Voxels);
+		voxelStreams const& __restrict streams(level ? level->streams : _Streams);
 
 		/*
 		// serial
 		RenderFuncBlockChunk(xmVoxelOrigin, xmVoxelOrient, vxl_offset,
-							_Voxels,
+							voxels, streams, lod,
 							pVoxelsOutStatic, pVoxelsOutDynamic, pVoxelsOutTrans,
 							std::forward<bit_row_reference<static_direct_buffer_size>&&>(bit_row_reference<static_direct_buffer_size>::create(*statics.bits, pVoxelsOutStatic - statics.voxels_start)),
 							std::forward<bit_row_reference<dynamic_direct_buffer_size>&&>(bit_row_reference<dynamic_direct_buffer_size>::create(*dynamics.bits, pVoxelsOutDynamic - dynamics.voxels_start)),
@@ -759,7 +1017,7 @@ namespace voxB
 
 			tbb::parallel_for(tbb::blocked_range<uint32_t>(vxl_offset, vxl_offset + vxl_count, eThreadBatchGrainSize::MODEL),
 			    std::forward<RenderFuncBlockChunk&&>(RenderFuncBlockChunk(xmVoxelOrigin, xmVoxelOrient, vxl_offset,
-					_Voxels,
+					voxels, streams, lod,
 					pVoxelsOutStatic, pVoxelsOutDynamic, pVoxelsOutTrans,
 					std::forward<bit_row_reference_atomic<static_direct_buffer_size>&&>(bit_row_reference_atomic<static_direct_buffer_size>::create(*statics.bits, pVoxelsOutStatic - statics.voxels_start)),
 					std::forward<bit_row_reference_atomic<dynamic_direct_buffer_size>&&>(bit_row_reference_atomic<dynamic_direct_buffer_size>::create(*dynamics.bits, pVoxelsOutDynamic - dynamics.voxels_start)),
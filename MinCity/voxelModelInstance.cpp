@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "voxelModelInstance.h"
 #include "cVoxelWorld.h"
+#include "deferredUpdate.h"
 
 namespace Volumetric
 {
@@ -36,7 +37,7 @@ namespace Volumetric
 		// instance will not be rendered anymore, deletion is managed by World instance cleanup queue
 	}
 
-	bool const __vectorcall voxelModelInstance_Dynamic::synchronize(FXMVECTOR const xmLoc, v2_rotation_t const vYaw) const // only for dynamic instances, expects 2D vector with x, z components only!!!
+	bool const __vectorcall voxelModelInstance_Dynamic::synchronize(FXMVECTOR const xmLoc, v2_rotation_t const vYawFrom, v2_rotation_t const vYaw) const // only for dynamic instances, expects 2D vector with x, z components only!!!
 	{
 		if (hashID && !destroyPending()) {
 
@@ -48,13 +49,13 @@ namespace Volumetric
 				point2D_t const new_rootVoxel(v2_to_p2D(xmLoc)); // matches getVoxelIndex() method
 
 				// this could be a slight move (fractional) that does not change the voxelindex (integer)
-				if (new_rootVoxel != old_rootVoxel || vYaw != _vYaw) {
+				if (new_rootVoxel != old_rootVoxel || vYaw != vYawFrom) {
 
 					// clear and set areas 1st, then update root voxels
 					rect2D_t const vLocalArea(getModel()._LocalArea);
 
 					// clear old area of the hash id only			   
-					world::resetVoxelsHashAt(r2D_add(vLocalArea, old_rootVoxel), hashID, _vYaw); // using old location & Yaw
+					world::resetVoxelsHashAt(r2D_add(vLocalArea, old_rootVoxel), hashID, vYawFrom); // using old location & Yaw
 
 					/// ////////////////////////////////////////////////////////////////////////////////////
 					Iso::Voxel oVoxelNew(world::getVoxelAt(new_rootVoxel));
@@ -97,19 +98,33 @@ namespace Volumetric
 		return(false); // signalled for destruction //
 	}
 
-	void __vectorcall voxelModelInstance_Dynamic::synchronize(FXMVECTOR const xmLoc)  // only for dynamic instances
+	void __vectorcall voxelModelInstance_Dynamic::requestSynchronize(FXMVECTOR const xmLoc, v2_rotation_t const vYaw)  // only for dynamic instances
 	{
-		Interpolator.set(vLoc, xmLoc); // *must* be set b4 synchro
+		if (world::deferred::isDeferring()) { // parallel update, grid & root index changes are made later in order by the apply phase
+			world::deferred::push(this, xmLoc, _vYaw, vYaw);
+			return;
+		}
 
-		if (!synchronize(XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Z, XM_SWIZZLE_Y, XM_SWIZZLE_W>(XMLoadFloat3A(&(XMFLOAT3A const&)vLoc)), _vYaw)) {
+		if (!synchronize(xmLoc, _vYaw, vYaw)) {
 			destroy(milliseconds(0)); // signalled for destruction //
 		}
 	}
-	void __vectorcall voxelModelInstance_Dynamic::synchronize(v2_rotation_t const vYaw)  // only for dynamic instances
+	void __vectorcall voxelModelInstance_Dynamic::synchronizeDeferred(FXMVECTOR const xmLoc, v2_rotation_t const vYawFrom, v2_rotation_t const vYaw)
 	{
-		if (!synchronize(XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Z, XM_SWIZZLE_Y, XM_SWIZZLE_W>(XMLoadFloat3A(&(XMFLOAT3A const&)vLoc)), vYaw)) {
+		if (!synchronize(xmLoc, vYawFrom, vYaw)) {
 			destroy(milliseconds(0)); // signalled for destruction //
 		}
+	}
+
+	void __vectorcall voxelModelInstance_Dynamic::synchronize(FXMVECTOR const xmLoc)  // only for dynamic instances
+	{
+		Interpolator.set(vLoc, xmLoc); // *must* be set b4 synchro
+
+		requestSynchronize(XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Z, XM_SWIZZLE_Y, XM_SWIZZLE_W>(XMLoadFloat3A(&(XMFLOAT3A const&)vLoc)), _vYaw);
+	}
+	void __vectorcall voxelModelInstance_Dynamic::synchronize(v2_rotation_t const vYaw)  // only for dynamic instances
+	{
+		requestSynchronize(XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Z, XM_SWIZZLE_Y, XM_SWIZZLE_W>(XMLoadFloat3A(&(XMFLOAT3A const&)vLoc)), vYaw);
 
 		_vYaw = vYaw; // must be last
 	}
@@ -118,9 +133,7 @@ namespace Volumetric
 
 		Interpolator.set(vLoc, xmLoc); // *must* be set b4 synchro
 
-		if (!synchronize(XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Z, XM_SWIZZLE_Y, XM_SWIZZLE_W>(XMLoadFloat3A(&(XMFLOAT3A const&)vLoc)), yYaw)) {
-			destroy(milliseconds(0)); // signalled for destruction //
-		}
+		requestSynchronize(XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Z, XM_SWIZZLE_Y, XM_SWIZZLE_W>(XMLoadFloat3A(&(XMFLOAT3A const&)vLoc)), yYaw);
 
 		_vYaw = yYaw; // must be last
 		_vPitch = xPitch; _vRoll = zRoll;
@@ -116,6 +116,12 @@ namespace Volumetric
 
 	typedef VOXEL_EVENT_FUNCTION_RETURN(__vectorcall* voxel_event_function)(VOXEL_EVENT_FUNCTION_PARAMETERS);
 
+	// batched, one call per block of visible voxels (see voxB::voxelEventBatch). preferred over the per voxel event function, which remains for compatibility.
+#define VOXEL_BATCH_EVENT_FUNCTION_PARAMETERS Volumetric::voxB::voxelEventBatch& __restrict batch, void const* const __restrict _this
+#define VOXEL_BATCH_EVENT_FUNCTION_RESOLVED_PARAMETERS Volumetric::voxB::voxelEventBatch& __restrict batch
+
+	typedef void(__vectorcall* voxel_batch_event_function)(VOXEL_BATCH_EVENT_FUNCTION_PARAMETERS);
+
 	template< bool const Dynamic >
 	class voxelModelInstance : public voxelModelInstanceBase
 	{
@@ -132,6 +138,8 @@ namespace Volumetric
 		/// Transparency only has affect if loaded model has state groups defining the voxels that are transparent at load model time
 		void														  setTransparency(uint32_t const transparency_) { transparency = transparency_; } // use eVoxelTransparency enum
 		void														  setVoxelEventFunction(voxel_event_function const eventHandler) { eOnVoxel = eventHandler; }
+		void														  setVoxelBatchEventFunction(voxel_batch_event_function const eventHandler) { eOnVoxelBatch = eventHandler; }
+		__inline bool const											  hasVoxelBatchEvent() const;
 
 		uint32_t const												  getOffset() const { return(vxl.offset); }
 		uint32_t const												  getCount() const { return(vxl.count); }
@@ -140,13 +148,24 @@ namespace Volumetric
 		 void														  setOffsetCount(uint32_t const vxl_offset, uint32_t const vxl_count) { vxl.offset = vxl_offset; vxl.count = vxl_count; } // for sequence animation control
 		void														  setTransparentCount(uint32_t const vxl_transparent_count) { vxl.transparent_count = vxl_transparent_count; } // *** this count must be accurate otherwise "flicker" of any transparent voxels will occur, don't mess around.
 
+		__inline uint32_t const										  getLOD() const; // level of detail for the current zoom, 0 = full resolution
+
 	public:
 		__inline bool const Validate() const;
 		__inline VOXEL_EVENT_FUNCTION_RETURN __vectorcall OnVoxel(VOXEL_EVENT_FUNCTION_RESOLVED_PARAMETERS) const;
+		__inline void __vectorcall OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_RESOLVED_PARAMETERS) const;
+
+#ifdef DEBUG_BENCHMARK_VOXEL_EVENTS
+		void														  setPerVoxelEvents(bool const per_voxel_events_) { per_voxel_events = per_voxel_events_; } // forces the per voxel path for a batched event
+#endif
 
 	protected:
 		voxB::voxelModel<Dynamic> const& __restrict 		model;
 		voxel_event_function								eOnVoxel;
+		voxel_batch_event_function							eOnVoxelBatch;
+#ifdef DEBUG_BENCHMARK_VOXEL_EVENTS
+		bool												per_voxel_events = false;
+#endif
 		bool												faded, emission_only;
 		uint32_t											transparency;	// 4 distinct levels of transparency supported - see eVoxelTransparency enum - however all values between 0 - 255 will be correctly converted to transparency level that is closest
 		
@@ -159,7 +178,7 @@ namespace Volumetric
 
 	public:
 		inline explicit voxelModelInstance(voxB::voxelModel<Dynamic> const& __restrict refModel, uint32_t const hash, point2D_t const voxelIndex, uint32_t const flags_)
-			: voxelModelInstanceBase(hash, voxelIndex, flags_), model(refModel), faded(false), emission_only(false), transparency(Volumetric::Konstants::DEFAULT_TRANSPARENCY), eOnVoxel(nullptr),
+			: voxelModelInstanceBase(hash, voxelIndex, flags_), model(refModel), faded(false), emission_only(false), transparency(Volumetric::Konstants::DEFAULT_TRANSPARENCY), eOnVoxel(nullptr), eOnVoxelBatch(nullptr),
 			vxl{ .offset{}, .count{refModel._numVoxels}, .transparent_count{refModel._numVoxelsTransparent} } // defaults to single "frame" mode
 		{}
 	};
@@ -181,13 +200,63 @@ namespace Volumetric
 		return(true);
 	}
 	template<bool const Dynamic>
+	__inline uint32_t const voxelModelInstance<Dynamic>::getLOD() const
+	{
+		// per voxel operations depend on the voxel index & position, sequences change offset/count every frame - both always render the full resolution voxels
+		if (eOnVoxel || eOnVoxelBatch || 0 != vxl.offset || model._numVoxels != vxl.count || model._numVoxelsTransparent != vxl.transparent_count)
+			return(0);
+
+		return(model.selectLOD(VolumetricLink->zoom));
+	}
+	template<bool const Dynamic>
 	__inline VOXEL_EVENT_FUNCTION_RETURN __vectorcall voxelModelInstance<Dynamic>::OnVoxel(VOXEL_EVENT_FUNCTION_RESOLVED_PARAMETERS) const
 	{
 		if (eOnVoxel) {
 			return((*eOnVoxel)(xmIndex, voxel, owner_gameobject, vxl_index));
 		}
+		if (eOnVoxelBatch) { // compatibility, a batched event driven one voxel at a time
+			voxB::voxelEventBatch batch;
+			
+			XMFLOAT3A vIndex;
+			XMStoreFloat3A(&vIndex, xmIndex);
+			batch.index_x[0] = vIndex.x; batch.index_y[0] = vIndex.y; batch.index_z[0] = vIndex.z;
+			batch.voxel[0] = voxel;
+			batch.vxl_index[0] = vxl_index;
+			batch.count = 1;
+
+			(*eOnVoxelBatch)(batch, owner_gameobject);
+
+			xmIndex = XMVectorSet(batch.index_x[0], batch.index_y[0], batch.index_z[0], 0.0f);
+			return(batch.voxel[0]);
+		}
 		return(voxel);
 	}
+	template<bool const Dynamic>
+	__inline bool const voxelModelInstance<Dynamic>::hasVoxelBatchEvent() const
+	{
+#ifdef DEBUG_BENCHMARK_VOXEL_EVENTS
+		if (per_voxel_events)
+			return(false);
+#endif
+		return(nullptr == eOnVoxel && nullptr != eOnVoxelBatch);
+	}
+	template<bool const Dynamic>
+	__inline void __vectorcall voxelModelInstance<Dynamic>::OnVoxelBatch(VOXEL_BATCH_EVENT_FUNCTION_RESOLVED_PARAMETERS) const
+	{
+		if (eOnVoxelBatch) {
+			(*eOnVoxelBatch)(batch, owner_gameobject);
+		}
+		else if (eOnVoxel) { // compatibility, a per voxel event driven by the batch
+			for (uint32_t i = 0; i < batch.count; ++i) {
+				XMVECTOR xmIndex(XMVectorSet(batch.index_x[i], batch.index_y[i], batch.index_z[i], 0.0f));
+				batch.voxel[i] = (*eOnVoxel)(xmIndex, batch.voxel[i], owner_gameobject, batch.vxl_index[i]);
+
+				XMFLOAT3A vIndex;
+				XMStoreFloat3A(&vIndex, xmIndex);
+				batch.index_x[i] = vIndex.x; batch.index_y[i] = vIndex.y; batch.index_z[i] = vIndex.z;
+			}
+		}
+	}
 
 	class alignas(16) voxelModelInstance_Dynamic : public voxelModelInstance<voxB::DYNAMIC>
 	{
@@ -209,6 +278,8 @@ namespace Volumetric
 		void __vectorcall setPitchYawRoll(v2_rotation_t const& xPitch, v2_rotation_t const& yYaw, v2_rotation_t const& zRoll) { _vPitch = xPitch; _vRoll = zRoll; synchronize(yYaw); }
 		void __vectorcall setTransform(FXMVECTOR const xmLoc, v2_rotation_t const& xPitch, v2_rotation_t const& yYaw, v2_rotation_t const& zRoll);
 
+		void __vectorcall synchronizeDeferred(FXMVECTOR const xmLoc, v2_rotation_t const vYawFrom, v2_rotation_t const vYaw); // apply phase of world::deferred only
+
 	public:
 		__inline bool const XM_CALLCONV Render(FXMVECTOR xmVoxelOrigin, point2D_t const voxelIndex, bool bVisible,
 											   voxelBufferReference_Static& __restrict statics,
@@ -217,7 +288,8 @@ namespace Volumetric
 											   tbb::affinity_partitioner& __restrict part) const;
 
 	private:
-		bool const __vectorcall synchronize(FXMVECTOR const xmLoc, v2_rotation_t const vYaw) const; // internally used only
+		bool const __vectorcall synchronize(FXMVECTOR const xmLoc, v2_rotation_t const vYawFrom, v2_rotation_t const vYaw) const; // internally used only
+		void __vectorcall requestSynchronize(FXMVECTOR const xmLoc, v2_rotation_t const vYaw);	// synchronizes now, or records it for the apply phase while deferring (world::deferred)
 		void __vectorcall synchronize(FXMVECTOR const xmLoc);		// must be called whenever a change in location is intended 
 		void __vectorcall synchronize(v2_rotation_t const vYaw);	// must be called whenever a change in only *yaw* rotation is intended 
 
@@ -275,10 +347,10 @@ namespace Volumetric
 			return(false); // model not actually visible, only lights are seeded
 		}
 		else if (isFaded()) {
-			model.Render<false, true>(xmVoxelOrigin, orientation.v4(), *this, statics, dynamics, trans, part);
+			model.Render<false, true>(xmVoxelOrigin, orientation.v4(), *this, statics, dynamics, trans, part, getLOD());
 		}
 		else {
-			model.Render<false, false>(xmVoxelOrigin, orientation.v4(), *this, statics, dynamics, trans, part);
+			model.Render<false, false>(xmVoxelOrigin, orientation.v4(), *this, statics, dynamics, trans, part, getLOD());
 		}
 
 		return(true);
@@ -303,10 +375,10 @@ namespace Volumetric
 			return(false); // model not actually visible, only lights are seeded
 		}
 		else if (isFaded()) {
-			model.Render<false, true>(xmVoxelOrigin, XMVectorZero(), *this, statics, dynamics, trans, part);
+			model.Render<false, true>(xmVoxelOrigin, XMVectorZero(), *this, statics, dynamics, trans, part, getLOD());
 		}
 		else {
-			model.Render<false, false>(xmVoxelOrigin, XMVectorZero(), *this, statics, dynamics, trans, part);
+			model.Render<false, false>(xmVoxelOrigin, XMVectorZero(), *this, statics, dynamics, trans, part, getLOD());
 		}
 
 		return(true);
@@ -2,6 +2,7 @@
 #include <Math/point2D_t.h>
 #include <Math/v2_rotation_t.h>
 #include "IsoVoxel.h"
+#include "SlotMap.h"
 
 // forward decl's
 namespace Volumetric
@@ -80,6 +81,9 @@ namespace world
 	uint32_t const getVoxelsAt_AverageHeight(rect2D_t voxelArea);
 	uint32_t const __vectorcall getVoxelsAt_MaximumHeight(rect2D_t const voxelArea, v2_rotation_t const& __restrict vR); // ""  dynamic ""
 
+	// Grid Space (0,0) to (X, Y) Coordinates Only
+	void __vectorcall markHeightDirtyLocal(point2D_t const voxelIndex); // Iso::setHeightStep() marks every change
+
 	void setVoxelHeightAt(point2D_t const voxelIndex, uint32_t const heightstep);
 	void setVoxelsHeightAt(rect2D_t voxelArea, uint32_t const heightstep);
 	rect2D_t const voxelArea_grow(rect2D_t const voxelArea, point2D_t const grow);
@@ -103,8 +107,8 @@ namespace world
 	point2D_t const __vectorcall getRandomNonVisibleVoxelIndexNear();
 
 	// intended for private usage by cVoxelWorld
-	using mapVoxelModelInstancesStatic = tbb::concurrent_unordered_map<uint32_t const, Volumetric::voxelModelInstance_Static*>;
-	using mapVoxelModelInstancesDynamic = tbb::concurrent_unordered_map<uint32_t const, Volumetric::voxelModelInstance_Dynamic*>;
+	using mapVoxelModelInstancesStatic = tSlotMap<Volumetric::voxelModelInstance_Static*>;
+	using mapVoxelModelInstancesDynamic = tSlotMap<Volumetric::voxelModelInstance_Dynamic*>;
 
 	namespace access
 	{
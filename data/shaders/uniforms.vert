@@ -132,6 +132,8 @@ const uint MASK_ADJACENCY =  0x3FU;		/*           0000 0000 0011 1111 */
 const uint MASK_EMISSION = 0x40U;		/*           0000 0000 01xx xxxx */
 const uint MASK_METALLIC = 0x80U;		/*           0000 0000 1xxx xxxx */
 const uint MASK_ROUGHNESS = 0xF00U;		/*			 0000 1111 xxxx xxxx */ 
+#define SHIFT_LOD 15U
+const uint MASK_LOD = 0x18000U;			/* 0001 1xxx xxxx xxxx xxxx */	// level of detail, voxel is (1 << lod) voxels wide
 
 #if defined(DYNAMIC) && defined(TRANS) 
 #define SHIFT_TRANSPARENCY 13U
@@ -164,7 +166,13 @@ vec4 decode_quaternion(in const vec3 xyz, in const float sgn)
 
 void main() {
   
+  const uint hash = floatBitsToUint(inWorldPos.w);
+
+#if defined(HEIGHT)
 #define size VOX_SIZE
+#else
+  const float size = VOX_SIZE * float(1U << ((hash & MASK_LOD) >> SHIFT_LOD));
+#endif
   { // orientation output vectors right, forward, up
 
 #ifdef DYNAMIC
@@ -185,7 +193,6 @@ void main() {
 #endif
   }
 
-  const uint hash = floatBitsToUint(inWorldPos.w);
   Out.adjacency = (hash & MASK_ADJACENCY);
 
 #if defined(HEIGHT) // terrain only                                                                             // heightstep column: